@@ -0,0 +1,237 @@
+// This file is part of the dune-gdt project:
+//   http://users.dune-project.org/projects/dune-gdt
+// Copyright holders: Felix Schindler
+// License: BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+
+#ifndef DUNE_GDT_ASSEMBLER_BOUNDARY_INDEX_HH
+#define DUNE_GDT_ASSEMBLER_BOUNDARY_INDEX_HH
+
+#include <limits>
+#include <vector>
+
+#include <dune/stuff/common/ranges.hh>
+#include <dune/stuff/grid/boundaryinfo.hh>
+#include <dune/stuff/grid/walker/apply-on.hh>
+
+namespace Dune {
+namespace GDT {
+
+
+/**
+ * \brief Lists all boundary intersections of a grid view, together with their type according to a boundary info.
+ *
+ *        The index is computed once (which is the only time the boundary info is queried) and may then be shared by
+ *        all assemblies on the same grid view and boundary info (see SystemAssembler::add and Functionals::L2Face),
+ *        which then only visit the boundary intersections of the requested type. All other entities are skipped by a
+ *        lookup, no intersection has to be tested against the boundary info during the grid walk.
+ *
+ *        Each entry holds the seed of the inside entity, the local index of the intersection (as in
+ *        intersection.indexInInside()) and its type. The entries of each entity are stored consecutively and can
+ *        be accessed by the index of the entity.
+ * \note  The index is only valid as long as the grid view is not changed, it has to be recomputed after adaptation.
+ */
+template< class GridViewImp >
+class BoundaryIntersectionIndex
+{
+public:
+  typedef GridViewImp                                                   GridViewType;
+  typedef typename GridViewType::template Codim< 0 >::Entity            EntityType;
+  typedef typename GridViewType::Grid::template Codim< 0 >::EntitySeed  EntitySeedType;
+  typedef typename GridViewType::Intersection                           IntersectionType;
+  typedef Stuff::Grid::BoundaryInfoInterface< IntersectionType >        BoundaryInfoType;
+
+  enum class BoundaryType
+  {
+    dirichlet,
+    neumann,
+    other
+  };
+
+  struct Entry
+  {
+    Entry(const EntitySeedType& seed, const int local_index, const BoundaryType tp)
+      : entity_seed(seed)
+      , local_intersection_index(local_index)
+      , type(tp)
+    {}
+
+    EntitySeedType entity_seed;
+    int local_intersection_index;
+    BoundaryType type;
+  }; // struct Entry
+
+  BoundaryIntersectionIndex(const GridViewType& grid_view, const BoundaryInfoType& boundary_info)
+    : grid_view_(grid_view)
+    , first_entry_(grid_view_.indexSet().size(0), std::numeric_limits< size_t >::max())
+    , num_entries_(grid_view_.indexSet().size(0), 0)
+    , num_dirichlet_(0)
+    , num_neumann_(0)
+  {
+    const auto& index_set = grid_view_.indexSet();
+    for (const auto& entity : DSC::entityRange(grid_view_)) {
+      if (!entity.hasBoundaryIntersections())
+        continue;
+      const size_t entity_index = index_set.index(entity);
+      const auto intersection_it_end = grid_view_.iend(entity);
+      for (auto intersection_it = grid_view_.ibegin(entity);
+           intersection_it != intersection_it_end;
+           ++intersection_it) {
+        const auto& intersection = *intersection_it;
+        if (!intersection.boundary() || intersection.neighbor())
+          continue;
+        BoundaryType type = BoundaryType::other;
+        if (boundary_info.dirichlet(intersection)) {
+          type = BoundaryType::dirichlet;
+          ++num_dirichlet_;
+        } else if (boundary_info.neumann(intersection)) {
+          type = BoundaryType::neumann;
+          ++num_neumann_;
+        }
+        if (num_entries_[entity_index] == 0)
+          first_entry_[entity_index] = entries_.size();
+        entries_.emplace_back(entity.seed(), intersection.indexInInside(), type);
+        ++num_entries_[entity_index];
+      }
+    }
+  } // BoundaryIntersectionIndex(...)
+
+  const GridViewType& grid_view() const
+  {
+    return grid_view_;
+  }
+
+  const std::vector< Entry >& entries() const
+  {
+    return entries_;
+  }
+
+  size_t size() const
+  {
+    return entries_.size();
+  }
+
+  size_t size(const BoundaryType type) const
+  {
+    if (type == BoundaryType::dirichlet)
+      return num_dirichlet_;
+    else if (type == BoundaryType::neumann)
+      return num_neumann_;
+    else
+      return entries_.size() - num_dirichlet_ - num_neumann_;
+  } // ... size(...)
+
+  /**
+   * \brief Returns true, if entity has at least one boundary intersection of the given type.
+   */
+  bool contains(const EntityType& entity, const BoundaryType type) const
+  {
+    const size_t entity_index = grid_view_.indexSet().index(entity);
+    const size_t num_entries = num_entries_[entity_index];
+    for (size_t ii = 0; ii < num_entries; ++ii)
+      if (entries_[first_entry_[entity_index] + ii].type == type)
+        return true;
+    return false;
+  } // ... contains(...)
+
+  /**
+   * \brief Calls functor(intersection) for all boundary intersections of entity of the given type.
+   */
+  template< class FunctorType >
+  void for_each_intersection(const EntityType& entity, const BoundaryType type, FunctorType&& functor) const
+  {
+    const size_t entity_index = grid_view_.indexSet().index(entity);
+    const size_t num_entries = num_entries_[entity_index];
+    if (num_entries == 0)
+      return;
+    const size_t first_entry = first_entry_[entity_index];
+    const auto intersection_it_end = grid_view_.iend(entity);
+    for (auto intersection_it = grid_view_.ibegin(entity);
+         intersection_it != intersection_it_end;
+         ++intersection_it) {
+      const auto& intersection = *intersection_it;
+      const int local_index = intersection.indexInInside();
+      for (size_t ii = 0; ii < num_entries; ++ii) {
+        const auto& entry = entries_[first_entry + ii];
+        if (entry.local_intersection_index == local_index && entry.type == type && intersection.boundary()) {
+          functor(intersection);
+          break;
+        }
+      }
+    }
+  } // ... for_each_intersection(...)
+
+  /**
+   * \brief Calls functor(entity, intersection) for all boundary intersections of the given type, without walking
+   *        the grid view.
+   */
+  template< class FunctorType >
+  void for_each(const BoundaryType type, FunctorType&& functor) const
+  {
+    size_t ii = 0;
+    while (ii < entries_.size()) {
+      const auto entity_ptr = grid_view_.grid().entityPointer(entries_[ii].entity_seed);
+      const auto& entity = *entity_ptr;
+      const size_t num_entries = num_entries_[grid_view_.indexSet().index(entity)];
+      bool has_type = false;
+      for (size_t jj = 0; jj < num_entries; ++jj)
+        has_type = has_type || (entries_[ii + jj].type == type);
+      if (has_type)
+        for_each_intersection(entity, type, [&](const IntersectionType& intersection) {
+          functor(entity, intersection);
+        });
+      ii += num_entries;
+    }
+  } // ... for_each(...)
+
+private:
+  const GridViewType grid_view_;
+  std::vector< size_t > first_entry_;
+  std::vector< unsigned char > num_entries_;
+  std::vector< Entry > entries_;
+  size_t num_dirichlet_;
+  size_t num_neumann_;
+}; // class BoundaryIntersectionIndex
+
+
+/**
+ * \brief Selects all entities with at least one boundary intersection of the given type, see
+ *        BoundaryIntersectionIndex.
+ *
+ *        Can be used to restrict entity based functors (as DirichletConstraints) to the relevant entities, e.g.
+\code
+typedef BoundaryIntersectionIndex< GV > IndexType;
+assembler.add(dirichlet_constraints,
+              new IndexedBoundaryEntities< GV >(boundary_index, IndexType::BoundaryType::dirichlet));
+\endcode
+ * \note  The index has to outlive this object.
+ */
+template< class GridViewImp >
+class IndexedBoundaryEntities
+  : public Stuff::Grid::ApplyOn::WhichEntity< GridViewImp >
+{
+public:
+  typedef GridViewImp                                        GridViewType;
+  typedef typename GridViewType::template Codim< 0 >::Entity EntityType;
+  typedef BoundaryIntersectionIndex< GridViewType >          IndexType;
+  typedef typename IndexType::BoundaryType                   BoundaryType;
+
+  IndexedBoundaryEntities(const IndexType& index, const BoundaryType type)
+    : index_(index)
+    , type_(type)
+  {}
+
+  virtual bool apply_on(const GridViewType& /*grid_view*/, const EntityType& entity) const override final
+  {
+    return index_.contains(entity, type_);
+  }
+
+private:
+  const IndexType& index_;
+  const BoundaryType type_;
+}; // class IndexedBoundaryEntities
+
+
+} // namespace GDT
+} // namespace Dune
+
+#endif // DUNE_GDT_ASSEMBLER_BOUNDARY_INDEX_HH
@@ -0,0 +1,165 @@
+// This file is part of the dune-gdt project:
+//   http://users.dune-project.org/projects/dune-gdt
+// Copyright holders: Felix Schindler
+// License: BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+
+#ifndef DUNE_GDT_ASSEMBLER_COSTS_HH
+#define DUNE_GDT_ASSEMBLER_COSTS_HH
+
+#include <algorithm>
+#include <vector>
+
+#include <dune/stuff/common/exceptions.hh>
+
+namespace Dune {
+namespace GDT {
+
+
+template< class GridViewImp >
+class CostWeightedPartitioner;
+
+
+/**
+ * \brief The measured assembly cost (in seconds) of each entity of a grid view, see SystemAssembler::record_costs().
+ *
+ *        The costs can be used as weights to repartition the grid (operator() can be passed as the weight function of
+ *        a load balancing grid, e.g. ALUGrid, scale and round the costs if integral weights are required) and to
+ *        balance the work of the threads in the next walk, see partitioner().
+ * \note  add() may be called concurrently for different entities.
+ */
+template< class GridViewImp >
+class AssemblyCosts
+{
+public:
+  typedef GridViewImp                                        GridViewType;
+  typedef typename GridViewType::template Codim< 0 >::Entity EntityType;
+
+  explicit AssemblyCosts(const GridViewType& grid_view)
+    : grid_view_(grid_view)
+    , costs_(grid_view_.indexSet().size(0), 0.0)
+  {}
+
+  const GridViewType& grid_view() const
+  {
+    return grid_view_;
+  }
+
+  void add(const EntityType& entity, const double seconds)
+  {
+    costs_[grid_view_.indexSet().index(entity)] += seconds;
+  }
+
+  double operator()(const EntityType& entity) const
+  {
+    return costs_[grid_view_.indexSet().index(entity)];
+  }
+
+  /**
+   * \brief The costs of all entities, indexed by the index set of the grid view.
+   */
+  const std::vector< double >& values() const
+  {
+    return costs_;
+  }
+
+  double total() const
+  {
+    double ret = 0.0;
+    for (const auto& cost : costs_)
+      ret += cost;
+    return ret;
+  }
+
+  void clear()
+  {
+    std::fill(costs_.begin(), costs_.end(), 0.0);
+  }
+
+  /**
+   * \brief The maximum total cost of all processes divided by the mean total cost (1 for a perfect balance).
+   * \note  Collective.
+   */
+  double imbalance() const
+  {
+    const auto& comm = grid_view_.comm();
+    const double local_total = total();
+    const double sum = comm.sum(local_total);
+    return sum > 0 ? comm.max(local_total) * comm.size() / sum : 1.0;
+  }
+
+  CostWeightedPartitioner< GridViewType > partitioner(const size_t num_partitions) const
+  {
+    return CostWeightedPartitioner< GridViewType >(*this, num_partitions);
+  }
+
+private:
+  const GridViewType grid_view_;
+  std::vector< double > costs_;
+}; // class AssemblyCosts
+
+
+/**
+ * \brief Assigns the entities (in the order of the index set) to num_partitions consecutive partitions of equal
+ *        cost, for a threaded walk:
+\code
+const auto partitioner = costs.partitioner(num_partitions);
+SeedListPartitioning< GridType, 0 > partitioning(grid_view, partitioner);
+system_assembler.assemble(partitioning);
+\endcode
+ *        Entities without recorded costs count as the mean cost of all entities with recorded costs.
+ */
+template< class GridViewImp >
+class CostWeightedPartitioner
+{
+public:
+  typedef GridViewImp                                        GridViewType;
+  typedef typename GridViewType::template Codim< 0 >::Entity EntityType;
+
+  CostWeightedPartitioner(const AssemblyCosts< GridViewType >& costs, const size_t num_partitions)
+    : grid_view_(costs.grid_view())
+    , num_partitions_(num_partitions)
+    , partition_of_(costs.values().size(), 0)
+  {
+    if (num_partitions_ == 0)
+      DUNE_THROW(Stuff::Exceptions::wrong_input_given, "num_partitions has to be positive!");
+    const auto& values = costs.values();
+    size_t num_recorded = 0;
+    double recorded_total = 0.0;
+    for (const auto& cost : values)
+      if (cost > 0) {
+        ++num_recorded;
+        recorded_total += cost;
+      }
+    const double default_cost = num_recorded > 0 ? recorded_total / num_recorded : 1.0;
+    const double total = recorded_total + (values.size() - num_recorded) * default_cost;
+    double accumulated = 0.0;
+    for (size_t ii = 0; ii < values.size(); ++ii) {
+      const double cost = values[ii] > 0 ? values[ii] : default_cost;
+      // assign each entity to the partition containing the center of its cost interval
+      const size_t partition = static_cast< size_t >((accumulated + 0.5 * cost) / total * num_partitions_);
+      partition_of_[ii] = std::min(partition, num_partitions_ - 1);
+      accumulated += cost;
+    }
+  } // CostWeightedPartitioner(...)
+
+  size_t partitions() const
+  {
+    return num_partitions_;
+  }
+
+  size_t partition(const EntityType& entity) const
+  {
+    return partition_of_[grid_view_.indexSet().index(entity)];
+  }
+
+private:
+  const GridViewType grid_view_;
+  const size_t num_partitions_;
+  std::vector< size_t > partition_of_;
+}; // class CostWeightedPartitioner
+
+
+} // namespace GDT
+} // namespace Dune
+
+#endif // DUNE_GDT_ASSEMBLER_COSTS_HH
@@ -0,0 +1,486 @@
+// This file is part of the dune-gdt project:
+//   http://users.dune-project.org/projects/dune-gdt
+// Copyright holders: Felix Schindler
+// License: BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+
+#ifndef DUNE_GDT_ASSEMBLER_FACE_TABLE_HH
+#define DUNE_GDT_ASSEMBLER_FACE_TABLE_HH
+
+#include <limits>
+#include <vector>
+
+#if HAVE_TBB
+# include <tbb/blocked_range.h>
+# include <tbb/parallel_for.h>
+#endif
+
+#include <boost/numeric/conversion/cast.hpp>
+
+#include <dune/common/fvector.hh>
+
+#include <dune/geometry/quadraturerules.hh>
+
+#include <dune/stuff/common/exceptions.hh>
+#include <dune/stuff/common/ranges.hh>
+
+namespace Dune {
+namespace GDT {
+
+
+/**
+ * \brief Precomputed face connectivity and geometry of a grid view, stored as flat arrays (one per quantity).
+ *
+ *        Each face (i.e., each intersection of the grid view) is contained exactly once: inner faces are owned by the
+ *        inside entity with the smaller index (and are stored as seen from that entity), boundary faces by their only
+ *        entity. Periodic faces (intersections with a neighbor on the domain boundary) are inner faces, see
+ *        periodic(). For each face the table holds
+ *        - the indices (w.r.t. the index set of the grid view) of the inside and the outside entity (invalid() for
+ *          boundary faces) and the local indices of the face in both entities (indexInInside(), indexInOutside()),
+ *        - whether the face lies on the domain boundary and whether its geometry is affine,
+ *        - its volume, center and unit outer normal (at the center).
+ *        If a quadrature order is given, the table additionally holds for each quadrature point of each face the
+ *        point in the reference elements of inside and outside entity, the quadrature weight times the integration
+ *        element and the unit outer normal.
+ *        For each entity the table holds its seed, its volume and the list of all adjacent faces.
+ *
+ *        The topology is computed in one walk, the geometric data is then filled in parallel (if TBB is available and
+ *        requested), one entity at a time. Face kernels (e.g. finite volume fluxes) can thus loop over the arrays
+ *        without materializing entity pointers or intersections and without recomputing normals and face geometries.
+ *        Face assemblies which need the intersections (e.g. of local coupling operators) can use the table to visit
+ *        each inner face once, see SystemAssembler::add.
+ *
+ * \note  The table is only valid as long as the grid view is not changed, it has to be recomputed after adaptation.
+ */
+template< class GridViewImp >
+class FaceTable
+{
+public:
+  typedef GridViewImp                                                   GridViewType;
+  typedef typename GridViewType::template Codim< 0 >::Entity            EntityType;
+  typedef typename GridViewType::Grid::template Codim< 0 >::EntitySeed  EntitySeedType;
+  typedef typename GridViewType::ctype                                  DomainFieldType;
+  static const size_t                                                   dimDomain = GridViewType::dimension;
+  static const size_t                                                   dimWorld = GridViewType::dimensionworld;
+  typedef FieldVector< DomainFieldType, dimWorld >                      WorldType;
+  typedef FieldVector< DomainFieldType, dimDomain >                     LocalType;
+
+  static size_t invalid()
+  {
+    return std::numeric_limits< size_t >::max();
+  }
+
+  /**
+   * \param quadrature_order If non-negative, quadrature data of this order is computed for each face.
+   * \param use_tbb          Fill the geometric data in parallel, if TBB is available.
+   */
+  FaceTable(const GridViewType& grid_view, const int quadrature_order = -1, const bool use_tbb = false)
+    : grid_view_(grid_view)
+    , quadrature_order_(quadrature_order)
+    , periodic_(false)
+  {
+    compute_topology();
+    compute_geometry(use_tbb);
+  } // FaceTable(...)
+
+  const GridViewType& grid_view() const
+  {
+    return grid_view_;
+  }
+
+  int quadrature_order() const
+  {
+    return quadrature_order_;
+  }
+
+  /**
+   * \brief Whether any inner face lies on the domain boundary (i.e., the grid view is periodic).
+   */
+  bool periodic() const
+  {
+    return periodic_;
+  }
+
+  /// \name Entities
+  /// \{
+
+  size_t num_entities() const
+  {
+    return entity_seeds_.size();
+  }
+
+  const EntitySeedType& entity_seed(const size_t entity_index) const
+  {
+    assert(entity_index < entity_seeds_.size());
+    return entity_seeds_[entity_index];
+  }
+
+  const std::vector< DomainFieldType >& entity_volumes() const
+  {
+    return entity_volumes_;
+  }
+
+  /**
+   * \brief Number of faces adjacent to the entity with the given index (as inside or outside entity).
+   */
+  size_t num_faces(const size_t entity_index) const
+  {
+    assert(entity_index + 1 < entity_faces_offsets_.size());
+    return entity_faces_offsets_[entity_index + 1] - entity_faces_offsets_[entity_index];
+  }
+
+  /**
+   * \brief Index of the ii-th face adjacent to the entity with the given index.
+   */
+  size_t face(const size_t entity_index, const size_t ii) const
+  {
+    assert(ii < num_faces(entity_index));
+    return entity_faces_[entity_faces_offsets_[entity_index] + ii];
+  }
+
+  /**
+   * \brief Index of the first face owned by the entity with the given index. The faces owned by an entity are stored
+   *        consecutively, in the order of the intersections of the entity.
+   */
+  size_t first_owned_face(const size_t entity_index) const
+  {
+    assert(entity_index + 1 < owned_faces_offsets_.size());
+    return owned_faces_offsets_[entity_index];
+  }
+
+  size_t num_owned_faces(const size_t entity_index) const
+  {
+    assert(entity_index + 1 < owned_faces_offsets_.size());
+    return owned_faces_offsets_[entity_index + 1] - owned_faces_offsets_[entity_index];
+  }
+
+  /// \}
+  /// \name Faces
+  /// \{
+
+  size_t num_faces() const
+  {
+    return inside_.size();
+  }
+
+  const std::vector< size_t >& insides() const
+  {
+    return inside_;
+  }
+
+  const std::vector< size_t >& outsides() const
+  {
+    return outside_;
+  }
+
+  const std::vector< unsigned char >& local_indices_in_inside() const
+  {
+    return local_index_in_inside_;
+  }
+
+  const std::vector< unsigned char >& local_indices_in_outside() const
+  {
+    return local_index_in_outside_;
+  }
+
+  const std::vector< DomainFieldType >& volumes() const
+  {
+    return volume_;
+  }
+
+  bool boundary(const size_t face) const
+  {
+    return boundary_[face] != 0;
+  }
+
+  bool affine(const size_t face) const
+  {
+    return affine_[face] != 0;
+  }
+
+  WorldType center(const size_t face) const
+  {
+    return get_world(center_, face);
+  }
+
+  WorldType unit_outer_normal(const size_t face) const
+  {
+    return get_world(normal_, face);
+  }
+
+  /// \}
+  /// \name Quadrature data (only available if a non-negative quadrature order was given)
+  /// \{
+
+  size_t num_quadrature_points(const size_t face) const
+  {
+    return quadrature_offsets_[face + 1] - quadrature_offsets_[face];
+  }
+
+  /**
+   * \brief Index of the first quadrature point of the given face, the points of one face are stored consecutively.
+   */
+  size_t quadrature_offset(const size_t face) const
+  {
+    return quadrature_offsets_[face];
+  }
+
+  /**
+   * \brief Quadrature weight times integration element of the qq-th quadrature point (of all faces).
+   */
+  DomainFieldType quadrature_weight(const size_t qq) const
+  {
+    return quadrature_weights_[qq];
+  }
+
+  LocalType quadrature_point_in_inside(const size_t qq) const
+  {
+    return get_local(quadrature_points_in_inside_, qq);
+  }
+
+  /**
+   * \note Only meaningful for inner faces.
+   */
+  LocalType quadrature_point_in_outside(const size_t qq) const
+  {
+    return get_local(quadrature_points_in_outside_, qq);
+  }
+
+  WorldType quadrature_unit_outer_normal(const size_t qq) const
+  {
+    return get_world(quadrature_normals_, qq);
+  }
+
+  /// \}
+
+private:
+  template< class IntersectionType >
+  static bool is_inner(const IntersectionType& intersection)
+  {
+    return intersection.neighbor();
+  }
+
+  template< class IntersectionType >
+  static bool is_boundary(const IntersectionType& intersection)
+  {
+    return intersection.boundary() && !intersection.neighbor();
+  }
+
+  /**
+   * \brief Calls functor(intersection, outside_index) for all intersections owned by entity.
+   */
+  template< class FunctorType >
+  void for_each_owned_intersection(const EntityType& entity, FunctorType&& functor) const
+  {
+    const auto& index_set = grid_view_.indexSet();
+    const size_t entity_index = index_set.index(entity);
+    const auto intersection_it_end = grid_view_.iend(entity);
+    for (auto intersection_it = grid_view_.ibegin(entity);
+         intersection_it != intersection_it_end;
+         ++intersection_it) {
+      const auto& intersection = *intersection_it;
+      if (is_inner(intersection)) {
+        const auto neighbor_ptr = intersection.outside();
+        const size_t neighbor_index = index_set.index(*neighbor_ptr);
+        if (entity_index < neighbor_index)
+          functor(intersection, neighbor_index);
+      } else if (is_boundary(intersection))
+        functor(intersection, invalid());
+    }
+  } // ... for_each_owned_intersection(...)
+
+  void compute_topology()
+  {
+    const auto& index_set = grid_view_.indexSet();
+    const size_t num_entities = index_set.size(0);
+    entity_seeds_.reserve(num_entities);
+    std::vector< size_t > entity_order(num_entities, invalid());
+    // count the owned faces per entity
+    owned_faces_offsets_ = std::vector< size_t >(num_entities + 1, 0);
+    for (const auto& entity : DSC::entityRange(grid_view_)) {
+      const size_t entity_index = index_set.index(entity);
+      entity_order[entity_index] = entity_seeds_.size();
+      entity_seeds_.emplace_back(entity.seed());
+      for_each_owned_intersection(entity, [&](const typename GridViewType::Intersection&, const size_t) {
+        ++owned_faces_offsets_[entity_index + 1];
+      });
+    }
+    if (entity_seeds_.size() != num_entities)
+      DUNE_THROW(Stuff::Exceptions::internal_error,
+                 "The index set of the grid view is not consecutive (" << entity_seeds_.size() << " entities, "
+                 << num_entities << " indices)!");
+    // store the seeds by index
+    std::vector< EntitySeedType > seeds_by_index;
+    seeds_by_index.reserve(num_entities);
+    for (size_t ii = 0; ii < num_entities; ++ii)
+      seeds_by_index.emplace_back(entity_seeds_[entity_order[ii]]);
+    entity_seeds_.swap(seeds_by_index);
+    for (size_t ii = 0; ii < num_entities; ++ii)
+      owned_faces_offsets_[ii + 1] += owned_faces_offsets_[ii];
+    const size_t num_faces = owned_faces_offsets_[num_entities];
+    // compute the connectivity
+    inside_ = std::vector< size_t >(num_faces, invalid());
+    outside_ = std::vector< size_t >(num_faces, invalid());
+    local_index_in_inside_ = std::vector< unsigned char >(num_faces, 0);
+    local_index_in_outside_ = std::vector< unsigned char >(num_faces, 0);
+    boundary_ = std::vector< unsigned char >(num_faces, 0);
+    quadrature_offsets_ = std::vector< size_t >(num_faces + 1, 0);
+    entity_faces_offsets_ = std::vector< size_t >(num_entities + 1, 0);
+    for (const auto& entity : DSC::entityRange(grid_view_)) {
+      const size_t entity_index = index_set.index(entity);
+      size_t face = owned_faces_offsets_[entity_index];
+      for_each_owned_intersection(entity, [&](const typename GridViewType::Intersection& intersection,
+                                              const size_t neighbor_index) {
+        inside_[face] = entity_index;
+        outside_[face] = neighbor_index;
+        local_index_in_inside_[face] = boost::numeric_cast< unsigned char >(intersection.indexInInside());
+        ++entity_faces_offsets_[entity_index + 1];
+        if (neighbor_index != invalid()) {
+          local_index_in_outside_[face] = boost::numeric_cast< unsigned char >(intersection.indexInOutside());
+          ++entity_faces_offsets_[neighbor_index + 1];
+          if (intersection.boundary())
+            periodic_ = true;
+        } else
+          boundary_[face] = 1;
+        if (quadrature_order_ >= 0)
+          quadrature_offsets_[face + 1] = QuadratureRules< DomainFieldType, dimDomain - 1 >::rule(
+                intersection.type(), quadrature_order_).size();
+        ++face;
+      });
+    }
+    // the entity to face adjacency
+    for (size_t ii = 0; ii < num_entities; ++ii)
+      entity_faces_offsets_[ii + 1] += entity_faces_offsets_[ii];
+    entity_faces_ = std::vector< size_t >(entity_faces_offsets_[num_entities], invalid());
+    std::vector< size_t > filled(num_entities, 0);
+    for (size_t face = 0; face < num_faces; ++face) {
+      entity_faces_[entity_faces_offsets_[inside_[face]] + filled[inside_[face]]++] = face;
+      if (outside_[face] != invalid())
+        entity_faces_[entity_faces_offsets_[outside_[face]] + filled[outside_[face]]++] = face;
+    }
+    // the quadrature offsets
+    for (size_t face = 0; face < num_faces; ++face)
+      quadrature_offsets_[face + 1] += quadrature_offsets_[face];
+  } // ... compute_topology(...)
+
+  void compute_geometry(const bool use_tbb)
+  {
+    const size_t num_entities = entity_seeds_.size();
+    const size_t num_faces = inside_.size();
+    const size_t num_quadrature_points = quadrature_offsets_[num_faces];
+    entity_volumes_ = std::vector< DomainFieldType >(num_entities, 0);
+    affine_ = std::vector< unsigned char >(num_faces, 0);
+    volume_ = std::vector< DomainFieldType >(num_faces, 0);
+    center_ = std::vector< DomainFieldType >(num_faces * dimWorld, 0);
+    normal_ = std::vector< DomainFieldType >(num_faces * dimWorld, 0);
+    quadrature_weights_ = std::vector< DomainFieldType >(num_quadrature_points, 0);
+    quadrature_points_in_inside_ = std::vector< DomainFieldType >(num_quadrature_points * dimDomain, 0);
+    quadrature_points_in_outside_ = std::vector< DomainFieldType >(num_quadrature_points * dimDomain, 0);
+    quadrature_normals_ = std::vector< DomainFieldType >(num_quadrature_points * dimWorld, 0);
+#if HAVE_TBB
+    if (use_tbb) {
+      // each entity only writes to the faces it owns, so no synchronization is required
+      tbb::parallel_for(tbb::blocked_range< size_t >(0, num_entities),
+                        [&](const tbb::blocked_range< size_t >& range) {
+                          for (size_t ii = range.begin(); ii != range.end(); ++ii)
+                            this->compute_geometry(ii);
+                        });
+      return;
+    }
+#else // HAVE_TBB
+    static_cast< void >(use_tbb);
+#endif // HAVE_TBB
+    for (size_t ii = 0; ii < num_entities; ++ii)
+      compute_geometry(ii);
+  } // ... compute_geometry(...)
+
+  void compute_geometry(const size_t entity_index)
+  {
+    const auto entity_ptr = grid_view_.grid().entityPointer(entity_seeds_[entity_index]);
+    const auto& entity = *entity_ptr;
+    entity_volumes_[entity_index] = entity.geometry().volume();
+    size_t face = owned_faces_offsets_[entity_index];
+    for_each_owned_intersection(entity, [&](const typename GridViewType::Intersection& intersection,
+                                            const size_t neighbor_index) {
+      const auto face_geometry = intersection.geometry();
+      affine_[face] = face_geometry.affine() ? 1 : 0;
+      volume_[face] = face_geometry.volume();
+      set_world(center_, face, face_geometry.center());
+      const auto center_normal = intersection.centerUnitOuterNormal();
+      set_world(normal_, face, center_normal);
+      if (quadrature_order_ >= 0) {
+        const auto& quadrature = QuadratureRules< DomainFieldType, dimDomain - 1 >::rule(intersection.type(),
+                                                                                          quadrature_order_);
+        const auto geometry_in_inside = intersection.geometryInInside();
+        size_t qq = quadrature_offsets_[face];
+        for (const auto& quadrature_point : quadrature) {
+          const auto& xx = quadrature_point.position();
+          quadrature_weights_[qq] = quadrature_point.weight() * face_geometry.integrationElement(xx);
+          set_local(quadrature_points_in_inside_, qq, geometry_in_inside.global(xx));
+          if (neighbor_index != invalid())
+            set_local(quadrature_points_in_outside_, qq, intersection.geometryInOutside().global(xx));
+          // the normal of an affine face is constant
+          set_world(quadrature_normals_, qq, affine_[face] ? center_normal : intersection.unitOuterNormal(xx));
+          ++qq;
+        }
+      }
+      ++face;
+    });
+  } // ... compute_geometry(...)
+
+  static void set_world(std::vector< DomainFieldType >& values, const size_t ii, const WorldType& value)
+  {
+    for (size_t dd = 0; dd < dimWorld; ++dd)
+      values[ii * dimWorld + dd] = value[dd];
+  }
+
+  static WorldType get_world(const std::vector< DomainFieldType >& values, const size_t ii)
+  {
+    WorldType ret;
+    for (size_t dd = 0; dd < dimWorld; ++dd)
+      ret[dd] = values[ii * dimWorld + dd];
+    return ret;
+  }
+
+  static void set_local(std::vector< DomainFieldType >& values, const size_t ii, const LocalType& value)
+  {
+    for (size_t dd = 0; dd < dimDomain; ++dd)
+      values[ii * dimDomain + dd] = value[dd];
+  }
+
+  static LocalType get_local(const std::vector< DomainFieldType >& values, const size_t ii)
+  {
+    LocalType ret;
+    for (size_t dd = 0; dd < dimDomain; ++dd)
+      ret[dd] = values[ii * dimDomain + dd];
+    return ret;
+  }
+
+  const GridViewType grid_view_;
+  const int quadrature_order_;
+  bool periodic_;
+  std::vector< EntitySeedType > entity_seeds_;
+  std::vector< DomainFieldType > entity_volumes_;
+  std::vector< size_t > entity_faces_offsets_;
+  std::vector< size_t > entity_faces_;
+  std::vector< size_t > owned_faces_offsets_;
+  std::vector< size_t > inside_;
+  std::vector< size_t > outside_;
+  std::vector< unsigned char > local_index_in_inside_;
+  std::vector< unsigned char > local_index_in_outside_;
+  std::vector< unsigned char > boundary_;
+  std::vector< unsigned char > affine_;
+  std::vector< DomainFieldType > volume_;
+  std::vector< DomainFieldType > center_;
+  std::vector< DomainFieldType > normal_;
+  std::vector< size_t > quadrature_offsets_;
+  std::vector< DomainFieldType > quadrature_weights_;
+  std::vector< DomainFieldType > quadrature_points_in_inside_;
+  std::vector< DomainFieldType > quadrature_points_in_outside_;
+  std::vector< DomainFieldType > quadrature_normals_;
+}; // class FaceTable
+
+
+} // namespace GDT
+} // namespace Dune
+
+#endif // DUNE_GDT_ASSEMBLER_FACE_TABLE_HH
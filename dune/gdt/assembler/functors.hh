@@ -0,0 +1,90 @@
+// This file is part of the dune-gdt project:
+//   http://users.dune-project.org/projects/dune-gdt
+// Copyright holders: Felix Schindler
+// License: BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+
+#ifndef DUNE_GDT_ASSEMBLER_FUNCTORS_HH
+#define DUNE_GDT_ASSEMBLER_FUNCTORS_HH
+
+#include <functional>
+#include <utility>
+
+#include <dune/stuff/common/parallel/threadstorage.hh>
+#include <dune/stuff/grid/walker.hh>
+
+namespace Dune {
+namespace GDT {
+namespace internal {
+
+
+/**
+ * \brief Calls the given local computation for each entity of a (possibly threaded) walk, with the storage of the
+ *        current thread (e.g., temporary matrices), which is constructed from the given arguments.
+\code
+internal::Codim0LambdaFunctor< GridViewType, StorageType > functor(local_computation, storage_args...);
+Stuff::Grid::Walker< GridViewType > walker(grid_view);
+walker.add(functor);
+walker.walk(use_tbb);
+\endcode
+ * \note  In a threaded walk the local computation is called concurrently for different entities. It thus has to write
+ *        only to data which belongs to the given entity alone (e.g., its indicator or the DoFs of its faces, if each
+ *        face is handled by one of its entities only).
+ * \sa    Codim0LambdaFunctor< GridViewImp, void > for local computations which do not require any storage.
+ */
+template< class GridViewImp, class StorageImp = void >
+class Codim0LambdaFunctor
+  : public Stuff::Grid::Functor::Codim0< GridViewImp >
+{
+public:
+  typedef StorageImp                                                       StorageType;
+  typedef typename Stuff::Grid::Functor::Codim0< GridViewImp >::EntityType EntityType;
+  typedef std::function< void(const EntityType&, StorageType&) >           LocalComputationType;
+
+  template< class... Args >
+  explicit Codim0LambdaFunctor(const LocalComputationType local_computation, Args&& ...args)
+    : local_computation_(local_computation)
+    , storage_(std::forward< Args >(args)...)
+  {}
+
+  virtual ~Codim0LambdaFunctor() {}
+
+  virtual void apply_local(const EntityType& entity) override final
+  {
+    local_computation_(entity, *storage_);
+  }
+
+private:
+  const LocalComputationType local_computation_;
+  DS::PerThreadValue< StorageType > storage_;
+}; // class Codim0LambdaFunctor
+
+
+template< class GridViewImp >
+class Codim0LambdaFunctor< GridViewImp, void >
+  : public Stuff::Grid::Functor::Codim0< GridViewImp >
+{
+public:
+  typedef typename Stuff::Grid::Functor::Codim0< GridViewImp >::EntityType EntityType;
+  typedef std::function< void(const EntityType&) >                         LocalComputationType;
+
+  explicit Codim0LambdaFunctor(const LocalComputationType local_computation)
+    : local_computation_(local_computation)
+  {}
+
+  virtual ~Codim0LambdaFunctor() {}
+
+  virtual void apply_local(const EntityType& entity) override final
+  {
+    local_computation_(entity);
+  }
+
+private:
+  const LocalComputationType local_computation_;
+}; // class Codim0LambdaFunctor< ..., void >
+
+
+} // namespace internal
+} // namespace GDT
+} // namespace Dune
+
+#endif // DUNE_GDT_ASSEMBLER_FUNCTORS_HH
@@ -106,6 +106,41 @@ public:
     } // write local matrix to global
   } // ... assembleLocal(...)
 
+  /**
+   *  \brief Does the same as the variant above, but takes base function sets, global indices, the geometry and the
+   *         local functions of the local operator from context.
+   *  \tparam C A model of EntityContext, bound to the entity to assemble on
+   */
+  template< class C, class M, class R >
+  void assembleLocal(C& context,
+                     Dune::Stuff::LA::MatrixInterface< M, R >& systemMatrix,
+                     std::vector< std::vector< Dune::DynamicMatrix< R > > >& tmpLocalMatricesContainer) const
+  {
+    // check
+    assert(tmpLocalMatricesContainer.size() >= 2);
+    assert(tmpLocalMatricesContainer[0].size() >= numTmpObjectsRequired_);
+    assert(tmpLocalMatricesContainer[1].size() >= localOperator_.numTmpObjectsRequired());
+    // get and clear matrix
+    auto& localMatrix = tmpLocalMatricesContainer[0][0];
+    localMatrix *= 0.0;
+    auto& tmpOperatorMatrices = tmpLocalMatricesContainer[1];
+    // apply local operator (result is in localMatrix)
+    localOperator_.apply(context, context.test_base(), context.ansatz_base(), localMatrix, tmpOperatorMatrices);
+    // write local matrix to global
+    const auto& globalRows = context.test_indices();
+    const auto& globalCols = context.ansatz_indices();
+    const size_t rows = context.test_size();
+    const size_t cols = context.ansatz_size();
+    assert(globalRows.size() >= rows);
+    assert(globalCols.size() >= cols);
+    for (size_t ii = 0; ii < rows; ++ii) {
+      const auto& localRow = localMatrix[ii];
+      const size_t globalII = globalRows[ii];
+      for (size_t jj = 0; jj < cols; ++jj)
+        systemMatrix.add_to_entry(globalII, globalCols[jj], localRow[jj]);
+    } // write local matrix to global
+  } // ... assembleLocal(...)
+
 private:
   const LocalOperatorType& localOperator_;
 }; // class Codim0Matrix
@@ -175,6 +210,34 @@ public:
     } // write local matrix to global
   } // ... assembleLocal(...)
 
+  /**
+   *  \brief Does the same as the variant above, but takes the base function set, global indices, the geometry and the
+   *         local functions of the local functional from context.
+   *  \tparam C A model of EntityContext, bound to the entity to assemble on
+   */
+  template< class C, class V, class R >
+  void assembleLocal(C& context,
+                     Dune::Stuff::LA::VectorInterface< V, R >& systemVector,
+                     std::vector< std::vector< Dune::DynamicVector< R > > >& tmpLocalVectorContainer) const
+  {
+    // check
+    assert(tmpLocalVectorContainer.size() >= 2);
+    assert(tmpLocalVectorContainer[0].size() >= numTmpObjectsRequired_);
+    assert(tmpLocalVectorContainer[1].size() >= localFunctional_.numTmpObjectsRequired());
+    // get and clear vector
+    auto& localVector = tmpLocalVectorContainer[0][0];
+    localVector *= 0.0;
+    auto& tmpFunctionalVectors = tmpLocalVectorContainer[1];
+    // apply local functional (result is in localVector)
+    localFunctional_.apply(context, context.test_base(), localVector, tmpFunctionalVectors);
+    // write local vector to global
+    const auto& globalIndices = context.test_indices();
+    const size_t size = context.test_size();
+    assert(globalIndices.size() >= size);
+    for (size_t ii = 0; ii < size; ++ii)
+      systemVector.add_to_entry(globalIndices[ii], localVector[ii]);
+  } // ... assembleLocal(...)
+
 private:
   const LocalFunctionalType& localFunctional_;
 }; // class Codim0Vector
@@ -166,6 +166,70 @@ public:
                   tmpIndicesContainer);
   } // void assembleLocal(...) const
 
+  /**
+   *  \brief Does the same as the variant above, but takes base function sets and global indices from the contexts.
+   *  \tparam CE A model of EntityContext, bound to the inside entity of intersection
+   *  \tparam CN A model of EntityContext, bound to the outside entity of intersection
+   */
+  template< class CE, class CN, class IntersectionType, class M, class R >
+  void assembleLocal(CE& entityContext,
+                     CN& neighborContext,
+                     const IntersectionType& intersection,
+                     Dune::Stuff::LA::MatrixInterface< M, R >& systemMatrix,
+                     std::vector< std::vector< Dune::DynamicMatrix< R > > >& tmpLocalMatricesContainer) const
+  {
+    // check
+    assert(tmpLocalMatricesContainer.size() >= 2);
+    assert(tmpLocalMatricesContainer[0].size() >= numTmpObjectsRequired_);
+    assert(tmpLocalMatricesContainer[1].size() >= localOperator_.numTmpObjectsRequired());
+    // get and clear matrix
+    auto& localEntityEntityMatrix = tmpLocalMatricesContainer[0][0];
+    auto& localNeighborNeighborMatrix = tmpLocalMatricesContainer[0][1];
+    auto& localEntityNeighborMatrix = tmpLocalMatricesContainer[0][2];
+    auto& localNeighborEntityMatrix = tmpLocalMatricesContainer[0][3];
+    localEntityEntityMatrix *= 0.0;
+    localNeighborNeighborMatrix *= 0.0;
+    localEntityNeighborMatrix *= 0.0;
+    localNeighborEntityMatrix *= 0.0;
+    auto& tmpOperatorMatrices = tmpLocalMatricesContainer[1];
+    // apply local operator (results are in local*Matrix)
+    localOperator_.apply(entityContext.test_base(), entityContext.ansatz_base(),
+                         neighborContext.test_base(), neighborContext.ansatz_base(),
+                         intersection,
+                         localEntityEntityMatrix,
+                         localNeighborNeighborMatrix,
+                         localEntityNeighborMatrix,
+                         localNeighborEntityMatrix,
+                         tmpOperatorMatrices);
+    // write local matrices to global
+    const size_t rowsEn = entityContext.test_size();
+    const size_t colsEn = entityContext.ansatz_size();
+    const size_t rowsNe = neighborContext.test_size();
+    const size_t colsNe = neighborContext.ansatz_size();
+    const auto& globalRowsEn = entityContext.test_indices();
+    const auto& globalColsEn = entityContext.ansatz_indices();
+    const auto& globalRowsNe = neighborContext.test_indices();
+    const auto& globalColsNe = neighborContext.ansatz_indices();
+    for (size_t ii = 0; ii < rowsEn; ++ii) {
+      const auto& localEntityEntityMatrixRow = localEntityEntityMatrix[ii];
+      const auto& localEntityNeighborMatrixRow = localEntityNeighborMatrix[ii];
+      const size_t globalII = globalRowsEn[ii];
+      for (size_t jj = 0; jj < colsEn; ++jj)
+        systemMatrix.add_to_entry(globalII, globalColsEn[jj], localEntityEntityMatrixRow[jj]);
+      for (size_t jj = 0; jj < colsNe; ++jj)
+        systemMatrix.add_to_entry(globalII, globalColsNe[jj], localEntityNeighborMatrixRow[jj]);
+    }
+    for (size_t ii = 0; ii < rowsNe; ++ii) {
+      const auto& localNeighborEntityMatrixRow = localNeighborEntityMatrix[ii];
+      const auto& localNeighborNeighborMatrixRow = localNeighborNeighborMatrix[ii];
+      const size_t globalII = globalRowsNe[ii];
+      for (size_t jj = 0; jj < colsEn; ++jj)
+        systemMatrix.add_to_entry(globalII, globalColsEn[jj], localNeighborEntityMatrixRow[jj]);
+      for (size_t jj = 0; jj < colsNe; ++jj)
+        systemMatrix.add_to_entry(globalII, globalColsNe[jj], localNeighborNeighborMatrixRow[jj]);
+    }
+  } // void assembleLocal(...) const
+
 private:
   const LocalOperatorType& localOperator_;
 }; // class Codim1CouplingMatrix
@@ -245,6 +309,39 @@ public:
     }
   } // void assembleLocal(...) const
 
+  /**
+   *  \brief Does the same as the variant above, but takes base function sets and global indices from context.
+   *  \tparam C A model of EntityContext, bound to the inside entity of intersection
+   */
+  template< class C, class IntersectionType, class M, class R >
+  void assembleLocal(C& context,
+                     const IntersectionType& intersection,
+                     Dune::Stuff::LA::MatrixInterface< M, R >& systemMatrix,
+                     std::vector< std::vector< Dune::DynamicMatrix< R > > >& tmpLocalMatricesContainer) const
+  {
+    // check
+    assert(tmpLocalMatricesContainer.size() >= 2);
+    assert(tmpLocalMatricesContainer[0].size() >= numTmpObjectsRequired_);
+    assert(tmpLocalMatricesContainer[1].size() >= localOperator_.numTmpObjectsRequired());
+    // get and clear matrix
+    auto& localMatrix = tmpLocalMatricesContainer[0][0];
+    localMatrix *= 0.0;
+    auto& tmpOperatorMatrices = tmpLocalMatricesContainer[1];
+    // apply local operator (results are in local*Matrix)
+    localOperator_.apply(context.test_base(), context.ansatz_base(), intersection, localMatrix, tmpOperatorMatrices);
+    // write local matrices to global
+    const size_t rows = context.test_size();
+    const size_t cols = context.ansatz_size();
+    const auto& globalRows = context.test_indices();
+    const auto& globalCols = context.ansatz_indices();
+    for (size_t ii = 0; ii < rows; ++ii) {
+      const auto& localMatrixRow = localMatrix[ii];
+      const size_t globalII = globalRows[ii];
+      for (size_t jj = 0; jj < cols; ++jj)
+        systemMatrix.add_to_entry(globalII, globalCols[jj], localMatrixRow[jj]);
+    }
+  } // void assembleLocal(...) const
+
 private:
   const LocalOperatorType& localOperator_;
 }; // class Codim1BoundaryMatrix
@@ -308,6 +405,33 @@ public:
     }
   } // void assembleLocal(...) const
 
+  /**
+   *  \brief Does the same as the variant above, but takes the base function set and global indices from context.
+   *  \tparam C A model of EntityContext, bound to the inside entity of intersection
+   */
+  template< class C, class IntersectionType, class V, class R >
+  void assembleLocal(C& context,
+                     const IntersectionType& intersection,
+                     Dune::Stuff::LA::VectorInterface< V, R >& systemVector,
+                     std::vector< std::vector< Dune::DynamicVector< R > > >& tmpLocalVectorsContainer) const
+  {
+    // check
+    assert(tmpLocalVectorsContainer.size() >= 2);
+    assert(tmpLocalVectorsContainer[0].size() >= numTmpObjectsRequired_);
+    assert(tmpLocalVectorsContainer[1].size() >= localFunctional_.numTmpObjectsRequired());
+    // get and clear vector
+    auto& localVector = tmpLocalVectorsContainer[0][0];
+    localVector *= 0.0;
+    auto& tmpFunctionalVectors = tmpLocalVectorsContainer[1];
+    // apply local functional (results are in localVector)
+    localFunctional_.apply(context.test_base(), intersection, localVector, tmpFunctionalVectors);
+    // write local vectors to global
+    const size_t size = context.test_size();
+    const auto& globalIndices = context.test_indices();
+    for (size_t ii = 0; ii < size; ++ii)
+      systemVector.add_to_entry(globalIndices[ii], localVector[ii]);
+  } // void assembleLocal(...) const
+
 private:
   const LocalFunctionalType& localFunctional_;
 }; // class Codim1Vector
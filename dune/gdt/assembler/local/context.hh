@@ -0,0 +1,309 @@
+// This file is part of the dune-gdt project:
+//   http://users.dune-project.org/projects/dune-gdt
+// Copyright holders: Felix Schindler
+// License: BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+
+#ifndef DUNE_GDT_ASSEMBLER_LOCAL_CONTEXT_HH
+#define DUNE_GDT_ASSEMBLER_LOCAL_CONTEXT_HH
+
+#include <limits>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <dune/common/dynvector.hh>
+
+#include <dune/stuff/common/parallel/threadstorage.hh>
+#include <dune/stuff/functions/interfaces.hh>
+
+#include <dune/gdt/spaces/interface.hh>
+
+namespace Dune {
+namespace GDT {
+namespace LocalAssembler {
+
+
+/**
+ * \brief Holds everything the local assemblers of one walk need to know about the current entity.
+ *
+ *        The context is bound to an entity once (see SystemAssembler::apply_local) and then handed to all local
+ *        assemblers of that walk. Base function sets, global indices, the geometry and localized functions are
+ *        created on first request and reused by all subsequent requests for the same entity, instead of being
+ *        recomputed by each local assembler. This pays off in particular for spaces with expensive base function sets
+ *        (e.g., the PDELab based ones) and when several operators and functionals are assembled in one walk (e.g., the
+ *        elliptic operator and an elliptic product with the same diffusion, see LocalOperator::Codim0Integral).
+ *
+ * \note  The context does not own the entity, which has to outlive the binding (as is the case during a grid walk).
+ * \note  The spaces are held as per thread values to be usable in a threaded walk, every thread has to use its own
+ *        context, though.
+ */
+template< class TestSpaceImp, class AnsatzSpaceImp = TestSpaceImp >
+class EntityContext
+{
+  static_assert(is_space< TestSpaceImp >::value,   "TestSpaceImp has to be derived from SpaceInterface!");
+  static_assert(is_space< AnsatzSpaceImp >::value, "AnsatzSpaceImp has to be derived from SpaceInterface!");
+  typedef EntityContext< TestSpaceImp, AnsatzSpaceImp > ThisType;
+public:
+  typedef TestSpaceImp                                   TestSpaceType;
+  typedef AnsatzSpaceImp                                 AnsatzSpaceType;
+  typedef typename TestSpaceType::EntityType             EntityType;
+  typedef typename EntityType::Geometry                  GeometryType;
+  typedef typename TestSpaceType::BaseFunctionSetType    TestBaseType;
+  typedef typename AnsatzSpaceType::BaseFunctionSetType  AnsatzBaseType;
+  typedef Dune::DynamicVector< size_t >                  IndicesType;
+  //! Identifies an entity within a walk (see bind()).
+  typedef std::pair< size_t, size_t >                    KeyType;
+
+  EntityContext(const DS::PerThreadValue< const TestSpaceType >& test_space,
+                const DS::PerThreadValue< const AnsatzSpaceType >& ansatz_space)
+    : test_space_(test_space)
+    , ansatz_space_(ansatz_space)
+    , entity_(nullptr)
+    , key_(invalid_key())
+    , test_indices_(test_space_->mapper().maxNumDofs(), 0)
+    , ansatz_indices_(ansatz_space_->mapper().maxNumDofs(), 0)
+    , test_indices_computed_(false)
+    , ansatz_indices_computed_(false)
+  {}
+
+  /**
+   * \note Only the spaces are copied, the copy is not bound to any entity (required by DS::PerThreadValue).
+   */
+  EntityContext(const ThisType& other)
+    : test_space_(other.test_space_)
+    , ansatz_space_(other.ansatz_space_)
+    , entity_(nullptr)
+    , key_(invalid_key())
+    , test_indices_(other.test_indices_.size(), 0)
+    , ansatz_indices_(other.ansatz_indices_.size(), 0)
+    , test_indices_computed_(false)
+    , ansatz_indices_computed_(false)
+  {}
+
+  ThisType& operator=(const ThisType& other) = delete;
+
+  /**
+   * \brief Binds the context to entity, drops everything computed for the previously bound entity.
+   */
+  void bind(const EntityType& entity)
+  {
+    entity_ = &entity;
+    key_ = invalid_key();
+    test_base_.reset();
+    ansatz_base_.reset();
+    geometry_.reset();
+    test_indices_computed_ = false;
+    ansatz_indices_computed_ = false;
+    local_functions_.clear();
+  } // ... bind(...)
+
+  /**
+   * \brief Binds the context to entity, which is identified by key (e.g., the number of the walk and the index of the
+   *        entity), and keeps everything computed so far if the context is already bound to the same key.
+   * \note  Entities can not be compared by address, since grid iterators reuse their entity objects.
+   */
+  void bind(const EntityType& entity, const KeyType& key)
+  {
+    if (entity_ != nullptr && key == key_) {
+      entity_ = &entity;
+      return;
+    }
+    bind(entity);
+    key_ = key;
+  } // ... bind(...)
+
+  bool bound() const
+  {
+    return entity_ != nullptr;
+  }
+
+  const EntityType& entity() const
+  {
+    assert(bound());
+    return *entity_;
+  }
+
+  const TestSpaceType& test_space() const
+  {
+    return *test_space_;
+  }
+
+  const AnsatzSpaceType& ansatz_space() const
+  {
+    return *ansatz_space_;
+  }
+
+  const GeometryType& geometry()
+  {
+    if (!geometry_)
+      geometry_ = std::unique_ptr< GeometryType >(new GeometryType(entity().geometry()));
+    return *geometry_;
+  }
+
+  const TestBaseType& test_base()
+  {
+    if (!test_base_)
+      test_base_ = std::unique_ptr< TestBaseType >(new TestBaseType(test_space_->base_function_set(entity())));
+    return *test_base_;
+  }
+
+  const AnsatzBaseType& ansatz_base()
+  {
+    if (!ansatz_base_)
+      ansatz_base_ = std::unique_ptr< AnsatzBaseType >(new AnsatzBaseType(ansatz_space_->base_function_set(entity())));
+    return *ansatz_base_;
+  }
+
+  /// \name Global indices of the bound entity, only the first test_size() (ansatz_size()) entries are valid.
+  /// \{
+
+  size_t test_size()
+  {
+    return test_base().size();
+  }
+
+  size_t ansatz_size()
+  {
+    return ansatz_base().size();
+  }
+
+  const IndicesType& test_indices()
+  {
+    if (!test_indices_computed_) {
+      test_space_->mapper().globalIndices(entity(), test_indices_);
+      test_indices_computed_ = true;
+    }
+    return test_indices_;
+  } // ... test_indices(...)
+
+  const IndicesType& ansatz_indices()
+  {
+    if (!ansatz_indices_computed_) {
+      ansatz_space_->mapper().globalIndices(entity(), ansatz_indices_);
+      ansatz_indices_computed_ = true;
+    }
+    return ansatz_indices_;
+  } // ... ansatz_indices(...)
+
+  /// \}
+
+  /**
+   * \brief Returns the localization of function to the bound entity, which is computed only once per entity.
+   * \note  Functions are identified by their address, the cache is thus only valid as long as function lives.
+   */
+  template< class E, class D, size_t d, class R, size_t r, size_t rC >
+  std::shared_ptr< typename Stuff::LocalizableFunctionInterface< E, D, d, R, r, rC >::LocalfunctionType >
+  local_function(const Stuff::LocalizableFunctionInterface< E, D, d, R, r, rC >& function)
+  {
+    typedef typename Stuff::LocalizableFunctionInterface< E, D, d, R, r, rC >::LocalfunctionType LocalfunctionType;
+    const void* key = &function;
+    for (const auto& element : local_functions_)
+      if (element.first == key)
+        return std::static_pointer_cast< LocalfunctionType >(element.second);
+    std::shared_ptr< LocalfunctionType > local_func(function.local_function(entity()));
+    local_functions_.emplace_back(key, local_func);
+    return local_func;
+  } // ... local_function(...)
+
+private:
+  static KeyType invalid_key()
+  {
+    return KeyType(std::numeric_limits< size_t >::max(), std::numeric_limits< size_t >::max());
+  }
+
+  const DS::PerThreadValue< const TestSpaceType >& test_space_;
+  const DS::PerThreadValue< const AnsatzSpaceType >& ansatz_space_;
+  const EntityType* entity_;
+  KeyType key_;
+  std::unique_ptr< TestBaseType > test_base_;
+  std::unique_ptr< AnsatzBaseType > ansatz_base_;
+  std::unique_ptr< GeometryType > geometry_;
+  IndicesType test_indices_;
+  IndicesType ansatz_indices_;
+  bool test_indices_computed_;
+  bool ansatz_indices_computed_;
+  std::vector< std::pair< const void*, std::shared_ptr< void > > > local_functions_;
+}; // class EntityContext
+
+
+/**
+ * \brief The per thread entity contexts of an assembler, which can be redirected to the ones of another assembler.
+ *
+ *        Dereferencing yields the context of the current thread. After share(other) this is the context of other (or
+ *        of whatever other shares with), so an assembler nested into another one (see SystemAssembler::add) computes
+ *        base function sets, global indices and local functions only once per entity together with the outer one.
+ *        Contexts are bound by key, the first part of which is the walk number (see next_walk()), so that bindings of
+ *        previous walks are never reused.
+ */
+template< class EntityContextImp >
+class EntityContexts
+{
+  typedef EntityContexts< EntityContextImp > ThisType;
+public:
+  typedef EntityContextImp                       EntityContextType;
+  typedef typename EntityContextType::KeyType    KeyType;
+  typedef typename EntityContextType::EntityType EntityType;
+
+  template< class... Args >
+  explicit EntityContexts(Args&&... args)
+    : contexts_(std::forward< Args >(args)...)
+    , shared_(nullptr)
+    , walk_(0)
+  {}
+
+  EntityContexts(const ThisType& other) = delete;
+
+  ThisType& operator=(const ThisType& other) = delete;
+
+  EntityContextType& operator*()
+  {
+    return shared_ ? **shared_ : *contexts_;
+  }
+
+  EntityContextType* operator->()
+  {
+    return &(**this);
+  }
+
+  /**
+   * \brief Uses the contexts of other from now on.
+   * \note  other has to outlive this and has to be bound to entities of the same grid view and spaces.
+   */
+  void share(ThisType& other)
+  {
+    if (&other != this)
+      shared_ = &other;
+  }
+
+  //! Starts a new walk, to be called before the walk (i.e., in prepare()).
+  void next_walk()
+  {
+    if (shared_)
+      shared_->next_walk();
+    else
+      ++walk_;
+  }
+
+  size_t walk() const
+  {
+    return shared_ ? shared_->walk() : walk_;
+  }
+
+  //! Binds the context of the current thread to entity, which has the given index in the grid view of the walk.
+  void bind(const EntityType& entity, const size_t index)
+  {
+    (**this).bind(entity, KeyType(walk(), index));
+  }
+
+private:
+  DS::PerThreadValue< EntityContextType > contexts_;
+  ThisType* shared_;
+  size_t walk_;
+}; // class EntityContexts
+
+
+} // namespace LocalAssembler
+} // namespace GDT
+} // namespace Dune
+
+#endif // DUNE_GDT_ASSEMBLER_LOCAL_CONTEXT_HH
@@ -0,0 +1,448 @@
+// This file is part of the dune-gdt project:
+//   http://users.dune-project.org/projects/dune-gdt
+// Copyright holders: Felix Schindler
+// License: BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+
+#ifndef DUNE_GDT_ASSEMBLER_STATIC_CONDENSATION_HH
+#define DUNE_GDT_ASSEMBLER_STATIC_CONDENSATION_HH
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <set>
+#include <vector>
+
+#if HAVE_TBB
+# include <tbb/blocked_range.h>
+# include <tbb/parallel_for.h>
+#endif
+
+#include <boost/numeric/conversion/cast.hpp>
+
+#include <dune/common/dynmatrix.hh>
+#include <dune/common/dynvector.hh>
+
+#include <dune/geometry/quadraturerules.hh>
+
+#include <dune/stuff/common/exceptions.hh>
+#include <dune/stuff/common/parallel/threadstorage.hh>
+#include <dune/stuff/common/tmp-storage.hh>
+#include <dune/stuff/grid/walker.hh>
+#include <dune/stuff/la/container/interfaces.hh>
+#include <dune/stuff/la/container/pattern.hh>
+
+#include <dune/gdt/exceptions.hh>
+#include <dune/gdt/spaces/constraints.hh>
+#include <dune/gdt/spaces/interface.hh>
+
+#include "local/codim0.hh"
+
+namespace Dune {
+namespace GDT {
+
+
+/**
+ * \brief Assembles the Schur complement of the system matrix with respect to the interior DoFs of each entity.
+ *
+ *        For CG spaces of higher order the DoFs whose basis functions vanish on the boundary of an entity (the bubble
+ *        DoFs) only couple with the DoFs of that entity. Given the local matrix of an entity, split into its interior
+ *        (i) and skeleton (s) parts,
+\code
+| A_ss A_si |
+| A_is A_ii |,
+\endcode
+ *        the interior DoFs are eliminated locally and only the Schur complement A_ss - A_si A_ii^{-1} A_is is
+ *        assembled into the reduced system matrix(), which only contains the skeleton DoFs. This is a grid functor,
+ *        which is meant to be added to the SystemAssembler (see below), and the local matrices are given by the
+ *        added local codim 0 assemblers (as for the SystemAssembler, their contributions are summed up).
+ *
+ *        Right hand sides are assembled as usual into a vector of the full space, reduce() condenses them and
+ *        recover() computes the interior DoFs from the solution of the reduced system (in parallel, if requested):
+\code
+StaticCondensation< SpaceType, MatrixType, VectorType > condensation(space);
+condensation.add(local_elliptic_assembler);
+SystemAssembler< SpaceType > system_assembler(space);
+system_assembler.add(condensation);
+system_assembler.add(local_rhs_assembler, rhs_vector);
+system_assembler.add(dirichlet_constraints);
+system_assembler.assemble(true);
+auto reduced_rhs = condensation.reduce(rhs_vector);
+condensation.apply(dirichlet_constraints, reduced_rhs);
+auto reduced_solution = reduced_rhs.copy();
+Stuff::LA::Solver< MatrixType >(condensation.matrix()).apply(reduced_rhs, reduced_solution);
+condensation.recover(reduced_solution, rhs_vector, solution, true);
+\endcode
+ * \note  Neither face terms nor Dirichlet constraints may touch the interior DoFs (which holds for conforming
+ *        spaces, since the interior basis functions vanish on all faces).
+ * \note  The local matrices A_ii^{-1}, A_is and A_si of each entity are kept for reduce() and recover().
+ */
+template< class SpaceImp, class MatrixImp, class VectorImp, class GridViewImp = typename SpaceImp::GridViewType >
+class StaticCondensation
+  : public Stuff::Grid::Functor::Codim0< GridViewImp >
+{
+  static_assert(is_space< SpaceImp >::value, "SpaceImp has to be derived from SpaceInterface!");
+  static_assert(Stuff::LA::is_matrix< MatrixImp >::value,
+                "MatrixImp has to be derived from Stuff::LA::MatrixInterface!");
+  static_assert(Stuff::LA::is_vector< VectorImp >::value,
+                "VectorImp has to be derived from Stuff::LA::VectorInterface!");
+public:
+  typedef SpaceImp                                                         SpaceType;
+  typedef MatrixImp                                                        MatrixType;
+  typedef VectorImp                                                        VectorType;
+  typedef GridViewImp                                                      GridViewType;
+  typedef typename SpaceType::RangeFieldType                               RangeFieldType;
+  typedef typename Stuff::Grid::Functor::Codim0< GridViewImp >::EntityType EntityType;
+private:
+  typedef typename SpaceType::BaseFunctionSetType  BaseFunctionSetType;
+  typedef Dune::DynamicMatrix< RangeFieldType >    LocalMatrixType;
+  typedef Dune::DynamicVector< RangeFieldType >    LocalVectorType;
+  typedef std::function< void(const BaseFunctionSetType&, LocalMatrixType&) > LocalMatrixFunctionType;
+
+  struct LocalData
+  {
+    // the local indices of the interior and skeleton DoFs, the global indices of the interior DoFs and the indices of
+    // the skeleton DoFs in the reduced system
+    std::vector< size_t > interior;
+    std::vector< size_t > skeleton;
+    std::vector< size_t > global_interior;
+    std::vector< size_t > reduced_skeleton;
+    LocalMatrixType inverse_interior_matrix;
+    LocalMatrixType interior_skeleton_matrix;
+    LocalMatrixType skeleton_interior_matrix;
+  }; // struct LocalData
+
+public:
+  StaticCondensation(const SpaceType& spc, const GridViewType& grd_vw)
+    : space_(spc)
+    , grid_view_(grd_vw)
+    , reduced_indices_(spc.mapper().size(), invalid_index())
+    , num_skeleton_DoFs_(0)
+  {
+    setup(spc);
+  }
+
+  explicit StaticCondensation(const SpaceType& spc)
+    : space_(spc)
+    , grid_view_(spc.grid_view())
+    , reduced_indices_(spc.mapper().size(), invalid_index())
+    , num_skeleton_DoFs_(0)
+  {
+    setup(spc);
+  }
+
+  virtual ~StaticCondensation() {}
+
+  /**
+   * \brief Adds the local matrices of local_assembler to the local matrices which are condensed.
+   * \note  local_assembler has to outlive this object.
+   */
+  template< class L >
+  void add(const LocalAssembler::Codim0Matrix< L >& local_assembler)
+  {
+    const size_t max_num_DoFs = space_->mapper().maxNumDofs();
+    const auto tmp_storage = std::make_shared< DSC::TmpMatricesStorage< RangeFieldType > >(
+          local_assembler.numTmpObjectsRequired(), max_num_DoFs, max_num_DoFs);
+    local_matrix_functions_.emplace_back([&local_assembler, tmp_storage](const BaseFunctionSetType& base,
+                                                                         LocalMatrixType& ret) {
+      auto& tmp_matrices = tmp_storage->matrices();
+      auto& local_matrix = tmp_matrices[0][0];
+      local_matrix *= 0.0;
+      local_assembler.localOperator().apply(base, base, local_matrix, tmp_matrices[1]);
+      for (size_t ii = 0; ii < ret.rows(); ++ii)
+        for (size_t jj = 0; jj < ret.cols(); ++jj)
+          ret[ii][jj] += local_matrix[ii][jj];
+    });
+  } // ... add(...)
+
+  /**
+   * \brief The number of DoFs of the reduced system, i.e. the size of matrix().
+   */
+  size_t size() const
+  {
+    return num_skeleton_DoFs_;
+  }
+
+  /**
+   * \brief The index of the given DoF of the space in the reduced system, if it is a skeleton DoF.
+   */
+  size_t reduced_index(const size_t global_index) const
+  {
+    if (reduced_indices_[global_index] == invalid_index())
+      DUNE_THROW(Stuff::Exceptions::wrong_input_given,
+                 "DoF " << global_index << " is an interior DoF and thus not contained in the reduced system!");
+    return reduced_indices_[global_index];
+  }
+
+  const MatrixType& matrix() const
+  {
+    return *matrix_;
+  }
+
+  MatrixType& matrix()
+  {
+    return *matrix_;
+  }
+
+  /**
+   * \brief Clears the reduced matrix, which is thus reassembled in each walk.
+   */
+  virtual void prepare() override final
+  {
+    *matrix_ *= RangeFieldType(0);
+  }
+
+  virtual void apply_local(const EntityType& entity) override final
+  {
+    // each entity only writes to its own local data
+    auto& data = local_data_[grid_view_.indexSet().index(entity)];
+    const auto base = space_->base_function_set(entity);
+    LocalMatrixType local_matrix(base.size(), base.size(), RangeFieldType(0));
+    for (const auto& local_matrix_function : local_matrix_functions_)
+      local_matrix_function(base, local_matrix);
+    // without interior DoFs the local matrix is assembled as is
+    if (data.interior.empty()) {
+      for (size_t ii = 0; ii < data.skeleton.size(); ++ii)
+        for (size_t jj = 0; jj < data.skeleton.size(); ++jj)
+          matrix_->add_to_entry(data.reduced_skeleton[ii],
+                                data.reduced_skeleton[jj],
+                                local_matrix[data.skeleton[ii]][data.skeleton[jj]]);
+      return;
+    }
+    const size_t num_interior = data.interior.size();
+    const size_t num_skeleton = data.skeleton.size();
+    data.inverse_interior_matrix = LocalMatrixType(num_interior, num_interior);
+    data.interior_skeleton_matrix = LocalMatrixType(num_interior, num_skeleton);
+    data.skeleton_interior_matrix = LocalMatrixType(num_skeleton, num_interior);
+    for (size_t ii = 0; ii < num_interior; ++ii) {
+      for (size_t jj = 0; jj < num_interior; ++jj)
+        data.inverse_interior_matrix[ii][jj] = local_matrix[data.interior[ii]][data.interior[jj]];
+      for (size_t jj = 0; jj < num_skeleton; ++jj) {
+        data.interior_skeleton_matrix[ii][jj] = local_matrix[data.interior[ii]][data.skeleton[jj]];
+        data.skeleton_interior_matrix[jj][ii] = local_matrix[data.skeleton[jj]][data.interior[ii]];
+      }
+    }
+    try {
+      data.inverse_interior_matrix.invert();
+    } catch (Dune::FMatrixError& ee) {
+      DUNE_THROW(Stuff::Exceptions::internal_error,
+                 "The local matrix of the interior DoFs could not be inverted!\n\n"
+                 << "This was the original error: " << ee.what());
+    }
+    // A_ii^{-1} A_is
+    LocalMatrixType interior_solution(num_interior, num_skeleton, RangeFieldType(0));
+    for (size_t ii = 0; ii < num_interior; ++ii)
+      for (size_t kk = 0; kk < num_interior; ++kk)
+        for (size_t jj = 0; jj < num_skeleton; ++jj)
+          interior_solution[ii][jj] += data.inverse_interior_matrix[ii][kk]
+                                       * data.interior_skeleton_matrix[kk][jj];
+    // A_ss - A_si A_ii^{-1} A_is
+    for (size_t ii = 0; ii < num_skeleton; ++ii)
+      for (size_t jj = 0; jj < num_skeleton; ++jj) {
+        RangeFieldType value = local_matrix[data.skeleton[ii]][data.skeleton[jj]];
+        for (size_t kk = 0; kk < num_interior; ++kk)
+          value -= data.skeleton_interior_matrix[ii][kk] * interior_solution[kk][jj];
+        matrix_->add_to_entry(data.reduced_skeleton[ii], data.reduced_skeleton[jj], value);
+      }
+  } // ... apply_local(...)
+
+  /**
+   * \brief Applies the Dirichlet constraints to the reduced system, rhs has to be a reduced vector.
+   */
+  template< class IntersectionType >
+  void apply(const Spaces::DirichletConstraints< IntersectionType >& constraints, VectorType& rhs)
+  {
+    assert(rhs.size() == size());
+    for (const auto& DoF : constraints.dirichlet_DoFs()) {
+      matrix_->unit_row(reduced_index(DoF));
+      rhs.set_entry(reduced_index(DoF), RangeFieldType(0));
+    }
+  } // ... apply(...)
+
+  /**
+   * \brief Returns the condensed right hand side b_s - A_si A_ii^{-1} b_i, given the right hand side of the full
+   *        system.
+   * \note  Requires the system matrix to be assembled.
+   */
+  VectorType reduce(const VectorType& rhs) const
+  {
+    if (rhs.size() != reduced_indices_.size())
+      DUNE_THROW(Stuff::Exceptions::shapes_do_not_match,
+                 "The size of rhs (" << rhs.size() << ") does not match the size of the space ("
+                 << reduced_indices_.size() << ")!");
+    VectorType ret(size(), RangeFieldType(0));
+    for (size_t global_index = 0; global_index < reduced_indices_.size(); ++global_index)
+      if (reduced_indices_[global_index] != invalid_index())
+        ret.set_entry(reduced_indices_[global_index], rhs.get_entry(global_index));
+    for (const auto& data : local_data_) {
+      if (data.interior.empty())
+        continue;
+      const auto interior_solution = solve_interior(data, rhs);
+      for (size_t ii = 0; ii < data.skeleton.size(); ++ii) {
+        RangeFieldType value(0);
+        for (size_t kk = 0; kk < data.interior.size(); ++kk)
+          value += data.skeleton_interior_matrix[ii][kk] * interior_solution[kk];
+        ret.add_to_entry(data.reduced_skeleton[ii], -value);
+      }
+    }
+    return ret;
+  } // ... reduce(...)
+
+  /**
+   * \brief Computes the solution of the full system, given the solution of the reduced system and the right hand side
+   *        of the full system, the interior DoFs are given by A_ii^{-1} (b_i - A_is x_s).
+   */
+  void recover(const VectorType& reduced_solution,
+               const VectorType& rhs,
+               VectorType& solution,
+               const bool use_tbb = false) const
+  {
+    if (reduced_solution.size() != size())
+      DUNE_THROW(Stuff::Exceptions::shapes_do_not_match,
+                 "The size of reduced_solution (" << reduced_solution.size() << ") does not match the size of the "
+                 << "reduced system (" << size() << ")!");
+    if (rhs.size() != reduced_indices_.size() || solution.size() != reduced_indices_.size())
+      DUNE_THROW(Stuff::Exceptions::shapes_do_not_match,
+                 "The sizes of rhs (" << rhs.size() << ") and solution (" << solution.size() << ") do not match the "
+                 << "size of the space (" << reduced_indices_.size() << ")!");
+    for (size_t global_index = 0; global_index < reduced_indices_.size(); ++global_index)
+      if (reduced_indices_[global_index] != invalid_index())
+        solution.set_entry(global_index, reduced_solution.get_entry(reduced_indices_[global_index]));
+#if HAVE_TBB
+    if (use_tbb) {
+      // each entity only writes to its own interior DoFs, so no synchronization is required
+      tbb::parallel_for(tbb::blocked_range< size_t >(0, local_data_.size()),
+                        [&](const tbb::blocked_range< size_t >& range) {
+                          for (size_t ii = range.begin(); ii != range.end(); ++ii)
+                            this->recover_interior(local_data_[ii], reduced_solution, rhs, solution);
+                        });
+      return;
+    }
+#else // HAVE_TBB
+    static_cast< void >(use_tbb);
+#endif // HAVE_TBB
+    for (const auto& data : local_data_)
+      recover_interior(data, reduced_solution, rhs, solution);
+  } // ... recover(...)
+
+private:
+  static constexpr size_t invalid_index()
+  {
+    return std::numeric_limits< size_t >::max();
+  }
+
+  // marks all DoFs as interior whose basis functions vanish on all intersections and which belong to a single entity
+  void setup(const SpaceType& space)
+  {
+    typedef typename BaseFunctionSetType::RangeType RangeType;
+    static const size_t dimDomain = GridViewType::dimension;
+    local_data_.resize(grid_view_.indexSet().size(0));
+    std::vector< size_t > num_entities(space.mapper().size(), 0);
+    const auto entity_it_end = grid_view_.template end< 0 >();
+    for (auto entity_it = grid_view_.template begin< 0 >(); entity_it != entity_it_end; ++entity_it)
+      for (const auto& global_index : space.mapper().globalIndices(*entity_it))
+        ++num_entities[global_index];
+    for (auto entity_it = grid_view_.template begin< 0 >(); entity_it != entity_it_end; ++entity_it) {
+      const auto& entity = *entity_it;
+      auto& data = local_data_[grid_view_.indexSet().index(entity)];
+      const auto base = space.base_function_set(entity);
+      const auto global_indices = space.mapper().globalIndices(entity);
+      std::vector< RangeFieldType > trace_norms(base.size(), RangeFieldType(0));
+      std::vector< RangeType > values(base.size(), RangeType(0));
+      const auto intersection_it_end = grid_view_.iend(entity);
+      for (auto intersection_it = grid_view_.ibegin(entity); intersection_it != intersection_it_end;
+           ++intersection_it) {
+        const auto& intersection = *intersection_it;
+        const auto& quadrature = QuadratureRules< typename GridViewType::ctype, dimDomain - 1 >::rule(
+              intersection.type(), boost::numeric_cast< int >(2*base.order()));
+        for (const auto& quadrature_point : quadrature) {
+          base.evaluate(intersection.geometryInInside().global(quadrature_point.position()), values);
+          for (size_t ii = 0; ii < base.size(); ++ii)
+            trace_norms[ii] += quadrature_point.weight() * values[ii].two_norm2();
+        }
+      }
+      // the traces are compared relative to the largest one of the entity, to be independent of the mesh size
+      RangeFieldType max_trace_norm(0);
+      for (const auto& trace_norm : trace_norms)
+        max_trace_norm = std::max(max_trace_norm, trace_norm);
+      for (size_t ii = 0; ii < base.size(); ++ii) {
+        if (trace_norms[ii] <= 1e-12 * max_trace_norm && num_entities[global_indices[ii]] == 1) {
+          data.interior.push_back(ii);
+          data.global_interior.push_back(global_indices[ii]);
+        } else
+          data.skeleton.push_back(ii);
+      }
+    }
+    // number the skeleton DoFs
+    for (size_t global_index = 0; global_index < num_entities.size(); ++global_index)
+      if (num_entities[global_index] > 0)
+        reduced_indices_[global_index] = 0;
+    for (const auto& data : local_data_)
+      for (const auto& global_index : data.global_interior)
+        reduced_indices_[global_index] = invalid_index();
+    for (auto& reduced_index : reduced_indices_)
+      if (reduced_index != invalid_index())
+        reduced_index = num_skeleton_DoFs_++;
+    // the reduced matrix couples all skeleton DoFs of each entity
+    std::vector< std::set< size_t > > rows(num_skeleton_DoFs_);
+    for (auto entity_it = grid_view_.template begin< 0 >(); entity_it != entity_it_end; ++entity_it) {
+      auto& data = local_data_[grid_view_.indexSet().index(*entity_it)];
+      const auto global_indices = space.mapper().globalIndices(*entity_it);
+      for (const auto& local_index : data.skeleton)
+        data.reduced_skeleton.push_back(reduced_indices_[global_indices[local_index]]);
+      for (const auto& ii : data.reduced_skeleton)
+        rows[ii].insert(data.reduced_skeleton.begin(), data.reduced_skeleton.end());
+    }
+    Stuff::LA::SparsityPatternDefault pattern(num_skeleton_DoFs_);
+    for (size_t ii = 0; ii < num_skeleton_DoFs_; ++ii)
+      for (const auto& jj : rows[ii])
+        pattern.inner(ii).push_back(jj);
+    matrix_ = std::make_shared< MatrixType >(num_skeleton_DoFs_, num_skeleton_DoFs_, pattern);
+  } // ... setup(...)
+
+  // A_ii^{-1} b_i
+  LocalVectorType solve_interior(const LocalData& data, const VectorType& rhs) const
+  {
+    LocalVectorType ret(data.interior.size(), RangeFieldType(0));
+    for (size_t ii = 0; ii < data.interior.size(); ++ii)
+      for (size_t kk = 0; kk < data.interior.size(); ++kk)
+        ret[ii] += data.inverse_interior_matrix[ii][kk] * rhs.get_entry(data.global_interior[kk]);
+    return ret;
+  }
+
+  void recover_interior(const LocalData& data,
+                        const VectorType& reduced_solution,
+                        const VectorType& rhs,
+                        VectorType& solution) const
+  {
+    if (data.interior.empty())
+      return;
+    LocalVectorType local_rhs(data.interior.size(), RangeFieldType(0));
+    for (size_t ii = 0; ii < data.interior.size(); ++ii) {
+      local_rhs[ii] = rhs.get_entry(data.global_interior[ii]);
+      for (size_t jj = 0; jj < data.skeleton.size(); ++jj)
+        local_rhs[ii] -= data.interior_skeleton_matrix[ii][jj]
+                         * reduced_solution.get_entry(data.reduced_skeleton[jj]);
+    }
+    for (size_t ii = 0; ii < data.interior.size(); ++ii) {
+      RangeFieldType value(0);
+      for (size_t kk = 0; kk < data.interior.size(); ++kk)
+        value += data.inverse_interior_matrix[ii][kk] * local_rhs[kk];
+      solution.set_entry(data.global_interior[ii], value);
+    }
+  } // ... recover_interior(...)
+
+  const DS::PerThreadValue< const SpaceType > space_;
+  const GridViewType grid_view_;
+  std::vector< size_t > reduced_indices_;
+  size_t num_skeleton_DoFs_;
+  std::vector< LocalData > local_data_;
+  std::shared_ptr< MatrixType > matrix_;
+  std::vector< LocalMatrixFunctionType > local_matrix_functions_;
+}; // class StaticCondensation
+
+
+} // namespace GDT
+} // namespace Dune
+
+#endif // DUNE_GDT_ASSEMBLER_STATIC_CONDENSATION_HH
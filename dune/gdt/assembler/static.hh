@@ -0,0 +1,530 @@
+// This file is part of the dune-gdt project:
+//   http://users.dune-project.org/projects/dune-gdt
+// Copyright holders: Felix Schindler
+// License: BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+
+#ifndef DUNE_GDT_ASSEMBLER_STATIC_HH
+#define DUNE_GDT_ASSEMBLER_STATIC_HH
+
+#include <memory>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if HAVE_TBB
+# include <tbb/blocked_range.h>
+# include <tbb/parallel_for.h>
+#endif
+
+#include <dune/stuff/common/memory.hh>
+#include <dune/stuff/common/ranges.hh>
+#include <dune/stuff/common/tmp-storage.hh>
+#include <dune/stuff/common/parallel/threadstorage.hh>
+#include <dune/stuff/la/container/interfaces.hh>
+
+#include <dune/gdt/spaces/interface.hh>
+
+#include "local/codim0.hh"
+#include "local/codim1.hh"
+#include "local/context.hh"
+
+namespace Dune {
+namespace GDT {
+namespace internal {
+
+
+/**
+ * \brief Filter for StaticLocalAssembly, which applies on all entities and all intersections.
+ */
+class ApplyOnEverything
+{
+public:
+  template< class GridViewType, class EntityOrIntersectionType >
+  bool apply_on(const GridViewType& /*grid_view*/, const EntityOrIntersectionType& /*entity_or_intersection*/) const
+  {
+    return true;
+  }
+}; // class ApplyOnEverything
+
+
+/**
+ * \brief Combines a local assembler with the container to assemble into and a filter, see make_local_assembly().
+ *
+ *        The filter is held by value and any type providing apply_on(grid_view, entity_or_intersection) may be used,
+ *        in particular the DSG::ApplyOn classes. Since its dynamic type is known, the call to apply_on() can be
+ *        resolved at compile time.
+ */
+template< class LocalAssemblerType, class ContainerType, class WhereType >
+class StaticLocalAssembly
+{
+  static_assert(AlwaysFalse< LocalAssemblerType >::value, "Please add a specialization for this LocalAssemblerType!");
+};
+
+
+template< class L, class M, class WhereType >
+class StaticLocalAssembly< LocalAssembler::Codim0Matrix< L >, M, WhereType >
+{
+  typedef typename M::ScalarType                    RangeFieldType;
+  typedef DSC::TmpMatricesStorage< RangeFieldType > TmpStorageType;
+public:
+  static const bool needs_intersections = false;
+
+  StaticLocalAssembly(const LocalAssembler::Codim0Matrix< L >& local_assembler, M& matrix, WhereType where)
+    : local_assembler_(local_assembler)
+    , matrix_(matrix)
+    , where_(where)
+  {}
+
+  template< class TestSpaceType, class AnsatzSpaceType >
+  void prepare(const TestSpaceType& test_space, const AnsatzSpaceType& ansatz_space)
+  {
+    assert(matrix_.rows() == test_space.mapper().size());
+    assert(matrix_.cols() == ansatz_space.mapper().size());
+    tmp_storage_ = DSC::make_unique< TmpStorageType >(local_assembler_.numTmpObjectsRequired(),
+                                                      test_space.mapper().maxNumDofs(),
+                                                      ansatz_space.mapper().maxNumDofs());
+  } // ... prepare(...)
+
+  template< class GridViewType, class EntityType, class ContextType >
+  void apply_local(const GridViewType& grid_view, const EntityType& entity, ContextType& context)
+  {
+    if (where_.apply_on(grid_view, entity))
+      local_assembler_.assembleLocal(context, matrix_, tmp_storage_->matrices());
+  }
+
+  template< class GridViewType, class IntersectionType, class ContextType >
+  void apply_local(const GridViewType& /*grid_view*/,
+                   const IntersectionType& /*intersection*/,
+                   ContextType& /*entity_context*/,
+                   ContextType& /*neighbor_context*/)
+  {}
+
+private:
+  const LocalAssembler::Codim0Matrix< L >& local_assembler_;
+  M& matrix_;
+  const WhereType where_;
+  std::unique_ptr< TmpStorageType > tmp_storage_;
+}; // class StaticLocalAssembly< LocalAssembler::Codim0Matrix< ... >, ... >
+
+
+template< class L, class V, class WhereType >
+class StaticLocalAssembly< LocalAssembler::Codim0Vector< L >, V, WhereType >
+{
+  typedef typename V::ScalarType                   RangeFieldType;
+  typedef DSC::TmpVectorsStorage< RangeFieldType > TmpStorageType;
+public:
+  static const bool needs_intersections = false;
+
+  StaticLocalAssembly(const LocalAssembler::Codim0Vector< L >& local_assembler, V& vector, WhereType where)
+    : local_assembler_(local_assembler)
+    , vector_(vector)
+    , where_(where)
+  {}
+
+  template< class TestSpaceType, class AnsatzSpaceType >
+  void prepare(const TestSpaceType& test_space, const AnsatzSpaceType& /*ansatz_space*/)
+  {
+    assert(vector_.size() == test_space.mapper().size());
+    tmp_storage_ = DSC::make_unique< TmpStorageType >(local_assembler_.numTmpObjectsRequired(),
+                                                      test_space.mapper().maxNumDofs());
+  }
+
+  template< class GridViewType, class EntityType, class ContextType >
+  void apply_local(const GridViewType& grid_view, const EntityType& entity, ContextType& context)
+  {
+    if (where_.apply_on(grid_view, entity))
+      local_assembler_.assembleLocal(context, vector_, tmp_storage_->vectors());
+  }
+
+  template< class GridViewType, class IntersectionType, class ContextType >
+  void apply_local(const GridViewType& /*grid_view*/,
+                   const IntersectionType& /*intersection*/,
+                   ContextType& /*entity_context*/,
+                   ContextType& /*neighbor_context*/)
+  {}
+
+private:
+  const LocalAssembler::Codim0Vector< L >& local_assembler_;
+  V& vector_;
+  const WhereType where_;
+  std::unique_ptr< TmpStorageType > tmp_storage_;
+}; // class StaticLocalAssembly< LocalAssembler::Codim0Vector< ... >, ... >
+
+
+template< class L, class M, class WhereType >
+class StaticLocalAssembly< LocalAssembler::Codim1CouplingMatrix< L >, M, WhereType >
+{
+  typedef typename M::ScalarType                    RangeFieldType;
+  typedef DSC::TmpMatricesStorage< RangeFieldType > TmpStorageType;
+public:
+  static const bool needs_intersections = true;
+
+  StaticLocalAssembly(const LocalAssembler::Codim1CouplingMatrix< L >& local_assembler, M& matrix, WhereType where)
+    : local_assembler_(local_assembler)
+    , matrix_(matrix)
+    , where_(where)
+  {}
+
+  template< class TestSpaceType, class AnsatzSpaceType >
+  void prepare(const TestSpaceType& test_space, const AnsatzSpaceType& ansatz_space)
+  {
+    assert(matrix_.rows() == test_space.mapper().size());
+    assert(matrix_.cols() == ansatz_space.mapper().size());
+    tmp_storage_ = DSC::make_unique< TmpStorageType >(local_assembler_.numTmpObjectsRequired(),
+                                                      test_space.mapper().maxNumDofs(),
+                                                      ansatz_space.mapper().maxNumDofs());
+  } // ... prepare(...)
+
+  template< class GridViewType, class EntityType, class ContextType >
+  void apply_local(const GridViewType& /*grid_view*/, const EntityType& /*entity*/, ContextType& /*context*/)
+  {}
+
+  template< class GridViewType, class IntersectionType, class ContextType >
+  void apply_local(const GridViewType& grid_view,
+                   const IntersectionType& intersection,
+                   ContextType& entity_context,
+                   ContextType& neighbor_context)
+  {
+    if (where_.apply_on(grid_view, intersection))
+      local_assembler_.assembleLocal(entity_context, neighbor_context, intersection, matrix_,
+                                     tmp_storage_->matrices());
+  }
+
+private:
+  const LocalAssembler::Codim1CouplingMatrix< L >& local_assembler_;
+  M& matrix_;
+  const WhereType where_;
+  std::unique_ptr< TmpStorageType > tmp_storage_;
+}; // class StaticLocalAssembly< LocalAssembler::Codim1CouplingMatrix< ... >, ... >
+
+
+template< class L, class M, class WhereType >
+class StaticLocalAssembly< LocalAssembler::Codim1BoundaryMatrix< L >, M, WhereType >
+{
+  typedef typename M::ScalarType                    RangeFieldType;
+  typedef DSC::TmpMatricesStorage< RangeFieldType > TmpStorageType;
+public:
+  static const bool needs_intersections = true;
+
+  StaticLocalAssembly(const LocalAssembler::Codim1BoundaryMatrix< L >& local_assembler, M& matrix, WhereType where)
+    : local_assembler_(local_assembler)
+    , matrix_(matrix)
+    , where_(where)
+  {}
+
+  template< class TestSpaceType, class AnsatzSpaceType >
+  void prepare(const TestSpaceType& test_space, const AnsatzSpaceType& ansatz_space)
+  {
+    assert(matrix_.rows() == test_space.mapper().size());
+    assert(matrix_.cols() == ansatz_space.mapper().size());
+    tmp_storage_ = DSC::make_unique< TmpStorageType >(local_assembler_.numTmpObjectsRequired(),
+                                                      test_space.mapper().maxNumDofs(),
+                                                      ansatz_space.mapper().maxNumDofs());
+  } // ... prepare(...)
+
+  template< class GridViewType, class EntityType, class ContextType >
+  void apply_local(const GridViewType& /*grid_view*/, const EntityType& /*entity*/, ContextType& /*context*/)
+  {}
+
+  template< class GridViewType, class IntersectionType, class ContextType >
+  void apply_local(const GridViewType& grid_view,
+                   const IntersectionType& intersection,
+                   ContextType& entity_context,
+                   ContextType& /*neighbor_context*/)
+  {
+    if (where_.apply_on(grid_view, intersection))
+      local_assembler_.assembleLocal(entity_context, intersection, matrix_, tmp_storage_->matrices());
+  }
+
+private:
+  const LocalAssembler::Codim1BoundaryMatrix< L >& local_assembler_;
+  M& matrix_;
+  const WhereType where_;
+  std::unique_ptr< TmpStorageType > tmp_storage_;
+}; // class StaticLocalAssembly< LocalAssembler::Codim1BoundaryMatrix< ... >, ... >
+
+
+template< class L, class V, class WhereType >
+class StaticLocalAssembly< LocalAssembler::Codim1Vector< L >, V, WhereType >
+{
+  typedef typename V::ScalarType                   RangeFieldType;
+  typedef DSC::TmpVectorsStorage< RangeFieldType > TmpStorageType;
+public:
+  static const bool needs_intersections = true;
+
+  StaticLocalAssembly(const LocalAssembler::Codim1Vector< L >& local_assembler, V& vector, WhereType where)
+    : local_assembler_(local_assembler)
+    , vector_(vector)
+    , where_(where)
+  {}
+
+  template< class TestSpaceType, class AnsatzSpaceType >
+  void prepare(const TestSpaceType& test_space, const AnsatzSpaceType& /*ansatz_space*/)
+  {
+    assert(vector_.size() == test_space.mapper().size());
+    tmp_storage_ = DSC::make_unique< TmpStorageType >(local_assembler_.numTmpObjectsRequired(),
+                                                      test_space.mapper().maxNumDofs());
+  }
+
+  template< class GridViewType, class EntityType, class ContextType >
+  void apply_local(const GridViewType& /*grid_view*/, const EntityType& /*entity*/, ContextType& /*context*/)
+  {}
+
+  template< class GridViewType, class IntersectionType, class ContextType >
+  void apply_local(const GridViewType& grid_view,
+                   const IntersectionType& intersection,
+                   ContextType& entity_context,
+                   ContextType& /*neighbor_context*/)
+  {
+    if (where_.apply_on(grid_view, intersection))
+      local_assembler_.assembleLocal(entity_context, intersection, vector_, tmp_storage_->vectors());
+  }
+
+private:
+  const LocalAssembler::Codim1Vector< L >& local_assembler_;
+  V& vector_;
+  const WhereType where_;
+  std::unique_ptr< TmpStorageType > tmp_storage_;
+}; // class StaticLocalAssembly< LocalAssembler::Codim1Vector< ... >, ... >
+
+
+template< class... Assemblies >
+struct any_needs_intersections
+{
+  static const bool value = false;
+};
+
+template< class A, class... Assemblies >
+struct any_needs_intersections< A, Assemblies... >
+{
+  static const bool value = A::needs_intersections || any_needs_intersections< Assemblies... >::value;
+};
+
+
+} // namespace internal
+
+
+/**
+ * \brief A variant of SystemAssembler, where the local assemblies are known at compile time.
+ *
+ *        SystemAssembler (as any DSG::Walker) stores its functors in a vector and calls several virtual methods per
+ *        entity (or intersection) and functor. In contrast, this assembler holds all local assemblies in a tuple, so
+ *        the complete walk over the grid can be inlined. This pays off for cheap local problems on many entities
+ *        (e.g., finite volumes or first order elements), where the virtual calls are a measurable part of the walk.
+ *        Use SystemAssembler, if the operators and functionals to assemble are only known at runtime.
+ *
+ *        Create one by make_system_assembler(), passing the local assemblies created by make_local_assembly():
+\code
+auto assembler = make_system_assembler(space,
+                                       make_local_assembly(elliptic_local_assembler, system_matrix),
+                                       make_local_assembly(force_local_assembler, rhs_vector),
+                                       make_local_assembly(neumann_local_assembler,
+                                                           rhs_vector,
+                                                           DSG::ApplyOn::NeumannIntersections< GV >(boundary_info)));
+assembler->assemble();
+\endcode
+ * \note  The local assemblies are assembled in the order they were given, on each entity and intersection.
+ */
+template< class TestSpaceImp, class GridViewImp, class AnsatzSpaceImp, class... LocalAssemblyImps >
+class StaticSystemAssembler
+{
+  static_assert(GDT::is_space< TestSpaceImp >::value,   "TestSpaceImp has to be derived from SpaceInterface!");
+  static_assert(GDT::is_space< AnsatzSpaceImp >::value, "AnsatzSpaceImp has to be derived from SpaceInterface!");
+  static_assert(std::is_same< typename TestSpaceImp::RangeFieldType, typename AnsatzSpaceImp::RangeFieldType >::value,
+                "Types do not match!");
+  static const size_t num_assemblies = sizeof...(LocalAssemblyImps);
+  static const bool needs_intersections = internal::any_needs_intersections< LocalAssemblyImps... >::value;
+public:
+  typedef TestSpaceImp                                                    TestSpaceType;
+  typedef AnsatzSpaceImp                                                  AnsatzSpaceType;
+  typedef GridViewImp                                                     GridViewType;
+  typedef typename TestSpaceType::RangeFieldType                          RangeFieldType;
+  typedef typename GridViewType::template Codim< 0 >::Entity              EntityType;
+  typedef typename GridViewType::Intersection                             IntersectionType;
+  typedef LocalAssembler::EntityContext< TestSpaceType, AnsatzSpaceType > EntityContextType;
+
+  StaticSystemAssembler(TestSpaceType test, AnsatzSpaceType ansatz, GridViewType grid_view,
+                        LocalAssemblyImps&&... local_assemblies)
+    : test_space_(test)
+    , ansatz_space_(ansatz)
+    , grid_view_(grid_view)
+    , entity_context_(test_space_, ansatz_space_)
+    , neighbor_context_(test_space_, ansatz_space_)
+    , local_assemblies_(std::move(local_assemblies)...)
+  {}
+
+  const TestSpaceType& test_space() const
+  {
+    return *test_space_;
+  }
+
+  const AnsatzSpaceType& ansatz_space() const
+  {
+    return *ansatz_space_;
+  }
+
+  const GridViewType& grid_view() const
+  {
+    return grid_view_;
+  }
+
+  void assemble()
+  {
+    prepare< 0 >();
+    walk_range(DSC::entityRange(grid_view_));
+  }
+
+  /**
+   * \brief Assembles in parallel, if TBB is available, one partition per task.
+   * \note  The same partitionings as for SystemAssembler::assemble() can be used.
+   */
+  template< class Partitioning >
+  void assemble(const Partitioning& partitioning)
+  {
+    prepare< 0 >();
+#if HAVE_TBB
+    tbb::parallel_for(tbb::blocked_range< std::size_t >(0, partitioning.partitions()),
+                      [&](const tbb::blocked_range< std::size_t >& range) {
+                        for (std::size_t pp = range.begin(); pp != range.end(); ++pp)
+                          this->walk_range(partitioning.partition(pp));
+                      });
+#else // HAVE_TBB
+    for (std::size_t pp = 0; pp < partitioning.partitions(); ++pp)
+      walk_range(partitioning.partition(pp));
+#endif // HAVE_TBB
+  } // ... assemble(...)
+
+private:
+  template< class EntityRange >
+  void walk_range(const EntityRange& entity_range)
+  {
+    auto& entity_context = *entity_context_;
+    auto& neighbor_context = *neighbor_context_;
+    for (const EntityType& entity : entity_range) {
+      entity_context.bind(entity);
+      apply_local< 0 >(entity, entity_context);
+      if (needs_intersections) {
+        const auto intersection_it_end = grid_view_.iend(entity);
+        for (auto intersection_it = grid_view_.ibegin(entity);
+             intersection_it != intersection_it_end;
+             ++intersection_it) {
+          const IntersectionType& intersection = *intersection_it;
+          if (intersection.neighbor()) {
+            const auto neighbor_ptr = intersection.outside();
+            const auto& neighbor = *neighbor_ptr;
+            neighbor_context.bind(neighbor);
+            apply_local< 0 >(intersection, entity_context, neighbor_context);
+          } else {
+            neighbor_context.bind(entity);
+            apply_local< 0 >(intersection, entity_context, neighbor_context);
+          }
+        }
+      }
+    }
+  } // ... walk_range(...)
+
+  template< size_t ii >
+  typename std::enable_if< (ii < num_assemblies), void >::type prepare()
+  {
+    std::get< ii >(local_assemblies_).prepare(*test_space_, *ansatz_space_);
+    prepare< ii + 1 >();
+  }
+
+  template< size_t ii >
+  typename std::enable_if< (ii == num_assemblies), void >::type prepare()
+  {}
+
+  template< size_t ii >
+  typename std::enable_if< (ii < num_assemblies), void >::type apply_local(const EntityType& entity,
+                                                                            EntityContextType& context)
+  {
+    std::get< ii >(local_assemblies_).apply_local(grid_view_, entity, context);
+    apply_local< ii + 1 >(entity, context);
+  }
+
+  template< size_t ii >
+  typename std::enable_if< (ii == num_assemblies), void >::type apply_local(const EntityType& /*entity*/,
+                                                                             EntityContextType& /*context*/)
+  {}
+
+  template< size_t ii >
+  typename std::enable_if< (ii < num_assemblies), void >::type apply_local(const IntersectionType& intersection,
+                                                                            EntityContextType& entity_context,
+                                                                            EntityContextType& neighbor_context)
+  {
+    std::get< ii >(local_assemblies_).apply_local(grid_view_, intersection, entity_context, neighbor_context);
+    apply_local< ii + 1 >(intersection, entity_context, neighbor_context);
+  }
+
+  template< size_t ii >
+  typename std::enable_if< (ii == num_assemblies), void >::type apply_local(const IntersectionType& /*intersection*/,
+                                                                             EntityContextType& /*entity_context*/,
+                                                                             EntityContextType& /*neighbor_context*/)
+  {}
+
+  const DS::PerThreadValue< const TestSpaceType > test_space_;
+  const DS::PerThreadValue< const AnsatzSpaceType > ansatz_space_;
+  const GridViewType grid_view_;
+  DS::PerThreadValue< EntityContextType > entity_context_;
+  DS::PerThreadValue< EntityContextType > neighbor_context_;
+  std::tuple< LocalAssemblyImps... > local_assemblies_;
+}; // class StaticSystemAssembler
+
+
+/// \name Create local assemblies to be used with make_system_assembler().
+/// \{
+
+template< class LocalAssemblerType, class C, class R >
+internal::StaticLocalAssembly< LocalAssemblerType, C, internal::ApplyOnEverything >
+make_local_assembly(const LocalAssemblerType& local_assembler, Stuff::LA::MatrixInterface< C, R >& matrix)
+{
+  return internal::StaticLocalAssembly< LocalAssemblerType, C, internal::ApplyOnEverything >(
+        local_assembler, matrix.as_imp(), internal::ApplyOnEverything());
+}
+
+template< class LocalAssemblerType, class C, class R, class WhereType >
+internal::StaticLocalAssembly< LocalAssemblerType, C, WhereType >
+make_local_assembly(const LocalAssemblerType& local_assembler,
+                    Stuff::LA::MatrixInterface< C, R >& matrix,
+                    const WhereType& where)
+{
+  return internal::StaticLocalAssembly< LocalAssemblerType, C, WhereType >(local_assembler, matrix.as_imp(), where);
+}
+
+template< class LocalAssemblerType, class C, class R >
+internal::StaticLocalAssembly< LocalAssemblerType, C, internal::ApplyOnEverything >
+make_local_assembly(const LocalAssemblerType& local_assembler, Stuff::LA::VectorInterface< C, R >& vector)
+{
+  return internal::StaticLocalAssembly< LocalAssemblerType, C, internal::ApplyOnEverything >(
+        local_assembler, vector.as_imp(), internal::ApplyOnEverything());
+}
+
+template< class LocalAssemblerType, class C, class R, class WhereType >
+internal::StaticLocalAssembly< LocalAssemblerType, C, WhereType >
+make_local_assembly(const LocalAssemblerType& local_assembler,
+                    Stuff::LA::VectorInterface< C, R >& vector,
+                    const WhereType& where)
+{
+  return internal::StaticLocalAssembly< LocalAssemblerType, C, WhereType >(local_assembler, vector.as_imp(), where);
+}
+
+/// \}
+
+
+template< class SpaceType, class... LocalAssemblyTypes >
+    std::unique_ptr< StaticSystemAssembler< SpaceType, typename SpaceType::GridViewType, SpaceType,
+                                            LocalAssemblyTypes... > >
+make_system_assembler(const SpaceType& space, LocalAssemblyTypes... local_assemblies)
+{
+  static_assert(is_space< SpaceType >::value, "SpaceType has to be derived from SpaceInterface!");
+  return DSC::make_unique< StaticSystemAssembler< SpaceType, typename SpaceType::GridViewType, SpaceType,
+                                                  LocalAssemblyTypes... > >(
+        space, space, space.grid_view(), std::move(local_assemblies)...);
+}
+
+
+} // namespace GDT
+} // namespace Dune
+
+#endif // DUNE_GDT_ASSEMBLER_STATIC_HH
@@ -6,8 +6,10 @@
 #ifndef DUNE_GDT_ASSEMBLER_SYSTEM_HH
 #define DUNE_GDT_ASSEMBLER_SYSTEM_HH
 
+#include <chrono>
 #include <type_traits>
 #include <memory>
+#include <vector>
 
 #include <dune/common/deprecated.hh>
 #include <dune/common/version.hh>
@@ -17,15 +19,28 @@
 
 #include <dune/gdt/spaces/interface.hh>
 #include <dune/gdt/spaces/constraints.hh>
+#include <dune/gdt/spaces/parallel.hh>
 
 #include "local/codim0.hh"
 #include "local/codim1.hh"
+#include "local/context.hh"
+#include "boundary-index.hh"
+#include "costs.hh"
+#include "face-table.hh"
 #include "wrapper.hh"
 
 namespace Dune {
 namespace GDT {
 
 
+/**
+ * \brief Assembles all added local assemblers in one grid walk.
+ *
+ *        Each entity (and the outside entity of each intersection) is bound to a LocalAssembler::EntityContext, which
+ *        is shared by all local assemblers. Base function sets and global indices are thus computed at most once per
+ *        entity and walk, regardless of the number of operators and functionals which are assembled. This includes
+ *        assemblers added to this one (see add(ThisType&, ...)), which then use the contexts of this assembler.
+ */
 template< class TestSpaceImp,
           class GridViewImp = typename TestSpaceImp::GridViewType,
           class AnsatzSpaceImp = TestSpaceImp >
@@ -50,28 +65,44 @@ public:
   typedef DSG::ApplyOn::WhichEntity< GridViewType >       ApplyOnWhichEntity;
   typedef DSG::ApplyOn::WhichIntersection< GridViewType > ApplyOnWhichIntersection;
 
+  typedef LocalAssembler::EntityContext< TestSpaceType, AnsatzSpaceType > EntityContextType;
+  typedef LocalAssembler::EntityContexts< EntityContextType >             EntityContextsType;
+  typedef AssemblyCosts< GridViewType >                                   CostsType;
+
   SystemAssembler(TestSpaceType test, AnsatzSpaceType ansatz, GridViewType grid_view)
     : BaseType(grid_view)
     , test_space_(test)
     , ansatz_space_(ansatz)
+    , entity_context_(test_space_, ansatz_space_)
+    , neighbor_context_(test_space_, ansatz_space_)
+    , costs_(nullptr)
   {}
 
   SystemAssembler(TestSpaceType test, AnsatzSpaceType ansatz)
     : BaseType(test.grid_view())
     , test_space_(test)
     , ansatz_space_(ansatz)
+    , entity_context_(test_space_, ansatz_space_)
+    , neighbor_context_(test_space_, ansatz_space_)
+    , costs_(nullptr)
   {}
 
   explicit SystemAssembler(TestSpaceType test)
     : BaseType(test.grid_view())
     , test_space_(test)
     , ansatz_space_(test)
+    , entity_context_(test_space_, ansatz_space_)
+    , neighbor_context_(test_space_, ansatz_space_)
+    , costs_(nullptr)
   {}
 
   SystemAssembler(TestSpaceType test, GridViewType grid_view_in)
     : BaseType(grid_view_in)
     , test_space_(test)
     , ansatz_space_(test)
+    , entity_context_(test_space_, ansatz_space_)
+    , neighbor_context_(test_space_, ansatz_space_)
+    , costs_(nullptr)
   {}
 
   const TestSpaceType& test_space() const
@@ -84,8 +115,70 @@ public:
     return *ansatz_space_;
   }
 
+  /**
+   * \brief Records the time spent on each entity (including its intersections) in all subsequent walks, pass nullptr
+   *        to stop recording.
+   * \note  costs has to outlive all these walks. The costs are added to the present ones.
+   */
+  void record_costs(CostsType* costs)
+  {
+    costs_ = costs;
+  }
+
+  virtual void prepare() override
+  {
+    entity_context_.next_walk();
+    neighbor_context_.next_walk();
+    BaseType::prepare();
+  }
+
+  virtual void apply_local(const EntityType& entity) override
+  {
+    const auto start = costs_ ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point();
+    entity_context_.bind(entity, this->grid_view().indexSet().index(entity));
+    BaseType::apply_local(entity);
+    if (costs_)
+      costs_->add(entity, std::chrono::duration< double >(std::chrono::steady_clock::now() - start).count());
+  } // ... apply_local(...)
+
+  /**
+   * \note The walker usually visits the intersections of an entity right after the entity itself, the entity context
+   *       is then already bound to inside_entity and is kept.
+   */
+  virtual void apply_local(const IntersectionType& intersection,
+                           const EntityType& inside_entity,
+                           const EntityType& outside_entity) override
+  {
+    const auto start = costs_ ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point();
+    const auto& index_set = this->grid_view().indexSet();
+    entity_context_.bind(inside_entity, index_set.index(inside_entity));
+    neighbor_context_.bind(outside_entity, index_set.index(outside_entity));
+    BaseType::apply_local(intersection, inside_entity, outside_entity);
+    if (costs_)
+      costs_->add(inside_entity, std::chrono::duration< double >(std::chrono::steady_clock::now() - start).count());
+  } // ... apply_local(...)
+
   using BaseType::add;
 
+  /**
+   * \brief Walks other along with this assembler (see DSG::Walker::add). If both work on the same spaces and grid view,
+   *        other uses the entity contexts of this assembler from now on, so that base function sets and global
+   *        indices are computed only once per entity for both.
+   * \note  The spaces are considered to be the same if they have the same number of DoFs. this has to outlive other.
+   */
+  void add(ThisType& other,
+           const ApplyOnWhichEntity* which_entities = new DSG::ApplyOn::AllEntities< GridViewType >(),
+           const ApplyOnWhichIntersection* which_intersections = new DSG::ApplyOn::AllIntersections< GridViewType >())
+  {
+    if (&other.grid_view().indexSet() == &this->grid_view().indexSet()
+        && other.test_space_->mapper().size() == test_space_->mapper().size()
+        && other.ansatz_space_->mapper().size() == ansatz_space_->mapper().size()) {
+      other.entity_context_.share(entity_context_);
+      other.neighbor_context_.share(neighbor_context_);
+    }
+    BaseType::add(other, which_entities, which_intersections);
+  } // ... add(...)
+
   template< class C >
   void add(Spaces::ConstraintsInterface< C >& constraints,
            const ApplyOnWhichEntity* where = new DSG::ApplyOn::AllEntities< GridViewType >())
@@ -110,7 +203,7 @@ public:
     typedef internal::LocalVolumeMatrixAssemblerWrapper< ThisType, LocalAssembler::Codim0Matrix< L >,
                                                          typename M::derived_type >                   WrapperType;
     this->codim0_functors_.emplace_back(
-          new WrapperType(test_space_, ansatz_space_, where, local_assembler, matrix.as_imp()));
+          new WrapperType(entity_context_, where, local_assembler, matrix.as_imp()));
   } // ... add(...)
 
   template< class Codim0Assembler, class M >
@@ -124,8 +217,7 @@ public:
     assert(matrix.cols() == ansatz_space_->mapper().size());
     typedef internal::LocalVolumeMatrixAssemblerWrapper< ThisType, Codim0Assembler, typename M::derived_type >
         WrapperType;
-    this->codim0_functors_.emplace_back(
-          new WrapperType(test_space_, ansatz_space_, where, local_assembler, matrix.as_imp()));
+    this->codim0_functors_.emplace_back(new WrapperType(entity_context_, where, local_assembler, matrix.as_imp()));
   } // ... add(...)
 
   template< class Codim0Assembler, class V >
@@ -138,7 +230,7 @@ public:
     assert(vector.size() == test_space_->mapper().size());
     typedef internal::LocalVolumeVectorAssemblerWrapper< ThisType, Codim0Assembler, typename V::derived_type >
         WrapperType;
-    this->codim0_functors_.emplace_back(new WrapperType(test_space_, where, local_assembler, vector.as_imp()));
+    this->codim0_functors_.emplace_back(new WrapperType(entity_context_, where, local_assembler, vector.as_imp()));
   } // ... add(...)
 
   template< class L, class M >
@@ -151,7 +243,7 @@ public:
     typedef internal::LocalFaceMatrixAssemblerWrapper< ThisType, LocalAssembler::Codim1CouplingMatrix< L >,
                                                        typename M::derived_type >                           WrapperType;
     this->codim1_functors_.emplace_back(
-          new WrapperType(test_space_, ansatz_space_, where, local_assembler, matrix.as_imp()));
+          new WrapperType(entity_context_, neighbor_context_, where, local_assembler, matrix.as_imp()));
   } // ... add(...)
 
   template< class L, class M >
@@ -164,7 +256,7 @@ public:
     typedef internal::LocalFaceMatrixAssemblerWrapper< ThisType, LocalAssembler::Codim1BoundaryMatrix< L >,
                                                        typename M::derived_type >                           WrapperType;
     this->codim1_functors_.emplace_back(
-          new WrapperType(test_space_, ansatz_space_, where, local_assembler, matrix.as_imp()));
+          new WrapperType(entity_context_, neighbor_context_, where, local_assembler, matrix.as_imp()));
   } // ... add(...)
 
   template< class L, class V >
@@ -176,7 +268,7 @@ public:
     assert(vector.size() == test_space_->mapper().size());
     typedef internal::LocalVolumeVectorAssemblerWrapper< ThisType, LocalAssembler::Codim0Vector< L >,
                                                          typename V::derived_type >                   WrapperType;
-    this->codim0_functors_.emplace_back(new WrapperType(test_space_, where, local_assembler, vector.as_imp()));
+    this->codim0_functors_.emplace_back(new WrapperType(entity_context_, where, local_assembler, vector.as_imp()));
   } // ... add(...)
 
   template< class L, class V >
@@ -188,7 +280,62 @@ public:
     assert(vector.size() == test_space_->mapper().size());
     typedef internal::LocalFaceVectorAssemblerWrapper< ThisType, LocalAssembler::Codim1Vector< L >,
                                                        typename V::derived_type >                   WrapperType;
-    this->codim1_functors_.emplace_back(new WrapperType(test_space_, where, local_assembler, vector.as_imp()));
+    this->codim1_functors_.emplace_back(new WrapperType(entity_context_, where, local_assembler, vector.as_imp()));
+  } // ... add(...)
+
+  /**
+   * \brief Assembles local_assembler only on the boundary intersections of the given type listed in index.
+   * \note  index has to outlive the assembly.
+   */
+  template< class L, class M >
+  void add(const LocalAssembler::Codim1BoundaryMatrix< L >& local_assembler,
+           Stuff::LA::MatrixInterface< M, RangeFieldType >& matrix,
+           const BoundaryIntersectionIndex< GridViewType >& index,
+           const typename BoundaryIntersectionIndex< GridViewType >::BoundaryType type)
+  {
+    assert(matrix.rows() == test_space_->mapper().size());
+    assert(matrix.cols() == ansatz_space_->mapper().size());
+    typedef internal::IndexedBoundaryAssemblerWrapper< ThisType, LocalAssembler::Codim1BoundaryMatrix< L >,
+                                                       typename M::derived_type >                           WrapperType;
+    this->codim0_functors_.emplace_back(
+          new WrapperType(entity_context_, index, type, local_assembler, matrix.as_imp()));
+  } // ... add(...)
+
+  /**
+   * \brief Assembles local_assembler only on the boundary intersections of the given type listed in index.
+   * \note  index has to outlive the assembly.
+   */
+  template< class L, class V >
+  void add(const LocalAssembler::Codim1Vector< L >& local_assembler,
+           Stuff::LA::VectorInterface< V, RangeFieldType >& vector,
+           const BoundaryIntersectionIndex< GridViewType >& index,
+           const typename BoundaryIntersectionIndex< GridViewType >::BoundaryType type)
+  {
+    assert(vector.size() == test_space_->mapper().size());
+    typedef internal::IndexedBoundaryAssemblerWrapper< ThisType, LocalAssembler::Codim1Vector< L >,
+                                                       typename V::derived_type >                   WrapperType;
+    this->codim0_functors_.emplace_back(
+          new WrapperType(entity_context_, index, type, local_assembler, vector.as_imp()));
+  } // ... add(...)
+
+  /**
+   * \brief Assembles local_assembler on all inner faces listed in face_table, each face once from the entity owning it
+   *        (as with DSG::ApplyOn::InnerIntersectionsPrimally, but without testing each intersection).
+   * \note  face_table has to be computed on the grid view of this assembler and has to outlive the assembly.
+   * \note  Throws if face_table is periodic (see FaceTable::periodic()).
+   */
+  template< class L, class M >
+  void add(const LocalAssembler::Codim1CouplingMatrix< L >& local_assembler,
+           Stuff::LA::MatrixInterface< M, RangeFieldType >& matrix,
+           const FaceTable< GridViewType >& face_table)
+  {
+    assert(matrix.rows() == test_space_->mapper().size());
+    assert(matrix.cols() == ansatz_space_->mapper().size());
+    assert(face_table.num_entities() == this->grid_view().indexSet().size(0));
+    typedef internal::FaceTableCouplingAssemblerWrapper< ThisType, LocalAssembler::Codim1CouplingMatrix< L >,
+                                                         typename M::derived_type >                 WrapperType;
+    this->codim0_functors_.emplace_back(
+          new WrapperType(entity_context_, neighbor_context_, face_table, local_assembler, matrix.as_imp()));
   } // ... add(...)
 
   void assemble(const bool use_tbb = false)
@@ -202,10 +349,104 @@ public:
     this->walk(partitioning);
   }
 
+  /**
+   * \brief Assembles only on the given entities (entities[ii] is true for the entity with index ii) and on all their
+   *        intersections, e.g. to update a system after a local adaptation of the grid (see Adaptation::Driver).
+   * \note  Only the rows of the DoFs of entities which are completely surrounded by given entities (or, for
+   *        intersection terms, their neighbors) receive all their contributions. The walk is sequential.
+   */
+  void assemble(const std::vector< bool >& entities)
+  {
+    const auto& grid_view = this->grid_view();
+    if (entities.size() != grid_view.indexSet().size(0))
+      DUNE_THROW(Stuff::Exceptions::shapes_do_not_match,
+                 "Given " << entities.size() << " flags for " << grid_view.indexSet().size(0) << " entities!");
+    this->prepare();
+    const auto entity_it_end = grid_view.template end< 0 >();
+    for (auto entity_it = grid_view.template begin< 0 >(); entity_it != entity_it_end; ++entity_it) {
+      const EntityType& entity = *entity_it;
+      if (entities[grid_view.indexSet().index(entity)])
+        walk_entity(entity);
+      else {
+        // the intersections with given neighbors might only be visited from this side, the local assemblers of these
+        // intersections use the entity context, which is thus bound to entity (without visiting entity itself)
+        entity_context_.bind(entity, grid_view.indexSet().index(entity));
+        const auto intersection_it_end = grid_view.iend(entity);
+        for (auto intersection_it = grid_view.ibegin(entity);
+             intersection_it != intersection_it_end;
+             ++intersection_it) {
+          const IntersectionType& intersection = *intersection_it;
+          if (intersection.neighbor()) {
+            const auto neighbor_ptr = intersection.outside();
+            if (entities[grid_view.indexSet().index(*neighbor_ptr)])
+              this->apply_local(intersection, entity, *neighbor_ptr);
+          }
+        }
+      }
+    }
+    this->finalize();
+  } // ... assemble(...)
+
+  /**
+   * \brief Assembles in a distributed run and makes vector consistent, overlapping the communication with the
+   *        assembly: all entities with sent DoFs (see HaloExchange::sent_dofs()) are walked first, the exchange of
+   *        vector is started, all other entities are walked and the exchange is finished.
+   * \note  Only vector is exchanged. It has to be (one of) the vector(s) this assembler was given. The walk is
+   *        sequential within each process.
+   */
+  template< class V >
+  void assemble(Spaces::HaloExchange< RangeFieldType >& halo_exchange,
+                Stuff::LA::VectorInterface< V, RangeFieldType >& vector)
+  {
+    const auto& grid_view = this->grid_view();
+    const auto& mapper = test_space_->mapper();
+    std::vector< bool > sent(mapper.size(), false);
+    for (const auto& dof : halo_exchange.sent_dofs())
+      sent[dof] = true;
+    std::vector< bool > border(grid_view.indexSet().size(0), false);
+    this->prepare();
+    const auto entity_it_end = grid_view.template end< 0 >();
+    for (auto entity_it = grid_view.template begin< 0 >(); entity_it != entity_it_end; ++entity_it) {
+      const EntityType& entity = *entity_it;
+      const auto global_indices = mapper.globalIndices(entity);
+      for (size_t ii = 0; ii < mapper.numDofs(entity); ++ii)
+        if (sent[global_indices[ii]]) {
+          border[grid_view.indexSet().index(entity)] = true;
+          walk_entity(entity);
+          break;
+        }
+    }
+    halo_exchange.begin([&](const size_t dof) { return vector.get_entry(dof); });
+    for (auto entity_it = grid_view.template begin< 0 >(); entity_it != entity_it_end; ++entity_it) {
+      const EntityType& entity = *entity_it;
+      if (!border[grid_view.indexSet().index(entity)])
+        walk_entity(entity);
+    }
+    this->finalize();
+    halo_exchange.finish([&](const size_t dof, const RangeFieldType& value) { vector.set_entry(dof, value); });
+  } // ... assemble(...)
 
 private:
+  void walk_entity(const EntityType& entity)
+  {
+    const auto& grid_view = this->grid_view();
+    this->apply_local(entity);
+    const auto intersection_it_end = grid_view.iend(entity);
+    for (auto intersection_it = grid_view.ibegin(entity); intersection_it != intersection_it_end; ++intersection_it) {
+      const IntersectionType& intersection = *intersection_it;
+      if (intersection.neighbor()) {
+        const auto neighbor_ptr = intersection.outside();
+        this->apply_local(intersection, entity, *neighbor_ptr);
+      } else
+        this->apply_local(intersection, entity, entity);
+    }
+  } // ... walk_entity(...)
+
   const DS::PerThreadValue< const TestSpaceType > test_space_;
   const DS::PerThreadValue< const AnsatzSpaceType > ansatz_space_;
+  EntityContextsType entity_context_;
+  EntityContextsType neighbor_context_;
+  CostsType* costs_;
 }; // class SystemAssembler
 
 
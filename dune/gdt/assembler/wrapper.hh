@@ -3,6 +3,7 @@
 
 #include <type_traits>
 
+#include <dune/stuff/common/exceptions.hh>
 #include <dune/stuff/common/tmp-storage.hh>
 #include <dune/stuff/la/container/interfaces.hh>
 #include <dune/stuff/grid/walker.hh>
@@ -15,6 +16,9 @@
 
 #include "local/codim0.hh"
 #include "local/codim1.hh"
+#include "local/context.hh"
+#include "boundary-index.hh"
+#include "face-table.hh"
 #include "tmp-storage.hh"
 
 namespace Dune {
@@ -22,6 +26,41 @@ namespace GDT {
 namespace internal {
 
 
+/**
+ * \brief Calls the context based assembleLocal() of the local assembler, if present.
+ *
+ *        The fallbacks below are only needed for local assemblers which do not provide these (see the deprecated
+ *        SystemAssembler::add_codim0_assembler), they call the variant which takes the spaces and the entity.
+ */
+template< class L, class C, class M, class T, class I >
+auto assemble_local_volume_matrix(const L& local_assembler, C& context, M& matrix, T& tmp_matrices, I& /*tmp_indices*/,
+                                  int) -> decltype(local_assembler.assembleLocal(context, matrix, tmp_matrices))
+{
+  local_assembler.assembleLocal(context, matrix, tmp_matrices);
+}
+
+template< class L, class C, class M, class T, class I >
+void assemble_local_volume_matrix(const L& local_assembler, C& context, M& matrix, T& tmp_matrices, I& tmp_indices,
+                                  long)
+{
+  local_assembler.assembleLocal(context.test_space(), context.ansatz_space(), context.entity(),
+                                matrix, tmp_matrices, tmp_indices);
+}
+
+template< class L, class C, class V, class T, class I >
+auto assemble_local_volume_vector(const L& local_assembler, C& context, V& vector, T& tmp_vectors, I& /*tmp_indices*/,
+                                  int) -> decltype(local_assembler.assembleLocal(context, vector, tmp_vectors))
+{
+  local_assembler.assembleLocal(context, vector, tmp_vectors);
+}
+
+template< class L, class C, class V, class T, class I >
+void assemble_local_volume_vector(const L& local_assembler, C& context, V& vector, T& tmp_vectors, I& tmp_indices,
+                                  long)
+{
+  local_assembler.assembleLocal(context.test_space(), context.entity(), vector, tmp_vectors, tmp_indices);
+}
+
 
 template< class TestSpaceType, class AnsatzSpaceType, class GridViewType, class ConstraintsType >
 class ConstraintsWrapper
@@ -88,21 +127,21 @@ class LocalVolumeMatrixAssemblerWrapper
 {
   typedef DSC::TmpMatricesStorage< typename AssemblerType::TestSpaceType::RangeFieldType > TmpMatricesProvider;
 public:
-  typedef typename AssemblerType::TestSpaceType   TestSpaceType;
-  typedef typename AssemblerType::AnsatzSpaceType AnsatzSpaceType;
-  typedef typename AssemblerType::GridViewType    GridViewType;
-  typedef typename AssemblerType::EntityType      EntityType;
-
-  LocalVolumeMatrixAssemblerWrapper(const DS::PerThreadValue< const TestSpaceType >& test_space,
-                                    const DS::PerThreadValue< const AnsatzSpaceType >& ansatz_space,
+  typedef typename AssemblerType::TestSpaceType      TestSpaceType;
+  typedef typename AssemblerType::AnsatzSpaceType    AnsatzSpaceType;
+  typedef typename AssemblerType::GridViewType       GridViewType;
+  typedef typename AssemblerType::EntityType         EntityType;
+  typedef typename AssemblerType::EntityContextType  EntityContextType;
+  typedef typename AssemblerType::EntityContextsType EntityContextsType;
+
+  LocalVolumeMatrixAssemblerWrapper(EntityContextsType& context,
                                     const Stuff::Grid::ApplyOn::WhichEntity< GridViewType >* where,
                                     const LocalVolumeMatrixAssembler& localAssembler,
                                     MatrixType& matrix)
     : TmpMatricesProvider(localAssembler.numTmpObjectsRequired(),
-                          test_space->mapper().maxNumDofs(),
-                          ansatz_space->mapper().maxNumDofs())
-    , test_space_(test_space)
-    , ansatz_space_(ansatz_space)
+                          context->test_space().mapper().maxNumDofs(),
+                          context->ansatz_space().mapper().maxNumDofs())
+    , context_(context)
     , where_(where)
     , localMatrixAssembler_(localAssembler)
     , matrix_(matrix)
@@ -115,14 +154,13 @@ public:
     return where_->apply_on(gv, entity);
   }
 
-  virtual void apply_local(const EntityType& entity) override final
+  virtual void apply_local(const EntityType& /*entity*/) override final
   {
-    localMatrixAssembler_.assembleLocal(*test_space_, *ansatz_space_, entity, matrix_, this->matrices(), this->indices());
+    assemble_local_volume_matrix(localMatrixAssembler_, *context_, matrix_, this->matrices(), this->indices(), 0);
   }
 
 private:
-  const DS::PerThreadValue< const TestSpaceType >& test_space_;
-  const DS::PerThreadValue< const AnsatzSpaceType >& ansatz_space_;
+  EntityContextsType& context_;
   const std::unique_ptr< const Stuff::Grid::ApplyOn::WhichEntity< GridViewType > > where_;
   const LocalVolumeMatrixAssembler& localMatrixAssembler_;
   MatrixType& matrix_;
@@ -140,18 +178,20 @@ public:
   typedef typename AssemblerType::AnsatzSpaceType                                          AnsatzSpaceType;
   typedef typename AssemblerType::GridViewType                                             GridViewType;
   typedef typename AssemblerType::EntityType                                               EntityType;
+  typedef typename AssemblerType::EntityContextType                                        EntityContextType;
+  typedef typename AssemblerType::EntityContextsType                                       EntityContextsType;
   typedef typename Stuff::Grid::internal::Codim1Object< GridViewType >::IntersectionType   IntersectionType;
 
-  LocalFaceMatrixAssemblerWrapper(const DS::PerThreadValue< const TestSpaceType >& test_space,
-                                  const DS::PerThreadValue< const AnsatzSpaceType >& ansatz_space,
+  LocalFaceMatrixAssemblerWrapper(EntityContextsType& entity_context,
+                                  EntityContextsType& neighbor_context,
                                   const Stuff::Grid::ApplyOn::WhichIntersection< GridViewType >* where,
                                   const LocalFaceMatrixAssembler& localAssembler,
                                   MatrixType& matrix)
     : TmpMatricesProvider(localAssembler.numTmpObjectsRequired(),
-                          test_space->mapper().maxNumDofs(),
-                          ansatz_space->mapper().maxNumDofs())
-    , test_space_(test_space)
-    , ansatz_space_(ansatz_space)
+                          entity_context->test_space().mapper().maxNumDofs(),
+                          entity_context->ansatz_space().mapper().maxNumDofs())
+    , entity_context_(entity_context)
+    , neighbor_context_(neighbor_context)
     , where_(where)
     , localMatrixAssembler_(localAssembler)
     , matrix_(matrix)
@@ -168,15 +208,26 @@ public:
                            const EntityType& /*inside_entity*/,
                            const EntityType& /*outside_entity*/) override final
   {
-    localMatrixAssembler_.assembleLocal(*test_space_, *ansatz_space_,
-                                        intersection,
-                                        matrix_,
-                                        this->matrices(), this->indices());
-  } // ... apply_local(...)
+    assemble_local(localMatrixAssembler_, intersection);
+  }
 
 private:
-  const DS::PerThreadValue< const TestSpaceType >& test_space_;
-  const DS::PerThreadValue< const AnsatzSpaceType >& ansatz_space_;
+  template< class L >
+  void assemble_local(const LocalAssembler::Codim1CouplingMatrix< L >& local_assembler,
+                      const IntersectionType& intersection)
+  {
+    local_assembler.assembleLocal(*entity_context_, *neighbor_context_, intersection, matrix_, this->matrices());
+  }
+
+  template< class L >
+  void assemble_local(const LocalAssembler::Codim1BoundaryMatrix< L >& local_assembler,
+                      const IntersectionType& intersection)
+  {
+    local_assembler.assembleLocal(*entity_context_, intersection, matrix_, this->matrices());
+  }
+
+  EntityContextsType& entity_context_;
+  EntityContextsType& neighbor_context_;
   const std::unique_ptr< const Stuff::Grid::ApplyOn::WhichIntersection< GridViewType > > where_;
   const LocalFaceMatrixAssembler& localMatrixAssembler_;
   MatrixType& matrix_;
@@ -190,16 +241,18 @@ class LocalVolumeVectorAssemblerWrapper
 {
   typedef DSC::TmpVectorsStorage< typename AssemblerType::TestSpaceType::RangeFieldType > TmpVectorsProvider;
 public:
-  typedef typename AssemblerType::TestSpaceType TestSpaceType;
-  typedef typename AssemblerType::GridViewType  GridViewType;
-  typedef typename AssemblerType::EntityType    EntityType;
+  typedef typename AssemblerType::TestSpaceType      TestSpaceType;
+  typedef typename AssemblerType::GridViewType       GridViewType;
+  typedef typename AssemblerType::EntityType         EntityType;
+  typedef typename AssemblerType::EntityContextType  EntityContextType;
+  typedef typename AssemblerType::EntityContextsType EntityContextsType;
 
-  LocalVolumeVectorAssemblerWrapper(const DS::PerThreadValue< const TestSpaceType >& space,
+  LocalVolumeVectorAssemblerWrapper(EntityContextsType& context,
                                     const Stuff::Grid::ApplyOn::WhichEntity< GridViewType >* where,
                                     const LocalVolumeVectorAssembler& localAssembler,
                                     VectorType& vector)
-    : TmpVectorsProvider(localAssembler.numTmpObjectsRequired(), space->mapper().maxNumDofs())
-    , space_(space)
+    : TmpVectorsProvider(localAssembler.numTmpObjectsRequired(), context->test_space().mapper().maxNumDofs())
+    , context_(context)
     , where_(where)
     , localVectorAssembler_(localAssembler)
     , vector_(vector)
@@ -212,13 +265,13 @@ public:
     return where_->apply_on(gv, entity);
   }
 
-  virtual void apply_local(const EntityType& entity) override final
+  virtual void apply_local(const EntityType& /*entity*/) override final
   {
-    localVectorAssembler_.assembleLocal(*space_, entity, vector_, this->vectors(), this->indices());
+    assemble_local_volume_vector(localVectorAssembler_, *context_, vector_, this->vectors(), this->indices(), 0);
   }
 
 private:
-  const DS::PerThreadValue< const TestSpaceType >& space_;
+  EntityContextsType& context_;
   const std::unique_ptr< const Stuff::Grid::ApplyOn::WhichEntity< GridViewType > > where_;
   const LocalVolumeVectorAssembler& localVectorAssembler_;
   VectorType& vector_;
@@ -235,14 +288,16 @@ public:
   typedef typename AssemblerType::TestSpaceType                                          TestSpaceType;
   typedef typename AssemblerType::GridViewType                                           GridViewType;
   typedef typename AssemblerType::EntityType                                             EntityType;
+  typedef typename AssemblerType::EntityContextType                                      EntityContextType;
+  typedef typename AssemblerType::EntityContextsType                                     EntityContextsType;
   typedef typename Stuff::Grid::internal::Codim1Object< GridViewType >::IntersectionType IntersectionType;
 
-  LocalFaceVectorAssemblerWrapper(const DS::PerThreadValue< const TestSpaceType >& space,
+  LocalFaceVectorAssemblerWrapper(EntityContextsType& context,
                                   const Stuff::Grid::ApplyOn::WhichIntersection< GridViewType >* where,
                                   const LocalFaceVectorAssembler& localAssembler,
                                   VectorType& vector)
-    : TmpVectorsProvider(localAssembler.numTmpObjectsRequired(), space->mapper().maxNumDofs())
-    , space_(space)
+    : TmpVectorsProvider(localAssembler.numTmpObjectsRequired(), context->test_space().mapper().maxNumDofs())
+    , context_(context)
     , where_(where)
     , localVectorAssembler_(localAssembler)
     , vector_(vector)
@@ -259,17 +314,198 @@ public:
                            const EntityType& /*inside_entity*/,
                            const EntityType& /*outside_entity*/) override final
   {
-    localVectorAssembler_.assembleLocal(*space_, intersection, vector_, this->vectors(), this->indices());
+    localVectorAssembler_.assembleLocal(*context_, intersection, vector_, this->vectors());
   }
 
 private:
-  const DS::PerThreadValue< const TestSpaceType >& space_;
+  EntityContextsType& context_;
   const std::unique_ptr< const Stuff::Grid::ApplyOn::WhichIntersection< GridViewType > > where_;
   const LocalFaceVectorAssembler& localVectorAssembler_;
   VectorType& vector_;
 }; // class LocalFaceVectorAssemblerWrapper
 
 
+/**
+ * \brief Assembles a local face assembler on the boundary intersections of one type listed in a
+ *        BoundaryIntersectionIndex.
+ *
+ *        This is an entity functor, which is only applied on entities with such intersections, so no other entity or
+ *        intersection has to be checked during the walk.
+ */
+template< class AssemblerType, class LocalFaceAssembler, class ContainerType >
+class IndexedBoundaryAssemblerWrapper
+  : public Stuff::Grid::internal::Codim0Object< typename AssemblerType::GridViewType >
+{
+  typedef typename AssemblerType::RangeFieldType RangeFieldType;
+  typedef typename std::conditional< Stuff::LA::is_vector< ContainerType >::value,
+                                     DSC::TmpVectorsStorage< RangeFieldType >,
+                                     DSC::TmpMatricesStorage< RangeFieldType > >::type TmpStorageType;
+public:
+  typedef typename AssemblerType::GridViewType       GridViewType;
+  typedef typename AssemblerType::EntityType         EntityType;
+  typedef typename AssemblerType::IntersectionType   IntersectionType;
+  typedef typename AssemblerType::EntityContextType  EntityContextType;
+  typedef typename AssemblerType::EntityContextsType EntityContextsType;
+  typedef BoundaryIntersectionIndex< GridViewType >  IndexType;
+  typedef typename IndexType::BoundaryType           BoundaryType;
+
+  IndexedBoundaryAssemblerWrapper(EntityContextsType& context,
+                                  const IndexType& index,
+                                  const BoundaryType type,
+                                  const LocalFaceAssembler& localAssembler,
+                                  ContainerType& container)
+    : context_(context)
+    , index_(index)
+    , type_(type)
+    , local_assembler_(localAssembler)
+    , container_(container)
+    , tmp_storage_(create_tmp_storage(localAssembler, *context))
+  {}
+
+  virtual ~IndexedBoundaryAssemblerWrapper() {}
+
+  virtual bool apply_on(const GridViewType& /*gv*/, const EntityType& entity) const override final
+  {
+    return index_.contains(entity, type_);
+  }
+
+  virtual void apply_local(const EntityType& entity) override final
+  {
+    index_.for_each_intersection(entity, type_, [&](const IntersectionType& intersection) {
+      this->assemble_local(local_assembler_, intersection);
+    });
+  }
+
+private:
+  template< class L >
+  static TmpStorageType* create_tmp_storage(const LocalAssembler::Codim1BoundaryMatrix< L >& local_assembler,
+                                            const EntityContextType& context)
+  {
+    return new TmpStorageType(local_assembler.numTmpObjectsRequired(),
+                              context.test_space().mapper().maxNumDofs(),
+                              context.ansatz_space().mapper().maxNumDofs());
+  }
+
+  template< class L >
+  static TmpStorageType* create_tmp_storage(const LocalAssembler::Codim1Vector< L >& local_assembler,
+                                            const EntityContextType& context)
+  {
+    return new TmpStorageType(local_assembler.numTmpObjectsRequired(), context.test_space().mapper().maxNumDofs());
+  }
+
+  template< class L >
+  void assemble_local(const LocalAssembler::Codim1BoundaryMatrix< L >& local_assembler,
+                      const IntersectionType& intersection)
+  {
+    local_assembler.assembleLocal(*context_, intersection, container_, tmp_storage_->matrices());
+  }
+
+  template< class L >
+  void assemble_local(const LocalAssembler::Codim1Vector< L >& local_assembler,
+                      const IntersectionType& intersection)
+  {
+    local_assembler.assembleLocal(*context_, intersection, container_, tmp_storage_->vectors());
+  }
+
+  EntityContextsType& context_;
+  const IndexType& index_;
+  const BoundaryType type_;
+  const LocalFaceAssembler& local_assembler_;
+  ContainerType& container_;
+  const std::unique_ptr< TmpStorageType > tmp_storage_;
+}; // class IndexedBoundaryAssemblerWrapper
+
+
+/**
+ * \brief Assembles a local coupling matrix assembler on all inner faces of a FaceTable, each face once from the
+ *        entity owning it (as with Stuff::Grid::ApplyOn::InnerIntersectionsPrimally).
+ *
+ *        This is an entity functor, which finds the owned faces of each entity in the table. Only the outside
+ *        entities of these faces are materialized, all other intersections are skipped without being tested.
+ * \note  Periodic grid views are not supported (the periodic faces of the table can not be matched consistently with
+ *        the intersections of the walk), an exception is thrown on construction.
+ */
+template< class AssemblerType, class LocalCouplingAssembler, class MatrixType >
+class FaceTableCouplingAssemblerWrapper
+  : public Stuff::Grid::internal::Codim0Object< typename AssemblerType::GridViewType >
+  , DSC::TmpMatricesStorage< typename AssemblerType::TestSpaceType::RangeFieldType >
+{
+  typedef DSC::TmpMatricesStorage< typename AssemblerType::TestSpaceType::RangeFieldType > TmpMatricesProvider;
+public:
+  typedef typename AssemblerType::GridViewType       GridViewType;
+  typedef typename AssemblerType::EntityType         EntityType;
+  typedef typename AssemblerType::EntityContextsType EntityContextsType;
+  typedef FaceTable< GridViewType >                  FaceTableType;
+
+  FaceTableCouplingAssemblerWrapper(EntityContextsType& entity_context,
+                                    EntityContextsType& neighbor_context,
+                                    const FaceTableType& face_table,
+                                    const LocalCouplingAssembler& localAssembler,
+                                    MatrixType& matrix)
+    : TmpMatricesProvider(localAssembler.numTmpObjectsRequired(),
+                          entity_context->test_space().mapper().maxNumDofs(),
+                          entity_context->ansatz_space().mapper().maxNumDofs())
+    , entity_context_(entity_context)
+    , neighbor_context_(neighbor_context)
+    , face_table_(face_table)
+    , local_assembler_(localAssembler)
+    , matrix_(matrix)
+  {
+    if (face_table_.periodic())
+      DUNE_THROW(Stuff::Exceptions::you_are_using_this_wrong,
+                 "Coupling assemblies on the faces of a FaceTable are not supported on periodic grid views!");
+  }
+
+  virtual ~FaceTableCouplingAssemblerWrapper() {}
+
+  virtual bool apply_on(const GridViewType& /*gv*/, const EntityType& entity) const override final
+  {
+    return face_table_.num_owned_faces(face_table_.grid_view().indexSet().index(entity)) > 0;
+  }
+
+  virtual void apply_local(const EntityType& entity) override final
+  {
+    const auto& grid_view = face_table_.grid_view();
+    const auto& index_set = grid_view.indexSet();
+    const size_t entity_index = index_set.index(entity);
+    const auto& outsides = face_table_.outsides();
+    const auto& local_indices = face_table_.local_indices_in_inside();
+    // the owned faces are stored in the order of the intersections
+    size_t face = face_table_.first_owned_face(entity_index);
+    const size_t face_end = face + face_table_.num_owned_faces(entity_index);
+    const auto intersection_it_end = grid_view.iend(entity);
+    for (auto intersection_it = grid_view.ibegin(entity);
+         intersection_it != intersection_it_end && face != face_end;
+         ++intersection_it) {
+      const auto& intersection = *intersection_it;
+      if (size_t(local_indices[face]) != size_t(intersection.indexInInside()))
+        continue;
+      if (face_table_.boundary(face)) {
+        if (!intersection.neighbor())
+          ++face;
+        continue;
+      }
+      if (!intersection.neighbor())
+        continue;
+      const auto neighbor_ptr = intersection.outside();
+      // on nonconforming grids several intersections share a local index
+      if (index_set.index(*neighbor_ptr) != outsides[face])
+        continue;
+      neighbor_context_.bind(*neighbor_ptr, outsides[face]);
+      local_assembler_.assembleLocal(*entity_context_, *neighbor_context_, intersection, matrix_, this->matrices());
+      ++face;
+    }
+  } // ... apply_local(...)
+
+private:
+  EntityContextsType& entity_context_;
+  EntityContextsType& neighbor_context_;
+  const FaceTableType& face_table_;
+  const LocalCouplingAssembler& local_assembler_;
+  MatrixType& matrix_;
+}; // class FaceTableCouplingAssemblerWrapper
+
+
 } // namespace internal
 } // namespace GDT
 } // namespace Dune
@@ -6,8 +6,22 @@
 #ifndef DUNE_GDT_DISCRETIZATIONS_DEFAULT_HH
 #define DUNE_GDT_DISCRETIZATIONS_DEFAULT_HH
 
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <boost/numeric/conversion/cast.hpp>
+
 #include <dune/stuff/common/exceptions.hh>
 
+#include <dune/gdt/solvers/csr.hh>
+
 #include "interfaces.hh"
 
 namespace Dune {
@@ -19,6 +33,9 @@ namespace Discretizations {
 template< class ProblemType, class AnsatzSpaceType, class MatrixType, class VectorType, class TestSpaceType = AnsatzSpaceType >
 class StationaryContainerBasedDefault;
 
+template< class ProblemType, class SpaceType, class MatrixType, class VectorType >
+class InstationaryContainerBasedDefault;
+
 
 namespace internal {
 
@@ -38,6 +55,19 @@ public:
 }; // class StationaryContainerBasedDefaultTraits
 
 
+template< class ProblemImp, class SpaceImp, class MatrixImp, class VectorImp >
+class InstationaryContainerBasedDefaultTraits
+{
+  // no checks of the arguments needed, those are done in the interfaces
+public:
+  typedef InstationaryContainerBasedDefault< ProblemImp, SpaceImp, MatrixImp, VectorImp > derived_type;
+  typedef ProblemImp ProblemType;
+  typedef SpaceImp   SpaceType;
+  typedef MatrixImp  MatrixType;
+  typedef VectorImp  VectorType;
+}; // class InstationaryContainerBasedDefaultTraits
+
+
 } // namespace internal
 
 
@@ -56,6 +86,7 @@ public:
   using typename BaseType::TestSpaceType;
   using typename BaseType::MatrixType;
   using typename BaseType::VectorType;
+  using typename BaseType::LinearSolverType;
 
   StationaryContainerBasedDefault(const ProblemType& prblm,
                                   AnsatzSpaceType ansatz_sp,
@@ -70,6 +101,7 @@ public:
     , rhs_vector_(rhs_vec)
     , dirichlet_shift_(dirichlet)
     , has_dirichlet_shift_(true)
+    , linear_solver_(std::make_shared< LinearSolverType >(system_matrix_))
   {}
 
   StationaryContainerBasedDefault(const ProblemType& prblm,
@@ -84,6 +116,7 @@ public:
     , rhs_vector_(rhs_vec)
     , dirichlet_shift_(dirichlet)
     , has_dirichlet_shift_(true)
+    , linear_solver_(std::make_shared< LinearSolverType >(system_matrix_))
   {}
 
   StationaryContainerBasedDefault(const ProblemType& prblm,
@@ -98,6 +131,7 @@ public:
     , rhs_vector_(rhs_vec)
     , dirichlet_shift_()
     , has_dirichlet_shift_(false)
+    , linear_solver_(std::make_shared< LinearSolverType >(system_matrix_))
   {}
 
   StationaryContainerBasedDefault(const ProblemType& prblm,
@@ -111,6 +145,7 @@ public:
     , rhs_vector_(rhs_vec)
     , dirichlet_shift_()
     , has_dirichlet_shift_(false)
+    , linear_solver_(std::make_shared< LinearSolverType >(system_matrix_))
   {}
 
   StationaryContainerBasedDefault(ThisType&& /*source*/) = default;
@@ -160,6 +195,11 @@ public:
     return dirichlet_shift_;
   }
 
+  const LinearSolverType& linear_solver() const
+  {
+    return *linear_solver_;
+  }
+
   /// \}
 
 private:
@@ -170,9 +210,314 @@ private:
   const VectorType rhs_vector_;
   const VectorType dirichlet_shift_;
   const bool has_dirichlet_shift_;
+  // held by pointer to keep the discretization movable
+  const std::shared_ptr< const LinearSolverType > linear_solver_;
 }; // class StationaryContainerBasedDefault
 
 
+/**
+ * \brief Discretization of M d_t u + A u = f(t), given the mass matrix M and the stiffness matrix A, which are
+ *        assembled once (e.g. in one walk of a SystemAssembler).
+ *
+ *        Available time steppers are the theta scheme ("implicit_euler", "crank_nicolson" and "theta" with the option
+ *        "theta") and "bdf2" (its first step is an implicit Euler step). Each of them requires the solution of systems
+ *        with the matrix M + c A for a fixed c (c = theta dt, c = 2/3 dt), which is formed once per c, its linear
+ *        solver (see Solvers::CachedLinearSolver) keeps its factorization or preconditioner for all time steps and
+ *        subsequent calls of solve(). Only the right hand side f(t) is reassembled in each time step, if it is time
+ *        dependent.
+ * \note  The time step is reduced (if required) to reach end_time with a fixed number of equal steps.
+ * \note  The DoFs given as dirichlet_DoFs keep the values of the initial values for all times.
+ */
+template< class ProblemImp, class SpaceImp, class MatrixImp, class VectorImp >
+class InstationaryContainerBasedDefault
+  : public InstationaryDiscretizationInterface<
+             internal::InstationaryContainerBasedDefaultTraits< ProblemImp, SpaceImp, MatrixImp, VectorImp > >
+{
+  typedef InstationaryDiscretizationInterface
+          < internal::InstationaryContainerBasedDefaultTraits< ProblemImp, SpaceImp, MatrixImp, VectorImp > > BaseType;
+  typedef InstationaryContainerBasedDefault< ProblemImp, SpaceImp, MatrixImp, VectorImp >               ThisType;
+public:
+  using typename BaseType::ProblemType;
+  using typename BaseType::SpaceType;
+  using typename BaseType::VectorType;
+  using typename BaseType::RangeFieldType;
+  using typename BaseType::ObserverType;
+  typedef MatrixImp                                                                      MatrixType;
+  typedef Solvers::CachedLinearSolver< MatrixType >                                      LinearSolverType;
+  /// assembles f(time) into rhs, which is given as a zero vector
+  typedef std::function< void(const RangeFieldType /*time*/, VectorType& /*rhs*/) >     RhsAssemblerType;
+
+  InstationaryContainerBasedDefault(const ProblemType& prblm,
+                                    SpaceType sp,
+                                    MatrixType mass_mtrx,
+                                    MatrixType stiffness_mtrx,
+                                    RhsAssemblerType rhs_assembler,
+                                    std::set< size_t > dirichlet_DoFs = std::set< size_t >())
+    : problem_(prblm)
+    , space_(sp)
+    , mass_matrix_(mass_mtrx)
+    , stiffness_matrix_(stiffness_mtrx)
+    , rhs_assembler_(rhs_assembler)
+    , time_dependent_rhs_(true)
+    , dirichlet_DoFs_(dirichlet_DoFs)
+    , linear_solvers_(std::make_shared< LinearSolversType >())
+  {
+    check_sizes();
+  }
+
+  /**
+   * \brief Uses the time independent right hand side rhs_vec.
+   */
+  InstationaryContainerBasedDefault(const ProblemType& prblm,
+                                    SpaceType sp,
+                                    MatrixType mass_mtrx,
+                                    MatrixType stiffness_mtrx,
+                                    VectorType rhs_vec,
+                                    std::set< size_t > dirichlet_DoFs = std::set< size_t >())
+    : problem_(prblm)
+    , space_(sp)
+    , mass_matrix_(mass_mtrx)
+    , stiffness_matrix_(stiffness_mtrx)
+    , rhs_assembler_([rhs_vec](const RangeFieldType /*time*/, VectorType& rhs) { rhs = rhs_vec; })
+    , time_dependent_rhs_(false)
+    , dirichlet_DoFs_(dirichlet_DoFs)
+    , linear_solvers_(std::make_shared< LinearSolversType >())
+  {
+    check_sizes();
+  }
+
+  InstationaryContainerBasedDefault(ThisType&& /*source*/) = default;
+
+  /// \name Required by InstationaryDiscretizationInterface.
+  /// \{
+
+  const ProblemType& problem() const
+  {
+    return problem_;
+  }
+
+  const SpaceType& space() const
+  {
+    return space_;
+  }
+
+  static std::vector< std::string > time_stepper_types()
+  {
+    return {"implicit_euler", "crank_nicolson", "bdf2", "theta"};
+  }
+
+  static Stuff::Common::Configuration time_stepper_options(const std::string type = "")
+  {
+    const std::string tp = !type.empty() ? type : time_stepper_types()[0];
+    const auto available_types = time_stepper_types();
+    if (std::find(available_types.begin(), available_types.end(), tp) == available_types.end())
+      DUNE_THROW(Stuff::Exceptions::wrong_input_given,
+                 "Given type '" << tp << "' is not one of the available time_stepper_types()!");
+    Stuff::Common::Configuration opts;
+    opts["type"] = tp;
+    opts["start_time"] = "0";
+    opts["end_time"] = "1";
+    opts["time_step"] = "0.01";
+    if (tp == "theta")
+      opts["theta"] = "0.5";
+    opts["linear_solver"] = LinearSolverType::types()[0];
+    return opts;
+  } // ... time_stepper_options(...)
+
+  void solve(VectorType& solution, const Stuff::Common::Configuration& opts, const ObserverType& observer) const
+  {
+    if (solution.size() != space_.mapper().size())
+      DUNE_THROW(Stuff::Exceptions::shapes_do_not_match,
+                 "The size of solution (" << solution.size() << ") does not match the size of the space ("
+                 << space_.mapper().size() << ")!");
+    const std::string type = opts.get< std::string >("type");
+    const auto available_types = time_stepper_types();
+    if (std::find(available_types.begin(), available_types.end(), type) == available_types.end())
+      DUNE_THROW(Stuff::Exceptions::wrong_input_given,
+                 "Given type '" << type << "' is not one of the available time_stepper_types()!");
+    const RangeFieldType start_time = opts.get("start_time", RangeFieldType(0));
+    const RangeFieldType end_time = opts.get("end_time", RangeFieldType(1));
+    const RangeFieldType max_time_step = opts.get("time_step", RangeFieldType(0.01));
+    if (!(max_time_step > 0) || end_time < start_time)
+      DUNE_THROW(Stuff::Exceptions::wrong_input_given,
+                 "time_step (" << max_time_step << ") has to be positive and end_time (" << end_time << ") must not be "
+                 << "smaller than start_time (" << start_time << ")!");
+    RangeFieldType theta(1);
+    if (type == "crank_nicolson")
+      theta = 0.5;
+    else if (type == "theta")
+      theta = opts.get("theta", RangeFieldType(0.5));
+    if (!(theta > 0) || theta > 1)
+      DUNE_THROW(Stuff::Exceptions::wrong_input_given, "theta has to be in (0, 1], is " << theta << "!");
+    const auto solver_opts = LinearSolverType::options(opts.get("linear_solver", LinearSolverType::types()[0]));
+    const size_t num_steps = boost::numeric_cast< size_t >(
+          std::ceil((end_time - start_time) / max_time_step - RangeFieldType(1e-10)));
+    observer(start_time, solution);
+    if (num_steps == 0)
+      return;
+    const RangeFieldType dt = (end_time - start_time) / num_steps;
+    VectorType rhs = create_rhs(start_time);
+    VectorType previous_solution = solution.copy();
+    for (size_t step = 0; step < num_steps; ++step) {
+      const RangeFieldType time = start_time + (step + 1) * dt;
+      VectorType next_rhs = time_dependent_rhs_ ? create_rhs(time) : rhs;
+      if (type == "bdf2" && step > 0)
+        bdf2_step(dt, previous_solution, next_rhs, solution, solver_opts);
+      else {
+        if (type == "bdf2")
+          previous_solution = solution.copy();
+        theta_step(type == "bdf2" ? RangeFieldType(1) : theta, dt, rhs, next_rhs, solution, solver_opts);
+      }
+      rhs = next_rhs;
+      observer(time, solution);
+    }
+  } // ... solve(...)
+
+  /// \}
+
+  using BaseType::solve;
+
+  const MatrixType& mass_matrix() const
+  {
+    return mass_matrix_;
+  }
+
+  const MatrixType& stiffness_matrix() const
+  {
+    return stiffness_matrix_;
+  }
+
+  /**
+   * \brief Returns the solver for M + factor A, which is created (and set up by its first use) once for each factor.
+   */
+  const LinearSolverType& linear_solver(const RangeFieldType factor) const
+  {
+    std::lock_guard< std::mutex > lock(linear_solvers_->mutex);
+    auto& solver = linear_solvers_->solvers[factor];
+    if (!solver) {
+      auto system_matrix = linear_combination(factor);
+      for (const auto& DoF : dirichlet_DoFs_)
+        system_matrix.unit_row(DoF);
+      solver = std::make_shared< LinearSolverType >(system_matrix);
+    }
+    return *solver;
+  } // ... linear_solver(...)
+
+private:
+  struct LinearSolversType
+  {
+    std::mutex mutex;
+    std::map< RangeFieldType, std::shared_ptr< const LinearSolverType > > solvers;
+  }; // struct LinearSolversType
+
+  void check_sizes() const
+  {
+    const size_t size = space_.mapper().size();
+    if (mass_matrix_.rows() != size || mass_matrix_.cols() != size
+        || stiffness_matrix_.rows() != size || stiffness_matrix_.cols() != size)
+      DUNE_THROW(Stuff::Exceptions::shapes_do_not_match,
+                 "The mass matrix (" << mass_matrix_.rows() << "x" << mass_matrix_.cols() << ") and the stiffness "
+                 << "matrix (" << stiffness_matrix_.rows() << "x" << stiffness_matrix_.cols() << ") have to match the "
+                 << "size of the space (" << size << ")!");
+    for (const auto& DoF : dirichlet_DoFs_)
+      if (DoF >= size)
+        DUNE_THROW(Stuff::Exceptions::wrong_input_given,
+                   "The Dirichlet DoF " << DoF << " is not a DoF of the space (of size " << size << ")!");
+  } // ... check_sizes(...)
+
+  VectorType create_rhs(const RangeFieldType time) const
+  {
+    VectorType rhs(space_.mapper().size(), RangeFieldType(0));
+    rhs_assembler_(time, rhs);
+    return rhs;
+  }
+
+  // M + factor A, the patterns of M and A may differ
+  MatrixType linear_combination(const RangeFieldType factor) const
+  {
+    const auto mass = Solvers::internal::to_csr(mass_matrix_);
+    const auto stiffness = Solvers::internal::to_csr(stiffness_matrix_);
+    std::vector< size_t > row_offsets(mass.rows() + 1, 0);
+    std::vector< size_t > column_indices;
+    std::vector< RangeFieldType > values;
+    for (size_t ii = 0; ii < mass.rows(); ++ii) {
+      std::map< size_t, RangeFieldType > row;
+      for (size_t kk = mass.row_begin(ii); kk < mass.row_end(ii); ++kk)
+        row[mass.column_index(kk)] += mass.value(kk);
+      for (size_t kk = stiffness.row_begin(ii); kk < stiffness.row_end(ii); ++kk)
+        row[stiffness.column_index(kk)] += factor * stiffness.value(kk);
+      for (const auto& entry : row) {
+        column_indices.push_back(entry.first);
+        values.push_back(entry.second);
+      }
+      row_offsets[ii + 1] = values.size();
+    }
+    return Solvers::internal::from_csr< MatrixType >(
+          Solvers::internal::CsrMatrix< RangeFieldType >(mass.cols(), std::move(row_offsets),
+                                                         std::move(column_indices), std::move(values)));
+  } // ... linear_combination(...)
+
+  // the constrained DoFs keep their current values
+  void solve_system(const RangeFieldType factor,
+                    VectorType& system_rhs,
+                    VectorType& solution,
+                    const Stuff::Common::Configuration& solver_opts) const
+  {
+    for (const auto& DoF : dirichlet_DoFs_)
+      system_rhs.set_entry(DoF, solution.get_entry(DoF));
+    linear_solver(factor).apply(system_rhs, solution, solver_opts);
+  }
+
+  // (M + theta dt A) u^{n+1} = (M - (1 - theta) dt A) u^n + dt (theta f^{n+1} + (1 - theta) f^n)
+  void theta_step(const RangeFieldType theta,
+                  const RangeFieldType dt,
+                  const VectorType& rhs,
+                  const VectorType& next_rhs,
+                  VectorType& solution,
+                  const Stuff::Common::Configuration& solver_opts) const
+  {
+    VectorType system_rhs(solution.size(), RangeFieldType(0));
+    mass_matrix_.mv(solution, system_rhs);
+    if (theta < 1) {
+      VectorType tmp(solution.size(), RangeFieldType(0));
+      stiffness_matrix_.mv(solution, tmp);
+      system_rhs.axpy(-(1 - theta) * dt, tmp);
+      system_rhs.axpy((1 - theta) * dt, rhs);
+    }
+    system_rhs.axpy(theta * dt, next_rhs);
+    solve_system(theta * dt, system_rhs, solution, solver_opts);
+  } // ... theta_step(...)
+
+  // (M + 2/3 dt A) u^{n+1} = 4/3 M u^n - 1/3 M u^{n-1} + 2/3 dt f^{n+1}
+  void bdf2_step(const RangeFieldType dt,
+                 VectorType& previous_solution,
+                 const VectorType& next_rhs,
+                 VectorType& solution,
+                 const Stuff::Common::Configuration& solver_opts) const
+  {
+    VectorType combination = solution.copy();
+    combination *= RangeFieldType(4);
+    combination.axpy(RangeFieldType(-1), previous_solution);
+    combination *= RangeFieldType(1) / RangeFieldType(3);
+    VectorType system_rhs(solution.size(), RangeFieldType(0));
+    mass_matrix_.mv(combination, system_rhs);
+    system_rhs.axpy(RangeFieldType(2) / RangeFieldType(3) * dt, next_rhs);
+    previous_solution = solution.copy();
+    solve_system(RangeFieldType(2) / RangeFieldType(3) * dt, system_rhs, solution, solver_opts);
+  } // ... bdf2_step(...)
+
+  const ProblemType& problem_;
+  const SpaceType space_;
+  const MatrixType mass_matrix_;
+  const MatrixType stiffness_matrix_;
+  const RhsAssemblerType rhs_assembler_;
+  const bool time_dependent_rhs_;
+  const std::set< size_t > dirichlet_DoFs_;
+  // held by pointer to keep the discretization movable
+  const std::shared_ptr< LinearSolversType > linear_solvers_;
+}; // class InstationaryContainerBasedDefault
+
+
 
 } // namespace Discretizations
 } // namespace GDT
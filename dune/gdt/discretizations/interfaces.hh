@@ -6,6 +6,10 @@
 #ifndef DUNE_GDT_DISCRETIZATIONS_INTERFACES_HH
 #define DUNE_GDT_DISCRETIZATIONS_INTERFACES_HH
 
+#include <functional>
+#include <string>
+#include <vector>
+
 #include <dune/stuff/common/configuration.hh>
 #include <dune/stuff/common/crtp.hh>
 #include <dune/stuff/common/type_utils.hh>
@@ -13,6 +17,7 @@
 
 #include <dune/gdt/exceptions.hh>
 #include <dune/gdt/discretefunction/default.hh>
+#include <dune/gdt/solvers/cached.hh>
 #include <dune/gdt/spaces/interface.hh>
 
 namespace Dune {
@@ -139,11 +144,9 @@ class ContainerBasedStationaryDiscretizationInterface
 {
   typedef StationaryDiscretizationInterface< Traits > BaseType;
 public:
-  typedef typename Traits::MatrixType MatrixType;
+  typedef typename Traits::MatrixType                  MatrixType;
   using typename BaseType::VectorType;
-private:
-  typedef typename Stuff::LA::Solver< MatrixType > LinearSolverType;
-public:
+  typedef Solvers::CachedLinearSolver< MatrixType >    LinearSolverType;
 
   /// \name Have to be implemented by any derived class.
   /// \{
@@ -166,6 +169,16 @@ public:
     return this->as_imp().has_dirichlet_shift();
   }
 
+  /**
+   * \brief Returns a solver for system_matrix(), which keeps its setup (factorizations, preconditioners) for all
+   *        subsequent calls of solve().
+   */
+  const LinearSolverType& linear_solver() const
+  {
+    CHECK_CRTP(this->as_imp().linear_solver());
+    return this->as_imp().linear_solver();
+  }
+
   /// \}
 
   /**
@@ -198,15 +211,150 @@ public:
 
   void solve(VectorType& solution, const Stuff::Common::Configuration& options) const
   {
-    LinearSolverType(system_matrix()).apply(rhs_vector(), solution, options);
+    solve(rhs_vector(), solution, options);
+  }
+
+  /**
+   * \brief Solves the system for another right hand side, reusing the setup of linear_solver().
+   * \note  rhs has to be prepared like rhs_vector(), in particular the Dirichlet shift has to be applied already (it
+   *        is added to the solution).
+   */
+  void solve(const VectorType& rhs, VectorType& solution, const Stuff::Common::Configuration& options) const
+  {
+    linear_solver().apply(rhs, solution, options);
     if (has_dirichlet_shift())
       solution += dirichlet_shift();
   }
 
+  void solve(const VectorType& rhs, VectorType& solution, const std::string& type) const
+  {
+    solve(rhs, solution, solver_options(type));
+  }
+
+  /**
+   * \brief Solves the system for several right hand sides (e.g. assembled by Functionals::L2VolumeMulti), the setup
+   *        of linear_solver() is computed once and applied to all of them.
+   * \note  solutions is resized to match rhs, see solve(rhs, solution, options) for the requirements on rhs.
+   */
+  void solve(const std::vector< VectorType >& rhs,
+             std::vector< VectorType >& solutions,
+             const Stuff::Common::Configuration& options) const
+  {
+    solutions.resize(rhs.size(), this->create_vector());
+    for (size_t kk = 0; kk < rhs.size(); ++kk)
+      solve(rhs[kk], solutions[kk], options);
+  }
+
+  void solve(const std::vector< VectorType >& rhs,
+             std::vector< VectorType >& solutions,
+             const std::string& type) const
+  {
+    solve(rhs, solutions, solver_options(type));
+  }
+
   /// \}
 }; // class ContainerBasedStationaryDiscretizationInterface
 
 
+/**
+ * \brief Interface for discretizations of instationary problems of the form M d_t u + A u = f(t), which are solved by
+ *        a time stepping scheme.
+ *
+ *        solve() advances the given solution (the initial values) to the end time given in the options, the observer
+ *        (if given) is called with the initial values and after each time step.
+ */
+template< class Traits >
+class InstationaryDiscretizationInterface
+  : public Stuff::CRTPInterface< InstationaryDiscretizationInterface< Traits >, Traits >
+{
+  typedef Stuff::CRTPInterface< InstationaryDiscretizationInterface< Traits >, Traits > BaseType;
+public:
+  using typename BaseType::derived_type;
+  typedef typename Traits::ProblemType                                                 ProblemType;
+  typedef typename Traits::SpaceType                                                   SpaceType;
+  typedef typename Traits::VectorType                                                  VectorType;
+  typedef typename SpaceType::RangeFieldType                                           RangeFieldType;
+  typedef std::function< void(const RangeFieldType /*time*/, const VectorType& /*solution*/) > ObserverType;
+private:
+  static_assert(is_space< SpaceType >::value, "SpaceType has to be derived from SpaceInterface!");
+  static_assert(Stuff::LA::is_vector< VectorType >::value,
+                "VectorType has to be derived from Stuff::LA::VectorInterface!");
+public:
+  /// \name Have to be implemented by any derived class.
+  /// \{
+
+  const ProblemType& problem() const
+  {
+    CHECK_CRTP(this->as_imp().problem());
+    return this->as_imp().problem();
+  }
+
+  const SpaceType& space() const
+  {
+    CHECK_CRTP(this->as_imp().space());
+    return this->as_imp().space();
+  }
+
+  std::vector< std::string > time_stepper_types() const
+  {
+    CHECK_CRTP(this->as_imp().time_stepper_types());
+    auto types = this->as_imp().time_stepper_types();
+    if (types.empty())
+      DUNE_THROW(Stuff::Exceptions::internal_error,
+                 "Reported time_stepper_types() of the derived class (see below) must not be empty!\n\n  "
+                 << Stuff::Common::Typename< derived_type >::value());
+    return types;
+  } // ... time_stepper_types(...)
+
+  Stuff::Common::Configuration time_stepper_options(const std::string type = "") const
+  {
+    CHECK_CRTP(this->as_imp().time_stepper_options(type));
+    auto opts = this->as_imp().time_stepper_options(type);
+    if (opts.empty())
+      DUNE_THROW(Stuff::Exceptions::internal_error,
+                 "Reported time_stepper_options() of the derived class (see below) for type '" << type
+                 << "'must not be empty!\n\n  " << Stuff::Common::Typename< derived_type >::value());
+    return opts;
+  } // ... time_stepper_options(...)
+
+  void solve(VectorType& solution, const Stuff::Common::Configuration& options, const ObserverType& observer) const
+  {
+    CHECK_AND_CALL_CRTP(this->as_imp().solve(solution, options, observer));
+  }
+
+  /// \}
+  /// \name Provided by the interface for convenience.
+  /// \{
+
+  VectorType create_vector() const
+  {
+    return VectorType(space().mapper().size());
+  }
+
+  void solve(VectorType& solution, const Stuff::Common::Configuration& options) const
+  {
+    solve(solution, options, [](const RangeFieldType /*time*/, const VectorType& /*solution*/) {});
+  }
+
+  void solve(VectorType& solution, const std::string& type) const
+  {
+    solve(solution, time_stepper_options(type));
+  }
+
+  void solve(VectorType& solution) const
+  {
+    solve(solution, time_stepper_options(time_stepper_types().at(0)));
+  }
+
+  void visualize(const VectorType& vector, const std::string filename, const std::string name) const
+  {
+    make_const_discrete_function(this->space(), vector, name).visualize(filename);
+  }
+
+  /// \}
+}; // class InstationaryDiscretizationInterface
+
+
 namespace internal {
 
 
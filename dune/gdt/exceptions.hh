@@ -19,6 +19,10 @@ class prolongation_error : public operator_error {};
 
 class projection_error : public operator_error {};
 
+class nonlinear_solver_failed : public Dune::Exception {};
+
+class spe10_data_file_missing : public Dune::IOError {};
+
 
 } // namespace Exceptions
 } // namespace GDT
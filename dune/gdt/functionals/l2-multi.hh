@@ -0,0 +1,359 @@
+// This file is part of the dune-gdt project:
+//   http://users.dune-project.org/projects/dune-gdt
+// Copyright holders: Felix Schindler
+// License: BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+
+#ifndef DUNE_GDT_FUNCTIONALS_L2_MULTI_HH
+#define DUNE_GDT_FUNCTIONALS_L2_MULTI_HH
+
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include <boost/numeric/conversion/cast.hpp>
+
+#include <dune/common/dynvector.hh>
+
+#include <dune/geometry/quadraturerules.hh>
+
+#include <dune/stuff/common/exceptions.hh>
+#include <dune/stuff/common/parallel/threadstorage.hh>
+#include <dune/stuff/functions/interfaces.hh>
+#include <dune/stuff/grid/walker.hh>
+#include <dune/stuff/la/container/interfaces.hh>
+
+#include <dune/gdt/spaces/interface.hh>
+
+namespace Dune {
+namespace GDT {
+namespace Functionals {
+namespace internal {
+
+
+/**
+ * \brief Everything the multi functionals need per thread and entity: the values of the test basis and of all
+ *        functions in a quadrature point, one local vector per function and the global indices.
+ */
+template< class RangeFieldType, class RangeType >
+struct L2MultiStorage
+{
+  L2MultiStorage(const size_t num_functions, const size_t max_num_dofs)
+    : base_values(max_num_dofs, RangeType(0))
+    , function_values(num_functions, RangeType(0))
+    , local_vectors(num_functions, Dune::DynamicVector< RangeFieldType >(max_num_dofs, 0))
+    , global_indices(max_num_dofs, 0)
+  {}
+
+  std::vector< RangeType > base_values;
+  std::vector< RangeType > function_values;
+  std::vector< Dune::DynamicVector< RangeFieldType > > local_vectors;
+  Dune::DynamicVector< size_t > global_indices;
+}; // struct L2MultiStorage
+
+
+/**
+ * \brief Checks the arguments and holds the common members of L2VolumeMulti and L2FaceMulti.
+ */
+template< class FunctionImp, class VectorImp, class SpaceImp, class GridViewImp >
+class L2MultiBase
+{
+  static_assert(Stuff::is_localizable_function< FunctionImp >::value,
+                "FunctionImp has to be derived from Stuff::LocalizableFunctionInterface!");
+  static_assert(Stuff::LA::is_vector< VectorImp >::value,
+                "VectorImp has to be derived from Stuff::LA::VectorInterface!");
+  static_assert(is_space< SpaceImp >::value, "SpaceImp has to be derived from SpaceInterface!");
+  static_assert(SpaceImp::dimRangeCols == 1, "Not implemented for matrix valued spaces!");
+  static_assert(FunctionImp::dimRange == SpaceImp::dimRange && FunctionImp::dimRangeCols == 1,
+                "The functions have to have the same range as the space!");
+public:
+  typedef FunctionImp                                     FunctionType;
+  typedef VectorImp                                       VectorType;
+  typedef SpaceImp                                        SpaceType;
+  typedef GridViewImp                                     GridViewType;
+  typedef typename SpaceType::BaseFunctionSetType         TestBaseType;
+  typedef typename VectorType::ScalarType                 ScalarType;
+  typedef typename TestBaseType::RangeType                RangeType;
+  typedef std::vector< std::reference_wrapper< const FunctionType > > FunctionsType;
+
+  L2MultiBase(const FunctionsType& functions,
+              std::vector< VectorType >& vectors,
+              const SpaceType& space,
+              const GridViewType& grid_view,
+              const size_t over_integrate)
+    : functions_(functions)
+    , vectors_(vectors)
+    , space_(space)
+    , grid_view_(grid_view)
+    , over_integrate_(over_integrate)
+    , storage_(functions_.size(), space_.mapper().maxNumDofs())
+  {
+    if (functions_.size() != vectors_.size())
+      DUNE_THROW(Stuff::Exceptions::shapes_do_not_match,
+                 "Given " << functions_.size() << " functions but " << vectors_.size() << " vectors!");
+    for (const auto& vector : vectors_)
+      if (vector.size() != space_.mapper().size())
+        DUNE_THROW(Stuff::Exceptions::shapes_do_not_match,
+                   "The size of the vectors (" << vector.size() << ") does not match the number of DoFs of the space ("
+                   << space_.mapper().size() << ")!");
+  } // L2MultiBase(...)
+
+  const FunctionsType& functions() const
+  {
+    return functions_;
+  }
+
+  std::vector< VectorType >& vectors()
+  {
+    return vectors_;
+  }
+
+  const std::vector< VectorType >& vectors() const
+  {
+    return vectors_;
+  }
+
+  const SpaceType& space() const
+  {
+    return space_;
+  }
+
+  const GridViewType& grid_view() const
+  {
+    return grid_view_;
+  }
+
+protected:
+  typedef L2MultiStorage< ScalarType, RangeType > StorageType;
+
+  typedef std::vector< std::unique_ptr< typename FunctionType::LocalfunctionType > > LocalfunctionsType;
+
+  template< class EntityType >
+  LocalfunctionsType localize(const EntityType& entity) const
+  {
+    LocalfunctionsType local_functions;
+    local_functions.reserve(functions_.size());
+    for (const auto& function : functions_)
+      local_functions.emplace_back(function.get().local_function(entity));
+    return local_functions;
+  }
+
+  size_t integrand_order(const LocalfunctionsType& local_functions, const TestBaseType& test_base) const
+  {
+    size_t order = 0;
+    for (const auto& local_function : local_functions)
+      order = std::max(order, local_function->order());
+    return order + test_base.order() + over_integrate_;
+  }
+
+  /**
+   * \brief Computes the local vectors \int f_kk \cdot \phi_ii for all functions and test basis functions.
+   *        to_entity maps a quadrature point to the reference element of the entity, integration_factor yields the
+   *        integration element in a quadrature point.
+   */
+  template< class QuadratureType, class ToEntity, class IntegrationFactor >
+  void integrate(const LocalfunctionsType& local_functions,
+                 const TestBaseType& test_base,
+                 const QuadratureType& quadrature,
+                 const ToEntity& to_entity,
+                 const IntegrationFactor& integration_factor,
+                 StorageType& storage) const
+  {
+    const size_t num_functions = local_functions.size();
+    const size_t size = test_base.size();
+    for (size_t kk = 0; kk < num_functions; ++kk)
+      storage.local_vectors[kk] *= 0.0;
+    for (const auto& quadrature_point : quadrature) {
+      const auto xx = quadrature_point.position();
+      const auto point_in_entity = to_entity(xx);
+      const ScalarType factor = integration_factor(xx) * quadrature_point.weight();
+      // the basis is evaluated once for all functions
+      test_base.evaluate(point_in_entity, storage.base_values);
+      for (size_t kk = 0; kk < num_functions; ++kk) {
+        local_functions[kk]->evaluate(point_in_entity, storage.function_values[kk]);
+        auto& local_vector = storage.local_vectors[kk];
+        const auto& function_value = storage.function_values[kk];
+        for (size_t ii = 0; ii < size; ++ii)
+          local_vector[ii] += factor * (function_value * storage.base_values[ii]);
+      }
+    }
+  } // ... integrate(...)
+
+  void write(const size_t size, StorageType& storage)
+  {
+    for (size_t kk = 0; kk < functions_.size(); ++kk) {
+      auto& vector = vectors_[kk];
+      const auto& local_vector = storage.local_vectors[kk];
+      for (size_t ii = 0; ii < size; ++ii)
+        vector.add_to_entry(storage.global_indices[ii], local_vector[ii]);
+    }
+  } // ... write(...)
+
+  const FunctionsType functions_;
+  std::vector< VectorType >& vectors_;
+  const SpaceType& space_;
+  const GridViewType& grid_view_;
+  const size_t over_integrate_;
+  DS::PerThreadValue< StorageType > storage_;
+}; // class L2MultiBase
+
+
+} // namespace internal
+
+
+/**
+ * \brief Assembles \int f_k \phi_i for a family of functions f_1, ..., f_K into K vectors in one grid walk.
+ *
+ *        Does the same as K L2Volume functionals, but the test basis (and the geometry) is evaluated only once per
+ *        quadrature point for all functions. This pays off for many right hand sides, e.g. parameter samples or
+ *        a family of source terms. The functional is a grid functor and may thus also be added to any other
+ *        SystemAssembler (or Stuff::Grid::Walker) to be assembled along with the system matrix.
+ * \note  The functions and vectors have to outlive this functional.
+ */
+template< class FunctionImp, class VectorImp, class SpaceImp, class GridViewImp = typename SpaceImp::GridViewType >
+class L2VolumeMulti
+  : public internal::L2MultiBase< FunctionImp, VectorImp, SpaceImp, GridViewImp >
+  , public Stuff::Grid::Functor::Codim0< GridViewImp >
+{
+  typedef internal::L2MultiBase< FunctionImp, VectorImp, SpaceImp, GridViewImp > BaseType;
+public:
+  using typename BaseType::FunctionsType;
+  using typename BaseType::VectorType;
+  using typename BaseType::SpaceType;
+  using typename BaseType::GridViewType;
+  typedef typename Stuff::Grid::Functor::Codim0< GridViewImp >::EntityType EntityType;
+
+  L2VolumeMulti(const FunctionsType& functions,
+                std::vector< VectorType >& vectors,
+                const SpaceType& spc,
+                const GridViewType& grd_vw,
+                const size_t over_integrate = 0)
+    : BaseType(functions, vectors, spc, grd_vw, over_integrate)
+  {}
+
+  L2VolumeMulti(const FunctionsType& functions,
+                std::vector< VectorType >& vectors,
+                const SpaceType& spc,
+                const size_t over_integrate = 0)
+    : BaseType(functions, vectors, spc, spc.grid_view(), over_integrate)
+  {}
+
+  virtual ~L2VolumeMulti() {}
+
+  virtual void apply_local(const EntityType& entity) override final
+  {
+    auto& storage = *this->storage_;
+    const auto test_base = this->space_.base_function_set(entity);
+    const auto local_functions = this->localize(entity);
+    const auto& geometry = entity.geometry();
+    const auto& quadrature = QuadratureRules< typename GridViewType::ctype, GridViewType::dimension >::rule(
+          entity.type(), boost::numeric_cast< int >(this->integrand_order(local_functions, test_base)));
+    this->integrate(local_functions,
+                    test_base,
+                    quadrature,
+                    [](const typename EntityType::Geometry::LocalCoordinate& xx) { return xx; },
+                    [&](const typename EntityType::Geometry::LocalCoordinate& xx) {
+                      return geometry.integrationElement(xx); },
+                    storage);
+    this->space_.mapper().globalIndices(entity, storage.global_indices);
+    this->write(test_base.size(), storage);
+  } // ... apply_local(...)
+
+  void assemble(const bool use_tbb = false)
+  {
+    Stuff::Grid::Walker< GridViewType > walker(this->grid_view_);
+    walker.add(*this);
+    walker.walk(use_tbb);
+  }
+}; // class L2VolumeMulti
+
+
+/**
+ * \brief Assembles \int_F f_k \phi_i for a family of functions f_1, ..., f_K into K vectors in one grid walk, see
+ *        L2VolumeMulti.
+ * \note  The functions and vectors have to outlive this functional.
+ */
+template< class FunctionImp, class VectorImp, class SpaceImp, class GridViewImp = typename SpaceImp::GridViewType >
+class L2FaceMulti
+  : public internal::L2MultiBase< FunctionImp, VectorImp, SpaceImp, GridViewImp >
+  , public Stuff::Grid::Functor::Codim1< GridViewImp >
+{
+  typedef internal::L2MultiBase< FunctionImp, VectorImp, SpaceImp, GridViewImp > BaseType;
+public:
+  using typename BaseType::FunctionsType;
+  using typename BaseType::VectorType;
+  using typename BaseType::SpaceType;
+  using typename BaseType::GridViewType;
+  typedef typename Stuff::Grid::Functor::Codim1< GridViewImp >::EntityType       EntityType;
+  typedef typename Stuff::Grid::Functor::Codim1< GridViewImp >::IntersectionType IntersectionType;
+
+  /**
+   * \note Takes ownership of which_intersections.
+   */
+  L2FaceMulti(const FunctionsType& functions,
+              std::vector< VectorType >& vectors,
+              const SpaceType& spc,
+              const GridViewType& grd_vw,
+              const Stuff::Grid::ApplyOn::WhichIntersection< GridViewType >* which_intersections
+                = new Stuff::Grid::ApplyOn::AllIntersections< GridViewType >(),
+              const size_t over_integrate = 0)
+    : BaseType(functions, vectors, spc, grd_vw, over_integrate)
+    , which_intersections_(which_intersections)
+  {}
+
+  /**
+   * \note Takes ownership of which_intersections.
+   */
+  L2FaceMulti(const FunctionsType& functions,
+              std::vector< VectorType >& vectors,
+              const SpaceType& spc,
+              const Stuff::Grid::ApplyOn::WhichIntersection< GridViewType >* which_intersections
+                = new Stuff::Grid::ApplyOn::AllIntersections< GridViewType >(),
+              const size_t over_integrate = 0)
+    : BaseType(functions, vectors, spc, spc.grid_view(), over_integrate)
+    , which_intersections_(which_intersections)
+  {}
+
+  virtual ~L2FaceMulti() {}
+
+  virtual void apply_local(const IntersectionType& intersection,
+                           const EntityType& inside_entity,
+                           const EntityType& /*outside_entity*/) override final
+  {
+    if (!which_intersections_->apply_on(this->grid_view_, intersection))
+      return;
+    auto& storage = *this->storage_;
+    const auto test_base = this->space_.base_function_set(inside_entity);
+    const auto local_functions = this->localize(inside_entity);
+    const auto& intersection_geometry = intersection.geometry();
+    const auto& geometry_in_inside = intersection.geometryInInside();
+    const auto& quadrature = QuadratureRules< typename GridViewType::ctype, GridViewType::dimension - 1 >::rule(
+          intersection.type(), boost::numeric_cast< int >(this->integrand_order(local_functions, test_base)));
+    typedef typename IntersectionType::Geometry::LocalCoordinate LocalCoordinateType;
+    this->integrate(local_functions,
+                    test_base,
+                    quadrature,
+                    [&](const LocalCoordinateType& xx) { return geometry_in_inside.global(xx); },
+                    [&](const LocalCoordinateType& xx) { return intersection_geometry.integrationElement(xx); },
+                    storage);
+    this->space_.mapper().globalIndices(inside_entity, storage.global_indices);
+    this->write(test_base.size(), storage);
+  } // ... apply_local(...)
+
+  void assemble(const bool use_tbb = false)
+  {
+    Stuff::Grid::Walker< GridViewType > walker(this->grid_view_);
+    walker.add(*this);
+    walker.walk(use_tbb);
+  }
+
+private:
+  const std::unique_ptr< const Stuff::Grid::ApplyOn::WhichIntersection< GridViewType > > which_intersections_;
+}; // class L2FaceMulti
+
+
+} // namespace Functionals
+} // namespace GDT
+} // namespace Dune
+
+#endif // DUNE_GDT_FUNCTIONALS_L2_MULTI_HH
@@ -13,6 +13,7 @@
 #include <dune/gdt/localfunctional/codim0.hh>
 #include <dune/gdt/localfunctional/codim1.hh>
 #include <dune/gdt/localevaluation/product.hh>
+#include <dune/gdt/assembler/boundary-index.hh>
 #include <dune/gdt/assembler/system.hh>
 
 #include "base.hh"
@@ -178,6 +179,24 @@ public:
     setup(which_intersections);
   }
 
+  /**
+   * \brief Assembles only on the boundary intersections of the given type listed in boundary_index.
+   * \note  boundary_index has to outlive this functional.
+   */
+  L2Face(const FunctionType& function,
+         VectorType& vec,
+         const SpaceType& spc,
+         const BoundaryIntersectionIndex< GridViewType >& boundary_index,
+         const typename BoundaryIntersectionIndex< GridViewType >::BoundaryType boundary_type)
+    : FunctionalBaseType(vec, spc, boundary_index.grid_view())
+    , AssemblerBaseType(spc, boundary_index.grid_view())
+    , function_(function)
+    , local_functional_(function_)
+    , local_assembler_(local_functional_)
+  {
+    this->add(local_assembler_, this->vector(), boundary_index, boundary_type);
+  }
+
   virtual void assemble() override final
   {
     AssemblerBaseType::assemble();
@@ -221,6 +240,17 @@ make_l2_face(const F& function,
   return Stuff::Common::make_unique< L2Face< F, V, S > >(function, vector, space, which_intersections);
 }
 
+template< class F, class V, class S >
+  std::unique_ptr< L2Face< F, V, S > >
+make_l2_face(const F& function,
+             V& vector,
+             const S& space,
+             const BoundaryIntersectionIndex< typename S::GridViewType >& boundary_index,
+             const typename BoundaryIntersectionIndex< typename S::GridViewType >::BoundaryType boundary_type)
+{
+  return Stuff::Common::make_unique< L2Face< F, V, S > >(function, vector, space, boundary_index, boundary_type);
+}
+
 } // namespace Functionals
 } // namespace GDT
 } // namespace Dune
@@ -0,0 +1,245 @@
+// This file is part of the dune-gdt project:
+//   http://users.dune-project.org/projects/dune-gdt
+// Copyright holders: Felix Schindler
+// License: BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+
+#ifndef DUNE_GDT_FUNCTIONS_ELEMENTWISE_CONSTANT_HH
+#define DUNE_GDT_FUNCTIONS_ELEMENTWISE_CONSTANT_HH
+
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if HAVE_TBB
+# include <tbb/blocked_range.h>
+# include <tbb/parallel_for.h>
+#endif
+
+#include <dune/geometry/referenceelements.hh>
+
+#include <dune/stuff/common/exceptions.hh>
+#include <dune/stuff/common/memory.hh>
+#include <dune/stuff/common/ranges.hh>
+#include <dune/stuff/functions/interfaces.hh>
+
+namespace Dune {
+namespace GDT {
+namespace Functions {
+namespace internal {
+
+
+template< class EntityImp, class DomainFieldImp, size_t domainDim, class RangeFieldImp, size_t rangeDim,
+          size_t rangeDimCols >
+class ElementwiseConstantLocalfunction
+  : public Stuff::LocalfunctionInterface< EntityImp, DomainFieldImp, domainDim, RangeFieldImp, rangeDim, rangeDimCols >
+{
+  typedef Stuff::LocalfunctionInterface
+      < EntityImp, DomainFieldImp, domainDim, RangeFieldImp, rangeDim, rangeDimCols > BaseType;
+public:
+  typedef typename BaseType::EntityType        EntityType;
+  typedef typename BaseType::DomainType        DomainType;
+  typedef typename BaseType::RangeFieldType    RangeFieldType;
+  typedef typename BaseType::RangeType         RangeType;
+  typedef typename BaseType::JacobianRangeType JacobianRangeType;
+
+  ElementwiseConstantLocalfunction(const EntityType& ent, const RangeType& value)
+    : BaseType(ent)
+    , value_(value)
+  {}
+
+  virtual size_t order() const override
+  {
+    return 0;
+  }
+
+  virtual void evaluate(const DomainType& xx, RangeType& ret) const override
+  {
+    assert(this->is_a_valid_point(xx));
+    ret = value_;
+  }
+
+  virtual void jacobian(const DomainType& xx, JacobianRangeType& ret) const override
+  {
+    assert(this->is_a_valid_point(xx));
+    ret *= RangeFieldType(0);
+  }
+
+  using BaseType::evaluate;
+  using BaseType::jacobian;
+
+private:
+  const RangeType value_;
+}; // class ElementwiseConstantLocalfunction
+
+
+} // namespace internal
+
+
+/**
+ * \brief A function which is constant on each entity of a grid view, given by one value (or tensor) per entity.
+ *
+ *        The values are stored in a vector, indexed by the index set of the grid view. They can either be given
+ *        directly or be obtained by evaluating any localizable function in the center of each entity (in parallel, if
+ *        TBB is available and requested), which is the natural choice for piecewise constant data on a cartesian grid
+ *        (as the SPE10 permeabilities).
+ *
+ *        This is a localizable function like any other, but local evaluations can detect it at compile time (see
+ *        is_elementwise_constant) and use value(entity) instead of localizing it and evaluating the local function
+ *        in each quadrature point (see LocalEvaluation::Elliptic).
+ *
+ * \note  The function is only valid on the given grid view, it has to be recomputed after adaptation.
+ */
+template< class GridViewImp, class RangeFieldImp, size_t rangeDim, size_t rangeDimCols = 1 >
+class ElementwiseConstant
+  : public Stuff::LocalizableFunctionInterface< typename GridViewImp::template Codim< 0 >::Entity,
+                                                typename GridViewImp::ctype, GridViewImp::dimension,
+                                                RangeFieldImp, rangeDim, rangeDimCols >
+{
+  typedef Stuff::LocalizableFunctionInterface< typename GridViewImp::template Codim< 0 >::Entity,
+                                               typename GridViewImp::ctype, GridViewImp::dimension,
+                                               RangeFieldImp, rangeDim, rangeDimCols > BaseType;
+  typedef ElementwiseConstant< GridViewImp, RangeFieldImp, rangeDim, rangeDimCols > ThisType;
+public:
+  typedef GridViewImp                          GridViewType;
+  typedef typename BaseType::EntityType        EntityType;
+  typedef typename BaseType::DomainFieldType   DomainFieldType;
+  static const size_t                          dimDomain = BaseType::dimDomain;
+  typedef typename BaseType::RangeFieldType    RangeFieldType;
+  typedef typename BaseType::RangeType         RangeType;
+  typedef typename BaseType::LocalfunctionType LocalfunctionType;
+private:
+  typedef internal::ElementwiseConstantLocalfunction
+      < EntityType, DomainFieldType, dimDomain, RangeFieldType, rangeDim, rangeDimCols > ElementwiseLocalfunctionType;
+
+public:
+  static std::string static_id()
+  {
+    return BaseType::static_id() + ".elementwiseconstant";
+  }
+
+  /**
+   * \brief Evaluates function in the center of each entity of grid_view.
+   */
+  ElementwiseConstant(const GridViewType& grid_view,
+                      const BaseType& function,
+                      const bool use_tbb = false,
+                      const std::string nm = static_id())
+    : grid_view_(grid_view)
+    , values_(grid_view_.indexSet().size(0), RangeType(0))
+    , name_(nm)
+  {
+    typedef typename GridViewType::Grid::template Codim< 0 >::EntitySeed EntitySeedType;
+    std::vector< EntitySeedType > entity_seeds;
+    entity_seeds.reserve(values_.size());
+    for (const auto& entity : DSC::entityRange(grid_view_))
+      entity_seeds.emplace_back(entity.seed());
+    const auto evaluate_in_center = [&](const EntitySeedType& entity_seed) {
+      const auto entity_ptr = grid_view_.grid().entityPointer(entity_seed);
+      const auto& entity = *entity_ptr;
+      const auto& reference_element = ReferenceElements< DomainFieldType, dimDomain >::general(entity.type());
+      function.local_function(entity)->evaluate(reference_element.position(0, 0),
+                                                values_[grid_view_.indexSet().index(entity)]);
+    };
+#if HAVE_TBB
+    if (use_tbb) {
+      tbb::parallel_for(tbb::blocked_range< size_t >(0, entity_seeds.size()),
+                        [&](const tbb::blocked_range< size_t >& range) {
+                          for (size_t ii = range.begin(); ii != range.end(); ++ii)
+                            evaluate_in_center(entity_seeds[ii]);
+                        });
+      return;
+    }
+#else // HAVE_TBB
+    static_cast< void >(use_tbb);
+#endif // HAVE_TBB
+    for (const auto& entity_seed : entity_seeds)
+      evaluate_in_center(entity_seed);
+  } // ElementwiseConstant(...)
+
+  /**
+   * \brief Uses the given values, values[ii] is the value on the entity with index ii.
+   */
+  ElementwiseConstant(const GridViewType& grid_view,
+                      std::vector< RangeType > values,
+                      const std::string nm = static_id())
+    : grid_view_(grid_view)
+    , values_(std::move(values))
+    , name_(nm)
+  {
+    if (values_.size() != grid_view_.indexSet().size(0))
+      DUNE_THROW(Stuff::Exceptions::shapes_do_not_match,
+                 "Given " << values_.size() << " values for " << grid_view_.indexSet().size(0) << " entities!");
+  }
+
+  ElementwiseConstant(const ThisType& other) = default;
+
+  ThisType& operator=(const ThisType& other) = delete;
+
+  virtual ~ElementwiseConstant() {}
+
+  virtual std::string type() const override
+  {
+    return static_id();
+  }
+
+  virtual std::string name() const override
+  {
+    return name_;
+  }
+
+  const GridViewType& grid_view() const
+  {
+    return grid_view_;
+  }
+
+  const std::vector< RangeType >& values() const
+  {
+    return values_;
+  }
+
+  const RangeType& value(const EntityType& entity) const
+  {
+    assert(grid_view_.indexSet().contains(entity));
+    return values_[grid_view_.indexSet().index(entity)];
+  }
+
+  virtual std::unique_ptr< LocalfunctionType > local_function(const EntityType& entity) const override
+  {
+    return DSC::make_unique< ElementwiseLocalfunctionType >(entity, value(entity));
+  }
+
+private:
+  const GridViewType grid_view_;
+  std::vector< RangeType > values_;
+  const std::string name_;
+}; // class ElementwiseConstant
+
+
+template< class F >
+struct is_elementwise_constant
+  : public std::false_type
+{};
+
+template< class GV, class R, size_t r, size_t rC >
+struct is_elementwise_constant< ElementwiseConstant< GV, R, r, rC > >
+  : public std::true_type
+{};
+
+
+template< class GV, class E, class D, size_t d, class R, size_t r, size_t rC >
+ElementwiseConstant< GV, R, r, rC >
+make_elementwise_constant(const GV& grid_view,
+                          const Stuff::LocalizableFunctionInterface< E, D, d, R, r, rC >& function,
+                          const bool use_tbb = false)
+{
+  return ElementwiseConstant< GV, R, r, rC >(grid_view, function, use_tbb, function.name());
+}
+
+
+} // namespace Functions
+} // namespace GDT
+} // namespace Dune
+
+#endif // DUNE_GDT_FUNCTIONS_ELEMENTWISE_CONSTANT_HH
@@ -0,0 +1,555 @@
+// This file is part of the dune-gdt project:
+//   http://users.dune-project.org/projects/dune-gdt
+// Copyright holders: Felix Schindler
+// License: BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+
+#ifndef DUNE_GDT_FUNCTIONS_SPE10_HH
+#define DUNE_GDT_FUNCTIONS_SPE10_HH
+
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+# include <fcntl.h>
+# include <sys/mman.h>
+# include <sys/stat.h>
+# include <unistd.h>
+# define DUNE_GDT_FUNCTIONS_SPE10_USE_MMAP 1
+#else
+# define DUNE_GDT_FUNCTIONS_SPE10_USE_MMAP 0
+#endif
+
+#include <dune/common/fmatrix.hh>
+#include <dune/common/fvector.hh>
+#include <dune/common/typetraits.hh>
+
+#include <dune/stuff/common/memory.hh>
+#include <dune/stuff/common/string.hh>
+#include <dune/stuff/functions/interfaces.hh>
+#include <dune/stuff/functions/spe10.hh>
+
+#include <dune/gdt/exceptions.hh>
+
+#include "elementwise-constant.hh"
+
+namespace Dune {
+namespace GDT {
+namespace Functions {
+namespace Spe10 {
+namespace internal {
+
+
+static const std::string model2_filename = "spe_perm.dat";
+static const size_t model2_x_elements = 60;
+static const size_t model2_y_elements = 220;
+static const size_t model2_z_elements = 85;
+
+
+/**
+ * \brief Read-only view of the values of an SPE10 data file, see get().
+ *
+ *        On first access, the ASCII data file is converted to a binary file (filename + ".bin", a small header
+ *        followed by the values as native doubles), which is then memory mapped read-only. All subsequent accesses
+ *        (from the same or from other processes, also for other problem instances or refinement levels) only map the
+ *        binary file, which does not require to parse any text. The operating system shares the mapped pages between
+ *        all processes.
+ *
+ *        The header records the size and modification time of the ASCII file and a checksum of the values. The binary
+ *        file is recreated if the ASCII file has changed since or if the values do not match the checksum (e.g., if
+ *        the file was truncated or overwritten). If the ASCII file is missing, any valid binary file is used.
+ *
+ * \note  If the binary file can not be written (e.g., the directory is not writable), the parsed values are kept in
+ *        memory instead.
+ * \note  The binary file is not portable between platforms of different endianness, it is recreated if its header
+ *        does not match.
+ */
+class Data
+{
+  struct Header
+  {
+    char magic[8];
+    std::uint64_t version;
+    std::uint64_t size;
+    std::uint64_t source_size;
+    std::int64_t source_modification_time;
+    std::uint64_t checksum;
+  }; // struct Header
+
+  struct SourceStatus
+  {
+    bool exists;
+    std::uint64_t size;
+    std::int64_t modification_time;
+  }; // struct SourceStatus
+
+  static const std::uint64_t binary_version = 2;
+
+public:
+  /**
+   * \brief Returns the values of ascii_filename (which has to contain at least size values, only the first size
+   *        values are used), shared by all callers as long as any of them holds the returned pointer.
+   */
+  static std::shared_ptr< const Data > get(const std::string& ascii_filename, const size_t size)
+  {
+    static std::mutex mutex;
+    static std::map< std::pair< std::string, size_t >, std::weak_ptr< const Data > > cache;
+    std::lock_guard< std::mutex > lock(mutex);
+    const auto key = std::make_pair(ascii_filename, size);
+    auto data = cache[key].lock();
+    if (!data) {
+      data = std::shared_ptr< const Data >(new Data(ascii_filename, size));
+      cache[key] = data;
+    }
+    return data;
+  } // ... get(...)
+
+  Data(const Data& other) = delete;
+
+  Data& operator=(const Data& other) = delete;
+
+  ~Data()
+  {
+#if DUNE_GDT_FUNCTIONS_SPE10_USE_MMAP
+    if (mapping_ != nullptr)
+      munmap(mapping_, mapping_size_);
+#endif
+  }
+
+  size_t size() const
+  {
+    return size_;
+  }
+
+  double operator[](const size_t ii) const
+  {
+    assert(ii < size_);
+    return values_[ii];
+  }
+
+private:
+  Data(const std::string& ascii_filename, const size_t sz)
+    : size_(sz)
+    , values_(nullptr)
+    , mapping_(nullptr)
+    , mapping_size_(0)
+  {
+    const std::string binary_filename = ascii_filename + ".bin";
+    const SourceStatus source = source_status(ascii_filename);
+    if (map(binary_filename, source))
+      return;
+    parse(ascii_filename);
+    if (write(binary_filename, source) && map(binary_filename, source)) {
+      std::vector< double >().swap(parsed_values_);
+      return;
+    }
+    values_ = parsed_values_.data();
+  } // Data(...)
+
+  static SourceStatus source_status(const std::string& ascii_filename)
+  {
+    SourceStatus source;
+    std::memset(&source, 0, sizeof(source));
+#if DUNE_GDT_FUNCTIONS_SPE10_USE_MMAP
+    struct stat file_status;
+    if (stat(ascii_filename.c_str(), &file_status) == 0) {
+      source.exists = true;
+      source.size = std::uint64_t(file_status.st_size);
+      source.modification_time = std::int64_t(file_status.st_mtime);
+    }
+#else // DUNE_GDT_FUNCTIONS_SPE10_USE_MMAP
+    std::ifstream file(ascii_filename, std::ios::binary | std::ios::ate);
+    if (file.is_open()) {
+      source.exists = true;
+      source.size = std::uint64_t(file.tellg());
+    }
+#endif // DUNE_GDT_FUNCTIONS_SPE10_USE_MMAP
+    return source;
+  } // ... source_status(...)
+
+  //! FNV-1a hash of the bytes of the values.
+  static std::uint64_t checksum(const double* values, const size_t sz)
+  {
+    const unsigned char* bytes = reinterpret_cast< const unsigned char* >(values);
+    std::uint64_t hash = 14695981039346656037ull;
+    for (size_t ii = 0; ii < sz*sizeof(double); ++ii) {
+      hash ^= bytes[ii];
+      hash *= 1099511628211ull;
+    }
+    return hash;
+  } // ... checksum(...)
+
+  Header create_header(const SourceStatus& source) const
+  {
+    Header header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, "GDTSPE10", 8);
+    header.version = binary_version;
+    header.size = size_;
+    header.source_size = source.size;
+    header.source_modification_time = source.modification_time;
+    header.checksum = checksum(parsed_values_.data(), size_);
+    return header;
+  } // ... create_header(...)
+
+  //! The checksum has to be checked separately.
+  bool is_valid(const Header& header, const SourceStatus& source) const
+  {
+    return std::memcmp(header.magic, "GDTSPE10", 8) == 0
+        && header.version == binary_version
+        && header.size == size_
+        && (!source.exists || (header.source_size == source.size
+                               && header.source_modification_time == source.modification_time));
+  } // ... is_valid(...)
+
+  bool map(const std::string& binary_filename, const SourceStatus& source)
+  {
+#if DUNE_GDT_FUNCTIONS_SPE10_USE_MMAP
+    const int file_descriptor = open(binary_filename.c_str(), O_RDONLY);
+    if (file_descriptor < 0)
+      return false;
+    struct stat file_status;
+    const size_t expected_size = sizeof(Header) + size_*sizeof(double);
+    if (fstat(file_descriptor, &file_status) != 0 || size_t(file_status.st_size) != expected_size) {
+      close(file_descriptor);
+      return false;
+    }
+    void* mapping = mmap(nullptr, expected_size, PROT_READ, MAP_SHARED, file_descriptor, 0);
+    close(file_descriptor);
+    if (mapping == MAP_FAILED)
+      return false;
+    Header header;
+    std::memcpy(&header, mapping, sizeof(Header));
+    const double* values = reinterpret_cast< const double* >(static_cast< const char* >(mapping) + sizeof(Header));
+    if (!is_valid(header, source) || header.checksum != checksum(values, size_)) {
+      munmap(mapping, expected_size);
+      return false;
+    }
+    mapping_ = mapping;
+    mapping_size_ = expected_size;
+    values_ = values;
+    return true;
+#else // DUNE_GDT_FUNCTIONS_SPE10_USE_MMAP
+    std::ifstream file(binary_filename, std::ios::binary);
+    if (!file.is_open())
+      return false;
+    Header header;
+    if (!file.read(reinterpret_cast< char* >(&header), sizeof(Header)) || !is_valid(header, source))
+      return false;
+    parsed_values_.resize(size_);
+    if (!file.read(reinterpret_cast< char* >(parsed_values_.data()), size_*sizeof(double))
+        || header.checksum != checksum(parsed_values_.data(), size_)) {
+      std::vector< double >().swap(parsed_values_);
+      return false;
+    }
+    values_ = parsed_values_.data();
+    return true;
+#endif // DUNE_GDT_FUNCTIONS_SPE10_USE_MMAP
+  } // ... map(...)
+
+  void parse(const std::string& ascii_filename)
+  {
+    std::ifstream datafile(ascii_filename);
+    if (!datafile.is_open())
+      DUNE_THROW(Exceptions::spe10_data_file_missing,
+                 "could not open '" << ascii_filename << "'!"
+                 << " Did you download it from http://www.spe.org/web/csp/?");
+    parsed_values_.resize(size_);
+    double tmp = 0;
+    size_t counter = 0;
+    while (counter < size_ && datafile >> tmp)
+      parsed_values_[counter++] = tmp;
+    if (counter != size_)
+      DUNE_THROW(Exceptions::spe10_data_file_missing,
+                 "wrong number of entries in '" << ascii_filename << "' (are " << counter << ", should be " << size_
+                 << ")!");
+  } // ... parse(...)
+
+  /**
+   * \note Writes to a temporary file first (unique per process and call), which is then renamed, so that concurrent
+   *       writers never see an incomplete binary file.
+   */
+  bool write(const std::string& binary_filename, const SourceStatus& source) const
+  {
+    static std::atomic< size_t > counter(0);
+#if DUNE_GDT_FUNCTIONS_SPE10_USE_MMAP
+    const std::string tmp_filename = binary_filename + ".tmp." + DSC::toString(getpid()) + "."
+                                     + DSC::toString(counter++);
+#else
+    const std::string tmp_filename = binary_filename + ".tmp." + DSC::toString(std::random_device()()) + "."
+                                     + DSC::toString(counter++);
+#endif
+    {
+      std::ofstream file(tmp_filename, std::ios::binary | std::ios::trunc);
+      if (!file.is_open())
+        return false;
+      const Header header = create_header(source);
+      file.write(reinterpret_cast< const char* >(&header), sizeof(Header));
+      file.write(reinterpret_cast< const char* >(parsed_values_.data()), size_*sizeof(double));
+      if (!file.good()) {
+        file.close();
+        std::remove(tmp_filename.c_str());
+        return false;
+      }
+    }
+    if (std::rename(tmp_filename.c_str(), binary_filename.c_str()) != 0) {
+      std::remove(tmp_filename.c_str());
+      return false;
+    }
+    return true;
+  } // ... write(...)
+
+  const size_t size_;
+  const double* values_;
+  void* mapping_;
+  size_t mapping_size_;
+  std::vector< double > parsed_values_;
+}; // class Data
+
+
+/**
+ * \brief Index of the cell of a cartesian grid of num_elements cells on [lower_left, upper_right] which contains
+ *        point (the first direction runs fastest).
+ */
+template< class DomainType, size_t d >
+size_t cartesian_index(const DomainType& lower_left,
+                       const DomainType& upper_right,
+                       const std::array< size_t, d >& num_elements,
+                       const DomainType& point)
+{
+  size_t index = 0;
+  size_t factor = 1;
+  for (size_t dd = 0; dd < d; ++dd) {
+    const auto width = (upper_right[dd] - lower_left[dd]) / num_elements[dd];
+    const auto position = std::floor((point[dd] - lower_left[dd]) / width);
+    size_t ii = position < 0 ? 0 : size_t(position);
+    if (ii >= num_elements[dd])
+      ii = num_elements[dd] - 1;
+    index += ii*factor;
+    factor *= num_elements[dd];
+  }
+  return index;
+} // ... cartesian_index(...)
+
+
+} // namespace internal
+
+
+template< class E, class D, size_t d, class R, size_t r, size_t rC = 1 >
+class Model1
+{
+  static_assert(AlwaysFalse< E >::value, "Not available for these dimensions!");
+};
+
+
+/**
+ * \brief Scalar permeability of the SPE10 model 1 dataset, piecewise constant on 100x20 cells.
+ *
+ *        Behaves as Stuff::Functions::Spe10::Model1 (the values are affinely mapped to [min, max]), but the data is
+ *        only parsed once and then memory mapped from a binary file, see internal::Data.
+ */
+template< class E, class D, class R >
+class Model1< E, D, 2, R, 1, 1 >
+  : public Stuff::LocalizableFunctionInterface< E, D, 2, R, 1, 1 >
+{
+  typedef Stuff::LocalizableFunctionInterface< E, D, 2, R, 1, 1 > BaseType;
+  typedef Model1< E, D, 2, R, 1, 1 >                              ThisType;
+  typedef Functions::internal::ElementwiseConstantLocalfunction< E, D, 2, R, 1, 1 > ConstantLocalfunctionType;
+public:
+  typedef typename BaseType::EntityType        EntityType;
+  typedef typename BaseType::DomainType        DomainType;
+  typedef typename BaseType::RangeFieldType    RangeFieldType;
+  typedef typename BaseType::RangeType         RangeType;
+  typedef typename BaseType::LocalfunctionType LocalfunctionType;
+
+  static std::string static_id()
+  {
+    return BaseType::static_id() + ".spe10.model1";
+  }
+
+  Model1(const std::string& filename,
+         const DomainType& lower_left,
+         const DomainType& upper_right,
+         const RangeFieldType min = Stuff::Functions::Spe10::internal::model1_min_value,
+         const RangeFieldType max = Stuff::Functions::Spe10::internal::model1_max_value,
+         const std::string nm = static_id())
+    : data_(internal::Data::get(filename, num_elements_[0]*num_elements_[1]))
+    , lower_left_(lower_left)
+    , upper_right_(upper_right)
+    , scale_((max - min) / (Stuff::Functions::Spe10::internal::model1_max_value
+                            - Stuff::Functions::Spe10::internal::model1_min_value))
+    , shift_(min - scale_*Stuff::Functions::Spe10::internal::model1_min_value)
+    , name_(nm)
+  {
+    if (!(max > min))
+      DUNE_THROW(Dune::RangeError, "max (is " << max << ") has to be larger than min (is " << min << ")!");
+  }
+
+  Model1(const ThisType& other) = default;
+
+  ThisType& operator=(const ThisType& other) = delete;
+
+  virtual ~Model1() {}
+
+  virtual std::string type() const override
+  {
+    return static_id();
+  }
+
+  virtual std::string name() const override
+  {
+    return name_;
+  }
+
+  RangeType value(const DomainType& xx) const
+  {
+    const size_t index = internal::cartesian_index(lower_left_, upper_right_, num_elements_, xx);
+    return RangeType((*data_)[index]*scale_ + shift_);
+  }
+
+  virtual std::unique_ptr< LocalfunctionType > local_function(const EntityType& entity) const override
+  {
+    return DSC::make_unique< ConstantLocalfunctionType >(entity, value(entity.geometry().center()));
+  }
+
+private:
+  static const std::array< size_t, 2 > num_elements_;
+  const std::shared_ptr< const internal::Data > data_;
+  const DomainType lower_left_;
+  const DomainType upper_right_;
+  const RangeFieldType scale_;
+  const RangeFieldType shift_;
+  const std::string name_;
+}; // class Model1< ..., 2, ..., 1, 1 >
+
+template< class E, class D, class R >
+const std::array< size_t, 2 > Model1< E, D, 2, R, 1, 1 >::num_elements_ = {{100, 20}};
+
+
+template< class E, class D, size_t d, class R, size_t r, size_t rC = r >
+class Model2
+{
+  static_assert(AlwaysFalse< E >::value, "Not available for these dimensions!");
+};
+
+
+/**
+ * \brief Diagonal permeability tensor of the SPE10 model 2 dataset, piecewise constant on 60x220x85 cells.
+ *
+ *        The data file (spe_perm.dat, see http://www.spe.org/web/csp/datasets/set02.htm) contains all x-, then all
+ *        y- and then all z-permeabilities. It is only parsed once and then memory mapped from a binary file, see
+ *        internal::Data, which pays off in particular for this dataset of more than 3 million values.
+ */
+template< class E, class D, class R >
+class Model2< E, D, 3, R, 3, 3 >
+  : public Stuff::LocalizableFunctionInterface< E, D, 3, R, 3, 3 >
+{
+  typedef Stuff::LocalizableFunctionInterface< E, D, 3, R, 3, 3 > BaseType;
+  typedef Model2< E, D, 3, R, 3, 3 >                              ThisType;
+  typedef Functions::internal::ElementwiseConstantLocalfunction< E, D, 3, R, 3, 3 > ConstantLocalfunctionType;
+public:
+  typedef typename BaseType::EntityType        EntityType;
+  typedef typename BaseType::DomainType        DomainType;
+  typedef typename BaseType::RangeFieldType    RangeFieldType;
+  typedef typename BaseType::RangeType         RangeType;
+  typedef typename BaseType::LocalfunctionType LocalfunctionType;
+
+  static std::string static_id()
+  {
+    return BaseType::static_id() + ".spe10.model2";
+  }
+
+  static DomainType default_lower_left()
+  {
+    return DomainType(0);
+  }
+
+  /**
+   * \brief The extent of the dataset in feet.
+   */
+  static DomainType default_upper_right()
+  {
+    DomainType upper_right;
+    upper_right[0] = 1200;
+    upper_right[1] = 2200;
+    upper_right[2] = 170;
+    return upper_right;
+  }
+
+  Model2(const std::string& filename = internal::model2_filename,
+         const DomainType& lower_left = default_lower_left(),
+         const DomainType& upper_right = default_upper_right(),
+         const std::string nm = static_id())
+    : data_(internal::Data::get(filename, 3*num_cells()))
+    , lower_left_(lower_left)
+    , upper_right_(upper_right)
+    , name_(nm)
+  {}
+
+  Model2(const ThisType& other) = default;
+
+  ThisType& operator=(const ThisType& other) = delete;
+
+  virtual ~Model2() {}
+
+  virtual std::string type() const override
+  {
+    return static_id();
+  }
+
+  virtual std::string name() const override
+  {
+    return name_;
+  }
+
+  RangeType value(const DomainType& xx) const
+  {
+    const size_t index = internal::cartesian_index(lower_left_, upper_right_, num_elements_, xx);
+    RangeType ret(0);
+    for (size_t dd = 0; dd < 3; ++dd)
+      ret[dd][dd] = (*data_)[dd*num_cells() + index];
+    return ret;
+  } // ... value(...)
+
+  virtual std::unique_ptr< LocalfunctionType > local_function(const EntityType& entity) const override
+  {
+    return DSC::make_unique< ConstantLocalfunctionType >(entity, value(entity.geometry().center()));
+  }
+
+private:
+  static size_t num_cells()
+  {
+    return internal::model2_x_elements*internal::model2_y_elements*internal::model2_z_elements;
+  }
+
+  static const std::array< size_t, 3 > num_elements_;
+  const std::shared_ptr< const internal::Data > data_;
+  const DomainType lower_left_;
+  const DomainType upper_right_;
+  const std::string name_;
+}; // class Model2< ..., 3, ..., 3, 3 >
+
+template< class E, class D, class R >
+const std::array< size_t, 3 > Model2< E, D, 3, R, 3, 3 >::num_elements_ = {{internal::model2_x_elements,
+                                                                             internal::model2_y_elements,
+                                                                             internal::model2_z_elements}};
+
+
+} // namespace Spe10
+} // namespace Functions
+} // namespace GDT
+} // namespace Dune
+
+#undef DUNE_GDT_FUNCTIONS_SPE10_USE_MMAP
+
+#endif // DUNE_GDT_FUNCTIONS_SPE10_HH
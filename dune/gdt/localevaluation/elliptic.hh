@@ -8,15 +8,19 @@
 #ifndef DUNE_GDT_EVALUATION_ELLIPTIC_HH
 #define DUNE_GDT_EVALUATION_ELLIPTIC_HH
 
+#include <memory>
 #include <tuple>
 
 #include <boost/numeric/conversion/cast.hpp>
 
 #include <dune/common/dynmatrix.hh>
+#include <dune/common/fmatrix.hh>
 #include <dune/common/typetraits.hh>
 
 #include <dune/stuff/functions/interfaces.hh>
 
+#include <dune/gdt/functions/elementwise-constant.hh>
+
 #include "interface.hh"
 
 namespace Dune {
@@ -32,6 +36,80 @@ class Elliptic;
 namespace internal {
 
 
+/**
+ * \brief Localizes a diffusion function, see Elliptic.
+ *
+ *        In general, the local function is created on each entity (or taken from the entity context of the walk, which
+ *        creates it once per entity for all local assemblers) and evaluated in each quadrature point.
+ */
+template< class FunctionType, bool elementwise_constant = Functions::is_elementwise_constant< FunctionType >::value >
+class EllipticLocalCoefficient
+{
+public:
+  typedef std::shared_ptr< typename FunctionType::LocalfunctionType > Type;
+
+  template< class EntityType >
+  static Type localize(const FunctionType& function, const EntityType& entity)
+  {
+    return function.local_function(entity);
+  }
+
+  template< class T, class A >
+  static Type localize(const FunctionType& function, LocalAssembler::EntityContext< T, A >& context)
+  {
+    return context.local_function(function);
+  }
+
+  static size_t order(const Type& local_function)
+  {
+    return local_function->order();
+  }
+
+  template< class DomainType >
+  static typename FunctionType::RangeType evaluate(const Type& local_function, const DomainType& xx)
+  {
+    return local_function->evaluate(xx);
+  }
+}; // class EllipticLocalCoefficient
+
+
+/**
+ * \brief Localizes an elementwise constant diffusion function, see Elliptic.
+ *
+ *        Only its value on the entity is looked up (no local function is created), which is of order 0 and not
+ *        evaluated in the quadrature points.
+ */
+template< class FunctionType >
+class EllipticLocalCoefficient< FunctionType, true >
+{
+public:
+  typedef typename FunctionType::RangeType Type;
+
+  template< class EntityType >
+  static Type localize(const FunctionType& function, const EntityType& entity)
+  {
+    return function.value(entity);
+  }
+
+  template< class T, class A >
+  static Type localize(const FunctionType& function, LocalAssembler::EntityContext< T, A >& context)
+  {
+    return function.value(context.entity());
+  }
+
+  static size_t order(const Type& /*value*/)
+  {
+    return 0;
+  }
+
+  template< class DomainType >
+  static const Type& evaluate(const Type& value, const DomainType& /*xx*/)
+  {
+    return value;
+  }
+}; // class EllipticLocalCoefficient< ..., true >
+
+
 /**
  * \brief Traits for the Elliptic evaluation (variant for given diffusion factor and tensor).
  * \sa    EllipticTraits (below) for a variant if only a diffusion is given.
@@ -53,8 +131,8 @@ class EllipticTraits
                 "Dimensions have to agree!");
 public:
   typedef Elliptic< DiffusionFactorType, DiffusionTensorType > derived_type;
-  typedef std::tuple< std::shared_ptr< typename DiffusionFactorType::LocalfunctionType >,
-                      std::shared_ptr< typename DiffusionTensorType::LocalfunctionType > > LocalfunctionTupleType;
+  typedef std::tuple< typename EllipticLocalCoefficient< DiffusionFactorType >::Type,
+                      typename EllipticLocalCoefficient< DiffusionTensorType >::Type > LocalfunctionTupleType;
   typedef typename DiffusionFactorType::EntityType      EntityType;
   typedef typename DiffusionFactorType::DomainFieldType DomainFieldType;
   static const size_t                                   dimDomain = DiffusionFactorType::dimDomain;
@@ -76,7 +154,7 @@ public:
   typedef Elliptic< DiffusionType, void >         derived_type;
   typedef typename DiffusionType::EntityType      EntityType;
   typedef typename DiffusionType::DomainFieldType DomainFieldType;
-  typedef std::tuple< std::shared_ptr< typename DiffusionType::LocalfunctionType > > LocalfunctionTupleType;
+  typedef std::tuple< typename EllipticLocalCoefficient< DiffusionType >::Type > LocalfunctionTupleType;
   static const size_t                             dimDomain = DiffusionType::dimDomain;
 }; // class EllipticTraits< ..., void >
 
@@ -86,12 +164,16 @@ public:
 
 /**
  * \brief Computes an elliptic evaluation (variant for given diffusion factor and tensor).
+ * \note  If any of the functions is a Functions::ElementwiseConstant, its value is looked up once per entity instead
+ *        of being evaluated in each quadrature point.
  * \sa    Elliptic (below) for a variant if only a diffusion is given.
  */
 template< class DiffusionFactorImp, class DiffusionTensorImp >
 class Elliptic
   : public LocalEvaluation::Codim0Interface< internal::EllipticTraits< DiffusionFactorImp, DiffusionTensorImp >, 2 >
 {
+  typedef internal::EllipticLocalCoefficient< DiffusionFactorImp > LocalDiffusionFactorType;
+  typedef internal::EllipticLocalCoefficient< DiffusionTensorImp > LocalDiffusionTensorType;
 public:
   typedef DiffusionFactorImp                                                   DiffusionFactorType;
   typedef DiffusionTensorImp                                                   DiffusionTensorType;
@@ -109,12 +191,23 @@ public:
 
   LocalfunctionTupleType localFunctions(const EntityType& entity) const
   {
-    return std::make_tuple(diffusion_factor_.local_function(entity),
-                           diffusion_tensor_.local_function(entity));
+    return std::make_tuple(LocalDiffusionFactorType::localize(diffusion_factor_, entity),
+                           LocalDiffusionTensorType::localize(diffusion_tensor_, entity));
   }
 
   /**
-   * \brief extracts the local functions and calls the correct order() method
+   * \brief Takes the local functions from context, see internal::local_functions().
+   */
+  template< class T, class A >
+  LocalfunctionTupleType localFunctions(LocalAssembler::EntityContext< T, A >& context) const
+  {
+    return std::make_tuple(LocalDiffusionFactorType::localize(diffusion_factor_, context),
+                           LocalDiffusionTensorType::localize(diffusion_tensor_, context));
+  }
+
+  /**
+   * \return local_diffusion_factor.order() + local_diffusion_tensor.order() + (testBase.order() - 1)
+   *         + (ansatzBase.order() - 1)
    */
   template< class R, size_t rT, size_t rCT, size_t rA, size_t rCA >
   size_t order(const LocalfunctionTupleType& local_functions_tuple,
@@ -123,13 +216,14 @@ public:
                const Stuff::LocalfunctionSetInterface
                    < EntityType, DomainFieldType, dimDomain, R, rA, rCA >& ansatzBase) const
   {
-    const auto local_diffusion_factor = std::get< 0 >(local_functions_tuple);
-    const auto local_diffusion_tensor = std::get< 1 >(local_functions_tuple);
-    return order(*local_diffusion_factor, *local_diffusion_tensor, testBase, ansatzBase);
+    return LocalDiffusionFactorType::order(std::get< 0 >(local_functions_tuple))
+        + LocalDiffusionTensorType::order(std::get< 1 >(local_functions_tuple))
+        + boost::numeric_cast< size_t >(std::max(ssize_t(testBase.order()) - 1, ssize_t(0)))
+        + boost::numeric_cast< size_t >(std::max(ssize_t(ansatzBase.order()) - 1, ssize_t(0)));
   } // ... order(...)
 
   /**
-   * \brief extracts the local functions and calls the correct evaluate() method
+   * \brief extracts the values of the local functions and calls the correct evaluate() method
    */
   template< class R, size_t rT, size_t rCT, size_t rA, size_t rCA >
   void evaluate(const LocalfunctionTupleType& local_functions_tuple,
@@ -140,33 +234,18 @@ public:
                 const Dune::FieldVector< DomainFieldType, dimDomain >& localPoint,
                 Dune::DynamicMatrix< R >& ret) const
   {
-    const auto local_diffusion_factor = std::get< 0 >(local_functions_tuple);
-    const auto local_diffusion_tensor = std::get< 1 >(local_functions_tuple);
-    evaluate(*local_diffusion_factor, *local_diffusion_tensor, testBase, ansatzBase, localPoint, ret);
-  }
+    evaluate(LocalDiffusionFactorType::evaluate(std::get< 0 >(local_functions_tuple), localPoint),
+             LocalDiffusionTensorType::evaluate(std::get< 1 >(local_functions_tuple), localPoint),
+             testBase,
+             ansatzBase,
+             localPoint,
+             ret);
+  } // ... evaluate(...)
 
 private:
-  template< class R, size_t rDF, size_t rCDF, size_t rDT, size_t rCDT, size_t rT, size_t rCT, size_t rA, size_t rCA >
-  size_t order(const Stuff::LocalfunctionInterface
-                   < EntityType, DomainFieldType, dimDomain, R, rDF, rCDF >& local_diffusion_factor,
-               const Stuff::LocalfunctionInterface
-                   < EntityType, DomainFieldType, dimDomain, R, rDT, rCDT >& local_diffusion_tensor,
-               const Stuff::LocalfunctionSetInterface
-                   < EntityType, DomainFieldType, dimDomain, R, rT, rCT >& testBase,
-               const Stuff::LocalfunctionSetInterface
-                   < EntityType, DomainFieldType, dimDomain, R, rA, rCA >& ansatzBase) const
-  {
-    return local_diffusion_factor.order()
-        + local_diffusion_tensor.order()
-        + std::max(ssize_t(testBase.order()) - 1, ssize_t(0))
-        + std::max(ssize_t(ansatzBase.order()) - 1, ssize_t(0));
-  } // ... order(...)
-
   template< class R, size_t r >
-  void evaluate(const Stuff::LocalfunctionInterface
-                    < EntityType, DomainFieldType, dimDomain, R, 1, 1 >& local_diffusion_factor,
-                const Stuff::LocalfunctionInterface
-                    < EntityType, DomainFieldType, dimDomain, R, 1, 1 >& local_diffusion_tensor,
+  void evaluate(const FieldVector< R, 1 >& local_diffusion_factor_value,
+                const FieldVector< R, 1 >& local_diffusion_tensor_value,
                 const Stuff::LocalfunctionSetInterface
                     < EntityType, DomainFieldType, dimDomain, R, r, 1 >& testBase,
                 const Stuff::LocalfunctionSetInterface
@@ -174,9 +253,6 @@ private:
                 const Dune::FieldVector< DomainFieldType, dimDomain >& localPoint,
                 Dune::DynamicMatrix< R >& ret) const
   {
-    // evaluate local functions
-    const auto local_diffusion_factor_value = local_diffusion_factor.evaluate(localPoint);
-    const auto local_diffusion_tensor_value = local_diffusion_tensor.evaluate(localPoint);
     // evaluate test gradient
     const auto rows = testBase.size();
     const auto testGradients = testBase.jacobian(localPoint);
@@ -186,63 +262,33 @@ private:
     // compute products
     assert(ret.rows() >= rows);
     assert(ret.cols() >= cols);
+    const R local_diffusion_value = local_diffusion_factor_value * local_diffusion_tensor_value;
     for (size_t ii = 0; ii < rows; ++ii) {
       auto& retRow = ret[ii];
       for (size_t jj = 0; jj < cols; ++jj) {
-        retRow[jj] = local_diffusion_factor_value * local_diffusion_tensor_value
-                     * (ansatzGradients[jj][0] * testGradients[ii][0]);
+        retRow[jj] = local_diffusion_value * (ansatzGradients[jj][0] * testGradients[ii][0]);
       }
     }
   } // ... evaluate(...)
 
+  /**
+   * \note Unfortunately we need to require dimDomain x dimDomain matrices here, otherwise the compiler will complain
+   *       for 1d grids (a 1x1 tensor valued function is scalar valued, see above).
+   */
   template< class R >
-  void evaluate(const Stuff::LocalfunctionInterface
-                    < EntityType, DomainFieldType, dimDomain, R, 1, 1 >& local_diffusion_factor,
-                const Stuff::LocalfunctionInterface
-                    < EntityType, DomainFieldType, dimDomain, R, 2, 2 >& local_diffusion_tensor,
-                const Stuff::LocalfunctionSetInterface
-                    < EntityType, DomainFieldType, dimDomain, R, 1, 1 >& testBase,
-                const Stuff::LocalfunctionSetInterface
-                    < EntityType, DomainFieldType, dimDomain, R, 1, 1 >& ansatzBase,
-                const Dune::FieldVector< DomainFieldType, dimDomain >& localPoint,
-                Dune::DynamicMatrix< R >& ret) const
-  {
-    evaluate_matrix_valued_(local_diffusion_factor, local_diffusion_tensor, testBase, ansatzBase, localPoint, ret);
-  }
-
-  template< class R >
-  void evaluate(const Stuff::LocalfunctionInterface
-                    < EntityType, DomainFieldType, dimDomain, R, 1, 1 >& local_diffusion_factor,
-                const Stuff::LocalfunctionInterface
-                    < EntityType, DomainFieldType, dimDomain, R, 3, 3 >& local_diffusion_tensor,
+  void evaluate(const FieldVector< R, 1 >& local_diffusion_factor_value,
+                const FieldMatrix< R, dimDomain, dimDomain >& local_diffusion_tensor_value,
                 const Stuff::LocalfunctionSetInterface
                     < EntityType, DomainFieldType, dimDomain, R, 1, 1 >& testBase,
                 const Stuff::LocalfunctionSetInterface
                     < EntityType, DomainFieldType, dimDomain, R, 1, 1 >& ansatzBase,
                 const Dune::FieldVector< DomainFieldType, dimDomain >& localPoint,
                 Dune::DynamicMatrix< R >& ret) const
-  {
-    evaluate_matrix_valued_(local_diffusion_factor, local_diffusion_tensor, testBase, ansatzBase, localPoint, ret);
-  }
-
-  template< class R >
-  void evaluate_matrix_valued_(const Stuff::LocalfunctionInterface
-                                   < EntityType, DomainFieldType, dimDomain, R, 1, 1 >& local_diffusion_factor,
-                               const Stuff::LocalfunctionInterface
-                                   < EntityType, DomainFieldType, dimDomain, R, dimDomain, dimDomain >& local_diffusion_tensor,
-                               const Stuff::LocalfunctionSetInterface
-                                   < EntityType, DomainFieldType, dimDomain, R, 1, 1 >& testBase,
-                               const Stuff::LocalfunctionSetInterface
-                                   < EntityType, DomainFieldType, dimDomain, R, 1, 1 >& ansatzBase,
-                               const Dune::FieldVector< DomainFieldType, dimDomain >& localPoint,
-                               Dune::DynamicMatrix< R >& ret) const
   {
     typedef typename Stuff::LocalfunctionSetInterface
         < EntityType, DomainFieldType, dimDomain, R, 1, 1 >::JacobianRangeType JacobianRangeType;
-    // evaluate local functions
-    const auto local_diffusion_factor_value = local_diffusion_factor.evaluate(localPoint);
-    auto local_diffusion_tensor_value = local_diffusion_tensor.evaluate(localPoint);
-    local_diffusion_tensor_value *= local_diffusion_factor_value[0];
+    auto local_diffusion_value = local_diffusion_tensor_value;
+    local_diffusion_value *= local_diffusion_factor_value[0];
     // evaluate test gradient
     const size_t rows = testBase.size();
     std::vector< JacobianRangeType > testGradients(rows, JacobianRangeType(0));
@@ -258,11 +304,11 @@ private:
     for (size_t ii = 0; ii < rows; ++ii) {
       auto& retRow = ret[ii];
       for (size_t jj = 0; jj < cols; ++jj) {
-        local_diffusion_tensor_value.mv(ansatzGradients[jj][0], product);
+        local_diffusion_value.mv(ansatzGradients[jj][0], product);
         retRow[jj] = product * testGradients[ii][0];
       }
     }
-  } // ... evaluate_matrix_valued_(...)
+  } // ... evaluate(...)
 
   const DiffusionFactorType& diffusion_factor_;
   const DiffusionTensorType& diffusion_tensor_;
@@ -279,6 +325,7 @@ template< class DiffusionImp >
 class Elliptic< DiffusionImp, void >
   : public LocalEvaluation::Codim0Interface< internal::EllipticTraits< DiffusionImp, void >, 2 >
 {
+  typedef internal::EllipticLocalCoefficient< DiffusionImp > LocalDiffusionType;
 public:
   typedef DiffusionImp                                    DiffusionType;
   typedef internal::EllipticTraits< DiffusionType, void > Traits;
@@ -296,7 +343,16 @@ public:
 
   LocalfunctionTupleType localFunctions(const EntityType& entity) const
   {
-    return std::make_tuple(diffusion_.local_function(entity));
+    return std::make_tuple(LocalDiffusionType::localize(diffusion_, entity));
+  }
+
+  /**
+   * \brief Takes the local function from context, see internal::local_functions().
+   */
+  template< class T, class A >
+  LocalfunctionTupleType localFunctions(LocalAssembler::EntityContext< T, A >& context) const
+  {
+    return std::make_tuple(LocalDiffusionType::localize(diffusion_, context));
   }
 
   /**
@@ -309,11 +365,13 @@ public:
                const Stuff::LocalfunctionSetInterface
                    < EntityType, DomainFieldType, dimDomain, R, rA, rCA >& ansatzBase) const
   {
-    return order(*std::get< 0 >(localFuncs), testBase, ansatzBase);
+    return LocalDiffusionType::order(std::get< 0 >(localFuncs))
+        + boost::numeric_cast< size_t >(std::max(ssize_t(testBase.order())   - 1, ssize_t(0)))
+        + boost::numeric_cast< size_t >(std::max(ssize_t(ansatzBase.order()) - 1, ssize_t(0)));
   }
 
   /**
-   * \brief extracts the local functions and calls the correct evaluate() method
+   * \brief extracts the value of the local function and calls the correct evaluate_value_() method
    */
   template< class R, size_t rT, size_t rCT, size_t rA, size_t rCA >
   void evaluate(const LocalfunctionTupleType& localFuncs,
@@ -324,7 +382,11 @@ public:
                 const Dune::FieldVector< DomainFieldType, dimDomain >& localPoint,
                 Dune::DynamicMatrix< R >& ret) const
   {
-    evaluate(*std::get< 0 >(localFuncs), testBase, ansatzBase, localPoint, ret);
+    evaluate_value_(LocalDiffusionType::evaluate(std::get< 0 >(localFuncs), localPoint),
+                    testBase,
+                    ansatzBase,
+                    localPoint,
+                    ret);
   }
 
   /// \}
@@ -360,27 +422,7 @@ public:
                 const Dune::FieldVector< DomainFieldType, dimDomain >& localPoint,
                 Dune::DynamicMatrix< R >& ret) const
   {
-    typedef typename Stuff::LocalfunctionSetInterface
-        < EntityType, DomainFieldType, dimDomain, R, r, 1 >::JacobianRangeType JacobianRangeType;
-    // evaluate local function
-    const auto functionValue = localFunction.evaluate(localPoint);
-    // evaluate test gradient
-    const size_t rows = testBase.size();
-    std::vector< JacobianRangeType > testGradients(rows, JacobianRangeType(0));
-    testBase.jacobian(localPoint, testGradients);
-    // evaluate ansatz gradient
-    const size_t cols = ansatzBase.size();
-    std::vector< JacobianRangeType > ansatzGradients(cols, JacobianRangeType(0));
-    ansatzBase.jacobian(localPoint, ansatzGradients);
-    // compute products
-    assert(ret.rows() >= rows);
-    assert(ret.cols() >= cols);
-    for (size_t ii = 0; ii < rows; ++ii) {
-      auto& retRow = ret[ii];
-      for (size_t jj = 0; jj < cols; ++jj) {
-        retRow[jj] = functionValue * (ansatzGradients[jj][0] * testGradients[ii][0]);
-      }
-    }
+    evaluate_value_(localFunction.evaluate(localPoint), testBase, ansatzBase, localPoint, ret);
   } // ... evaluate< ..., 1, ... >(...)
 
   /**
@@ -395,7 +437,7 @@ public:
                 const Dune::FieldVector< DomainFieldType, dimDomain >& localPoint,
                 Dune::DynamicMatrix< R >& ret) const
   {
-    evaluate_matrix_valued_(localFunction, testBase, ansatzBase, localPoint, ret);
+    evaluate_value_(localFunction.evaluate(localPoint), testBase, ansatzBase, localPoint, ret);
   }
 
   /**
@@ -410,24 +452,51 @@ public:
                 const Dune::FieldVector< DomainFieldType, dimDomain >& localPoint,
                 Dune::DynamicMatrix< R >& ret) const
   {
-    evaluate_matrix_valued_(localFunction, testBase, ansatzBase, localPoint, ret);
+    evaluate_value_(localFunction.evaluate(localPoint), testBase, ansatzBase, localPoint, ret);
   }
 
   /// \}
 
 private:
+  template< class R, size_t r >
+  void evaluate_value_(const FieldVector< R, 1 >& functionValue,
+                       const Stuff::LocalfunctionSetInterface
+                           < EntityType, DomainFieldType, dimDomain, R, r, 1 >& testBase,
+                       const Stuff::LocalfunctionSetInterface
+                           < EntityType, DomainFieldType, dimDomain, R, r, 1 >& ansatzBase,
+                       const Dune::FieldVector< DomainFieldType, dimDomain >& localPoint,
+                       Dune::DynamicMatrix< R >& ret) const
+  {
+    typedef typename Stuff::LocalfunctionSetInterface
+        < EntityType, DomainFieldType, dimDomain, R, r, 1 >::JacobianRangeType JacobianRangeType;
+    // evaluate test gradient
+    const size_t rows = testBase.size();
+    std::vector< JacobianRangeType > testGradients(rows, JacobianRangeType(0));
+    testBase.jacobian(localPoint, testGradients);
+    // evaluate ansatz gradient
+    const size_t cols = ansatzBase.size();
+    std::vector< JacobianRangeType > ansatzGradients(cols, JacobianRangeType(0));
+    ansatzBase.jacobian(localPoint, ansatzGradients);
+    // compute products
+    assert(ret.rows() >= rows);
+    assert(ret.cols() >= cols);
+    for (size_t ii = 0; ii < rows; ++ii) {
+      auto& retRow = ret[ii];
+      for (size_t jj = 0; jj < cols; ++jj) {
+        retRow[jj] = functionValue * (ansatzGradients[jj][0] * testGradients[ii][0]);
+      }
+    }
+  } // ... evaluate_value_< ..., 1, ... >(...)
+
   template< class R >
-  void evaluate_matrix_valued_(const Stuff::LocalfunctionInterface
-                                   < EntityType, DomainFieldType, dimDomain, R, dimDomain, dimDomain >& localFunction,
-                               const Stuff::LocalfunctionSetInterface
-                                   < EntityType, DomainFieldType, dimDomain, R, 1, 1 >& testBase,
-                               const Stuff::LocalfunctionSetInterface
-                                   < EntityType, DomainFieldType, dimDomain, R, 1, 1 >& ansatzBase,
-                               const Dune::FieldVector< DomainFieldType, dimDomain >& localPoint,
-                               Dune::DynamicMatrix< R >& ret) const
+  void evaluate_value_(const FieldMatrix< R, dimDomain, dimDomain >& functionValue,
+                       const Stuff::LocalfunctionSetInterface
+                           < EntityType, DomainFieldType, dimDomain, R, 1, 1 >& testBase,
+                       const Stuff::LocalfunctionSetInterface
+                           < EntityType, DomainFieldType, dimDomain, R, 1, 1 >& ansatzBase,
+                       const Dune::FieldVector< DomainFieldType, dimDomain >& localPoint,
+                       Dune::DynamicMatrix< R >& ret) const
   {
-    // evaluate local function
-    const auto functionValue = localFunction.evaluate(localPoint);
     // evaluate test gradient
     const size_t rows = testBase.size();
     const auto testGradients = testBase.jacobian(localPoint);
@@ -445,7 +514,7 @@ private:
         retRow[jj] = product * testGradients[ii][0];
       }
     }
-  } // ... evaluate_matrix_valued_(...)
+  } // ... evaluate_value_< ..., dimDomain, dimDomain >(...)
 
   const DiffusionType& diffusion_;
 }; // class Elliptic< ...., void >
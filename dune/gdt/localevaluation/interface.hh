@@ -17,6 +17,15 @@
 
 namespace Dune {
 namespace GDT {
+namespace LocalAssembler {
+
+
+// forward, see assembler/local/context.hh
+template< class TestSpaceImp, class AnsatzSpaceImp >
+class EntityContext;
+
+
+} // namespace LocalAssembler
 namespace LocalEvaluation {
 
 
@@ -355,6 +364,39 @@ public:
 }; // class Codim1Interface< Traits, 4 >
 
 
+namespace internal {
+
+
+/**
+ * \brief Returns the local functions of evaluation on the entity context is bound to.
+ *
+ *        Evaluations which provide localFunctions(LocalAssembler::EntityContext< ... >&) take their local functions
+ *        from the context (see EntityContext::local_function), so that functions used by several local assemblers of
+ *        one walk are localized only once per entity. All others localize them on context.entity().
+ */
+template< class EvaluationType, class ContextType >
+auto local_functions(const EvaluationType& evaluation, ContextType& context, int)
+    -> decltype(evaluation.localFunctions(context))
+{
+  return evaluation.localFunctions(context);
+}
+
+template< class EvaluationType, class ContextType >
+typename EvaluationType::LocalfunctionTupleType local_functions(const EvaluationType& evaluation,
+                                                                ContextType& context,
+                                                                long)
+{
+  return evaluation.localFunctions(context.entity());
+}
+
+template< class EvaluationType, class ContextType >
+typename EvaluationType::LocalfunctionTupleType local_functions(const EvaluationType& evaluation, ContextType& context)
+{
+  return local_functions(evaluation, context, 0);
+}
+
+
+} // namespace internal
 } // namespace LocalEvaluation
 } // namespace GDT
 } // namespace Dune
@@ -0,0 +1,257 @@
+// This file is part of the dune-gdt project:
+//   http://users.dune-project.org/projects/dune-gdt
+// Copyright holders: Felix Schindler
+// License: BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+
+#ifndef DUNE_GDT_EVALUATION_NONLINEAR_ELLIPTIC_HH
+#define DUNE_GDT_EVALUATION_NONLINEAR_ELLIPTIC_HH
+
+#include <cmath>
+#include <memory>
+#include <tuple>
+
+#include <dune/common/dynmatrix.hh>
+#include <dune/common/dynvector.hh>
+#include <dune/common/fvector.hh>
+
+#include <dune/stuff/functions/interfaces.hh>
+
+#include "interface.hh"
+
+namespace Dune {
+namespace GDT {
+namespace LocalEvaluation {
+
+
+/**
+ * \brief The p-Laplace coefficient a(u, grad u) = (epsilon^2 + |grad u|^2)^((p - 2) / 2), see NonlinearElliptic.
+ *
+ *        A coefficient for NonlinearElliptic has to provide evaluate(u, grad_u) (the value of a), partial_u(u, grad_u)
+ *        (the derivative of a w.r.t. u) and partial_gradient(u, grad_u) (the derivative of a w.r.t. grad u).
+ * \note  For p < 2, epsilon has to be positive.
+ */
+template< class RangeFieldImp, size_t domainDim >
+class PLaplaceCoefficient
+{
+public:
+  typedef RangeFieldImp                            RangeFieldType;
+  static const size_t                              dimDomain = domainDim;
+  typedef FieldVector< RangeFieldType, dimDomain > DomainType;
+
+  PLaplaceCoefficient(const RangeFieldType p, const RangeFieldType epsilon = RangeFieldType(0))
+    : p_(p)
+    , epsilon_squared_(epsilon * epsilon)
+  {}
+
+  RangeFieldType evaluate(const RangeFieldType /*u*/, const DomainType& grad_u) const
+  {
+    return std::pow(epsilon_squared_ + grad_u.two_norm2(), (p_ - 2) / 2);
+  }
+
+  RangeFieldType partial_u(const RangeFieldType /*u*/, const DomainType& /*grad_u*/) const
+  {
+    return RangeFieldType(0);
+  }
+
+  DomainType partial_gradient(const RangeFieldType /*u*/, const DomainType& grad_u) const
+  {
+    DomainType ret = grad_u;
+    ret *= (p_ - 2) * std::pow(epsilon_squared_ + grad_u.two_norm2(), (p_ - 4) / 2);
+    return ret;
+  }
+
+private:
+  const RangeFieldType p_;
+  const RangeFieldType epsilon_squared_;
+}; // class PLaplaceCoefficient
+
+
+// forwards
+template< class CoefficientImp, class DiscreteFunctionImp >
+class NonlinearElliptic;
+
+template< class CoefficientImp, class DiscreteFunctionImp >
+class NonlinearEllipticResidual;
+
+
+namespace internal {
+
+
+template< class CoefficientImp, class DiscreteFunctionImp, class DerivedImp >
+class NonlinearEllipticTraits
+{
+  static_assert(Stuff::is_localizable_function< DiscreteFunctionImp >::value,
+                "DiscreteFunctionImp has to be a localizable function!");
+  static_assert(DiscreteFunctionImp::dimRange == 1 && DiscreteFunctionImp::dimRangeCols == 1,
+                "Only implemented for scalar functions!");
+  static_assert(CoefficientImp::dimDomain == DiscreteFunctionImp::dimDomain, "Dimensions have to agree!");
+public:
+  typedef DerivedImp                                               derived_type;
+  typedef typename DiscreteFunctionImp::EntityType                 EntityType;
+  typedef typename DiscreteFunctionImp::DomainFieldType            DomainFieldType;
+  static const size_t                                              dimDomain = DiscreteFunctionImp::dimDomain;
+  typedef typename DiscreteFunctionImp::LocalfunctionType          LocalfunctionType;
+  typedef std::tuple< std::shared_ptr< LocalfunctionType > >       LocalfunctionTupleType;
+}; // class NonlinearEllipticTraits
+
+
+} // namespace internal
+
+
+/**
+ * \brief Computes the evaluation of the jacobian of the nonlinear elliptic operator -div(a(u, grad u) grad u) at the
+ *        given discrete function u, i.e.
+ *        a grad(phi_j) * grad(phi_i) + (partial_u a phi_j + partial_gradient a * grad(phi_j)) grad(u) * grad(phi_i).
+ * \sa    NonlinearEllipticResidual for the evaluation of the operator itself, PLaplaceCoefficient for the requirements
+ *        on the coefficient.
+ * \note  u is only referenced, its values are thus those of the time of the assembly.
+ */
+template< class CoefficientImp, class DiscreteFunctionImp >
+class NonlinearElliptic
+  : public LocalEvaluation::Codim0Interface< internal::NonlinearEllipticTraits
+        < CoefficientImp, DiscreteFunctionImp, NonlinearElliptic< CoefficientImp, DiscreteFunctionImp > >, 2 >
+{
+public:
+  typedef internal::NonlinearEllipticTraits
+      < CoefficientImp, DiscreteFunctionImp, NonlinearElliptic< CoefficientImp, DiscreteFunctionImp > > Traits;
+  typedef CoefficientImp                          CoefficientType;
+  typedef DiscreteFunctionImp                     DiscreteFunctionType;
+  typedef typename Traits::LocalfunctionTupleType LocalfunctionTupleType;
+  typedef typename Traits::EntityType             EntityType;
+  typedef typename Traits::DomainFieldType        DomainFieldType;
+  static const size_t                             dimDomain = Traits::dimDomain;
+
+  NonlinearElliptic(const CoefficientType& coefficient, const DiscreteFunctionType& discrete_function)
+    : coefficient_(coefficient)
+    , discrete_function_(discrete_function)
+  {}
+
+  LocalfunctionTupleType localFunctions(const EntityType& entity) const
+  {
+    return std::make_tuple(std::shared_ptr< typename Traits::LocalfunctionType >(
+                             discrete_function_.local_function(entity)));
+  }
+
+  /**
+   * \return local_function.order() + testBase.order() + ansatzBase.order(), the coefficient is in general not
+   *         polynomial (use the over_integrate argument of LocalOperator::Codim0Integral, if required).
+   */
+  template< class R, size_t rT, size_t rCT, size_t rA, size_t rCA >
+  size_t order(const LocalfunctionTupleType& local_functions_tuple,
+               const Stuff::LocalfunctionSetInterface
+                   < EntityType, DomainFieldType, dimDomain, R, rT, rCT >& testBase,
+               const Stuff::LocalfunctionSetInterface
+                   < EntityType, DomainFieldType, dimDomain, R, rA, rCA >& ansatzBase) const
+  {
+    return std::get< 0 >(local_functions_tuple)->order() + testBase.order() + ansatzBase.order();
+  }
+
+  template< class R >
+  void evaluate(const LocalfunctionTupleType& local_functions_tuple,
+                const Stuff::LocalfunctionSetInterface
+                    < EntityType, DomainFieldType, dimDomain, R, 1, 1 >& testBase,
+                const Stuff::LocalfunctionSetInterface
+                    < EntityType, DomainFieldType, dimDomain, R, 1, 1 >& ansatzBase,
+                const Dune::FieldVector< DomainFieldType, dimDomain >& localPoint,
+                Dune::DynamicMatrix< R >& ret) const
+  {
+    const auto& local_function = *std::get< 0 >(local_functions_tuple);
+    const R u = local_function.evaluate(localPoint)[0];
+    const auto grad_u = local_function.jacobian(localPoint)[0];
+    const R value = coefficient_.evaluate(u, grad_u);
+    const R partial_u = coefficient_.partial_u(u, grad_u);
+    const auto partial_gradient = coefficient_.partial_gradient(u, grad_u);
+    const auto testGradients = testBase.jacobian(localPoint);
+    const auto ansatzValues = ansatzBase.evaluate(localPoint);
+    const auto ansatzGradients = ansatzBase.jacobian(localPoint);
+    const size_t rows = testBase.size();
+    const size_t cols = ansatzBase.size();
+    assert(ret.rows() >= rows);
+    assert(ret.cols() >= cols);
+    for (size_t ii = 0; ii < rows; ++ii) {
+      auto& retRow = ret[ii];
+      const R grad_u_times_test_gradient = grad_u * testGradients[ii][0];
+      for (size_t jj = 0; jj < cols; ++jj)
+        retRow[jj] = value * (ansatzGradients[jj][0] * testGradients[ii][0])
+                     + (partial_u * ansatzValues[jj][0] + partial_gradient * ansatzGradients[jj][0])
+                       * grad_u_times_test_gradient;
+    }
+  } // ... evaluate(...)
+
+private:
+  const CoefficientType& coefficient_;
+  const DiscreteFunctionType& discrete_function_;
+}; // class NonlinearElliptic
+
+
+/**
+ * \brief Computes the evaluation of the nonlinear elliptic operator -div(a(u, grad u) grad u) at the given discrete
+ *        function u (in weak form), i.e. a grad(u) * grad(phi_i).
+ * \sa    NonlinearElliptic for its jacobian.
+ */
+template< class CoefficientImp, class DiscreteFunctionImp >
+class NonlinearEllipticResidual
+  : public LocalEvaluation::Codim0Interface< internal::NonlinearEllipticTraits
+        < CoefficientImp, DiscreteFunctionImp, NonlinearEllipticResidual< CoefficientImp, DiscreteFunctionImp > >, 1 >
+{
+public:
+  typedef internal::NonlinearEllipticTraits
+      < CoefficientImp, DiscreteFunctionImp, NonlinearEllipticResidual< CoefficientImp, DiscreteFunctionImp > >
+      Traits;
+  typedef CoefficientImp                          CoefficientType;
+  typedef DiscreteFunctionImp                     DiscreteFunctionType;
+  typedef typename Traits::LocalfunctionTupleType LocalfunctionTupleType;
+  typedef typename Traits::EntityType             EntityType;
+  typedef typename Traits::DomainFieldType        DomainFieldType;
+  static const size_t                             dimDomain = Traits::dimDomain;
+
+  NonlinearEllipticResidual(const CoefficientType& coefficient, const DiscreteFunctionType& discrete_function)
+    : coefficient_(coefficient)
+    , discrete_function_(discrete_function)
+  {}
+
+  LocalfunctionTupleType localFunctions(const EntityType& entity) const
+  {
+    return std::make_tuple(std::shared_ptr< typename Traits::LocalfunctionType >(
+                             discrete_function_.local_function(entity)));
+  }
+
+  /**
+   * \return 2 * local_function.order() + testBase.order(), see NonlinearElliptic.
+   */
+  template< class R, size_t r, size_t rC >
+  size_t order(const LocalfunctionTupleType& local_functions_tuple,
+               const Stuff::LocalfunctionSetInterface< EntityType, DomainFieldType, dimDomain, R, r, rC >& testBase)
+  const
+  {
+    return 2 * std::get< 0 >(local_functions_tuple)->order() + testBase.order();
+  }
+
+  template< class R >
+  void evaluate(const LocalfunctionTupleType& local_functions_tuple,
+                const Stuff::LocalfunctionSetInterface< EntityType, DomainFieldType, dimDomain, R, 1, 1 >& testBase,
+                const Dune::FieldVector< DomainFieldType, dimDomain >& localPoint,
+                Dune::DynamicVector< R >& ret) const
+  {
+    const auto& local_function = *std::get< 0 >(local_functions_tuple);
+    const R u = local_function.evaluate(localPoint)[0];
+    const auto grad_u = local_function.jacobian(localPoint)[0];
+    auto flux = grad_u;
+    flux *= coefficient_.evaluate(u, grad_u);
+    const auto testGradients = testBase.jacobian(localPoint);
+    assert(ret.size() >= testBase.size());
+    for (size_t ii = 0; ii < testBase.size(); ++ii)
+      ret[ii] = flux * testGradients[ii][0];
+  } // ... evaluate(...)
+
+private:
+  const CoefficientType& coefficient_;
+  const DiscreteFunctionType& discrete_function_;
+}; // class NonlinearEllipticResidual
+
+
+} // namespace LocalEvaluation
+} // namespace GDT
+} // namespace Dune
+
+#endif // DUNE_GDT_EVALUATION_NONLINEAR_ELLIPTIC_HH
@@ -80,6 +80,15 @@ public:
     return std::make_tuple(inducingFunction_.local_function(entity));
   }
 
+  /**
+   * \brief Takes the local function from context, see internal::local_functions().
+   */
+  template< class T, class A >
+  LocalfunctionTupleType localFunctions(LocalAssembler::EntityContext< T, A >& context) const
+  {
+    return std::make_tuple(context.local_function(inducingFunction_));
+  }
+
   /// \}
   /// \name Required by LocalEvaluation::Codim0Interface< ..., 1 >
   /// \{
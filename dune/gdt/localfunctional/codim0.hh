@@ -94,12 +94,39 @@ public:
              Dune::DynamicVector< R >& ret,
              std::vector< Dune::DynamicVector< R > >& tmpLocalVectors) const
   {
-    // local inducing function
     const auto& entity = testBase.entity();
-    const auto localFunctions = evaluation_.localFunctions(entity);
+    apply_(evaluation_.localFunctions(entity), entity.geometry(), testBase, ret, tmpLocalVectors);
+  }
+
+  /**
+   * \brief Does the same as the variant above, but takes the geometry and the local functions (if supported by the
+   *        evaluation, see LocalEvaluation::internal::local_functions()) from context.
+   * \tparam C A model of LocalAssembler::EntityContext, bound to the entity of testBase
+   */
+  template< class C, class E, class D, size_t d, class R, size_t r, size_t rC >
+  void apply(C& context,
+             const Stuff::LocalfunctionSetInterface< E, D, d, R, r, rC >& testBase,
+             Dune::DynamicVector< R >& ret,
+             std::vector< Dune::DynamicVector< R > >& tmpLocalVectors) const
+  {
+    apply_(LocalEvaluation::internal::local_functions(evaluation_, context),
+           context.geometry(),
+           testBase,
+           ret,
+           tmpLocalVectors);
+  }
+
+private:
+  template< class LocalfunctionTupleType, class GeometryType, class E, class D, size_t d, class R, size_t r, size_t rC >
+  void apply_(const LocalfunctionTupleType& localFunctions,
+              const GeometryType& geometry,
+              const Stuff::LocalfunctionSetInterface< E, D, d, R, r, rC >& testBase,
+              Dune::DynamicVector< R >& ret,
+              std::vector< Dune::DynamicVector< R > >& tmpLocalVectors) const
+  {
     // quadrature
     const auto integrand_order = evaluation_.order(localFunctions, testBase) + over_integrate_;
-    const auto& volumeQuadrature = QuadratureRules< D, d >::rule(entity.type(),
+    const auto& volumeQuadrature = QuadratureRules< D, d >::rule(geometry.type(),
                                                                  boost::numeric_cast< int >(integrand_order));
     // check vector and tmp storage
     ret *= 0.0;
@@ -112,7 +139,7 @@ public:
     for (auto quadPointIt = volumeQuadrature.begin(); quadPointIt != quadPointEndIt; ++quadPointIt) {
       const Dune::FieldVector< D, d > x = quadPointIt->position();
       // integration factors
-      const auto integrationFactor = entity.geometry().integrationElement(x);
+      const auto integrationFactor = geometry.integrationElement(x);
       const auto quadratureWeight = quadPointIt->weight();
       // evaluate the local operation
       evaluation_.evaluate(localFunctions, testBase, x, localVector);
@@ -120,9 +147,8 @@ public:
       for (size_t ii = 0; ii < size; ++ii)
         ret[ii] += localVector[ii] * integrationFactor * quadratureWeight;
     } // loop over all quadrature points
-  } // ... apply(...)
+  } // ... apply_(...)
 
-private:
   const UnaryEvaluationType evaluation_;
   const size_t over_integrate_;
 }; // class Codim0Integral
@@ -91,12 +91,44 @@ public:
              std::vector< Dune::DynamicMatrix< R > >& tmpLocalMatrices) const
   {
     const auto& entity = ansatzBase.entity();
-    const auto localFunctions = evaluation_.localFunctions(entity);
+    apply_(evaluation_.localFunctions(entity), entity.geometry(), testBase, ansatzBase, ret, tmpLocalMatrices);
+  }
+
+  /**
+   * \brief Does the same as the variant above, but takes the geometry and the local functions (if supported by the
+   *        evaluation, see LocalEvaluation::internal::local_functions()) from context.
+   * \tparam C A model of LocalAssembler::EntityContext, bound to the entity of the bases
+   */
+  template< class C, class E, class D, size_t d, class R, size_t rT, size_t rCT, size_t rA, size_t rCA >
+  void apply(C& context,
+             const Stuff::LocalfunctionSetInterface< E, D, d, R, rT, rCT >& testBase,
+             const Stuff::LocalfunctionSetInterface< E, D, d, R, rA, rCA >& ansatzBase,
+             Dune::DynamicMatrix< R >& ret,
+             std::vector< Dune::DynamicMatrix< R > >& tmpLocalMatrices) const
+  {
+    apply_(LocalEvaluation::internal::local_functions(evaluation_, context),
+           context.geometry(),
+           testBase,
+           ansatzBase,
+           ret,
+           tmpLocalMatrices);
+  }
+
+private:
+  template< class LocalfunctionTupleType, class GeometryType,
+            class E, class D, size_t d, class R, size_t rT, size_t rCT, size_t rA, size_t rCA >
+  void apply_(const LocalfunctionTupleType& localFunctions,
+              const GeometryType& geometry,
+              const Stuff::LocalfunctionSetInterface< E, D, d, R, rT, rCT >& testBase,
+              const Stuff::LocalfunctionSetInterface< E, D, d, R, rA, rCA >& ansatzBase,
+              Dune::DynamicMatrix< R >& ret,
+              std::vector< Dune::DynamicMatrix< R > >& tmpLocalMatrices) const
+  {
     // quadrature
     typedef Dune::QuadratureRules< D, d > VolumeQuadratureRules;
     typedef Dune::QuadratureRule< D, d > VolumeQuadratureType;
     const size_t integrand_order = evaluation_.order(localFunctions, ansatzBase, testBase) + over_integrate_;
-    const VolumeQuadratureType& volumeQuadrature = VolumeQuadratureRules::rule(entity.type(),
+    const VolumeQuadratureType& volumeQuadrature = VolumeQuadratureRules::rule(geometry.type(),
                                                                                boost::numeric_cast< int >(integrand_order));
     // check matrix and tmp storage
     const size_t rows = testBase.size();
@@ -111,7 +143,7 @@ public:
     for (auto quadPointIt = volumeQuadrature.begin(); quadPointIt != quadPointEndIt; ++quadPointIt) {
       const Dune::FieldVector< D, d > x = quadPointIt->position();
       // integration factors
-      const double integrationFactor = entity.geometry().integrationElement(x);
+      const double integrationFactor = geometry.integrationElement(x);
       const double quadratureWeight = quadPointIt->weight();
       // evaluate the local operation
       evaluation_.evaluate(localFunctions, ansatzBase, testBase, x, evaluationResult);
@@ -123,9 +155,8 @@ public:
           retRow[jj] += evaluationResultRow[jj] * integrationFactor * quadratureWeight;
       } // compute integral
     } // loop over all quadrature points
-  } // ... apply(...)
+  } // ... apply_(...)
 
-private:
   const BinaryEvaluationType evaluation_;
   const size_t over_integrate_;
 }; // class Codim0Integral
@@ -7,6 +7,9 @@
 #define DUNE_GDT_OPERATORS_DARCY_HH
 
 #include <limits>
+#include <memory>
+#include <mutex>
+#include <vector>
 
 #include <boost/numeric/conversion/cast.hpp>
 
@@ -15,11 +18,15 @@
 #include <dune/stuff/common/exceptions.hh>
 #include <dune/stuff/common/type_utils.hh>
 #include <dune/stuff/functions/interfaces.hh>
+#include <dune/stuff/grid/walker.hh>
 #include <dune/stuff/la/container.hh>
 #include <dune/stuff/la/solver.hh>
 
+#include <dune/gdt/assembler/functors.hh>
 #include <dune/gdt/discretefunction/default.hh>
 #include <dune/gdt/exceptions.hh>
+#include <dune/gdt/solvers/cached.hh>
+#include <dune/gdt/solvers/csr.hh>
 #include <dune/gdt/spaces/cg/interface.hh>
 #include <dune/gdt/spaces/rt/interface.hh>
 
@@ -60,11 +67,33 @@ public:
 }; // class DarcyTraits
 
 
+/**
+ * \brief The (factorized) mass matrix of a CG space, and how to sum the local right hand sides of all entities into
+ *        the global one: the local right hand side of the entity with index ii is stored at
+ *        entity_offsets[ii], ..., entity_offsets[ii + 1] - 1, the contributions to DoF jj are those at
+ *        contributions[DoF_offsets[jj]], ..., contributions[DoF_offsets[jj + 1] - 1].
+ */
+template< class MatrixImp >
+struct DarcyMassMatrix
+{
+  /// to check if this mass matrix belongs to a space (on an unchanged grid)
+  const void* space;
+  size_t num_entities;
+  std::vector< size_t > entity_offsets;
+  std::vector< size_t > DoF_offsets;
+  std::vector< size_t > contributions;
+  std::unique_ptr< const Solvers::CachedLinearSolver< MatrixImp > > solver;
+}; // struct DarcyMassMatrix
+
+
 } // namespace internal
 
 
 /**
   * \note Only works for scalar valued function atm.
+  * \note For CG range spaces, the mass matrix (and its factorization, if the solver caches one) is computed on the
+  *       first application to a space and kept for all further applications to the same space. It is recomputed if
+  *       the space or the number of entities changes.
   **/
 template< class GridViewImp, class FunctionImp >
 class Darcy
@@ -77,7 +106,12 @@ public:
   typedef typename GridViewType::template Codim< 0 >::Entity EntityType;
   typedef typename GridViewType::ctype                       DomainFieldType;
   static const size_t                                        dimDomain = GridViewType::dimension;
+private:
+  typedef typename Stuff::LA::Container< FieldType >::MatrixType MatrixType;
+  typedef typename Stuff::LA::Container< FieldType >::VectorType VectorType;
+  typedef internal::DarcyMassMatrix< MatrixType >                MassMatrixType;
 
+public:
   Darcy(const GridViewType& grd_vw, const FunctionImp& function)
     : grid_view_(grd_vw)
     , function_(function)
@@ -90,34 +124,34 @@ public:
    */
   template< class S, class V, size_t r, size_t rC >
   void apply(const Stuff::LocalizableFunctionInterface< EntityType, DomainFieldType, dimDomain, FieldType, r, rC >& source,
-             DiscreteFunction< S, V >& range) const
+             DiscreteFunction< S, V >& range,
+             const bool use_tbb = false) const
   {
-    redirect_apply(range.space(), source, range);
+    redirect_apply(range.space(), source, range, use_tbb);
   }
 
 private:
   /**
    * \brief Does an L2 projection of '- function * \gradient source' onto range.
+   *
+   *        The local right hand sides are computed in a (threaded) grid walk and summed up in a flat (threaded) loop
+   *        over all DoFs, the mass matrix and its solver are cached.
    */
   template< class T, class S, class V >
   void redirect_apply(const Spaces::CGInterface< T, dimDomain, dimDomain, 1 >& /*space*/,
                       const Stuff::LocalizableFunctionInterface< EntityType, DomainFieldType, dimDomain, FieldType, 1, 1 >& source,
-                      DiscreteFunction< S, V >& range) const
+                      DiscreteFunction< S, V >& range,
+                      const bool use_tbb) const
   {
-    typedef typename Stuff::LA::Container< FieldType >::MatrixType MatrixType;
-    typedef typename Stuff::LA::Container< FieldType >::VectorType VectorType;
-    MatrixType lhs(range.space().mapper().size(),
-                   range.space().mapper().size(),
-                   range.space().compute_volume_pattern());
-    VectorType rhs(range.space().mapper().size());
-
-    // walk the grid
-    const auto entity_it_end = grid_view_.template end< 0 >();
-    for (auto entity_it = grid_view_.template begin< 0 >(); entity_it != entity_it_end; ++entity_it) {
-      const auto& entity = *entity_it;
+    const auto& space = range.space();
+    const auto mass_matrix = get_mass_matrix(space);
+    // each entity writes to its own local right hand side only
+    std::vector< FieldType > local_rhs(mass_matrix->entity_offsets.back(), FieldType(0));
+    const auto compute_local_rhs = [&](const EntityType& entity) {
+      const size_t offset = mass_matrix->entity_offsets[grid_view_.indexSet().index(entity)];
       const auto local_function = function_.local_function(entity);
       const auto local_source = source.local_function(entity);
-      const auto basis = range.space().base_function_set(entity);
+      const auto basis = space.base_function_set(entity);
       // do a volume quadrature
       const size_t integrand_order = std::max(local_function->order() + ssize_t(local_source->order()) - 1,
                                               basis.order())
@@ -132,24 +166,29 @@ private:
         const auto function_value = local_function->evaluate(xx);
         const auto source_gradient = local_source->jacobian(xx);
         const auto basis_value = basis.evaluate(xx);
-        for (size_t ii = 0; ii < basis.size(); ++ii) {
-          const size_t global_ii = range.space().mapper().mapToGlobal(entity, ii);
-          rhs.add_to_entry(global_ii,
-                           integration_element * quadrature_weight
-                           * -1.0 * function_value * (source_gradient[0] * basis_value[ii]));
-          for (size_t jj = 0; jj < basis.size(); ++jj) {
-            const size_t global_jj = range.space().mapper().mapToGlobal(entity, jj);
-            lhs.add_to_entry(global_ii,
-                             global_jj,
-                             integration_element * quadrature_weight * (basis_value[ii] * basis_value[jj]));
-          }
-        }
+        for (size_t ii = 0; ii < basis.size(); ++ii)
+          local_rhs[offset + ii] += integration_element * quadrature_weight
+                                    * -1.0 * function_value * (source_gradient[0] * basis_value[ii]);
       } // do a volume quadrature
-    } // walk the grid
-
+    }; // ... compute_local_rhs(...)
+    GDT::internal::Codim0LambdaFunctor< GridViewType > functor(compute_local_rhs);
+    Stuff::Grid::Walker< GridViewType > walker(grid_view_);
+    walker.add(functor);
+    walker.walk(use_tbb);
+    // sum up the local right hand sides, each thread writes to its own DoFs only
+    const size_t num_DoFs = mass_matrix->DoF_offsets.size() - 1;
+    VectorType rhs(num_DoFs);
+    Solvers::internal::for_each_range(num_DoFs, use_tbb, [&](const size_t first, const size_t last) {
+      for (size_t ii = first; ii < last; ++ii) {
+        FieldType sum(0);
+        for (size_t kk = mass_matrix->DoF_offsets[ii]; kk < mass_matrix->DoF_offsets[ii + 1]; ++kk)
+          sum += local_rhs[mass_matrix->contributions[kk]];
+        rhs.set_entry(ii, sum);
+      }
+    });
     // solve
     try {
-      Stuff::LA::Solver< MatrixType >(lhs).apply(rhs, range.vector());
+      mass_matrix->solver->apply(rhs, range.vector());
     } catch (Stuff::Exceptions::linear_solver_failed& ee) {
       DUNE_THROW(Exceptions::darcy_operator_error,
                  "Application of the Darcy operator failed because a matrix could not be inverted!\n\n"
@@ -157,10 +196,82 @@ private:
     }
   } // ... redirect_apply(...)
 
+  template< class SpaceType >
+  std::shared_ptr< const MassMatrixType > get_mass_matrix(const SpaceType& space) const
+  {
+    std::lock_guard< std::mutex > lock(mass_matrix_mutex_);
+    if (!mass_matrix_
+        || mass_matrix_->space != static_cast< const void* >(&space)
+        || mass_matrix_->num_entities != grid_view_.indexSet().size(0)
+        || mass_matrix_->DoF_offsets.size() != space.mapper().size() + 1)
+      mass_matrix_ = compute_mass_matrix(space);
+    return mass_matrix_;
+  } // ... get_mass_matrix(...)
+
+  /**
+   * The mass matrix and the global DoFs of each entity are computed in one grid walk, the contributions to each DoF
+   * are then sorted into the compressed row storage.
+   */
+  template< class SpaceType >
+  std::shared_ptr< const MassMatrixType > compute_mass_matrix(const SpaceType& space) const
+  {
+    const size_t num_DoFs = space.mapper().size();
+    const size_t num_entities = grid_view_.indexSet().size(0);
+    MatrixType lhs(num_DoFs, num_DoFs, space.compute_volume_pattern());
+    std::vector< std::vector< size_t > > global_indices_of_entities(num_entities);
+    // walk the grid
+    const auto entity_it_end = grid_view_.template end< 0 >();
+    for (auto entity_it = grid_view_.template begin< 0 >(); entity_it != entity_it_end; ++entity_it) {
+      const auto& entity = *entity_it;
+      const auto basis = space.base_function_set(entity);
+      const auto global_indices = space.mapper().globalIndices(entity);
+      auto& global_indices_of_entity = global_indices_of_entities[grid_view_.indexSet().index(entity)];
+      for (size_t ii = 0; ii < basis.size(); ++ii)
+        global_indices_of_entity.push_back(global_indices[ii]);
+      // do a volume quadrature
+      const int integrand_order = boost::numeric_cast< int >(2 * basis.order());
+      const auto& quadrature = QuadratureRules< DomainFieldType, dimDomain >::rule(entity.type(), integrand_order);
+      const auto quadrature_it_end = quadrature.end();
+      for (auto quadrature_it = quadrature.begin(); quadrature_it != quadrature_it_end; ++quadrature_it) {
+        const auto xx = quadrature_it->position();
+        const auto quadrature_weight = quadrature_it->weight();
+        const auto integration_element = entity.geometry().integrationElement(xx);
+        const auto basis_value = basis.evaluate(xx);
+        for (size_t ii = 0; ii < basis.size(); ++ii)
+          for (size_t jj = 0; jj < basis.size(); ++jj)
+            lhs.add_to_entry(global_indices[ii],
+                             global_indices[jj],
+                             integration_element * quadrature_weight * (basis_value[ii] * basis_value[jj]));
+      } // do a volume quadrature
+    } // walk the grid
+    // sort the local contributions by their DoF
+    auto mass_matrix = std::make_shared< MassMatrixType >();
+    mass_matrix->space = &space;
+    mass_matrix->num_entities = num_entities;
+    mass_matrix->entity_offsets.assign(num_entities + 1, 0);
+    for (size_t ee = 0; ee < num_entities; ++ee)
+      mass_matrix->entity_offsets[ee + 1] = mass_matrix->entity_offsets[ee] + global_indices_of_entities[ee].size();
+    mass_matrix->DoF_offsets.assign(num_DoFs + 1, 0);
+    for (const auto& global_indices_of_entity : global_indices_of_entities)
+      for (const auto& global_index : global_indices_of_entity)
+        ++mass_matrix->DoF_offsets[global_index + 1];
+    for (size_t ii = 0; ii < num_DoFs; ++ii)
+      mass_matrix->DoF_offsets[ii + 1] += mass_matrix->DoF_offsets[ii];
+    mass_matrix->contributions.resize(mass_matrix->entity_offsets.back());
+    std::vector< size_t > next(mass_matrix->DoF_offsets.begin(), mass_matrix->DoF_offsets.end() - 1);
+    for (size_t ee = 0; ee < num_entities; ++ee)
+      for (size_t ii = 0; ii < global_indices_of_entities[ee].size(); ++ii)
+        mass_matrix->contributions[next[global_indices_of_entities[ee][ii]]++] = mass_matrix->entity_offsets[ee] + ii;
+    mass_matrix->solver = std::unique_ptr< const Solvers::CachedLinearSolver< MatrixType > >(
+        new Solvers::CachedLinearSolver< MatrixType >(lhs));
+    return mass_matrix;
+  } // ... compute_mass_matrix(...)
+
   template< class T, class S, class V >
   void redirect_apply(const Spaces::RTInterface< T, dimDomain, dimDomain, 1 >& /*space*/,
                       const Stuff::LocalizableFunctionInterface< EntityType, DomainFieldType, dimDomain, FieldType, 1 >& source,
-                      DiscreteFunction< S, V >& range) const
+                      DiscreteFunction< S, V >& range,
+                      const bool use_tbb) const
   {
     static_assert(Spaces::RTInterface< T, dimDomain, 1 >::polOrder == 0, "Untested!");
     const auto& rtn0_space = range.space();
@@ -168,10 +279,7 @@ private:
     const auto infinity = std::numeric_limits< FieldType >::infinity();
     for (size_t ii = 0; ii < range_vector.size(); ++ii)
       range_vector[ii] = infinity;
-    // walk the grid
-    const auto entity_it_end = grid_view_.template end< 0 >();
-    for (auto entity_it = grid_view_.template begin< 0 >(); entity_it != entity_it_end; ++entity_it) {
-      const auto& entity = *entity_it;
+    const auto compute_local_DoFs = [&](const EntityType& entity) {
       const auto local_DoF_indices = rtn0_space.local_DoF_indices(entity);
       const auto global_DoF_indices = rtn0_space.mapper().globalIndices(entity);
       assert(global_DoF_indices.size() == local_DoF_indices.size());
@@ -260,11 +368,18 @@ private:
         } else
           DUNE_THROW(Stuff::Exceptions::internal_error, "Unknown intersection type!");
       } // walk the intersections
-    } // walk the grid
+    }; // ... compute_local_DoFs(...)
+    // each face (and thus each DoF) is handled by one of its entities only
+    GDT::internal::Codim0LambdaFunctor< GridViewType > functor(compute_local_DoFs);
+    Stuff::Grid::Walker< GridViewType > walker(grid_view_);
+    walker.add(functor);
+    walker.walk(use_tbb);
   } // ... redirect_apply(...)
 
   const GridViewType& grid_view_;
   const FunctionImp& function_;
+  mutable std::mutex mass_matrix_mutex_;
+  mutable std::shared_ptr< const MassMatrixType > mass_matrix_;
 }; // class Darcy
 
 
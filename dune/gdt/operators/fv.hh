@@ -0,0 +1,455 @@
+// This file is part of the dune-gdt project:
+//   http://users.dune-project.org/projects/dune-gdt
+// Copyright holders: Felix Schindler
+// License: BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+
+#ifndef DUNE_GDT_OPERATORS_FV_HH
+#define DUNE_GDT_OPERATORS_FV_HH
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include <dune/common/fvector.hh>
+
+#include <dune/stuff/common/exceptions.hh>
+#include <dune/stuff/la/container/interfaces.hh>
+
+#include <dune/gdt/assembler/face-table.hh>
+#include <dune/gdt/solvers/csr.hh>
+#include <dune/gdt/spaces/fv/interface.hh>
+#include <dune/gdt/spaces/parallel.hh>
+
+namespace Dune {
+namespace GDT {
+namespace NumericalFluxes {
+
+
+/**
+ * \brief The local Lax-Friedrichs (Rusanov) flux 1/2 (f(u_i) + f(u_o)) n - 1/2 lambda (u_o - u_i), for scalar
+ *        conservation laws and systems.
+ *
+ *        physical_flux(u, n) has to return f(u) n, wave_speed(u, n) an upper bound of the absolute values of the
+ *        eigenvalues of the jacobian of f(u) n, lambda is the maximum of the wave speeds of both states.
+ */
+template< class RangeFieldImp, size_t rangeDim, size_t domainDim, class PhysicalFluxImp, class WaveSpeedImp >
+class LaxFriedrichs
+{
+public:
+  typedef RangeFieldImp                              RangeFieldType;
+  static const size_t                                dimRange = rangeDim;
+  static const size_t                                dimDomain = domainDim;
+  typedef FieldVector< RangeFieldType, dimRange >    RangeType;
+  typedef FieldVector< RangeFieldType, dimDomain >   DomainType;
+
+  LaxFriedrichs(PhysicalFluxImp physical_flux, WaveSpeedImp wave_speed)
+    : physical_flux_(physical_flux)
+    , wave_speed_(wave_speed)
+  {}
+
+  RangeFieldType max_wave_speed(const RangeType& u_inside, const RangeType& u_outside, const DomainType& normal) const
+  {
+    return std::max(wave_speed_(u_inside, normal), wave_speed_(u_outside, normal));
+  }
+
+  void evaluate(const RangeType& u_inside,
+                const RangeType& u_outside,
+                const DomainType& normal,
+                RangeType& ret) const
+  {
+    const RangeFieldType lambda = max_wave_speed(u_inside, u_outside, normal);
+    const RangeType flux_inside = physical_flux_(u_inside, normal);
+    const RangeType flux_outside = physical_flux_(u_outside, normal);
+    for (size_t ii = 0; ii < dimRange; ++ii)
+      ret[ii] = 0.5 * (flux_inside[ii] + flux_outside[ii]) - 0.5 * lambda * (u_outside[ii] - u_inside[ii]);
+  }
+
+private:
+  const PhysicalFluxImp physical_flux_;
+  const WaveSpeedImp wave_speed_;
+}; // class LaxFriedrichs
+
+
+template< class RangeFieldType, size_t dimRange, size_t dimDomain, class PhysicalFluxType, class WaveSpeedType >
+LaxFriedrichs< RangeFieldType, dimRange, dimDomain, PhysicalFluxType, WaveSpeedType >
+make_lax_friedrichs(PhysicalFluxType physical_flux, WaveSpeedType wave_speed)
+{
+  return LaxFriedrichs< RangeFieldType, dimRange, dimDomain, PhysicalFluxType, WaveSpeedType >(physical_flux,
+                                                                                                wave_speed);
+}
+
+
+/**
+ * \brief The upwind flux (v n) u_i if v n >= 0 and (v n) u_o otherwise, for linear advection of each component with
+ *        the constant velocity v.
+ */
+template< class RangeFieldImp, size_t rangeDim, size_t domainDim >
+class Upwind
+{
+public:
+  typedef RangeFieldImp                              RangeFieldType;
+  static const size_t                                dimRange = rangeDim;
+  static const size_t                                dimDomain = domainDim;
+  typedef FieldVector< RangeFieldType, dimRange >    RangeType;
+  typedef FieldVector< RangeFieldType, dimDomain >   DomainType;
+
+  explicit Upwind(const DomainType& velocity)
+    : velocity_(velocity)
+  {}
+
+  RangeFieldType max_wave_speed(const RangeType& /*u_inside*/,
+                                const RangeType& /*u_outside*/,
+                                const DomainType& normal) const
+  {
+    return std::abs(velocity_ * normal);
+  }
+
+  void evaluate(const RangeType& u_inside,
+                const RangeType& u_outside,
+                const DomainType& normal,
+                RangeType& ret) const
+  {
+    const RangeFieldType normal_velocity = velocity_ * normal;
+    ret = (normal_velocity >= 0) ? u_inside : u_outside;
+    ret *= normal_velocity;
+  }
+
+private:
+  const DomainType velocity_;
+}; // class Upwind
+
+
+} // namespace NumericalFluxes
+namespace Operators {
+
+
+/**
+ * \brief The explicit finite volume operator L(u)_K = - 1/|K| sum_e |e| F(u_K, u_{K_e}, n_e) for a Spaces::FV::Default,
+ *        where the sum runs over all faces e of the entity K and F is a numerical flux (see NumericalFluxes).
+ *
+ *        The kernel works on the FaceTable of the grid view of the space and on cell data in structure of arrays
+ *        layout (see CellDataType), in two passes, which are both parallel if TBB is available and requested:
+ *        - the numerical flux is evaluated once per face (and not once per intersection), the fluxes are stored,
+ *        - each entity sums up the stored fluxes of its faces (so no two threads write to the same entity).
+ *        The outside values at boundary faces are given by boundary_values(u_inside, x, n) (the default
+ *        boundary_values extrapolate the inside values, i.e. the boundary is an outflow boundary).
+ *
+ *        The throughput of apply() (the number of faces processed per second) is recorded, see faces_per_second().
+ *
+ *        In a distributed run, apply() computes the entities first, which other processes hold a copy of, starts the
+ *        (non-blocking) exchange of their values, computes all other entities and finishes with the exchange, which
+ *        updates all copies. source is thus expected to be consistent and range will be consistent.
+ * \note  apply() uses internal storage for the face fluxes and must thus not be called concurrently.
+ */
+template< class SpaceImp, class NumericalFluxImp >
+class FiniteVolume
+{
+  static_assert(is_fv_space< SpaceImp >::value, "SpaceImp has to be derived from FVInterface!");
+  static_assert(NumericalFluxImp::dimRange == SpaceImp::dimRange, "Dimensions do not match!");
+  static_assert(NumericalFluxImp::dimDomain == SpaceImp::GridViewType::dimensionworld, "Dimensions do not match!");
+public:
+  typedef SpaceImp                                    SpaceType;
+  typedef NumericalFluxImp                            NumericalFluxType;
+  typedef typename SpaceType::GridViewType            GridViewType;
+  typedef typename SpaceType::RangeFieldType          RangeFieldType;
+  static const size_t                                 dimRange = SpaceType::dimRange;
+  typedef FaceTable< GridViewType >                   FaceTableType;
+  typedef typename FaceTableType::WorldType           WorldType;
+  typedef typename NumericalFluxType::RangeType       RangeType;
+  typedef typename NumericalFluxType::DomainType      DomainType;
+  /// the value of component c on the entity with index e is stored at c * num_entities + e
+  typedef std::vector< RangeFieldType >               CellDataType;
+  typedef std::function< RangeType(const RangeType& /*u_inside*/, const WorldType& /*x*/, const WorldType& /*n*/) >
+      BoundaryValuesType;
+
+  FiniteVolume(const SpaceType& spc,
+               const NumericalFluxType& numerical_flux,
+               const bool use_tbb = false,
+               const BoundaryValuesType boundary_values = extrapolation())
+    : space_(spc)
+    , numerical_flux_(numerical_flux)
+    , use_tbb_(use_tbb)
+    , boundary_values_(boundary_values)
+    , face_table_(space_.grid_view(), -1, use_tbb)
+    , inverse_volumes_(face_table_.num_entities())
+    , face_fluxes_(dimRange * face_table_.num_faces(), RangeFieldType(0))
+    , halo_exchange_(create_halo_exchange(space_))
+    , num_processed_faces_(0)
+    , seconds_(0)
+  {
+    for (size_t ee = 0; ee < inverse_volumes_.size(); ++ee)
+      inverse_volumes_[ee] = RangeFieldType(1) / face_table_.entity_volumes()[ee];
+    if (!halo_exchange_.empty())
+      split_entities_and_faces();
+  } // FiniteVolume(...)
+
+  /**
+   * \brief Boundary values which coincide with the inside values.
+   */
+  static BoundaryValuesType extrapolation()
+  {
+    return [](const RangeType& u_inside, const WorldType& /*x*/, const WorldType& /*n*/) { return u_inside; };
+  }
+
+  const SpaceType& space() const
+  {
+    return space_;
+  }
+
+  const FaceTableType& face_table() const
+  {
+    return face_table_;
+  }
+
+  size_t num_faces() const
+  {
+    return face_table_.num_faces();
+  }
+
+  CellDataType create_cell_data() const
+  {
+    return CellDataType(dimRange * face_table_.num_entities(), RangeFieldType(0));
+  }
+
+  template< class V >
+  CellDataType to_cell_data(const Stuff::LA::VectorInterface< V, RangeFieldType >& vector) const
+  {
+    const size_t num_entities = face_table_.num_entities();
+    if (vector.size() != dimRange * num_entities)
+      DUNE_THROW(Stuff::Exceptions::shapes_do_not_match,
+                 "The size of vector (" << vector.size() << ") does not match the size of the space ("
+                 << dimRange * num_entities << ")!");
+    // the mapper of the space stores the components of each entity consecutively
+    CellDataType ret = create_cell_data();
+    for (size_t ee = 0; ee < num_entities; ++ee)
+      for (size_t cc = 0; cc < dimRange; ++cc)
+        ret[cc * num_entities + ee] = vector.get_entry(dimRange * ee + cc);
+    return ret;
+  } // ... to_cell_data(...)
+
+  template< class V >
+  void from_cell_data(const CellDataType& cell_data, Stuff::LA::VectorInterface< V, RangeFieldType >& vector) const
+  {
+    const size_t num_entities = face_table_.num_entities();
+    check_size(cell_data, "cell_data");
+    if (vector.size() != dimRange * num_entities)
+      DUNE_THROW(Stuff::Exceptions::shapes_do_not_match,
+                 "The size of vector (" << vector.size() << ") does not match the size of the space ("
+                 << dimRange * num_entities << ")!");
+    for (size_t ee = 0; ee < num_entities; ++ee)
+      for (size_t cc = 0; cc < dimRange; ++cc)
+        vector.set_entry(dimRange * ee + cc, cell_data[cc * num_entities + ee]);
+  } // ... from_cell_data(...)
+
+  void apply(const CellDataType& source, CellDataType& range) const
+  {
+    check_size(source, "source");
+    check_size(range, "range");
+    const auto start = std::chrono::steady_clock::now();
+    const size_t num_entities = face_table_.num_entities();
+    const size_t num_faces = face_table_.num_faces();
+    if (halo_exchange_.empty()) {
+      const auto identity = [](const size_t ii) { return ii; };
+      compute_face_fluxes(source, num_faces, identity);
+      gather_face_fluxes(range, num_entities, identity);
+    } else {
+      compute_face_fluxes(source, border_faces_.size(), [&](const size_t ii) { return border_faces_[ii]; });
+      gather_face_fluxes(range, border_entities_.size(), [&](const size_t ii) { return border_entities_[ii]; });
+      // the DoF dimRange * e + c of the space corresponds to the entry c * num_entities + e of range
+      halo_exchange_.begin([&](const size_t dof) {
+        return range[(dof % dimRange) * num_entities + dof / dimRange];
+      });
+      compute_face_fluxes(source, inner_faces_.size(), [&](const size_t ii) { return inner_faces_[ii]; });
+      gather_face_fluxes(range, inner_entities_.size(), [&](const size_t ii) { return inner_entities_[ii]; });
+      halo_exchange_.finish([&](const size_t dof, const RangeFieldType& value) {
+        range[(dof % dimRange) * num_entities + dof / dimRange] = value;
+      });
+    }
+    seconds_ += std::chrono::duration< double >(std::chrono::steady_clock::now() - start).count();
+    num_processed_faces_ += num_faces;
+  } // ... apply(...)
+
+  template< class S, class R >
+  void apply(const Stuff::LA::VectorInterface< S, RangeFieldType >& source,
+             Stuff::LA::VectorInterface< R, RangeFieldType >& range) const
+  {
+    auto range_data = create_cell_data();
+    apply(to_cell_data(source), range_data);
+    from_cell_data(range_data, range);
+  }
+
+  /**
+   * \brief The largest stable time step for explicit time stepping, cfl times the minimum over all entities of
+   *        |K| / sum_e |e| lambda_e, where lambda_e is the maximal wave speed of the numerical flux at e.
+   */
+  RangeFieldType max_time_step(const CellDataType& source, const RangeFieldType cfl = 0.5) const
+  {
+    check_size(source, "source");
+    const size_t num_entities = face_table_.num_entities();
+    std::vector< RangeFieldType > speeds(num_entities, RangeFieldType(0));
+    RangeType u_inside, u_outside;
+    for (size_t face = 0; face < face_table_.num_faces(); ++face) {
+      const size_t inside = face_table_.insides()[face];
+      for (size_t cc = 0; cc < dimRange; ++cc)
+        u_inside[cc] = source[cc * num_entities + inside];
+      const WorldType world_normal = face_table_.unit_outer_normal(face);
+      if (face_table_.boundary(face))
+        u_outside = boundary_values_(u_inside, face_table_.center(face), world_normal);
+      else
+        for (size_t cc = 0; cc < dimRange; ++cc)
+          u_outside[cc] = source[cc * num_entities + face_table_.outsides()[face]];
+      DomainType normal;
+      for (size_t dd = 0; dd < normal.size(); ++dd)
+        normal[dd] = world_normal[dd];
+      const RangeFieldType speed = face_table_.volumes()[face]
+                                   * numerical_flux_.max_wave_speed(u_inside, u_outside, normal);
+      speeds[inside] += speed;
+      if (!face_table_.boundary(face))
+        speeds[face_table_.outsides()[face]] += speed;
+    }
+    RangeFieldType ret = std::numeric_limits< RangeFieldType >::max();
+    for (size_t ee = 0; ee < num_entities; ++ee)
+      if (speeds[ee] > 0)
+        ret = std::min(ret, face_table_.entity_volumes()[ee] / speeds[ee]);
+    return cfl * ret;
+  } // ... max_time_step(...)
+
+  /**
+   * \brief The average number of faces processed per second by all calls of apply() so far.
+   */
+  double faces_per_second() const
+  {
+    return seconds_ > 0 ? num_processed_faces_ / seconds_ : 0.0;
+  }
+
+private:
+  static Spaces::HaloExchange< RangeFieldType > create_halo_exchange(const SpaceType& spc)
+  {
+    if (spc.grid_view().comm().size() == 1)
+      return Spaces::HaloExchange< RangeFieldType >();
+    return Spaces::HaloExchange< RangeFieldType >(Spaces::ParallelDofs< SpaceType >(spc));
+  }
+
+  /**
+   * The border entities are those with sent DoFs, the border faces are all faces of border entities.
+   */
+  void split_entities_and_faces()
+  {
+    const size_t num_entities = face_table_.num_entities();
+    std::vector< bool > border_entity(num_entities, false);
+    for (const auto& dof : halo_exchange_.sent_dofs())
+      border_entity[dof / dimRange] = true;
+    std::vector< bool > border_face(face_table_.num_faces(), false);
+    for (size_t ee = 0; ee < num_entities; ++ee) {
+      if (border_entity[ee]) {
+        border_entities_.push_back(ee);
+        for (size_t ii = 0; ii < face_table_.num_faces(ee); ++ii)
+          border_face[face_table_.face(ee, ii)] = true;
+      } else
+        inner_entities_.push_back(ee);
+    }
+    for (size_t face = 0; face < border_face.size(); ++face)
+      (border_face[face] ? border_faces_ : inner_faces_).push_back(face);
+  } // ... split_entities_and_faces(...)
+
+  /// the fluxes (times the face volume) from inside to outside, once per face
+  template< class FaceIndexType >
+  void compute_face_fluxes(const CellDataType& source, const size_t count, const FaceIndexType& face_index) const
+  {
+    const size_t num_entities = face_table_.num_entities();
+    const size_t num_faces = face_table_.num_faces();
+    const auto& insides = face_table_.insides();
+    const auto& outsides = face_table_.outsides();
+    const auto& volumes = face_table_.volumes();
+    Solvers::internal::for_each_range(count, use_tbb_, [&](const size_t first, const size_t last) {
+      RangeType u_inside, u_outside, flux;
+      for (size_t ii = first; ii < last; ++ii) {
+        const size_t face = face_index(ii);
+        const size_t inside = insides[face];
+        for (size_t cc = 0; cc < dimRange; ++cc)
+          u_inside[cc] = source[cc * num_entities + inside];
+        const WorldType world_normal = face_table_.unit_outer_normal(face);
+        if (face_table_.boundary(face))
+          u_outside = boundary_values_(u_inside, face_table_.center(face), world_normal);
+        else {
+          const size_t outside = outsides[face];
+          for (size_t cc = 0; cc < dimRange; ++cc)
+            u_outside[cc] = source[cc * num_entities + outside];
+        }
+        DomainType normal;
+        for (size_t dd = 0; dd < normal.size(); ++dd)
+          normal[dd] = world_normal[dd];
+        numerical_flux_.evaluate(u_inside, u_outside, normal, flux);
+        for (size_t cc = 0; cc < dimRange; ++cc)
+          face_fluxes_[cc * num_faces + face] = volumes[face] * flux[cc];
+      }
+    });
+  } // ... compute_face_fluxes(...)
+
+  /// each entity gathers the fluxes of its faces (so no two threads write to the same entity)
+  template< class EntityIndexType >
+  void gather_face_fluxes(CellDataType& range, const size_t count, const EntityIndexType& entity_index) const
+  {
+    const size_t num_entities = face_table_.num_entities();
+    const size_t num_faces = face_table_.num_faces();
+    const auto& insides = face_table_.insides();
+    Solvers::internal::for_each_range(count, use_tbb_, [&](const size_t first, const size_t last) {
+      for (size_t ii = first; ii < last; ++ii) {
+        const size_t ee = entity_index(ii);
+        const size_t num_entity_faces = face_table_.num_faces(ee);
+        for (size_t cc = 0; cc < dimRange; ++cc) {
+          const RangeFieldType* fluxes = face_fluxes_.data() + cc * num_faces;
+          RangeFieldType sum(0);
+          for (size_t jj = 0; jj < num_entity_faces; ++jj) {
+            const size_t face = face_table_.face(ee, jj);
+            sum += (insides[face] == ee) ? fluxes[face] : -fluxes[face];
+          }
+          range[cc * num_entities + ee] = -inverse_volumes_[ee] * sum;
+        }
+      }
+    });
+  } // ... gather_face_fluxes(...)
+
+  void check_size(const CellDataType& cell_data, const std::string name) const
+  {
+    if (cell_data.size() != dimRange * face_table_.num_entities())
+      DUNE_THROW(Stuff::Exceptions::shapes_do_not_match,
+                 "The size of " << name << " (" << cell_data.size() << ") does not match the size of the space ("
+                 << dimRange * face_table_.num_entities() << ")!");
+  }
+
+  const SpaceType space_;
+  const NumericalFluxType numerical_flux_;
+  const bool use_tbb_;
+  const BoundaryValuesType boundary_values_;
+  const FaceTableType face_table_;
+  std::vector< RangeFieldType > inverse_volumes_;
+  mutable std::vector< RangeFieldType > face_fluxes_;
+  mutable Spaces::HaloExchange< RangeFieldType > halo_exchange_;
+  std::vector< size_t > border_entities_;
+  std::vector< size_t > inner_entities_;
+  std::vector< size_t > border_faces_;
+  std::vector< size_t > inner_faces_;
+  mutable size_t num_processed_faces_;
+  mutable double seconds_;
+}; // class FiniteVolume
+
+
+template< class SpaceType, class NumericalFluxType >
+FiniteVolume< SpaceType, NumericalFluxType > make_finite_volume(const SpaceType& space,
+                                                                const NumericalFluxType& numerical_flux,
+                                                                const bool use_tbb = false)
+{
+  return FiniteVolume< SpaceType, NumericalFluxType >(space, numerical_flux, use_tbb);
+}
+
+
+} // namespace Operators
+} // namespace GDT
+} // namespace Dune
+
+#endif // DUNE_GDT_OPERATORS_FV_HH
@@ -0,0 +1,180 @@
+// This file is part of the dune-gdt project:
+//   http://users.dune-project.org/projects/dune-gdt
+// Copyright holders: Felix Schindler
+// License: BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+
+#ifndef DUNE_GDT_OPERATORS_NONLINEAR_ELLIPTIC_HH
+#define DUNE_GDT_OPERATORS_NONLINEAR_ELLIPTIC_HH
+
+#include <dune/stuff/common/exceptions.hh>
+#include <dune/stuff/functions/interfaces.hh>
+#include <dune/stuff/grid/boundaryinfo.hh>
+#include <dune/stuff/la/container/interfaces.hh>
+
+#include <dune/gdt/assembler/local/codim0.hh>
+#include <dune/gdt/assembler/system.hh>
+#include <dune/gdt/discretefunction/default.hh>
+#include <dune/gdt/localevaluation/nonlinear-elliptic.hh>
+#include <dune/gdt/localevaluation/product.hh>
+#include <dune/gdt/localfunctional/codim0.hh>
+#include <dune/gdt/localoperator/codim0.hh>
+#include <dune/gdt/spaces/constraints.hh>
+#include <dune/gdt/spaces/interface.hh>
+
+namespace Dune {
+namespace GDT {
+namespace Operators {
+
+
+/**
+ * \brief The residual R(u) and its jacobian DR(u) of the nonlinear elliptic problem -div(a(u, grad u) grad u) = f,
+ *        with homogeneous Dirichlet values on the Dirichlet boundary and natural boundary conditions elsewhere (see
+ *        LocalEvaluation::PLaplaceCoefficient for the requirements on the coefficient a).
+ *
+ *        assemble() computes the residual and (if requested) the jacobian in one walk of a SystemAssembler, the part
+ *        of the residual belonging to f is assembled once in the constructor. This is the assembler required by
+ *        Solvers::Newton:
+\code
+NonlinearElliptic< ... > nonlinear_elliptic(coefficient, force, boundary_info, space);
+Solvers::Newton< MatrixType, VectorType > newton(
+      [&](const VectorType& iterate, VectorType& residual, MatrixType* jacobian) {
+        nonlinear_elliptic.assemble(iterate, residual, jacobian);
+      },
+      nonlinear_elliptic.create_jacobian());
+\endcode
+ * \note  The rows of the Dirichlet DoFs are unit rows in the jacobian and vanish in the residual, the iterates thus
+ *        have to vanish in the Dirichlet DoFs.
+ * \note  The local evaluations reference a discrete function wrapping a member of this class, which can thus neither
+ *        be copied nor moved.
+ */
+template< class CoefficientImp, class ForceImp, class SpaceImp, class MatrixImp, class VectorImp >
+class NonlinearElliptic
+{
+  static_assert(Stuff::is_localizable_function< ForceImp >::value, "ForceImp has to be a localizable function!");
+  static_assert(is_space< SpaceImp >::value, "SpaceImp has to be derived from SpaceInterface!");
+  static_assert(Stuff::LA::is_matrix< MatrixImp >::value,
+                "MatrixImp has to be derived from Stuff::LA::MatrixInterface!");
+  static_assert(Stuff::LA::is_vector< VectorImp >::value,
+                "VectorImp has to be derived from Stuff::LA::VectorInterface!");
+  typedef NonlinearElliptic< CoefficientImp, ForceImp, SpaceImp, MatrixImp, VectorImp > ThisType;
+public:
+  typedef CoefficientImp                                                                CoefficientType;
+  typedef ForceImp                                                                      ForceType;
+  typedef SpaceImp                                                                      SpaceType;
+  typedef MatrixImp                                                                     MatrixType;
+  typedef VectorImp                                                                     VectorType;
+  typedef typename SpaceType::GridViewType::Intersection                                IntersectionType;
+  typedef Stuff::Grid::BoundaryInfoInterface< IntersectionType >                        BoundaryInfoType;
+  typedef ConstDiscreteFunction< SpaceType, VectorType >                                DiscreteFunctionType;
+private:
+  typedef LocalOperator::Codim0Integral
+      < LocalEvaluation::NonlinearElliptic< CoefficientType, DiscreteFunctionType > >     LocalJacobianType;
+  typedef LocalFunctional::Codim0Integral
+      < LocalEvaluation::NonlinearEllipticResidual< CoefficientType, DiscreteFunctionType > > LocalResidualType;
+  typedef LocalFunctional::Codim0Integral< LocalEvaluation::Product< ForceType > >      LocalForceType;
+
+public:
+  /**
+   * \param over_integrate Additional quadrature order for the coefficient, which is in general not polynomial.
+   */
+  NonlinearElliptic(const CoefficientType& coefficient,
+                    const ForceType& force,
+                    const BoundaryInfoType& boundary_info,
+                    const SpaceType& spc,
+                    const size_t over_integrate = 2,
+                    const bool use_tbb = false)
+    : space_(spc)
+    , use_tbb_(use_tbb)
+    , iterate_(space_.mapper().size(), 0.0)
+    , iterate_function_(space_, iterate_)
+    , local_jacobian_(over_integrate, coefficient, iterate_function_)
+    , local_residual_(over_integrate, coefficient, iterate_function_)
+    , local_jacobian_assembler_(local_jacobian_)
+    , local_residual_assembler_(local_residual_)
+    , pattern_(space_.compute_volume_pattern())
+    , force_vector_(space_.mapper().size(), 0.0)
+    , constraints_(boundary_info, space_.mapper().size(), true)
+  {
+    const LocalForceType local_force(force);
+    const LocalAssembler::Codim0Vector< LocalForceType > local_force_assembler(local_force);
+    SystemAssembler< SpaceType > system_assembler(space_);
+    system_assembler.add(local_force_assembler, force_vector_);
+    system_assembler.add(constraints_);
+    system_assembler.assemble(use_tbb_);
+  } // NonlinearElliptic(...)
+
+  NonlinearElliptic(const ThisType& other) = delete;
+  NonlinearElliptic(ThisType&& source) = delete;
+
+  ThisType& operator=(const ThisType& other) = delete;
+  ThisType& operator=(ThisType&& source) = delete;
+
+  const SpaceType& space() const
+  {
+    return space_;
+  }
+
+  MatrixType create_jacobian() const
+  {
+    return MatrixType(space_.mapper().size(), space_.mapper().size(), pattern_);
+  }
+
+  VectorType create_vector() const
+  {
+    return VectorType(space_.mapper().size(), 0.0);
+  }
+
+  /**
+   * \brief Assembles the residual at iterate and, if jacobian is not null, the jacobian at iterate in one grid walk.
+   * \note  residual and jacobian are overwritten, jacobian has to provide the pattern of create_jacobian() (which is
+   *        kept).
+   * \note  Not thread safe: the iterate is copied into a member (referenced by the local evaluations) before the walk,
+   *        concurrent calls on the same object thus race. The walk itself may be threaded (see use_tbb).
+   */
+  void assemble(const VectorType& iterate, VectorType& residual, MatrixType* jacobian) const
+  {
+    if (iterate.size() != space_.mapper().size() || residual.size() != space_.mapper().size())
+      DUNE_THROW(Stuff::Exceptions::shapes_do_not_match,
+                 "The sizes of iterate (" << iterate.size() << ") and residual (" << residual.size() << ") do not "
+                 << "match the size of the space (" << space_.mapper().size() << ")!");
+    // the local evaluations reference iterate_function_, which wraps iterate_
+    if (jacobian && (jacobian->rows() != space_.mapper().size() || jacobian->cols() != space_.mapper().size()))
+      DUNE_THROW(Stuff::Exceptions::shapes_do_not_match,
+                 "The size of jacobian (" << jacobian->rows() << "x" << jacobian->cols() << ") does not match the "
+                 << "size of the space (" << space_.mapper().size() << ")!");
+    iterate_ = iterate;
+    residual *= 0.0;
+    SystemAssembler< SpaceType > system_assembler(space_);
+    system_assembler.add(local_residual_assembler_, residual);
+    if (jacobian) {
+      *jacobian *= 0.0;
+      system_assembler.add(local_jacobian_assembler_, *jacobian);
+    }
+    system_assembler.assemble(use_tbb_);
+    residual -= force_vector_;
+    if (jacobian)
+      constraints_.apply(*jacobian, residual);
+    else
+      constraints_.apply(residual);
+  } // ... assemble(...)
+
+private:
+  const SpaceType space_;
+  const bool use_tbb_;
+  mutable VectorType iterate_;
+  const DiscreteFunctionType iterate_function_;
+  const LocalJacobianType local_jacobian_;
+  const LocalResidualType local_residual_;
+  const LocalAssembler::Codim0Matrix< LocalJacobianType > local_jacobian_assembler_;
+  const LocalAssembler::Codim0Vector< LocalResidualType > local_residual_assembler_;
+  const typename SpaceType::PatternType pattern_;
+  VectorType force_vector_;
+  Spaces::DirichletConstraints< IntersectionType > constraints_;
+}; // class NonlinearElliptic
+
+
+} // namespace Operators
+} // namespace GDT
+} // namespace Dune
+
+#endif // DUNE_GDT_OPERATORS_NONLINEAR_ELLIPTIC_HH
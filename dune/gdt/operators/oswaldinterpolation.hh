@@ -6,22 +6,29 @@
 #ifndef DUNE_GDT_OPERATORS_OSWALD_HH
 #define DUNE_GDT_OPERATORS_OSWALD_HH
 
-#include <vector>
-#include <set>
+#include <cmath>
 #include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <vector>
 
 #include <boost/numeric/conversion/cast.hpp>
 
+#include <dune/geometry/referenceelements.hh>
+#include <dune/geometry/type.hh>
+
 #include <dune/stuff/aliases.hh>
-#include <dune/stuff/common/vector.hh>
-#include <dune/stuff/common/float_cmp.hh>
+#include <dune/stuff/common/exceptions.hh>
 #include <dune/stuff/common/print.hh>
-#include <dune/stuff/common/ranges.hh>
 #include <dune/stuff/grid/walker.hh>
 
+#include <dune/gdt/assembler/functors.hh>
 #include <dune/gdt/discretefunction/default.hh>
 #include <dune/gdt/playground/spaces/dg/fem.hh>
 #include <dune/gdt/playground/spaces/block.hh>
+#include <dune/gdt/solvers/csr.hh>
 
 #include "interfaces.hh"
 
@@ -48,9 +55,36 @@ public:
 };
 
 
+/**
+ * \brief The DoFs associated with each vertex of a grid view, in compressed row storage: the DoFs of vertex ii are
+ *        DoFs[offsets[ii]], ..., DoFs[offsets[ii + 1] - 1].
+ */
+struct OswaldInterpolationAdjacency
+{
+  /// to check if this adjacency belongs to a space on an unchanged grid, see OswaldInterpolation::get_adjacency()
+  const void* space;
+  //! the sequence numbers of all dune-fem spaces involved (all local spaces of a block space)
+  std::vector< int > sequences;
+  size_t num_entities;
+  std::vector< size_t > offsets;
+  std::vector< size_t > DoFs;
+  std::vector< char > boundary;
+}; // struct OswaldInterpolationAdjacency
+
+
 } // namespace internal
 
 
+/**
+ * \brief Averages the DoFs of a piecewise linear DG function in each vertex (and sets them to zero on the boundary,
+ *        if requested).
+ *
+ *        The DoFs associated with each vertex are computed in one (threaded) grid walk on the first application to a
+ *        space and are kept for all further applications to the same space, each of which is a flat (threaded) loop
+ *        over all vertices.
+ * \note  The adjacency is recomputed if the space changes or its grid is adapted (see get_adjacency()), including
+ *        the case of a space which was destroyed and recreated at the same address on an adapted grid.
+ */
 template< class GridViewImp, class FieldImp >
 class OswaldInterpolation
   : public OperatorInterface< internal::OswaldInterpolationTraits< GridViewImp, FieldImp > >
@@ -60,7 +94,12 @@ public:
   typedef typename Traits::GridViewType GridViewType;
   typedef typename Traits::FieldType    FieldType;
   static const size_t                   dimDomain = GridViewType::dimension;
+private:
+  typedef typename GridViewType::template Codim< 0 >::Entity EntityType;
+  typedef typename GridViewType::ctype                       DomainFieldType;
+  typedef internal::OswaldInterpolationAdjacency             AdjacencyType;
 
+public:
   OswaldInterpolation(const GridViewType& grd_vw, const bool zero_boundary = true)
     : grid_view_(grd_vw)
     , zero_boundary_(zero_boundary)
@@ -70,135 +109,199 @@ public:
   void apply(const ConstDiscreteFunction< Spaces::DG::FemBased< SGP, 1, FieldType, 1, 1 >, SV >&
                 source,
              DiscreteFunction< Spaces::DG::FemBased< RGP, 1, FieldType, 1, 1 >, RV >&
-                range) const
+                range,
+             const bool use_tbb = false) const
   {
-    apply_dg_fem(source, range);
+    apply_dg_fem(source, range, use_tbb);
   }
 
   template< class SGP, class SV, class RGP, class RV >
   void apply(const ConstDiscreteFunction< Spaces::Block< Spaces::DG::FemBased< SGP, 1, FieldType, 1, 1 > >, SV >&
                 source,
              DiscreteFunction< Spaces::Block< Spaces::DG::FemBased< RGP, 1, FieldType, 1, 1 > >, RV >&
-                range) const
+                range,
+             const bool use_tbb = false) const
   {
-    apply_dg_fem(source, range);
+    apply_dg_fem(source, range, use_tbb);
   }
 
 private:
   template< class SourceType, class RangeType >
-  void apply_dg_fem(const SourceType& source, RangeType& range) const
+  void apply_dg_fem(const SourceType& source, RangeType& range, const bool use_tbb) const
   {
-    // data structures we need
-    // * a map from a global vertex index to global DoF indices
-    //   given a vertex, one obtains a set of all global DoF ids, which are associated with this vertex
-    std::map< size_t, std::set< size_t > > global_vertex_id_to_global_DoF_id_map;
-    // * a map from a global DoF index to the global index of its associated vertex
-    std::vector< size_t > global_DoF_id_to_global_vertex_id_map(source.space().mapper().size());
-    // * a set to hold the global id of all boundary vertices
-    std::set< size_t > boundary_vertices;
-
-    const auto entity_it_end = grid_view_.template end< 0 >();
-    //walk the grid to create the maps explained above and to find the boundary vertices
-    for (auto entity_it = grid_view_.template begin< 0 >(); entity_it != entity_it_end; ++entity_it) {
-      const auto& entity = *entity_it;
-      const size_t num_vertices = boost::numeric_cast< size_t >(entity.template count< dimDomain >());
-      const auto basis = source.space().base_function_set(entity);
-      if (basis.size() != num_vertices)
-        DUNE_THROW(Dune::Stuff::Exceptions::internal_error, "basis.size() = " << basis.size());
-
-      //loop over all vertices of the entitity, to find their associated global DoF indices
-      for (size_t local_vertex_id = 0; local_vertex_id < num_vertices; ++local_vertex_id) {
-        const auto vertex_ptr = entity.template subEntity< dimDomain >(boost::numeric_cast< int >(local_vertex_id));
-        const auto global_vertex_id = grid_view_.indexSet().index(*vertex_ptr);
-        const auto vertex = vertex_ptr->geometry().center();
-        // find the local basis function which corresponds to this vertex
-        const auto basis_values = basis.evaluate(entity.geometry().local(vertex));
-        if (basis_values.size() != num_vertices)
-          DUNE_THROW(Dune::Stuff::Exceptions::internal_error, "basis_values.size() = " << basis_values.size());
-        size_t ones = 0;
-        size_t zeros = 0;
-        size_t failures = 0;
-        size_t local_DoF_index = 0;
-        for (size_t ii = 0; ii < basis.size(); ++ii) {
-          if (std::abs(basis_values[ii][0] - 1.0) < 1e-14) {
-            local_DoF_index = ii;
-            ++ones;
-          } else if (std::abs(basis_values[ii][0] - 0.0) < 1e-14)
-            ++zeros;
-          else
-            ++failures;
-        }
-        if (ones != 1 || zeros != (basis.size() - 1) || failures > 0) {
-          std::stringstream ss;
-          ss << "ones = " << ones << ", zeros = " << zeros << ", failures = " << failures << ", num_vertices = "
-             << num_vertices << ", entity " << grid_view_.indexSet().index(entity)
-             << ", vertex " << local_vertex_id << ": [ " << vertex << "], ";
-          Stuff::Common::print(basis_values, "basis_values", ss);
-          DUNE_THROW(Dune::Stuff::Exceptions::internal_error, ss.str());
-        }
-        // now we know that the local DoF index of this vertex is ii
-        const size_t global_DoF_index = source.space().mapper().mapToGlobal(entity, local_DoF_index);
-        global_DoF_id_to_global_vertex_id_map[global_DoF_index] = global_vertex_id;
-        global_vertex_id_to_global_DoF_id_map[global_vertex_id].insert(global_DoF_index);
-      } //loop over all vertices
+    if (range.vector().size() != source.vector().size())
+      DUNE_THROW(Stuff::Exceptions::shapes_do_not_match,
+                 "The sizes of source (" << source.vector().size() << ") and range (" << range.vector().size()
+                 << ") do not match!");
+    const auto adjacency = get_adjacency(source.space(), use_tbb);
+    const auto& source_vector = source.vector();
+    auto& range_vector = range.vector();
+    // makes range_vector unique (copy on write) before the threads write to it
+    range_vector *= FieldType(0);
+    // each DoF is associated with exactly one vertex, which is handled by one thread only
+    const size_t num_vertices = adjacency->offsets.size() - 1;
+    Solvers::internal::for_each_range(num_vertices, use_tbb, [&](const size_t first, const size_t last) {
+      for (size_t vv = first; vv < last; ++vv) {
+        const size_t begin = adjacency->offsets[vv];
+        const size_t end = adjacency->offsets[vv + 1];
+        if (begin == end || (zero_boundary_ && adjacency->boundary[vv]))
+          continue;
+        FieldType sum(0);
+        for (size_t kk = begin; kk < end; ++kk)
+          sum += source_vector.get_entry(adjacency->DoFs[kk]);
+        const FieldType average = sum / FieldType(end - begin);
+        for (size_t kk = begin; kk < end; ++kk)
+          range_vector.set_entry(adjacency->DoFs[kk], average);
+      }
+    });
+  } // ... apply_dg_fem(...)
+
+  template< class GP >
+  static std::vector< int > sequences(const Spaces::DG::FemBased< GP, 1, FieldType, 1, 1 >& space)
+  {
+    return std::vector< int >(1, space.backend().sequence());
+  }
+
+  template< class GP >
+  static std::vector< int > sequences(const Spaces::Block< Spaces::DG::FemBased< GP, 1, FieldType, 1, 1 > >& space)
+  {
+    std::vector< int > ret;
+    for (const auto& local_space : space.local_spaces())
+      ret.push_back(local_space->backend().sequence());
+    return ret;
+  }
+
+  /**
+   * The adjacency is reused as long as it belongs to the same space and the grid did not change. The latter is
+   * detected by the sequence numbers of the dune-fem spaces, which are increased on each change of the grid (the
+   * address and the sizes alone might match a space which was recreated on an adapted grid). For a block space the
+   * sequence numbers of all local spaces are checked, since Spaces::Block::backend() only yields the first one.
+   */
+  template< class SpaceType >
+  std::shared_ptr< const AdjacencyType > get_adjacency(const SpaceType& space, const bool use_tbb) const
+  {
+    std::lock_guard< std::mutex > lock(adjacency_mutex_);
+    if (!adjacency_
+        || adjacency_->space != static_cast< const void* >(&space)
+        || adjacency_->sequences != sequences(space)
+        || adjacency_->num_entities != grid_view_.indexSet().size(0)
+        || adjacency_->offsets.size() != grid_view_.indexSet().size(dimDomain) + 1)
+      adjacency_ = compute_adjacency(space, use_tbb);
+    return adjacency_;
+  } // ... get_adjacency(...)
 
+  /**
+   * The vertex and boundary flag of each DoF are computed in a (threaded) grid walk, the local DoF of each vertex is
+   * only computed once per geometry type and thread. The DoFs of each vertex are then sorted into the compressed row
+   * storage.
+   */
+  template< class SpaceType >
+  std::shared_ptr< const AdjacencyType > compute_adjacency(const SpaceType& space, const bool use_tbb) const
+  {
+    const size_t num_DoFs = space.mapper().size();
+    std::vector< size_t > DoF_to_vertex(num_DoFs, std::numeric_limits< size_t >::max());
+    std::vector< char > DoF_on_boundary(num_DoFs, 0);
+    // local DoF index of each local vertex, per geometry type
+    typedef std::map< GeometryType, std::vector< size_t > > LocalDoFsType;
+    const auto local_DoFs_of_vertices = [&](const EntityType& entity,
+                                            LocalDoFsType& storage) -> const std::vector< size_t >& {
+      const auto& reference_element = ReferenceElements< DomainFieldType, dimDomain >::general(entity.type());
+      auto& local_DoFs = storage[entity.type()];
+      if (local_DoFs.empty()) {
+        const size_t num_vertices = boost::numeric_cast< size_t >(reference_element.size(dimDomain));
+        const auto basis = space.base_function_set(entity);
+        if (basis.size() != num_vertices)
+          DUNE_THROW(Dune::Stuff::Exceptions::internal_error, "basis.size() = " << basis.size());
+        for (size_t local_vertex_id = 0; local_vertex_id < num_vertices; ++local_vertex_id) {
+          // find the local basis function which corresponds to this vertex
+          const auto basis_values
+              = basis.evaluate(reference_element.position(boost::numeric_cast< int >(local_vertex_id), dimDomain));
+          if (basis_values.size() != num_vertices)
+            DUNE_THROW(Dune::Stuff::Exceptions::internal_error, "basis_values.size() = " << basis_values.size());
+          size_t ones = 0;
+          size_t zeros = 0;
+          size_t failures = 0;
+          size_t local_DoF_index = 0;
+          for (size_t ii = 0; ii < basis.size(); ++ii) {
+            if (std::abs(basis_values[ii][0] - 1.0) < 1e-14) {
+              local_DoF_index = ii;
+              ++ones;
+            } else if (std::abs(basis_values[ii][0] - 0.0) < 1e-14)
+              ++zeros;
+            else
+              ++failures;
+          }
+          if (ones != 1 || zeros != (basis.size() - 1) || failures > 0) {
+            std::stringstream ss;
+            ss << "ones = " << ones << ", zeros = " << zeros << ", failures = " << failures << ", num_vertices = "
+               << num_vertices << ", entity " << grid_view_.indexSet().index(entity)
+               << ", vertex " << local_vertex_id << ", ";
+            Stuff::Common::print(basis_values, "basis_values", ss);
+            DUNE_THROW(Dune::Stuff::Exceptions::internal_error, ss.str());
+          }
+          local_DoFs.push_back(local_DoF_index);
+        }
+      }
+      return local_DoFs;
+    }; // ... local_DoFs_of_vertices(...)
+    // the DoFs are local to the entities (see internal::Codim0LambdaFunctor)
+    const auto associate_DoFs = [&](const EntityType& entity, LocalDoFsType& storage) {
+      const auto& local_DoFs = local_DoFs_of_vertices(entity, storage);
+      const auto global_indices = space.mapper().globalIndices(entity);
+      for (size_t local_vertex_id = 0; local_vertex_id < local_DoFs.size(); ++local_vertex_id) {
+        const auto vertex_ptr = entity.template subEntity< dimDomain >(boost::numeric_cast< int >(local_vertex_id));
+        DoF_to_vertex[global_indices[local_DoFs[local_vertex_id]]] = grid_view_.indexSet().index(*vertex_ptr);
+      }
       if (zero_boundary_) {
-        // in order to determine the boundary vertices, we need to
-        // loop over all intersections
-        const auto intersectionEndIt = grid_view_.iend(entity);
-        for (auto intersectionIt = grid_view_.ibegin(entity); intersectionIt != intersectionEndIt; ++intersectionIt) {
-          const auto& intersection = *intersectionIt;
+        const auto& reference_element = ReferenceElements< DomainFieldType, dimDomain >::general(entity.type());
+        const auto intersection_it_end = grid_view_.iend(entity);
+        for (auto intersection_it = grid_view_.ibegin(entity);
+             intersection_it != intersection_it_end;
+             ++intersection_it) {
+          const auto& intersection = *intersection_it;
           if (intersection.boundary() && !intersection.neighbor()) {
-            const auto& intersection_geometry = intersection.geometry();
-            for (auto local_intersection_corner_id : DSC::valueRange(intersection_geometry.corners())) {
-              const auto global_intersection_corner = intersection_geometry.corner(local_intersection_corner_id);
-              // now, we need to find the entity's vertex this intersection's corner point equals to, so we
-              // loop over all vertices of the entity
-              for (size_t local_vertex_id = 0; local_vertex_id < num_vertices; ++local_vertex_id) {
-                const auto vertex_ptr = entity.template subEntity< dimDomain >(boost::numeric_cast< int >(local_vertex_id));
-                const auto global_vertex_id = grid_view_.indexSet().index(*vertex_ptr);
-                const auto vertex = vertex_ptr->geometry().center();
-                if (Stuff::Common::FloatCmp::eq(global_intersection_corner, vertex))
-                  boundary_vertices.insert(global_vertex_id);
-              } // loop over all vertices of the entity
-            } //loop over all intersection corners
-          } // if (intersection.boundary() && !intersection.neighbor())
-        } // loop over all intersections
-      } // if(zero_boundary)
-    } //walk the grid for the first time
-
-    // walk the grid for the second time
-    for (auto entity_it = grid_view_.template begin< 0 >(); entity_it != entity_it_end; ++entity_it) {
-      const auto& entity = *entity_it;
-      const auto num_vertices = boost::numeric_cast< size_t >(entity.template count< dimDomain >());
-      // get the local functions
-      const auto local_source = source.local_discrete_function(entity);
-      const auto& local_source_DoF_vector = local_source->vector();
-
-      // * loop over all local DoFs
-      for (size_t local_DoF_id = 0; local_DoF_id < num_vertices; ++local_DoF_id) {
-      const size_t global_DoF_index = source.space().mapper().mapToGlobal(entity, local_DoF_id);
-      const size_t global_vertex_id = global_DoF_id_to_global_vertex_id_map[global_DoF_index];
-        // if we are on the domain boundary
-        if (zero_boundary_ && boundary_vertices.count(global_vertex_id)) {
-          // set the dof to zero (we have dirichlet zero)
-          range.vector().set_entry(global_DoF_index, FieldType(0));
-        } else {
-          // do the oswald projection
-          const size_t num_DoFS_per_vertex = global_vertex_id_to_global_DoF_id_map[global_vertex_id].size();
-          // * get the source DoF
-          const FieldType source_DoF_value = local_source_DoF_vector.get(local_DoF_id);
-          // * and add it to all target DoFs
-          for (size_t target_global_DoF_id : global_vertex_id_to_global_DoF_id_map[global_vertex_id])
-            range.vector().add_to_entry(target_global_DoF_id, source_DoF_value / num_DoFS_per_vertex);
-        } // if (boundary_vertices.find(global_vertex_id))
-      } // loop over all local DoFs
-    } // walk the grid for the second time
-  } // ... apply(...)
-
+            const int face = intersection.indexInInside();
+            for (int ii = 0; ii < reference_element.size(face, 1, dimDomain); ++ii) {
+              const auto local_vertex_id = boost::numeric_cast< size_t >(reference_element.subEntity(face, 1, ii,
+                                                                                                     dimDomain));
+              DoF_on_boundary[global_indices[local_DoFs[local_vertex_id]]] = 1;
+            }
+          }
+        }
+      }
+    }; // ... associate_DoFs(...)
+    GDT::internal::Codim0LambdaFunctor< GridViewType, LocalDoFsType > functor(associate_DoFs);
+    Stuff::Grid::Walker< GridViewType > walker(grid_view_);
+    walker.add(functor);
+    walker.walk(use_tbb);
+    // sort the DoFs by their vertex
+    auto adjacency = std::make_shared< AdjacencyType >();
+    adjacency->space = &space;
+    adjacency->sequences = sequences(space);
+    adjacency->num_entities = grid_view_.indexSet().size(0);
+    const size_t num_vertices = grid_view_.indexSet().size(dimDomain);
+    adjacency->offsets.assign(num_vertices + 1, 0);
+    adjacency->boundary.assign(num_vertices, 0);
+    for (size_t ii = 0; ii < num_DoFs; ++ii) {
+      if (DoF_to_vertex[ii] >= num_vertices)
+        DUNE_THROW(Stuff::Exceptions::internal_error, "DoF " << ii << " is not associated with a vertex!");
+      ++adjacency->offsets[DoF_to_vertex[ii] + 1];
+      if (DoF_on_boundary[ii])
+        adjacency->boundary[DoF_to_vertex[ii]] = 1;
+    }
+    for (size_t vv = 0; vv < num_vertices; ++vv)
+      adjacency->offsets[vv + 1] += adjacency->offsets[vv];
+    adjacency->DoFs.resize(num_DoFs);
+    std::vector< size_t > next(adjacency->offsets.begin(), adjacency->offsets.end() - 1);
+    for (size_t ii = 0; ii < num_DoFs; ++ii)
+      adjacency->DoFs[next[DoF_to_vertex[ii]]++] = ii;
+    return adjacency;
+  } // ... compute_adjacency(...)
 
   const GridViewType& grid_view_;
   const bool zero_boundary_;
+  mutable std::mutex adjacency_mutex_;
+  mutable std::shared_ptr< const AdjacencyType > adjacency_;
 }; // class OswaldInterpolation
 
 
@@ -8,10 +8,13 @@
 
 #include <vector>
 #include <limits>
+#include <map>
+#include <cmath>
 
 #include <boost/numeric/conversion/cast.hpp>
 
 #include <dune/common/dynmatrix.hh>
+#include <dune/common/dynvector.hh>
 
 #include <dune/stuff/common/type_utils.hh>
 #include <dune/stuff/common/vector.hh>
@@ -44,6 +47,29 @@ class Block;
 }
 
 namespace Operators {
+namespace internal {
+
+
+/**
+ * \brief Creates a sparse matrix from the given rows, the sparsity pattern is given by the entries of the rows.
+ */
+template< class MatrixType, class RangeFieldType >
+MatrixType matrix_from_rows(const std::vector< std::map< size_t, RangeFieldType > >& rows, const size_t cols)
+{
+  Stuff::LA::SparsityPatternDefault pattern(rows.size());
+  for (size_t ii = 0; ii < rows.size(); ++ii)
+    for (const auto& entry : rows[ii])
+      pattern.inner(ii).push_back(entry.first);
+  MatrixType matrix(rows.size(), cols, pattern);
+  for (size_t ii = 0; ii < rows.size(); ++ii)
+    for (const auto& entry : rows[ii])
+      matrix.set_entry(ii, entry.first, entry.second);
+  return matrix;
+} // ... matrix_from_rows(...)
+
+
+} // namespace internal
+
 
 
 /**
@@ -131,6 +157,104 @@ public:
     prolong_onto_dg_fem_localfunctions_wrapper(source, range);
   }
 
+  /**
+   * \brief Assembles the matrix of this prolongation from coarse_space to fine_space, i.e. the matrix P such that
+   *        P times the DoF vector of a coarse function yields the DoF vector of its prolongation.
+   *
+   *        The local L2 projection onto each entity of the grid view is computed as in apply() for each coarse basis
+   *        function at once. This allows to reuse the prolongation, e.g. as transfer operator of a multigrid method
+   *        (see Solvers::Multigrid).
+   * \note  The DoFs of fine_space have to be local to the entities (as for DG spaces), which is checked. The
+   *        quadrature order is chosen for the highest order of the coarse basis on any entity.
+   */
+  template< class MatrixType, class CoarseSpaceType, class FineSpaceType >
+  MatrixType assemble_matrix(const CoarseSpaceType& coarse_space, const FineSpaceType& fine_space) const
+  {
+    typedef typename FineSpaceType::RangeFieldType                   RangeFieldType;
+    typedef typename FineSpaceType::BaseFunctionSetType::DomainType  DomainType;
+    typedef typename FineSpaceType::BaseFunctionSetType::RangeType   RangeType;
+    typedef typename CoarseSpaceType::GridViewType                   CoarseGridViewType;
+    std::vector< std::map< size_t, RangeFieldType > > rows(fine_space.mapper().size());
+    Stuff::Grid::EntityInlevelSearch< CoarseGridViewType > entity_search(coarse_space.grid_view());
+    std::vector< RangeType > fine_values(fine_space.mapper().maxNumDofs(), RangeType(0));
+    std::vector< RangeType > coarse_values(coarse_space.mapper().maxNumDofs(), RangeType(0));
+    size_t coarse_order = 0;
+    const auto coarse_entity_it_end = coarse_space.grid_view().template end< 0 >();
+    for (auto coarse_entity_it = coarse_space.grid_view().template begin< 0 >();
+         coarse_entity_it != coarse_entity_it_end;
+         ++coarse_entity_it)
+      coarse_order = std::max(coarse_order, coarse_space.base_function_set(*coarse_entity_it).order());
+    size_t num_local_fine_dofs = 0;
+    const auto entity_it_end = grid_view_.template end< 0 >();
+    for (auto entity_it = grid_view_.template begin< 0 >(); entity_it != entity_it_end; ++entity_it) {
+      const auto& entity = *entity_it;
+      const auto fine_basis = fine_space.base_function_set(entity);
+      const size_t fine_size = fine_basis.size();
+      num_local_fine_dofs += fine_size;
+      const auto fine_indices = fine_space.mapper().globalIndices(entity);
+      // the local mass matrix and the coupling with the coarse basis functions (given by their global index)
+      Dune::DynamicMatrix< RangeFieldType > local_mass_matrix(fine_size, fine_size, RangeFieldType(0));
+      std::map< size_t, Dune::DynamicVector< RangeFieldType > > coupling;
+      const size_t integrand_order = std::max(coarse_order, fine_basis.order()) + fine_basis.order();
+      const auto& quadrature = QuadratureRules< DomainFieldType, dimDomain >::rule(
+            entity.type(), boost::numeric_cast< int >(integrand_order));
+      std::vector< DomainType > quadrature_points;
+      for (const auto& quadrature_point : quadrature)
+        quadrature_points.emplace_back(entity.geometry().global(quadrature_point.position()));
+      const auto coarse_entity_ptr_unique_ptrs = entity_search(quadrature_points);
+      assert(coarse_entity_ptr_unique_ptrs.size() >= quadrature_points.size());
+      size_t pp = 0;
+      for (const auto& quadrature_point : quadrature) {
+        const auto local_point = quadrature_point.position();
+        const auto factor = entity.geometry().integrationElement(local_point) * quadrature_point.weight();
+        fine_basis.evaluate(local_point, fine_values);
+        for (size_t ii = 0; ii < fine_size; ++ii)
+          for (size_t jj = 0; jj < fine_size; ++jj)
+            local_mass_matrix[ii][jj] += factor * (fine_values[ii] * fine_values[jj]);
+        const auto& coarse_entity_ptr_unique_ptr = coarse_entity_ptr_unique_ptrs[pp];
+        if (coarse_entity_ptr_unique_ptr) {
+          const auto coarse_entity_ptr = *coarse_entity_ptr_unique_ptr;
+          const auto& coarse_entity = *coarse_entity_ptr;
+          const auto coarse_basis = coarse_space.base_function_set(coarse_entity);
+          const auto coarse_indices = coarse_space.mapper().globalIndices(coarse_entity);
+          coarse_basis.evaluate(coarse_entity.geometry().local(quadrature_points[pp]), coarse_values);
+          for (size_t jj = 0; jj < coarse_basis.size(); ++jj) {
+            auto coupling_it = coupling.find(coarse_indices[jj]);
+            if (coupling_it == coupling.end())
+              coupling_it = coupling.emplace(coarse_indices[jj],
+                                             Dune::DynamicVector< RangeFieldType >(fine_size, RangeFieldType(0))).first;
+            for (size_t ii = 0; ii < fine_size; ++ii)
+              coupling_it->second[ii] += factor * (fine_values[ii] * coarse_values[jj]);
+          }
+        }
+        ++pp;
+      }
+      // the local prolongation is the inverse of the local mass matrix times the coupling
+      try {
+        local_mass_matrix.invert();
+      } catch (Dune::FMatrixError& ee) {
+        DUNE_THROW(Exceptions::prolongation_error,
+                   "L2 prolongation failed because a local matrix could not be inverted!\n\n"
+                   << "This was the original error: " << ee.what());
+      }
+      for (const auto& element : coupling) {
+        for (size_t ii = 0; ii < fine_size; ++ii) {
+          RangeFieldType value(0);
+          for (size_t kk = 0; kk < fine_size; ++kk)
+            value += local_mass_matrix[ii][kk] * element.second[kk];
+          if (std::abs(value) > 0)
+            rows[fine_indices[ii]][element.first] = value;
+        }
+      }
+    } // walk the grid
+    // each row is only correct if its DoF belongs to a single entity
+    if (num_local_fine_dofs != fine_space.mapper().size())
+      DUNE_THROW(Stuff::Exceptions::you_are_using_this_wrong,
+                 "The DoFs of fine_space have to be local to the entities (as for DG spaces), but the entities hold "
+                 << num_local_fine_dofs << " local DoFs for " << fine_space.mapper().size() << " global ones!");
+    return internal::matrix_from_rows< MatrixType >(rows, coarse_space.mapper().size());
+  } // ... assemble_matrix(...)
+
 private:
   template< class SourceFunctionType, class RangeFunctionType >
   void prolong_onto_dg_fem_localfunctions_wrapper(const SourceFunctionType& source, RangeFunctionType& range) const
@@ -299,6 +423,59 @@ public:
     redirect_to_appropriate_apply(source, range);
   }
 
+  /**
+   * \brief Assembles the matrix of this prolongation from coarse_space to fine_space, i.e. the matrix P such that
+   *        P times the DoF vector of a coarse function yields the DoF vector of its prolongation.
+   *
+   *        The row of each fine DoF holds the values of the coarse basis functions in the corresponding Lagrange point,
+   *        as in apply(). This allows to reuse the prolongation, e.g. as transfer operator of a multigrid method (see
+   *        Solvers::Multigrid).
+   */
+  template< class MatrixType, class CoarseSpaceType, class FineSpaceType >
+  MatrixType assemble_matrix(const CoarseSpaceType& coarse_space, const FineSpaceType& fine_space) const
+  {
+    typedef typename FineSpaceType::RangeFieldType                  RangeFieldType;
+    typedef typename CoarseSpaceType::BaseFunctionSetType::RangeType RangeType;
+    typedef typename CoarseSpaceType::GridViewType                  CoarseGridViewType;
+    typedef FieldVector< typename CoarseGridViewType::ctype, CoarseGridViewType::dimension > DomainType;
+    static const size_t dimRange = FineSpaceType::dimRange;
+    std::vector< std::map< size_t, RangeFieldType > > rows(fine_space.mapper().size());
+    std::vector< bool > row_is_computed(fine_space.mapper().size(), false);
+    Stuff::Grid::EntityInlevelSearch< CoarseGridViewType > entity_search(coarse_space.grid_view());
+    std::vector< RangeType > coarse_values(coarse_space.mapper().maxNumDofs(), RangeType(0));
+    const auto entity_it_end = grid_view_.template end< 0 >();
+    for (auto entity_it = grid_view_.template begin< 0 >(); entity_it != entity_it_end; ++entity_it) {
+      const auto& entity = *entity_it;
+      const auto lagrange_point_set = fine_space.lagrange_points(entity);
+      std::vector< DomainType > lagrange_points(lagrange_point_set.size());
+      for (size_t ii = 0; ii < lagrange_point_set.size(); ++ii)
+        lagrange_points[ii] = entity.geometry().global(lagrange_point_set[ii]);
+      const auto coarse_entity_ptr_unique_ptrs = entity_search(lagrange_points);
+      assert(coarse_entity_ptr_unique_ptrs.size() >= lagrange_points.size());
+      const auto fine_indices = fine_space.mapper().globalIndices(entity);
+      // the local DoFs are ordered as in apply_local()
+      for (size_t ii = 0; ii < lagrange_points.size(); ++ii) {
+        if (row_is_computed[fine_indices[ii*dimRange]])
+          continue;
+        const auto& coarse_entity_ptr_unique_ptr = coarse_entity_ptr_unique_ptrs[ii];
+        if (coarse_entity_ptr_unique_ptr) {
+          const auto coarse_entity_ptr = *coarse_entity_ptr_unique_ptr;
+          const auto& coarse_entity = *coarse_entity_ptr;
+          const auto coarse_basis = coarse_space.base_function_set(coarse_entity);
+          const auto coarse_indices = coarse_space.mapper().globalIndices(coarse_entity);
+          coarse_basis.evaluate(coarse_entity.geometry().local(lagrange_points[ii]), coarse_values);
+          for (size_t cc = 0; cc < dimRange; ++cc)
+            for (size_t jj = 0; jj < coarse_basis.size(); ++jj)
+              if (std::abs(coarse_values[jj][cc]) > 0)
+                rows[fine_indices[ii*dimRange + cc]][coarse_indices[jj]] = coarse_values[jj][cc];
+        }
+        for (size_t cc = 0; cc < dimRange; ++cc)
+          row_is_computed[fine_indices[ii*dimRange + cc]] = true;
+      }
+    } // walk the grid
+    return internal::matrix_from_rows< MatrixType >(rows, coarse_space.mapper().size());
+  } // ... assemble_matrix(...)
+
 private:
   template< class SourceType, class RangeType >
   void redirect_to_appropriate_apply(const SourceType& source, RangeType& range) const
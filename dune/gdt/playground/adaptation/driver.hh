@@ -0,0 +1,521 @@
+// This file is part of the dune-gdt project:
+//   http://users.dune-project.org/projects/dune-gdt
+// Copyright holders: Felix Schindler
+// License: BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+
+#ifndef DUNE_GDT_PLAYGROUND_ADAPTATION_DRIVER_HH
+#define DUNE_GDT_PLAYGROUND_ADAPTATION_DRIVER_HH
+
+#include <functional>
+#include <limits>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <dune/stuff/common/configuration.hh>
+#include <dune/stuff/common/exceptions.hh>
+#include <dune/stuff/common/memory.hh>
+#include <dune/stuff/functions/interfaces.hh>
+#include <dune/stuff/la/container/interfaces.hh>
+#include <dune/stuff/la/solver.hh>
+
+#include <dune/gdt/discretefunction/default.hh>
+#include <dune/gdt/operators/projections.hh>
+
+#include "marking.hh"
+
+namespace Dune {
+namespace GDT {
+namespace Adaptation {
+namespace internal {
+
+
+/**
+ * \brief The local function of a discrete function of the grid before the adaptation, on an entity of the adapted grid,
+ *        given by the local DoFs of its ancestor which was a leaf before the adaptation.
+ */
+template< class SpaceType >
+class TransferredLocalfunction
+  : public Stuff::LocalfunctionInterface< typename SpaceType::EntityType, typename SpaceType::DomainFieldType,
+                                          SpaceType::dimDomain, typename SpaceType::RangeFieldType,
+                                          SpaceType::dimRange, SpaceType::dimRangeCols >
+{
+  typedef Stuff::LocalfunctionInterface< typename SpaceType::EntityType, typename SpaceType::DomainFieldType,
+                                         SpaceType::dimDomain, typename SpaceType::RangeFieldType,
+                                         SpaceType::dimRange, SpaceType::dimRangeCols > BaseType;
+public:
+  typedef typename BaseType::EntityType                                      EntityType;
+  typedef typename BaseType::DomainType                                      DomainType;
+  typedef typename BaseType::RangeFieldType                                  RangeFieldType;
+  typedef typename BaseType::RangeType                                       RangeType;
+  typedef typename BaseType::JacobianRangeType                               JacobianRangeType;
+  typedef typename EntityType::Geometry::GlobalCoordinate                    GlobalCoordinateType;
+  typedef typename SpaceType::GridViewType::Grid::template Codim< 0 >::EntityPointer EntityPointerType;
+
+  TransferredLocalfunction(const SpaceType& space,
+                           const EntityType& ent,
+                           const EntityPointerType& ancestor,
+                           const std::vector< RangeFieldType >& local_DoFs)
+    : BaseType(ent)
+    , ancestor_(ancestor)
+    , basis_(space.base_function_set(*ancestor_))
+    , local_DoFs_(local_DoFs)
+    , basis_values_(basis_.size(), RangeType(0))
+    , basis_jacobians_(basis_.size(), JacobianRangeType(0))
+  {
+    assert(local_DoFs_.size() == basis_.size());
+  }
+
+  virtual size_t order() const override
+  {
+    return basis_.order();
+  }
+
+  virtual void evaluate(const DomainType& xx, RangeType& ret) const override
+  {
+    assert(this->is_a_valid_point(xx));
+    basis_.evaluate(ancestor_local(xx), basis_values_);
+    ret *= RangeFieldType(0);
+    for (size_t ii = 0; ii < basis_.size(); ++ii)
+      ret.axpy(local_DoFs_[ii], basis_values_[ii]);
+  }
+
+  virtual void jacobian(const DomainType& xx, JacobianRangeType& ret) const override
+  {
+    assert(this->is_a_valid_point(xx));
+    basis_.jacobian(ancestor_local(xx), basis_jacobians_);
+    ret *= RangeFieldType(0);
+    for (size_t ii = 0; ii < basis_.size(); ++ii)
+      ret.axpy(local_DoFs_[ii], basis_jacobians_[ii]);
+  }
+
+  using BaseType::evaluate;
+  using BaseType::jacobian;
+
+private:
+  DomainType ancestor_local(const DomainType& xx) const
+  {
+    const GlobalCoordinateType global_point = this->entity().geometry().global(xx);
+    return ancestor_->geometry().local(global_point);
+  }
+
+  const EntityPointerType ancestor_;
+  const typename SpaceType::BaseFunctionSetType basis_;
+  const std::vector< RangeFieldType >& local_DoFs_;
+  mutable std::vector< RangeType > basis_values_;
+  mutable std::vector< JacobianRangeType > basis_jacobians_;
+}; // class TransferredLocalfunction
+
+
+/**
+ * \brief A discrete function of the grid before the adaptation, localizable w.r.t. the adapted grid, given by the local
+ *        DoFs of all entities which were leafs before the adaptation.
+ * \note  Only refinement is supported, each entity of the adapted grid has to have an ancestor with local DoFs.
+ */
+template< class SpaceImp >
+class TransferredFunction
+  : public Stuff::LocalizableFunctionInterface< typename SpaceImp::EntityType, typename SpaceImp::DomainFieldType,
+                                                SpaceImp::dimDomain, typename SpaceImp::RangeFieldType,
+                                                SpaceImp::dimRange, SpaceImp::dimRangeCols >
+{
+  typedef Stuff::LocalizableFunctionInterface< typename SpaceImp::EntityType, typename SpaceImp::DomainFieldType,
+                                               SpaceImp::dimDomain, typename SpaceImp::RangeFieldType,
+                                               SpaceImp::dimRange, SpaceImp::dimRangeCols > BaseType;
+public:
+  typedef SpaceImp                                              SpaceType;
+  typedef typename BaseType::EntityType                         EntityType;
+  typedef typename BaseType::RangeFieldType                     RangeFieldType;
+  typedef typename BaseType::LocalfunctionType                  LocalfunctionType;
+  typedef typename SpaceType::GridViewType::Grid                GridType;
+  typedef typename GridType::LocalIdSet::IdType                 IdType;
+  typedef std::map< IdType, std::vector< RangeFieldType > >     LocalDoFsType;
+
+  TransferredFunction(const GridType& grid, const SpaceType& space, const LocalDoFsType& local_DoFs)
+    : grid_(grid)
+    , space_(space)
+    , local_DoFs_(local_DoFs)
+  {}
+
+  virtual std::string type() const override
+  {
+    return BaseType::static_id() + ".transferred";
+  }
+
+  virtual std::string name() const override
+  {
+    return type();
+  }
+
+  virtual std::unique_ptr< LocalfunctionType > local_function(const EntityType& entity) const override
+  {
+    const auto& id_set = grid_.localIdSet();
+    typename TransferredLocalfunction< SpaceType >::EntityPointerType ancestor(entity);
+    auto local_DoFs_it = local_DoFs_.find(id_set.id(*ancestor));
+    while (local_DoFs_it == local_DoFs_.end()) {
+      if (!ancestor->hasFather())
+        DUNE_THROW(Stuff::Exceptions::internal_error,
+                   "No ancestor of this entity was a leaf before the adaptation, coarsening is not supported!");
+      ancestor = ancestor->father();
+      local_DoFs_it = local_DoFs_.find(id_set.id(*ancestor));
+    }
+    return DSC::make_unique< TransferredLocalfunction< SpaceType > >(space_, entity, ancestor, local_DoFs_it->second);
+  } // ... local_function(...)
+
+private:
+  const GridType& grid_;
+  const SpaceType& space_;
+  const LocalDoFsType& local_DoFs_;
+}; // class TransferredFunction
+
+
+} // namespace internal
+
+
+/**
+ * \brief Solves a stationary problem adaptively: solve, estimate, mark (see doerfler_marking()) and refine until the
+ *        estimate drops below a given tolerance, see run().
+ *
+ *        The driver owns the space (which is recreated on the leaf grid view after each adaptation), the system matrix,
+ *        the right hand side and the solution. After each adaptation, the solution is transferred onto the adapted
+ *        grid (by projecting it, see Operators::Projection) and the system is only reassembled on the changed entities
+ *        and their neighbors: the rows of all other DoFs are copied from the previous system.
+\code
+Adaptation::Driver< SpaceType, MatrixType, VectorType > driver(grid,
+                                                                [&]() { return SpaceType(grid.leafGridView()); },
+                                                                [&](const SpaceType& space,
+                                                                    MatrixType& matrix,
+                                                                    VectorType& vector,
+                                                                    const std::vector< bool >& entities) {
+                                                                  SystemAssembler< SpaceType > assembler(space);
+                                                                  // ... add operators and functionals
+                                                                  assembler.assemble(entities);
+                                                                },
+                                                                [&](const SpaceType& space,
+                                                                    const VectorType& solution,
+                                                                    std::vector< double >& indicators) {
+                                                                  // ... compute indicators, e.g. Estimators::ESV2007
+                                                                  return eta;
+                                                                });
+driver.run(Stuff::Common::Configuration({"tolerance", "max_steps"}, {"1e-2", "10"}));
+\endcode
+ * \note  The assembler has to add all local contributions of the given entities and their intersections (as
+ *        SystemAssembler::assemble(entities) does) to the given zero containers. Constraints (e.g. strong Dirichlet
+ *        values) have to be applied in the solver (on a copy of the system), since the assembled system is reused.
+ * \note  Only refinement is supported and the grid is adapted sequentially (no load balancing).
+ */
+template< class SpaceImp, class MatrixImp, class VectorImp >
+class Driver
+{
+  static_assert(Stuff::LA::is_matrix< MatrixImp >::value,
+                "MatrixImp has to be derived from Stuff::LA::MatrixInterface!");
+  static_assert(Stuff::LA::is_vector< VectorImp >::value,
+                "VectorImp has to be derived from Stuff::LA::VectorInterface!");
+public:
+  typedef SpaceImp                                         SpaceType;
+  typedef MatrixImp                                        MatrixType;
+  typedef VectorImp                                        VectorType;
+  typedef typename SpaceType::GridViewType                 GridViewType;
+  typedef typename GridViewType::Grid                      GridType;
+  typedef typename SpaceType::EntityType                   EntityType;
+  typedef typename SpaceType::RangeFieldType               RangeFieldType;
+  typedef typename SpaceType::PatternType                  PatternType;
+  typedef std::vector< RangeFieldType >                    IndicatorsType;
+  /// creates the space on the current leaf grid view
+  typedef std::function< SpaceType() >                     SpaceCreatorType;
+  /// assembles the local contributions of the flagged entities (and their intersections) into matrix and vector
+  typedef std::function< void(const SpaceType& /*space*/,
+                              MatrixType& /*matrix*/,
+                              VectorType& /*vector*/,
+                              const std::vector< bool >& /*entities*/) > AssemblerType;
+  /// computes the squared local indicators and returns the estimate
+  typedef std::function< RangeFieldType(const SpaceType& /*space*/,
+                                        const VectorType& /*solution*/,
+                                        IndicatorsType& /*indicators*/) > EstimatorType;
+  /// solves the system, the solution is given as the transferred solution of the previous grid
+  typedef std::function< void(const SpaceType& /*space*/,
+                              const MatrixType& /*matrix*/,
+                              const VectorType& /*rhs*/,
+                              VectorType& /*solution*/) > SolverType;
+  typedef std::function< PatternType(const SpaceType& /*space*/) > PatternCreatorType;
+
+private:
+  typedef typename GridType::LocalIdSet::IdType IdType;
+
+public:
+  static Stuff::Common::Configuration options()
+  {
+    Stuff::Common::Configuration opts;
+    opts["theta"] = "0.5";
+    opts["tolerance"] = "0";
+    opts["max_steps"] = "10";
+    return opts;
+  }
+
+  /**
+   * \note The default pattern is given by space.compute_pattern(), the default solver is Stuff::LA::Solver.
+   */
+  Driver(GridType& grd,
+         SpaceCreatorType create_space,
+         AssemblerType assembler,
+         EstimatorType estimator,
+         SolverType solver = default_solver(),
+         PatternCreatorType create_pattern = default_pattern())
+    : grid_(grd)
+    , create_space_(create_space)
+    , assembler_(assembler)
+    , estimator_(estimator)
+    , solver_(solver)
+    , create_pattern_(create_pattern)
+    , space_(DSC::make_unique< SpaceType >(create_space_()))
+    , num_reassembled_entities_(0)
+  {
+    const size_t size = space_->mapper().size();
+    system_matrix_ = DSC::make_unique< MatrixType >(size, size, create_pattern_(*space_));
+    rhs_vector_ = DSC::make_unique< VectorType >(size, RangeFieldType(0));
+    solution_ = DSC::make_unique< VectorType >(size, RangeFieldType(0));
+    const std::vector< bool > all_entities(space_->grid_view().indexSet().size(0), true);
+    assembler_(*space_, *system_matrix_, *rhs_vector_, all_entities);
+    num_reassembled_entities_ = all_entities.size();
+  } // Driver(...)
+
+  const SpaceType& space() const
+  {
+    return *space_;
+  }
+
+  const MatrixType& system_matrix() const
+  {
+    return *system_matrix_;
+  }
+
+  const VectorType& rhs_vector() const
+  {
+    return *rhs_vector_;
+  }
+
+  const VectorType& solution() const
+  {
+    return *solution_;
+  }
+
+  /**
+   * \brief The squared local indicators, as computed by the last call of estimate().
+   */
+  const IndicatorsType& indicators() const
+  {
+    return indicators_;
+  }
+
+  /**
+   * \brief The number of entities on which the current system was assembled.
+   */
+  size_t num_reassembled_entities() const
+  {
+    return num_reassembled_entities_;
+  }
+
+  void solve()
+  {
+    solver_(*space_, *system_matrix_, *rhs_vector_, *solution_);
+  }
+
+  RangeFieldType estimate()
+  {
+    const RangeFieldType eta = estimator_(*space_, *solution_, indicators_);
+    if (indicators_.size() != space_->grid_view().indexSet().size(0))
+      DUNE_THROW(Stuff::Exceptions::shapes_do_not_match,
+                 "The estimator computed " << indicators_.size() << " indicators for "
+                 << space_->grid_view().indexSet().size(0) << " entities!");
+    return eta;
+  } // ... estimate(...)
+
+  /**
+   * \brief Refines the entities marked by doerfler_marking(indicators(), theta), transfers the solution and updates
+   *        the system.
+   */
+  void mark_and_refine(const double theta = 0.5)
+  {
+    refine(doerfler_marking(indicators_, theta));
+  }
+
+  /**
+   * \brief Refines the marked entities (marked[ii] is true for the entity with index ii), transfers the solution and
+   *        updates the system.
+   */
+  void refine(const std::vector< bool >& marked)
+  {
+    const auto& old_grid_view = space_->grid_view();
+    if (marked.size() != old_grid_view.indexSet().size(0))
+      DUNE_THROW(Stuff::Exceptions::shapes_do_not_match,
+                 "Given " << marked.size() << " flags for " << old_grid_view.indexSet().size(0) << " entities!");
+    // remember the DoFs of the current leafs
+    const auto& id_set = grid_.localIdSet();
+    std::map< IdType, std::vector< size_t > > old_global_indices;
+    typename internal::TransferredFunction< SpaceType >::LocalDoFsType old_local_DoFs;
+    const auto old_entity_it_end = old_grid_view.template end< 0 >();
+    for (auto entity_it = old_grid_view.template begin< 0 >(); entity_it != old_entity_it_end; ++entity_it) {
+      const EntityType& entity = *entity_it;
+      const auto id = id_set.id(entity);
+      const auto global_indices = space_->mapper().globalIndices(entity);
+      auto& indices = old_global_indices[id];
+      auto& local_DoFs = old_local_DoFs[id];
+      for (size_t ii = 0; ii < global_indices.size(); ++ii) {
+        indices.push_back(global_indices[ii]);
+        local_DoFs.push_back(solution_->get_entry(global_indices[ii]));
+      }
+      if (marked[old_grid_view.indexSet().index(entity)])
+        grid_.mark(1, entity);
+    }
+    // adapt
+    grid_.preAdapt();
+    grid_.adapt();
+    grid_.postAdapt();
+    space_ = DSC::make_unique< SpaceType >(create_space_());
+    transfer_solution(old_local_DoFs);
+    update_system(old_global_indices);
+  } // ... refine(...)
+
+  /**
+   * \brief Solves, estimates and refines until the estimate is below opts["tolerance"] or opts["max_steps"]
+   *        refinements were done, see options().
+   * \return The last estimate.
+   */
+  RangeFieldType run(const Stuff::Common::Configuration& opts = options())
+  {
+    const double theta = opts.get("theta", 0.5);
+    const RangeFieldType tolerance = opts.get("tolerance", RangeFieldType(0));
+    const size_t max_steps = opts.get("max_steps", size_t(10));
+    for (size_t step = 0; true; ++step) {
+      solve();
+      const RangeFieldType eta = estimate();
+      if (!(eta > tolerance) || step >= max_steps)
+        return eta;
+      mark_and_refine(theta);
+    }
+  } // ... run(...)
+
+private:
+  static SolverType default_solver()
+  {
+    return [](const SpaceType& /*space*/, const MatrixType& matrix, const VectorType& rhs, VectorType& solution) {
+      Stuff::LA::Solver< MatrixType >(matrix).apply(rhs, solution);
+    };
+  }
+
+  static PatternCreatorType default_pattern()
+  {
+    return [](const SpaceType& space) { return space.compute_pattern(); };
+  }
+
+  template< class LocalDoFsType >
+  void transfer_solution(const LocalDoFsType& old_local_DoFs)
+  {
+    const internal::TransferredFunction< SpaceType > old_solution(grid_, *space_, old_local_DoFs);
+    solution_ = DSC::make_unique< VectorType >(space_->mapper().size(), RangeFieldType(0));
+    DiscreteFunction< SpaceType, VectorType > solution(*space_, *solution_);
+    Operators::Projection< GridViewType, RangeFieldType >(space_->grid_view()).apply(old_solution, solution);
+  }
+
+  /**
+   * The row of a DoF is copied from the old system if all entities of this DoF and their neighbors were not changed by
+   * the adaptation, all other rows are reassembled (on all entities of their DoFs).
+   */
+  void update_system(const std::map< IdType, std::vector< size_t > >& old_global_indices)
+  {
+    const auto& grid_view = space_->grid_view();
+    const auto& index_set = grid_view.indexSet();
+    const auto& mapper = space_->mapper();
+    const auto& id_set = grid_.localIdSet();
+    const size_t size = mapper.size();
+    const size_t invalid_index = std::numeric_limits< size_t >::max();
+    // find the unchanged entities and the old index of their DoFs
+    std::vector< bool > changed(index_set.size(0), false);
+    std::vector< size_t > old_index(size, invalid_index);
+    const auto entity_it_end = grid_view.template end< 0 >();
+    for (auto entity_it = grid_view.template begin< 0 >(); entity_it != entity_it_end; ++entity_it) {
+      const EntityType& entity = *entity_it;
+      const auto old_global_indices_it = old_global_indices.find(id_set.id(entity));
+      const auto global_indices = mapper.globalIndices(entity);
+      if (old_global_indices_it == old_global_indices.end()
+          || old_global_indices_it->second.size() != global_indices.size())
+        changed[index_set.index(entity)] = true;
+      else
+        for (size_t ii = 0; ii < global_indices.size(); ++ii)
+          old_index[global_indices[ii]] = old_global_indices_it->second[ii];
+    }
+    // the rows of all DoFs of changed entities and their neighbors have to be reassembled ...
+    std::vector< bool > copy_row(size, true);
+    for (auto entity_it = grid_view.template begin< 0 >(); entity_it != entity_it_end; ++entity_it) {
+      const EntityType& entity = *entity_it;
+      bool affected = changed[index_set.index(entity)];
+      const auto intersection_it_end = grid_view.iend(entity);
+      for (auto intersection_it = grid_view.ibegin(entity);
+           !affected && intersection_it != intersection_it_end;
+           ++intersection_it) {
+        const auto& intersection = *intersection_it;
+        if (intersection.neighbor())
+          affected = changed[index_set.index(*intersection.outside())];
+      }
+      if (affected) {
+        const auto global_indices = mapper.globalIndices(entity);
+        for (size_t ii = 0; ii < global_indices.size(); ++ii)
+          copy_row[global_indices[ii]] = false;
+      }
+    }
+    // ... as well as all rows which couple to new DoFs
+    const PatternType pattern = create_pattern_(*space_);
+    for (size_t ii = 0; ii < size; ++ii) {
+      if (copy_row[ii] && old_index[ii] == invalid_index)
+        copy_row[ii] = false;
+      for (const auto& jj : pattern.inner(ii))
+        if (copy_row[ii] && old_index[jj] == invalid_index)
+          copy_row[ii] = false;
+    }
+    // reassemble on all entities of the reassembled rows
+    std::vector< bool > reassemble(index_set.size(0), false);
+    num_reassembled_entities_ = 0;
+    for (auto entity_it = grid_view.template begin< 0 >(); entity_it != entity_it_end; ++entity_it) {
+      const EntityType& entity = *entity_it;
+      const auto global_indices = mapper.globalIndices(entity);
+      for (size_t ii = 0; ii < global_indices.size(); ++ii)
+        if (!copy_row[global_indices[ii]]) {
+          reassemble[index_set.index(entity)] = true;
+          ++num_reassembled_entities_;
+          break;
+        }
+    }
+    const auto old_system_matrix = std::move(system_matrix_);
+    const auto old_rhs_vector = std::move(rhs_vector_);
+    system_matrix_ = DSC::make_unique< MatrixType >(size, size, pattern);
+    rhs_vector_ = DSC::make_unique< VectorType >(size, RangeFieldType(0));
+    assembler_(*space_, *system_matrix_, *rhs_vector_, reassemble);
+    // copy the other rows, overwriting the partial contributions of the walk
+    for (size_t ii = 0; ii < size; ++ii)
+      if (copy_row[ii]) {
+        rhs_vector_->set_entry(ii, old_rhs_vector->get_entry(old_index[ii]));
+        for (const auto& jj : pattern.inner(ii))
+          system_matrix_->set_entry(ii, jj, old_system_matrix->get_entry(old_index[ii], old_index[jj]));
+      }
+  } // ... update_system(...)
+
+  GridType& grid_;
+  const SpaceCreatorType create_space_;
+  const AssemblerType assembler_;
+  const EstimatorType estimator_;
+  const SolverType solver_;
+  const PatternCreatorType create_pattern_;
+  std::unique_ptr< const SpaceType > space_;
+  std::unique_ptr< MatrixType > system_matrix_;
+  std::unique_ptr< VectorType > rhs_vector_;
+  std::unique_ptr< VectorType > solution_;
+  IndicatorsType indicators_;
+  size_t num_reassembled_entities_;
+}; // class Driver
+
+
+} // namespace Adaptation
+} // namespace GDT
+} // namespace Dune
+
+#endif // DUNE_GDT_PLAYGROUND_ADAPTATION_DRIVER_HH
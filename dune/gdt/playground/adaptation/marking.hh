@@ -0,0 +1,54 @@
+// This file is part of the dune-gdt project:
+//   http://users.dune-project.org/projects/dune-gdt
+// Copyright holders: Felix Schindler
+// License: BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+
+#ifndef DUNE_GDT_PLAYGROUND_ADAPTATION_MARKING_HH
+#define DUNE_GDT_PLAYGROUND_ADAPTATION_MARKING_HH
+
+#include <algorithm>
+#include <numeric>
+#include <vector>
+
+#include <dune/stuff/common/exceptions.hh>
+
+namespace Dune {
+namespace GDT {
+namespace Adaptation {
+
+
+/**
+ * \brief Marks a minimal set of entities with largest indicators, the sum of which is at least theta times the sum of
+ *        all indicators [Doerfler, 1996].
+ * \param indicators the squared local indicators eta_T^2, as returned by Estimators::ESV2007::indicators()
+ * \param theta      in (0, 1], larger values mark more entities
+ * \return           ret[ii] is true if the entity with index ii is marked
+ */
+template< class FieldType >
+std::vector< bool > doerfler_marking(const std::vector< FieldType >& indicators, const double theta)
+{
+  if (!(theta > 0) || theta > 1)
+    DUNE_THROW(Stuff::Exceptions::wrong_input_given, "theta has to be in (0, 1], is " << theta << "!");
+  std::vector< size_t > order(indicators.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::sort(order.begin(), order.end(), [&](const size_t& ii, const size_t& jj) {
+    return indicators[ii] > indicators[jj];
+  });
+  const FieldType total = std::accumulate(indicators.begin(), indicators.end(), FieldType(0));
+  std::vector< bool > ret(indicators.size(), false);
+  FieldType marked(0);
+  for (const auto& ii : order) {
+    if (!(marked < theta * total))
+      break;
+    ret[ii] = true;
+    marked += indicators[ii];
+  }
+  return ret;
+} // ... doerfler_marking(...)
+
+
+} // namespace Adaptation
+} // namespace GDT
+} // namespace Dune
+
+#endif // DUNE_GDT_PLAYGROUND_ADAPTATION_MARKING_HH
@@ -0,0 +1,282 @@
+// This file is part of the dune-gdt project:
+//   http://users.dune-project.org/projects/dune-gdt
+// Copyright holders: Felix Schindler
+// License: BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+
+#ifndef DUNE_GDT_ASSEMBLER_BLOCK_HH
+#define DUNE_GDT_ASSEMBLER_BLOCK_HH
+
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include <dune/stuff/common/exceptions.hh>
+#include <dune/stuff/common/type_utils.hh>
+#include <dune/stuff/grid/boundaryinfo.hh>
+#include <dune/stuff/la/container/interfaces.hh>
+
+#include <dune/gdt/assembler/system.hh>
+#include <dune/gdt/playground/spaces/block.hh>
+#include <dune/gdt/solvers/csr.hh>
+#include <dune/gdt/solvers/schwarz.hh>
+
+namespace Dune {
+namespace GDT {
+
+#if HAVE_DUNE_GRID_MULTISCALE
+
+
+/**
+ * \brief Assembles a system on a Spaces::Block subdomain by subdomain.
+ *
+ *        The volume terms (added local Codim0Matrix and Codim0Vector assemblers) of each subdomain are assembled by a
+ *        SystemAssembler on the respective local space into a separate local matrix and vector, one task per
+ *        subdomain (in parallel, if requested). Since each task only writes to its own block, no synchronization is
+ *        required. The face terms (added Codim1CouplingMatrix and Codim1BoundaryMatrix assemblers), which couple the
+ *        subdomains, are assembled separately afterwards, in one walk over the global grid view. matrix() and vector()
+ *        contain the complete system, ordered as the mapper of the block space, and blocks() the DoFs of each
+ *        subdomain, as required for a Schwarz preconditioner:
+\code
+BlockSystemAssembler< LocalSpaceType, MatrixType, VectorType > block_assembler(block_space);
+block_assembler.add(local_elliptic_assembler);
+block_assembler.add(local_rhs_assembler);
+block_assembler.add(local_coupling_assembler);
+block_assembler.assemble(true);
+const auto schwarz = block_assembler.schwarz(1, true);
+schwarz.apply(block_assembler.vector(), solution);
+\endcode
+ * \note  The added local assemblers are only referenced and have to outlive the call to assemble().
+ */
+template< class LocalSpaceImp, class MatrixImp, class VectorImp >
+class BlockSystemAssembler
+{
+  static_assert(Stuff::LA::is_matrix< MatrixImp >::value,
+                "MatrixImp has to be derived from Stuff::LA::MatrixInterface!");
+  static_assert(Stuff::LA::is_vector< VectorImp >::value,
+                "VectorImp has to be derived from Stuff::LA::VectorInterface!");
+public:
+  typedef LocalSpaceImp                             LocalSpaceType;
+  typedef Spaces::Block< LocalSpaceType >           SpaceType;
+  typedef MatrixImp                                 MatrixType;
+  typedef VectorImp                                 VectorType;
+  typedef typename MatrixType::ScalarType           RangeFieldType;
+  typedef typename SpaceType::GridViewType          GridViewType;
+  typedef typename SpaceType::PatternType           PatternType;
+  typedef std::vector< std::vector< size_t > >      BlocksType;
+  typedef SystemAssembler< LocalSpaceType >         LocalSystemAssemblerType;
+  typedef SystemAssembler< SpaceType >              GlobalSystemAssemblerType;
+  typedef Stuff::Grid::BoundaryInfoInterface< typename GridViewType::Intersection > BoundaryInfoType;
+
+  explicit BlockSystemAssembler(const SpaceType& spc)
+    : space_(spc)
+    , assemble_local_matrices_(false)
+    , assembled_(false)
+  {}
+
+  const SpaceType& space() const
+  {
+    return space_;
+  }
+
+  size_t num_subdomains() const
+  {
+    return space_.local_spaces().size();
+  }
+
+  template< class L >
+  void add(const LocalAssembler::Codim0Matrix< L >& local_assembler)
+  {
+    assemble_local_matrices_ = true;
+    local_additions_.emplace_back([&](LocalSystemAssemblerType& system_assembler, MatrixType& matrix, VectorType&) {
+      system_assembler.add(local_assembler, matrix);
+    });
+  } // ... add(...)
+
+  template< class L >
+  void add(const LocalAssembler::Codim0Vector< L >& local_assembler)
+  {
+    local_additions_.emplace_back([&](LocalSystemAssemblerType& system_assembler, MatrixType&, VectorType& vector) {
+      system_assembler.add(local_assembler, vector);
+    });
+  } // ... add(...)
+
+  /**
+   * \brief Adds coupling terms on all inner intersections of the global grid view (within and between subdomains).
+   */
+  template< class L >
+  void add(const LocalAssembler::Codim1CouplingMatrix< L >& local_assembler)
+  {
+    face_additions_.emplace_back([&](GlobalSystemAssemblerType& system_assembler, MatrixType& matrix) {
+      system_assembler.add(local_assembler,
+                           matrix,
+                           new Stuff::Grid::ApplyOn::InnerIntersectionsPrimally< GridViewType >());
+    });
+  } // ... add(...)
+
+  /**
+   * \brief Adds boundary terms on all Dirichlet intersections of the global grid view.
+   * \note  boundary_info has to outlive the call to assemble().
+   */
+  template< class L >
+  void add(const LocalAssembler::Codim1BoundaryMatrix< L >& local_assembler, const BoundaryInfoType& boundary_info)
+  {
+    face_additions_.emplace_back([&](GlobalSystemAssemblerType& system_assembler, MatrixType& matrix) {
+      system_assembler.add(local_assembler,
+                           matrix,
+                           new Stuff::Grid::ApplyOn::DirichletIntersections< GridViewType >(boundary_info));
+    });
+  } // ... add(...)
+
+  void assemble(const bool use_tbb = false)
+  {
+    const auto& local_spaces = space_.local_spaces();
+    const auto& mapper = space_.mapper();
+    local_matrices_ = std::vector< MatrixType >(local_spaces.size());
+    local_vectors_ = std::vector< VectorType >(local_spaces.size());
+    // the volume terms, one task per subdomain
+    const auto assemble_subdomains = [&](const size_t first, const size_t last) {
+      for (size_t ss = first; ss < last; ++ss) {
+        const auto& local_space = *local_spaces[ss];
+        const size_t local_size = local_space.mapper().size();
+        local_matrices_[ss] = MatrixType(local_size,
+                                         local_size,
+                                         assemble_local_matrices_ ? local_space.compute_volume_pattern()
+                                                                  : typename LocalSpaceType::PatternType(local_size));
+        local_vectors_[ss] = VectorType(local_size, RangeFieldType(0));
+        LocalSystemAssemblerType system_assembler(local_space);
+        for (const auto& local_addition : local_additions_)
+          local_addition(system_assembler, local_matrices_[ss], local_vectors_[ss]);
+        system_assembler.assemble(false);
+      }
+    };
+    Solvers::internal::for_each_range(local_spaces.size(), use_tbb, assemble_subdomains);
+    // the global pattern
+    PatternType pattern = face_additions_.empty() ? PatternType(mapper.size()) : space_.compute_face_pattern();
+    std::vector< Solvers::internal::CsrMatrix< RangeFieldType > > local_csr_matrices(local_spaces.size());
+    if (assemble_local_matrices_)
+      for (size_t ss = 0; ss < local_spaces.size(); ++ss) {
+        local_csr_matrices[ss] = Solvers::internal::to_csr(local_matrices_[ss]);
+        const auto& local_matrix = local_csr_matrices[ss];
+        for (size_t ii = 0; ii < local_matrix.rows(); ++ii) {
+          auto& row = pattern.inner(mapper.mapToGlobal(ss, ii));
+          for (size_t kk = local_matrix.row_begin(ii); kk < local_matrix.row_end(ii); ++kk)
+            row.push_back(mapper.mapToGlobal(ss, local_matrix.column_index(kk)));
+        }
+      }
+    for (size_t ii = 0; ii < mapper.size(); ++ii) {
+      auto& row = pattern.inner(ii);
+      std::sort(row.begin(), row.end());
+      row.erase(std::unique(row.begin(), row.end()), row.end());
+    }
+    // copy the blocks
+    matrix_ = MatrixType(mapper.size(), mapper.size(), pattern);
+    vector_ = VectorType(mapper.size(), RangeFieldType(0));
+    for (size_t ss = 0; ss < local_spaces.size(); ++ss) {
+      const auto& local_matrix = local_csr_matrices[ss];
+      for (size_t ii = 0; ii < local_matrix.rows(); ++ii)
+        for (size_t kk = local_matrix.row_begin(ii); kk < local_matrix.row_end(ii); ++kk)
+          matrix_.add_to_entry(mapper.mapToGlobal(ss, ii),
+                               mapper.mapToGlobal(ss, local_matrix.column_index(kk)),
+                               local_matrix.value(kk));
+      for (size_t ii = 0; ii < local_vectors_[ss].size(); ++ii)
+        vector_.set_entry(mapper.mapToGlobal(ss, ii), local_vectors_[ss].get_entry(ii));
+    }
+    // the face terms
+    if (!face_additions_.empty()) {
+      GlobalSystemAssemblerType system_assembler(space_);
+      for (const auto& face_addition : face_additions_)
+        face_addition(system_assembler, matrix_);
+      system_assembler.assemble(use_tbb);
+    }
+    assembled_ = true;
+  } // ... assemble(...)
+
+  /**
+   * \brief The volume terms of subdomain ss, w.r.t. the local space.
+   */
+  const MatrixType& local_matrix(const size_t ss) const
+  {
+    check_assembled(ss);
+    return local_matrices_[ss];
+  }
+
+  const VectorType& local_vector(const size_t ss) const
+  {
+    check_assembled(ss);
+    return local_vectors_[ss];
+  }
+
+  const MatrixType& matrix() const
+  {
+    check_assembled(0);
+    return matrix_;
+  }
+
+  const VectorType& vector() const
+  {
+    check_assembled(0);
+    return vector_;
+  }
+
+  /**
+   * \brief The global DoFs of each subdomain.
+   */
+  BlocksType blocks() const
+  {
+    const auto& mapper = space_.mapper();
+    BlocksType ret(mapper.numBlocks());
+    for (size_t ss = 0; ss < ret.size(); ++ss) {
+      ret[ss].resize(mapper.localSize(ss));
+      for (size_t ii = 0; ii < ret[ss].size(); ++ii)
+        ret[ss][ii] = mapper.mapToGlobal(ss, ii);
+    }
+    return ret;
+  } // ... blocks(...)
+
+  /**
+   * \brief A Schwarz preconditioner for matrix(), with one local problem per subdomain.
+   */
+  Solvers::Schwarz< MatrixType, VectorType > schwarz(const size_t overlap = 1, const bool use_tbb = false) const
+  {
+    return Solvers::Schwarz< MatrixType, VectorType >(matrix(), blocks(), overlap, use_tbb);
+  }
+
+private:
+  void check_assembled(const size_t ss) const
+  {
+    if (!assembled_)
+      DUNE_THROW(Stuff::Exceptions::you_are_using_this_wrong, "Call assemble() first!");
+    if (ss >= num_subdomains())
+      DUNE_THROW(Stuff::Exceptions::wrong_input_given,
+                 "Given subdomain " << ss << ", there are only " << num_subdomains() << "!");
+  } // ... check_assembled(...)
+
+  const SpaceType space_;
+  bool assemble_local_matrices_;
+  bool assembled_;
+  std::vector< std::function< void(LocalSystemAssemblerType&, MatrixType&, VectorType&) > > local_additions_;
+  std::vector< std::function< void(GlobalSystemAssemblerType&, MatrixType&) > > face_additions_;
+  std::vector< MatrixType > local_matrices_;
+  std::vector< VectorType > local_vectors_;
+  MatrixType matrix_;
+  VectorType vector_;
+}; // class BlockSystemAssembler
+
+
+#else // HAVE_DUNE_GRID_MULTISCALE
+
+
+template< class LocalSpaceImp, class MatrixImp, class VectorImp >
+class BlockSystemAssembler
+{
+  static_assert(AlwaysFalse< LocalSpaceImp >::value, "You are missing dune-grid-multiscale!");
+};
+
+
+#endif // HAVE_DUNE_GRID_MULTISCALE
+
+} // namespace GDT
+} // namespace Dune
+
+#endif // DUNE_GDT_ASSEMBLER_BLOCK_HH
@@ -0,0 +1,263 @@
+// This file is part of the dune-gdt project:
+//   http://users.dune-project.org/projects/dune-gdt
+// Copyright holders: Felix Schindler
+// License: BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+
+#ifndef DUNE_GDT_PLAYGROUND_ESTIMATORS_ESV2007_HH
+#define DUNE_GDT_PLAYGROUND_ESTIMATORS_ESV2007_HH
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <vector>
+
+#include <dune/common/dynmatrix.hh>
+
+#include <dune/stuff/common/exceptions.hh>
+#include <dune/stuff/functions/ESV2007.hh>
+#include <dune/stuff/grid/walker.hh>
+#include <dune/stuff/la/container/interfaces.hh>
+
+#include <dune/gdt/assembler/functors.hh>
+#include <dune/gdt/discretefunction/default.hh>
+#include <dune/gdt/localevaluation/elliptic.hh>
+#include <dune/gdt/localevaluation/product.hh>
+#include <dune/gdt/localoperator/codim0.hh>
+#include <dune/gdt/operators/fluxreconstruction.hh>
+#include <dune/gdt/operators/oswaldinterpolation.hh>
+#include <dune/gdt/operators/projections.hh>
+#include <dune/gdt/playground/localevaluation/ESV2007.hh>
+#include <dune/gdt/spaces/fv/default.hh>
+#include <dune/gdt/spaces/rt/pdelab.hh>
+
+namespace Dune {
+namespace GDT {
+namespace Estimators {
+
+
+/**
+ * \brief The a posteriori error estimator of [Ern, Stephansen, Vohralik, 2007] for (SWIP)DG discretizations of
+ *        elliptic problems, eta^2 = sum_T eta_T^2, where
+ *        eta_T^2 = eta_nc,T^2 + (eta_r,T + eta_df,T)^2
+ *        is the indicator of the entity T with the nonconformity (eta_nc), residual (eta_r) and diffusive flux (eta_df)
+ *        contributions.
+ *
+ *        The Oswald interpolation of the solution, the projection of the force onto piecewise constants and the
+ *        diffusive flux reconstruction are computed once per estimate(). All contributions of all entities are then
+ *        computed in one grid walk, in parallel if requested.
+\code
+Estimators::ESV2007< SpaceType, VectorType, DiffusionType, ForceType > estimator(space, diffusion, force);
+const auto eta = estimator.estimate(solution_vector, true);
+const auto& indicators = estimator.indicators(); // to mark entities for refinement
+\endcode
+ * \note  Only implemented for piecewise linear DG spaces in 2d and scalar diffusion. diffusion and force have to
+ *        outlive this estimator.
+ */
+template< class SpaceImp, class VectorImp, class DiffusionImp, class ForceImp,
+          class GridViewImp = typename SpaceImp::GridViewType >
+class ESV2007
+{
+  static_assert(Stuff::LA::is_vector< VectorImp >::value,
+                "VectorImp has to be derived from Stuff::LA::VectorInterface!");
+public:
+  typedef SpaceImp                                           SpaceType;
+  typedef VectorImp                                          VectorType;
+  typedef DiffusionImp                                       DiffusionType;
+  typedef ForceImp                                           ForceType;
+  typedef GridViewImp                                        GridViewType;
+  typedef typename GridViewType::template Codim< 0 >::Entity EntityType;
+  typedef typename SpaceType::RangeFieldType                 RangeFieldType;
+  static const size_t                                        dimDomain = GridViewType::dimension;
+  /// one value per entity, indexed by the index set of the grid view
+  typedef std::vector< RangeFieldType >                      IndicatorsType;
+
+private:
+  struct LocalStorage
+  {
+    explicit LocalStorage(const size_t num_tmp_matrices)
+      : tmp_matrices(num_tmp_matrices, DynamicMatrix< RangeFieldType >(1, 1, 0.0))
+      , local_result(1, 1, 0.0)
+    {}
+
+    std::vector< DynamicMatrix< RangeFieldType > > tmp_matrices;
+    DynamicMatrix< RangeFieldType > local_result;
+  }; // struct LocalStorage
+
+public:
+  ESV2007(const SpaceType& spc,
+          const GridViewType& grid_view,
+          const DiffusionType& diffusion,
+          const ForceType& force,
+          const size_t over_integrate = 1)
+    : space_(spc)
+    , grid_view_(grid_view)
+    , diffusion_(diffusion)
+    , force_(force)
+    , over_integrate_(over_integrate)
+    , oswald_interpolation_operator_(grid_view_)
+  {}
+
+  ESV2007(const SpaceType& spc, const DiffusionType& diffusion, const ForceType& force, const size_t over_integrate = 1)
+    : space_(spc)
+    , grid_view_(spc.grid_view())
+    , diffusion_(diffusion)
+    , force_(force)
+    , over_integrate_(over_integrate)
+    , oswald_interpolation_operator_(grid_view_)
+  {}
+
+  /**
+   * \brief Computes all indicators for the solution given by solution_vector and returns the estimate eta.
+   */
+  RangeFieldType estimate(const VectorType& solution_vector, const bool use_tbb = false)
+  {
+    if (solution_vector.size() != space_.mapper().size())
+      DUNE_THROW(Stuff::Exceptions::shapes_do_not_match,
+                 "The size of solution_vector (" << solution_vector.size() << ") does not match the size of the space ("
+                 << space_.mapper().size() << ")!");
+    const ConstDiscreteFunction< SpaceType, VectorType > discrete_solution(space_, solution_vector);
+    // the global computations
+    VectorType oswald_interpolation_vector(space_.mapper().size());
+    DiscreteFunction< SpaceType, VectorType > oswald_interpolation(space_, oswald_interpolation_vector);
+    oswald_interpolation_operator_.apply(discrete_solution, oswald_interpolation, use_tbb);
+    typedef Spaces::FV::Default< GridViewType, RangeFieldType, 1, 1 > P0SpaceType;
+    const P0SpaceType p0_space(grid_view_);
+    VectorType p0_force_vector(p0_space.mapper().size());
+    DiscreteFunction< P0SpaceType, VectorType > p0_force(p0_space, p0_force_vector);
+    Operators::Projection< GridViewType >(grid_view_).apply(force_, p0_force);
+    typedef Spaces::RT::PdelabBased< GridViewType, 0, RangeFieldType, dimDomain > RTN0SpaceType;
+    typedef DiscreteFunction< RTN0SpaceType, VectorType >                         RTN0DiscreteFunctionType;
+    const RTN0SpaceType rtn0_space(grid_view_);
+    VectorType diffusive_flux_vector(rtn0_space.mapper().size());
+    RTN0DiscreteFunctionType diffusive_flux(rtn0_space, diffusive_flux_vector);
+    Operators::DiffusiveFluxReconstruction< GridViewType, DiffusionType >(grid_view_, diffusion_)
+        .apply(discrete_solution, diffusive_flux, use_tbb);
+    // the local contributions
+    const LocalOperator::Codim0Integral< LocalEvaluation::Elliptic< DiffusionType > >
+        local_nonconformity_product(over_integrate_, diffusion_);
+    const auto nonconformity_difference = discrete_solution - oswald_interpolation;
+    typedef Stuff::Functions::ESV2007::Cutoff< DiffusionType > CutoffFunctionType;
+    const CutoffFunctionType cutoff_function(diffusion_);
+    const LocalOperator::Codim0Integral< LocalEvaluation::Product< CutoffFunctionType > >
+        local_residual_product(over_integrate_, cutoff_function);
+    const auto residual_difference = force_ - p0_force;
+    const LocalOperator::Codim0Integral< LocalEvaluation::ESV2007::DiffusiveFluxEstimate< DiffusionType,
+                                                                                        RTN0DiscreteFunctionType > >
+        local_diffusive_flux_product(over_integrate_, diffusion_, diffusive_flux);
+    const size_t num_entities = grid_view_.indexSet().size(0);
+    nonconformity_indicators_ = IndicatorsType(num_entities, RangeFieldType(0));
+    residual_indicators_ = IndicatorsType(num_entities, RangeFieldType(0));
+    diffusive_flux_indicators_ = IndicatorsType(num_entities, RangeFieldType(0));
+    indicators_ = IndicatorsType(num_entities, RangeFieldType(0));
+    // each entity only writes to its own indicators
+    const auto local_indicators = [&](const EntityType& entity, LocalStorage& storage) {
+      const size_t index = grid_view_.indexSet().index(entity);
+      const auto local_nonconformity_difference = nonconformity_difference.local_function(entity);
+      nonconformity_indicators_[index] = apply_local(local_nonconformity_product, *local_nonconformity_difference,
+                                                     storage);
+      const auto local_residual_difference = residual_difference.local_function(entity);
+      residual_indicators_[index] = apply_local(local_residual_product, *local_residual_difference, storage);
+      const auto local_discrete_solution = discrete_solution.local_function(entity);
+      diffusive_flux_indicators_[index] = apply_local(local_diffusive_flux_product, *local_discrete_solution,
+                                                      storage);
+      indicators_[index] = nonconformity_indicators_[index]
+                           + std::pow(std::sqrt(residual_indicators_[index])
+                                      + std::sqrt(diffusive_flux_indicators_[index]), 2);
+    }; // ... local_indicators(...)
+    GDT::internal::Codim0LambdaFunctor< GridViewType, LocalStorage >
+        functor(local_indicators, std::max(std::max(local_nonconformity_product.numTmpObjectsRequired(),
+                                                    local_residual_product.numTmpObjectsRequired()),
+                                           local_diffusive_flux_product.numTmpObjectsRequired()));
+    Stuff::Grid::Walker< GridViewType > walker(grid_view_);
+    walker.add(functor);
+    walker.walk(use_tbb);
+    return std::sqrt(sum(indicators_));
+  } // ... estimate(...)
+
+  /**
+   * \brief The squared indicators eta_T^2 of all entities, as computed by the last call of estimate().
+   */
+  const IndicatorsType& indicators() const
+  {
+    return indicators_;
+  }
+
+  /// \name The squared contributions eta_nc,T^2, eta_r,T^2 and eta_df,T^2 of all entities.
+  /// \{
+
+  const IndicatorsType& nonconformity_indicators() const
+  {
+    return nonconformity_indicators_;
+  }
+
+  const IndicatorsType& residual_indicators() const
+  {
+    return residual_indicators_;
+  }
+
+  const IndicatorsType& diffusive_flux_indicators() const
+  {
+    return diffusive_flux_indicators_;
+  }
+
+  /// \}
+  /// \name The global contributions eta_nc, eta_r and eta_df.
+  /// \{
+
+  RangeFieldType nonconformity_estimate() const
+  {
+    return std::sqrt(sum(nonconformity_indicators_));
+  }
+
+  RangeFieldType residual_estimate() const
+  {
+    return std::sqrt(sum(residual_indicators_));
+  }
+
+  RangeFieldType diffusive_flux_estimate() const
+  {
+    return std::sqrt(sum(diffusive_flux_indicators_));
+  }
+
+  /// \}
+
+private:
+  template< class LocalOperatorType, class LocalFunctionType >
+  static RangeFieldType apply_local(const LocalOperatorType& local_operator,
+                                    const LocalFunctionType& local_function,
+                                    LocalStorage& storage)
+  {
+    storage.local_result *= 0.0;
+    local_operator.apply(local_function, local_function, storage.local_result, storage.tmp_matrices);
+    assert(storage.local_result.rows() >= 1);
+    assert(storage.local_result.cols() >= 1);
+    return storage.local_result[0][0];
+  } // ... apply_local(...)
+
+  static RangeFieldType sum(const IndicatorsType& indicators)
+  {
+    RangeFieldType ret(0);
+    for (const auto& indicator : indicators)
+      ret += indicator;
+    return ret;
+  }
+
+  const SpaceType& space_;
+  const GridViewType grid_view_;
+  const DiffusionType& diffusion_;
+  const ForceType& force_;
+  const size_t over_integrate_;
+  // keeps the vertex to DoF adjacency for subsequent calls of estimate()
+  const Operators::OswaldInterpolation< GridViewType > oswald_interpolation_operator_;
+  IndicatorsType nonconformity_indicators_;
+  IndicatorsType residual_indicators_;
+  IndicatorsType diffusive_flux_indicators_;
+  IndicatorsType indicators_;
+}; // class ESV2007
+
+
+} // namespace Estimators
+} // namespace GDT
+} // namespace Dune
+
+#endif // DUNE_GDT_PLAYGROUND_ESTIMATORS_ESV2007_HH
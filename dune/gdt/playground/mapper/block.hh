@@ -6,6 +6,10 @@
 #ifndef DUNE_GDT_MAPPER_BLOCK_HH
 #define DUNE_GDT_MAPPER_BLOCK_HH
 
+#include <cstdint>
+#include <limits>
+#include <vector>
+
 #include <dune/stuff/common/exceptions.hh>
 #include <dune/stuff/common/type_utils.hh>
 
@@ -76,66 +80,45 @@ private:
     typedef typename MsGridType::EntityType Comdim0EntityType;
 
   public:
-    static size_t numDofs(const MsGridType& ms_grid,
-                          const std::vector< std::shared_ptr< const L > >& local_spaces,
+    static size_t numDofs(const std::vector< std::shared_ptr< const L > >& local_spaces,
+                          const size_t block,
                           const Comdim0EntityType& entity)
     {
-      const size_t block = find_block_of_(ms_grid, entity);
       return local_spaces[block]->mapper().numDofs(entity);
     }
 
-    static void globalIndices(const MsGridType& ms_grid,
-                              const std::vector< std::shared_ptr< const L > >& local_spaces,
+    static void globalIndices(const std::vector< std::shared_ptr< const L > >& local_spaces,
                               const std::vector< size_t >& global_start_indices,
+                              const size_t block,
                               const Comdim0EntityType& entity,
                               Dune::DynamicVector< size_t >& ret)
     {
-      const size_t block = find_block_of_(ms_grid, entity);
-      local_spaces[block]->mapper().globalIndices(entity, ret);
-      const size_t num_dofs = local_spaces[block]->mapper().numDofs(entity);
+      const auto& local_mapper = local_spaces[block]->mapper();
+      local_mapper.globalIndices(entity, ret);
+      const size_t num_dofs = local_mapper.numDofs(entity);
       assert(ret.size() >= num_dofs);
+      const size_t global_start_index = global_start_indices[block];
       for (size_t ii = 0; ii < num_dofs; ++ii)
-        ret[ii] += global_start_indices[block];
+        ret[ii] += global_start_index;
     }
 
-    static size_t mapToGlobal(const MsGridType& ms_grid,
-                              const std::vector< std::shared_ptr< const L > >& local_spaces,
+    static size_t mapToGlobal(const std::vector< std::shared_ptr< const L > >& local_spaces,
                               const std::vector< size_t >& global_start_indices,
+                              const size_t block,
                               const Comdim0EntityType& entity,
                               const size_t& localIndex)
     {
-      const size_t block = find_block_of_(ms_grid, entity);
-      const size_t block_local_index = local_spaces[block]->mapper().mapToGlobal(entity, localIndex);
-      return global_start_indices[block] + block_local_index;
+      return global_start_indices[block] + local_spaces[block]->mapper().mapToGlobal(entity, localIndex);
     }
-
-  private:
-    static size_t find_block_of_(const MsGridType& ms_grid, const Comdim0EntityType& entity)
-    {
-      const auto global_entity_index = ms_grid.globalGridView().indexSet().index(entity);
-      const auto result = ms_grid.entityToSubdomainMap()->find(global_entity_index);
-  #ifndef NDEBUG
-      if (result == ms_grid.entityToSubdomainMap()->end())
-        DUNE_THROW(Stuff::Exceptions::internal_error,
-                              "Entity " << global_entity_index
-                              << " of the global grid view was not found in the multiscale grid!");
-  #endif // NDEBUG
-      const size_t subdomain = result->second;
-  #ifndef NDEBUG
-      if (subdomain >= ms_grid.size())
-        DUNE_THROW(Stuff::Exceptions::internal_error,
-                              "The multiscale grid is corrupted!\nIt reports Entity " << global_entity_index
-                              << " to be in subdomain " << subdomain << " while only having "
-                              << ms_grid.size() << " subdomains!");
-  #endif // NDEBUG
-      return subdomain;
-    } // ... find_block_of_(...)
   }; // class Compute< ..., EntityType >
 
+  typedef typename MsGridType::GlobalGridViewType GlobalGridViewType;
+
 public:
   Block(const std::shared_ptr< const MsGridType > ms_grid,
         const std::vector< std::shared_ptr< const LocalSpaceType > > local_spaces)
     : ms_grid_(ms_grid)
+    , global_grid_view_(ms_grid_->globalGridView())
     , local_spaces_(local_spaces)
     , num_blocks_(local_spaces_.size())
     , size_(0)
@@ -151,6 +134,7 @@ public:
       global_start_indices_.push_back(size_);
       size_ += local_spaces_[bb]->mapper().size();
     }
+    build_entity_to_block_table();
   } // Block(...)
 
   size_t numBlocks() const
@@ -185,32 +169,78 @@ public:
     return max_num_dofs_;
   }
 
+  /**
+   * \brief The subdomain of the multiscale grid, which contains entity.
+   */
+  size_t blockOf(const EntityType& entity) const
+  {
+    const size_t global_entity_index = global_grid_view_.indexSet().index(entity);
+    assert(global_entity_index < entity_to_block_.size());
+    return entity_to_block_[global_entity_index];
+  }
+
   size_t numDofs(const EntityType& entity) const
   {
-    return Compute< LocalSpaceType, EntityType >::numDofs(*ms_grid_, local_spaces_, entity);
+    return Compute< LocalSpaceType, EntityType >::numDofs(local_spaces_, blockOf(entity), entity);
   }
 
   void globalIndices(const EntityType& entity, Dune::DynamicVector< size_t >& ret) const
   {
-    Compute< LocalSpaceType, EntityType >::globalIndices(*ms_grid_, local_spaces_, global_start_indices_, entity, ret);
+    Compute< LocalSpaceType, EntityType >::globalIndices(local_spaces_,
+                                                         global_start_indices_,
+                                                         blockOf(entity),
+                                                         entity,
+                                                         ret);
   }
 
   size_t mapToGlobal(const EntityType& entity, const size_t& localIndex) const
   {
-    return Compute< LocalSpaceType, EntityType >::mapToGlobal(*ms_grid_,
-                                                              local_spaces_,
+    return Compute< LocalSpaceType, EntityType >::mapToGlobal(local_spaces_,
                                                               global_start_indices_,
+                                                              blockOf(entity),
                                                               entity,
                                                               localIndex);
   } // ... mapToGlobal(...)
 
 private:
+  /**
+   * The entity to subdomain map of the multiscale grid is a search structure, we thus copy it once into a table
+   * indexed by the index set of the global grid view.
+   */
+  void build_entity_to_block_table()
+  {
+    static const uint32_t invalid = std::numeric_limits< uint32_t >::max();
+    if (num_blocks_ >= invalid)
+      DUNE_THROW(Stuff::Exceptions::internal_error,
+                 "The number of subdomains (" << num_blocks_ << ") exceeds the supported range!");
+    entity_to_block_ = std::vector< uint32_t >(global_grid_view_.indexSet().size(0), invalid);
+    for (const auto& element : *(ms_grid_->entityToSubdomainMap())) {
+      const size_t global_entity_index = element.first;
+      const size_t subdomain = element.second;
+      if (global_entity_index >= entity_to_block_.size())
+        DUNE_THROW(Stuff::Exceptions::internal_error,
+                   "The multiscale grid is corrupted!\nIt reports Entity " << global_entity_index << " while the "
+                   << "global grid view only has " << entity_to_block_.size() << " entities!");
+      if (subdomain >= num_blocks_)
+        DUNE_THROW(Stuff::Exceptions::internal_error,
+                   "The multiscale grid is corrupted!\nIt reports Entity " << global_entity_index
+                   << " to be in subdomain " << subdomain << " while only having " << num_blocks_ << " subdomains!");
+      entity_to_block_[global_entity_index] = static_cast< uint32_t >(subdomain);
+    }
+    for (size_t ii = 0; ii < entity_to_block_.size(); ++ii)
+      if (entity_to_block_[ii] == invalid)
+        DUNE_THROW(Stuff::Exceptions::internal_error,
+                   "Entity " << ii << " of the global grid view was not found in the multiscale grid!");
+  } // ... build_entity_to_block_table(...)
+
   std::shared_ptr< const MsGridType > ms_grid_;
+  GlobalGridViewType global_grid_view_;
   std::vector< std::shared_ptr< const LocalSpaceType > > local_spaces_;
   size_t num_blocks_;
   size_t size_;
   size_t max_num_dofs_;
   std::vector< size_t > global_start_indices_;
+  std::vector< uint32_t > entity_to_block_;
 }; // class Block
 
 
@@ -47,8 +47,12 @@ public:
 
   template< class GV, class V >
   void apply(const Stuff::LocalizableFunctionInterface< EntityType, DomainFieldType, dimDomain, FieldType, 1 >& source,
-             DiscreteFunction< Spaces::RT::PdelabBased< GV, 0, FieldType, dimDomain >, V >& range) const
+             DiscreteFunction< Spaces::RT::PdelabBased< GV, 0, FieldType, dimDomain >, V >& range,
+             const bool use_tbb = false) const
   {
+    typedef typename Spaces::RT::PdelabBased< GV, 0, FieldType, dimDomain >::BaseFunctionSetType::RangeType
+        BasisRangeType;
+    typedef internal::DiffusiveFluxReconstructionStorage< FieldType, BasisRangeType > StorageType;
     const auto& rtn0_space = range.space();
     auto& range_vector = range.vector();
     const FieldType infinity = std::numeric_limits< FieldType >::infinity();
@@ -59,18 +63,9 @@ public:
     const LocalEvaluation::SWIPDG::BoundaryLHS< DiffusionFactorType, DiffusionTensorType >
         boundary_evaluation(diffusion_factor_, diffusion_tensor_);
     const Stuff::Functions::Constant< EntityType, DomainFieldType, dimDomain, FieldType, 1 > constant_one(1);
-    DomainType normal(0);
-    DomainType xx_entity(0);
-    DynamicMatrix< FieldType > tmp_matrix(1, 1, 0);
-    DynamicMatrix< FieldType > tmp_matrix_en_en(1, 1, 0);
-    DynamicMatrix< FieldType > tmp_matrix_en_ne(1, 1, 0);
-    std::vector< typename Spaces::RT::PdelabBased< GV, 0, FieldType, dimDomain >::BaseFunctionSetType::RangeType >
-        basis_values(rtn0_space.mapper().maxNumDofs(),
-                     typename Spaces::RT::PdelabBased< GV, 0, FieldType, dimDomain >::BaseFunctionSetType::RangeType(0));
-    // walk the grid
-    const auto entity_it_end = grid_view_.template end< 0 >();
-    for (auto entity_it = grid_view_.template begin< 0 >(); entity_it != entity_it_end; ++entity_it) {
-      const auto& entity = *entity_it;
+    const auto local_reconstruction = [&](const EntityType& entity, StorageType& storage) {
+      DomainType normal(0);
+      DomainType xx_entity(0);
       const auto local_DoF_indices = rtn0_space.local_DoF_indices(entity);
       const auto global_DoF_indices = rtn0_space.mapper().globalIndices(entity);
       assert(global_DoF_indices.size() == local_DoF_indices.size());
@@ -116,11 +111,11 @@ public:
               const FieldType integration_factor = intersection.geometry().integrationElement(xx_intersection);
               const FieldType weigth = quadrature_it->weight();
               // evalaute
-              local_basis.evaluate(xx_entity, basis_values);
-              const auto& basis_value = basis_values[local_DoF_index];
-              tmp_matrix *= 0.0;
-              tmp_matrix_en_en *= 0.0;
-              tmp_matrix_en_ne *= 0.0;
+              local_basis.evaluate(xx_entity, storage.basis_values);
+              const auto& basis_value = storage.basis_values[local_DoF_index];
+              storage.tmp_matrix *= 0.0;
+              storage.tmp_matrix_en_en *= 0.0;
+              storage.tmp_matrix_en_ne *= 0.0;
               inner_evaluation.evaluate(*local_diffusion_factor,
                                         *local_diffusion_tensor,
                                         *local_diffusion_factor_neighbor,
@@ -131,17 +126,17 @@ public:
                                         *local_source_neighbor,
                                         intersection,
                                         xx_intersection,
-                                        tmp_matrix_en_en, // <- we are interested in this one
-                                        tmp_matrix,
-                                        tmp_matrix_en_ne, // <- and this one
-                                        tmp_matrix);
+                                        storage.tmp_matrix_en_en, // <- we are interested in this one
+                                        storage.tmp_matrix,
+                                        storage.tmp_matrix_en_ne, // <- and this one
+                                        storage.tmp_matrix);
               // compute integrals
-              assert(tmp_matrix_en_en.rows() >= 1);
-              assert(tmp_matrix_en_en.cols() >= 1);
-              assert(tmp_matrix_en_ne.rows() >= 1);
-              assert(tmp_matrix_en_ne.cols() >= 1);
+              assert(storage.tmp_matrix_en_en.rows() >= 1);
+              assert(storage.tmp_matrix_en_en.cols() >= 1);
+              assert(storage.tmp_matrix_en_ne.rows() >= 1);
+              assert(storage.tmp_matrix_en_ne.cols() >= 1);
               lhs += integration_factor * weigth * (basis_value * normal);
-              rhs += integration_factor * weigth * (tmp_matrix_en_en[0][0] + tmp_matrix_en_ne[0][0]);
+              rhs += integration_factor * weigth * (storage.tmp_matrix_en_en[0][0] + storage.tmp_matrix_en_ne[0][0]);
             } // do a face quadrature
             // set DoF
             const size_t global_DoF_index = global_DoF_indices[local_DoF_index];
@@ -169,21 +164,21 @@ public:
             const FieldType weigth = quadrature_it->weight();
             xx_entity = intersection.geometryInInside().global(xx_intersection);
             // evalaute
-            local_basis.evaluate(xx_entity, basis_values);
-            const auto& basis_value = basis_values[local_DoF_index];
-            tmp_matrix *= 0.0;
+            local_basis.evaluate(xx_entity, storage.basis_values);
+            const auto& basis_value = storage.basis_values[local_DoF_index];
+            storage.tmp_matrix *= 0.0;
             boundary_evaluation.evaluate(*local_diffusion_factor,
                                          *local_diffusion_tensor,
                                          *local_constant_one,
                                          *local_source,
                                          intersection,
                                          xx_intersection,
-                                         tmp_matrix);
+                                         storage.tmp_matrix);
             // compute integrals
-            assert(tmp_matrix.rows() >= 1);
-            assert(tmp_matrix.cols() >= 1);
+            assert(storage.tmp_matrix.rows() >= 1);
+            assert(storage.tmp_matrix.cols() >= 1);
             lhs += integration_factor * weigth * (basis_value * normal);
-            rhs += integration_factor * weigth * tmp_matrix[0][0];
+            rhs += integration_factor * weigth * storage.tmp_matrix[0][0];
           } // do a face quadrature
           // set DoF
           const size_t global_DoF_index = global_DoF_indices[local_DoF_index];
@@ -193,7 +188,13 @@ public:
         } else
           DUNE_THROW(Stuff::Exceptions::internal_error, "Unknown intersection type!");
       } // walk the intersections
-    } // walk the grid
+    }; // ... local_reconstruction(...)
+    // each face (and thus each DoF) is handled by one of its entities only
+    GDT::internal::Codim0LambdaFunctor< GridViewType, StorageType >
+        functor(local_reconstruction, rtn0_space.mapper().maxNumDofs());
+    Stuff::Grid::Walker< GridViewType > walker(grid_view_);
+    walker.add(functor);
+    walker.walk(use_tbb);
   } // ... apply(...)
 
 private:
@@ -164,28 +164,12 @@ public:
   }
 
 private:
-  template< class EntityType >
   size_t find_block_of_(const EntityType& entity) const
   {
-    const auto global_entity_index = ms_grid_->globalGridView().indexSet().index(entity);
-    const auto result = ms_grid_->entityToSubdomainMap()->find(global_entity_index);
-#ifndef NDEBUG
-    if (result == ms_grid_->entityToSubdomainMap()->end())
-      DUNE_THROW(Stuff::Exceptions::internal_error,
-                            "Entity " << global_entity_index
-                            << " of the global grid view was not found in the multiscale grid!");
-#endif // NDEBUG
-    const size_t subdomain = result->second;
-#ifndef NDEBUG
-    if (subdomain >= ms_grid_->size())
-      DUNE_THROW(Stuff::Exceptions::internal_error,
-                            "The multiscale grid is corrupted!\nIt reports Entity " << global_entity_index
-                            << " to be in subdomain " << subdomain << " while only having "
-                            << ms_grid_->size() << " subdomains!");
-#endif // NDEBUG
+    const size_t subdomain = mapper_->blockOf(entity);
     assert(subdomain < local_spaces_.size());
     return subdomain;
-  } // ... find_block_of_(...)
+  }
 
   const std::shared_ptr< const MsGridType > ms_grid_;
   const GridViewType grid_view_;
@@ -0,0 +1,382 @@
+// This file is part of the dune-gdt project:
+//   http://users.dune-project.org/projects/dune-gdt
+// Copyright holders: Felix Schindler
+// License: BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+
+#ifndef DUNE_GDT_SOLVERS_BLOCK_JACOBI_HH
+#define DUNE_GDT_SOLVERS_BLOCK_JACOBI_HH
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include <dune/common/dynmatrix.hh>
+
+#include <dune/stuff/common/configuration.hh>
+#include <dune/stuff/common/exceptions.hh>
+#include <dune/stuff/grid/walker.hh>
+#include <dune/stuff/la/container.hh>
+
+#include <dune/gdt/spaces/interface.hh>
+
+#include "csr.hh"
+#include "krylov.hh"
+
+namespace Dune {
+namespace GDT {
+namespace Solvers {
+namespace internal {
+
+
+/**
+ * \brief The inverses of the diagonal blocks of a matrix for the given (disjoint) sets of DoFs, rows which are not
+ *        contained in any block are treated pointwise (which gives the Jacobi method for no blocks at all).
+ *
+ *        Rows which only contain a 1 on the diagonal (as produced by Spaces::DirichletConstraints) are treated as
+ *        constrained and are never damped.
+ */
+template< class RangeFieldImp >
+class InverseBlocks
+{
+public:
+  typedef RangeFieldImp                        RangeFieldType;
+  typedef CsrMatrix< RangeFieldType >          MatrixType;
+  typedef std::vector< RangeFieldType >        VectorType;
+  typedef std::vector< std::vector< size_t > > BlocksType;
+
+  InverseBlocks() {}
+
+  InverseBlocks(const MatrixType& matrix, const BlocksType& blocks, const bool use_tbb)
+    : blocks_(blocks)
+    , inverse_blocks_(blocks_.size())
+    , in_block_(matrix.rows(), false)
+    , inverse_diagonal_(matrix.rows(), RangeFieldType(0))
+    , constrained_(matrix.unit_rows())
+  {
+    for (const auto& block : blocks_)
+      for (const auto& ii : block) {
+        if (ii >= matrix.rows())
+          DUNE_THROW(Stuff::Exceptions::wrong_input_given,
+                     "Given a block with DoF " << ii << ", the matrix has only " << matrix.rows() << " rows!");
+        // the blocks are updated concurrently
+        if (in_block_[ii])
+          DUNE_THROW(Stuff::Exceptions::wrong_input_given, "DoF " << ii << " is contained in several blocks!");
+        in_block_[ii] = true;
+      }
+    const auto diagonal = matrix.diagonal();
+    for (size_t ii = 0; ii < matrix.rows(); ++ii)
+      if (!in_block_[ii]) {
+        if (diagonal[ii] == RangeFieldType(0))
+          DUNE_THROW(Stuff::Exceptions::linear_solver_failed, "The matrix has a zero on its diagonal in row " << ii
+                     << "!");
+        inverse_diagonal_[ii] = RangeFieldType(1) / diagonal[ii];
+      }
+    // extract and invert the diagonal blocks
+    const auto invert_blocks = [&](const size_t first, const size_t last) {
+      for (size_t bb = first; bb < last; ++bb) {
+        const auto& block = blocks_[bb];
+        auto& inverse_block = inverse_blocks_[bb];
+        inverse_block = Dune::DynamicMatrix< RangeFieldType >(block.size(), block.size(), RangeFieldType(0));
+        for (size_t ii = 0; ii < block.size(); ++ii)
+          for (size_t kk = matrix.row_begin(block[ii]); kk < matrix.row_end(block[ii]); ++kk) {
+            const auto position = std::find(block.begin(), block.end(), matrix.column_index(kk));
+            if (position != block.end())
+              inverse_block[ii][position - block.begin()] = matrix.value(kk);
+          }
+        try {
+          inverse_block.invert();
+        } catch (Dune::FMatrixError& ee) {
+          DUNE_THROW(Stuff::Exceptions::linear_solver_failed,
+                     "Could not invert block " << bb << "!\n\nThis was the original error: " << ee.what());
+        }
+      }
+    };
+    for_each_range(blocks_.size(), use_tbb, invert_blocks);
+  } // InverseBlocks(...)
+
+  size_t num_blocks() const
+  {
+    return blocks_.size();
+  }
+
+  /**
+   * \brief Computes ret = damping * D^{-1} rr, where D is the block diagonal of the matrix (the rows of constrained
+   *        DoFs are not damped).
+   */
+  void apply(const VectorType& rr, VectorType& ret, const RangeFieldType damping, const bool use_tbb) const
+  {
+    assert(rr.size() == in_block_.size());
+    assert(ret.size() == in_block_.size());
+    const auto apply_blocks = [&](const size_t first, const size_t last) {
+      for (size_t bb = first; bb < last; ++bb) {
+        const auto& block = blocks_[bb];
+        const auto& inverse_block = inverse_blocks_[bb];
+        for (size_t ii = 0; ii < block.size(); ++ii) {
+          RangeFieldType value(0);
+          for (size_t jj = 0; jj < block.size(); ++jj)
+            value += inverse_block[ii][jj] * rr[block[jj]];
+          ret[block[ii]] = (constrained_[block[ii]] ? RangeFieldType(1) : damping) * value;
+        }
+      }
+    };
+    for_each_range(blocks_.size(), use_tbb, apply_blocks);
+    for (size_t ii = 0; ii < rr.size(); ++ii)
+      if (!in_block_[ii])
+        ret[ii] = (constrained_[ii] ? RangeFieldType(1) : damping) * inverse_diagonal_[ii] * rr[ii];
+  } // ... apply(...)
+
+private:
+  BlocksType blocks_;
+  std::vector< Dune::DynamicMatrix< RangeFieldType > > inverse_blocks_;
+  std::vector< bool > in_block_;
+  VectorType inverse_diagonal_;
+  std::vector< bool > constrained_;
+}; // class InverseBlocks
+
+
+} // namespace internal
+
+
+/**
+ * \brief The block Jacobi preconditioner, i.e. the inverse of the block diagonal of a matrix, with CG and BiCGStab.
+ *
+ *        For DG spaces the blocks are given by the DoFs of each entity (see BlockJacobiAssembler), which yields a
+ *        preconditioner which is set up and applied in parallel (if requested) without any communication between the
+ *        blocks. Since Stuff::LA::Solver does not accept external preconditioners, the Krylov methods are provided
+ *        here, see types() and options(); precondition() applies the preconditioner alone.
+ */
+template< class MatrixImp, class VectorImp >
+class BlockJacobi
+{
+public:
+  typedef MatrixImp                            MatrixType;
+  typedef VectorImp                            VectorType;
+  typedef typename MatrixType::ScalarType      ScalarType;
+  typedef std::vector< std::vector< size_t > > BlocksType;
+private:
+  static_assert(Stuff::LA::is_matrix< MatrixType >::value,
+                "MatrixType has to be derived from Stuff::LA::MatrixInterface!");
+  static_assert(Stuff::LA::is_vector< VectorType >::value,
+                "VectorType has to be derived from Stuff::LA::VectorInterface!");
+  typedef std::vector< ScalarType > StdVectorType;
+
+public:
+  static std::vector< std::string > types()
+  {
+    return {"bicgstab.block_jacobi", "cg.block_jacobi"};
+  }
+
+  static Stuff::Common::Configuration options(const std::string type = "")
+  {
+    const auto available_types = types();
+    const std::string tp = type.empty() ? available_types[0] : type;
+    if (std::find(available_types.begin(), available_types.end(), tp) == available_types.end())
+      DUNE_THROW(Stuff::Exceptions::wrong_input_given,
+                 "Given type '" << tp << "' is not one of the available types (see types())!");
+    Stuff::Common::Configuration opts;
+    opts["type"] = tp;
+    opts["max_iter"] = "10000";
+    opts["precision"] = "1e-10";
+    opts["post_check_solves_system"] = "1e-5";
+    opts["verbose"] = "0";
+    return opts;
+  } // ... options(...)
+
+  /**
+   * \param blocks The (disjoint) sets of DoFs, rows which are not contained in any block are treated pointwise.
+   */
+  BlockJacobi(const MatrixType& matrix, const BlocksType& blocks, const bool use_tbb = false)
+    : use_tbb_(use_tbb)
+    , matrix_(internal::to_csr(matrix))
+    , inverse_blocks_(matrix_, blocks, use_tbb_)
+    , last_iterations_(0)
+  {
+    if (matrix_.rows() != matrix_.cols())
+      DUNE_THROW(Stuff::Exceptions::shapes_do_not_match, "The given matrix is not square!");
+  }
+
+  size_t num_blocks() const
+  {
+    return inverse_blocks_.num_blocks();
+  }
+
+  /**
+   * \brief The number of iterations of the last call to apply().
+   */
+  size_t iterations() const
+  {
+    return last_iterations_;
+  }
+
+  /**
+   * \brief Computes ret = D^{-1} rhs, where D is the block diagonal of the matrix.
+   */
+  void precondition(const VectorType& rhs, VectorType& ret) const
+  {
+    StdVectorType rr(rhs.size()), zz(rhs.size());
+    for (size_t ii = 0; ii < rhs.size(); ++ii)
+      rr[ii] = rhs.get_entry(ii);
+    inverse_blocks_.apply(rr, zz, ScalarType(1), use_tbb_);
+    for (size_t ii = 0; ii < zz.size(); ++ii)
+      ret.set_entry(ii, zz[ii]);
+  } // ... precondition(...)
+
+  void apply(const VectorType& rhs, VectorType& solution) const
+  {
+    apply(rhs, solution, options(types()[0]));
+  }
+
+  void apply(const VectorType& rhs, VectorType& solution, const std::string& type) const
+  {
+    apply(rhs, solution, options(type));
+  }
+
+  /**
+   * \brief Solves the system, the given solution is used as initial guess.
+   */
+  void apply(const VectorType& rhs, VectorType& solution, const Stuff::Common::Configuration& opts) const
+  {
+    const size_t size = matrix_.rows();
+    if (rhs.size() != size || solution.size() != size)
+      DUNE_THROW(Stuff::Exceptions::shapes_do_not_match,
+                 "The sizes of rhs (" << rhs.size() << ") and solution (" << solution.size()
+                 << ") do not match the system (" << size << ")!");
+    const std::string type = opts.get< std::string >("type", types()[0]);
+    const internal::Krylov< ScalarType > krylov(matrix_,
+                                                opts.get("max_iter", size_t(10000)),
+                                                opts.get("precision", ScalarType(1e-10)),
+                                                opts.get("verbose", 0),
+                                                use_tbb_,
+                                                "block jacobi");
+    StdVectorType bb(size), xx(size);
+    for (size_t ii = 0; ii < size; ++ii) {
+      bb[ii] = rhs.get_entry(ii);
+      xx[ii] = solution.get_entry(ii);
+    }
+    const auto precondition = [&](const StdVectorType& rr, StdVectorType& zz) {
+      inverse_blocks_.apply(rr, zz, ScalarType(1), use_tbb_);
+    };
+    if (type == "cg.block_jacobi")
+      last_iterations_ = krylov.cg(bb, xx, precondition);
+    else if (type == "bicgstab.block_jacobi")
+      last_iterations_ = krylov.bicgstab(bb, xx, precondition);
+    else
+      DUNE_THROW(Stuff::Exceptions::wrong_input_given,
+                 "Given type '" << type << "' is not one of the available types (see types())!");
+    for (size_t ii = 0; ii < size; ++ii)
+      solution.set_entry(ii, xx[ii]);
+    if (!solution.valid())
+      DUNE_THROW(Stuff::Exceptions::linear_solver_failed, "The computed solution contains inf or nan!");
+    const ScalarType threshold = opts.get("post_check_solves_system", ScalarType(1e-5));
+    if (threshold > 0) {
+      StdVectorType rr(size);
+      krylov.residual(bb, xx, rr);
+      ScalarType sup_norm(0);
+      for (const auto& element : rr)
+        sup_norm = std::max(sup_norm, std::abs(element));
+      if (sup_norm > threshold)
+        DUNE_THROW(Stuff::Exceptions::linear_solver_failed,
+                   "The computed solution does not solve the system (sup norm of the residual is " << sup_norm
+                   << ", should be below " << threshold << ")!");
+    }
+  } // ... apply(...)
+
+private:
+  const bool use_tbb_;
+  const internal::CsrMatrix< ScalarType > matrix_;
+  const internal::InverseBlocks< ScalarType > inverse_blocks_;
+  mutable size_t last_iterations_;
+}; // class BlockJacobi
+
+
+/**
+ * \brief Collects the DoFs of each entity during a grid walk, to set up a BlockJacobi preconditioner for the
+ *        assembled matrix.
+ *
+ *        This is a grid functor, which is meant to be added to the SystemAssembler which assembles the matrix, so that
+ *        no additional grid walk is required:
+\code
+SystemAssembler< SpaceType > system_assembler(space);
+system_assembler.add(local_assembler, matrix);
+Solvers::BlockJacobiAssembler< SpaceType > block_jacobi_assembler(space);
+system_assembler.add(block_jacobi_assembler);
+system_assembler.assemble(true);
+const auto preconditioner = block_jacobi_assembler.preconditioner< VectorType >(matrix, true);
+\endcode
+ *        The diagonal blocks themselves are extracted once the walk is finished, since for DG discretizations the face
+ *        terms of an entity are only complete once all its neighbors have been visited. Their extraction and inversion
+ *        is done in parallel, if requested.
+ * \note  The DoFs of the space have to be local to the entities (as for DG spaces), see BlockJacobi.
+ */
+template< class SpaceImp, class GridViewImp = typename SpaceImp::GridViewType >
+class BlockJacobiAssembler
+  : public Stuff::Grid::Functor::Codim0< GridViewImp >
+{
+  static_assert(is_space< SpaceImp >::value, "SpaceImp has to be derived from SpaceInterface!");
+public:
+  typedef SpaceImp                                                         SpaceType;
+  typedef GridViewImp                                                      GridViewType;
+  typedef typename Stuff::Grid::Functor::Codim0< GridViewImp >::EntityType EntityType;
+  typedef std::vector< std::vector< size_t > >                             BlocksType;
+
+  BlockJacobiAssembler(const SpaceType& spc, const GridViewType& grd_vw)
+    : space_(spc)
+    , grid_view_(grd_vw)
+  {}
+
+  explicit BlockJacobiAssembler(const SpaceType& spc)
+    : space_(spc)
+    , grid_view_(spc.grid_view())
+  {}
+
+  virtual ~BlockJacobiAssembler() {}
+
+  virtual void prepare() override final
+  {
+    blocks_ = BlocksType(grid_view_.indexSet().size(0));
+  }
+
+  // each entity only writes to its own block, so this is thread safe
+  virtual void apply_local(const EntityType& entity) override final
+  {
+    const auto global_indices = space_.mapper().globalIndices(entity);
+    auto& block = blocks_[grid_view_.indexSet().index(entity)];
+    block.resize(global_indices.size());
+    for (size_t ii = 0; ii < global_indices.size(); ++ii)
+      block[ii] = global_indices[ii];
+  } // ... apply_local(...)
+
+  /**
+   * \brief The blocks of all visited entities.
+   */
+  BlocksType blocks() const
+  {
+    BlocksType ret;
+    for (const auto& block : blocks_)
+      if (!block.empty())
+        ret.push_back(block);
+    return ret;
+  }
+
+  /**
+   * \note matrix has to be assembled completely, i.e. this may only be called after the grid walk.
+   */
+  template< class VectorType, class MatrixType >
+  BlockJacobi< MatrixType, VectorType > preconditioner(const MatrixType& matrix, const bool use_tbb = false) const
+  {
+    return BlockJacobi< MatrixType, VectorType >(matrix, blocks(), use_tbb);
+  }
+
+private:
+  const SpaceType& space_;
+  const GridViewType grid_view_;
+  BlocksType blocks_;
+}; // class BlockJacobiAssembler
+
+
+} // namespace Solvers
+} // namespace GDT
+} // namespace Dune
+
+#endif // DUNE_GDT_SOLVERS_BLOCK_JACOBI_HH
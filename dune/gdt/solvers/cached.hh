@@ -0,0 +1,472 @@
+// This file is part of the dune-gdt project:
+//   http://users.dune-project.org/projects/dune-gdt
+// Copyright holders: Felix Schindler
+// License: BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+
+#ifndef DUNE_GDT_SOLVERS_CACHED_HH
+#define DUNE_GDT_SOLVERS_CACHED_HH
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#if HAVE_EIGEN
+# include <Eigen/IterativeLinearSolvers>
+# include <Eigen/SparseCholesky>
+# include <Eigen/SparseLU>
+#endif
+
+#if HAVE_DUNE_ISTL
+# include <dune/istl/operators.hh>
+# include <dune/istl/paamg/amg.hh>
+# include <dune/istl/preconditioners.hh>
+# include <dune/istl/solvers.hh>
+# if HAVE_SUPERLU
+#   include <dune/istl/superlu.hh>
+# endif
+#endif
+
+#include <dune/stuff/common/configuration.hh>
+#include <dune/stuff/common/exceptions.hh>
+#include <dune/stuff/la/container.hh>
+#include <dune/stuff/la/solver.hh>
+
+namespace Dune {
+namespace GDT {
+namespace Solvers {
+namespace internal {
+
+
+/**
+ * \brief Functionality shared by all CachedLinearSolver variants: the types and options are those of
+ *        Stuff::LA::Solver, solutions are checked as requested by the options.
+ */
+template< class MatrixImp >
+class CachedLinearSolverBase
+{
+public:
+  typedef MatrixImp                         MatrixType;
+  typedef typename MatrixType::ScalarType   ScalarType;
+  typedef Stuff::LA::Solver< MatrixType >   UncachedSolverType;
+
+  explicit CachedLinearSolverBase(const MatrixType& matrix)
+    : matrix_(matrix)
+  {}
+
+  static std::vector< std::string > types()
+  {
+    return UncachedSolverType::types();
+  }
+
+  static Stuff::Common::Configuration options(const std::string type = "")
+  {
+    return UncachedSolverType::options(type);
+  }
+
+  const MatrixType& matrix() const
+  {
+    return matrix_;
+  }
+
+protected:
+  template< class VectorType >
+  void check_solution(const VectorType& rhs, const VectorType& solution, const Stuff::Common::Configuration& opts)
+  const
+  {
+    if (opts.get("check_for_inf_nan", true) && !solution.valid())
+      DUNE_THROW(Stuff::Exceptions::linear_solver_failed,
+                 "The computed solution contains inf or nan!");
+    const ScalarType threshold = opts.get("post_check_solves_system", ScalarType(0));
+    if (threshold > 0) {
+      auto residual = rhs.copy();
+      matrix_.mv(solution, residual);
+      residual -= rhs;
+      const ScalarType sup_norm = residual.sup_norm();
+      if (sup_norm > threshold)
+        DUNE_THROW(Stuff::Exceptions::linear_solver_failed,
+                   "The computed solution does not solve the system (sup norm of the residual is " << sup_norm
+                   << ", should be below " << threshold << ")!");
+    }
+  } // ... check_solution(...)
+
+  // a (copy on write) copy, the handle thus stays valid if the owner of the original matrix is moved
+  const MatrixType matrix_;
+}; // class CachedLinearSolverBase
+
+
+} // namespace internal
+
+
+/**
+ * \brief A linear solver for a fixed matrix, which keeps the setup of the solver (factorizations, preconditioners)
+ *        for subsequent solves with other right hand sides.
+ *
+ *        The setup is computed on the first call to apply() for a given solver type (and preconditioner options) and
+ *        is reused as long as the type and these options do not change. This is the default variant for containers
+ *        for which no setup can be cached, it simply forwards to Stuff::LA::Solver. See the specializations for the
+ *        cached types.
+ * \note  The types and options are those of Stuff::LA::Solver.
+ * \note  The matrix must not be changed after the first solve, call reset() otherwise.
+ */
+template< class MatrixImp >
+class CachedLinearSolver
+  : public internal::CachedLinearSolverBase< MatrixImp >
+{
+  typedef internal::CachedLinearSolverBase< MatrixImp > BaseType;
+public:
+  using typename BaseType::MatrixType;
+
+  explicit CachedLinearSolver(const MatrixType& matrix)
+    : BaseType(matrix)
+  {}
+
+  static bool caches(const std::string& /*type*/)
+  {
+    return false;
+  }
+
+  void reset() {}
+
+  template< class VectorType >
+  void apply(const VectorType& rhs, VectorType& solution) const
+  {
+    apply(rhs, solution, this->options(this->types().at(0)));
+  }
+
+  template< class VectorType >
+  void apply(const VectorType& rhs, VectorType& solution, const std::string& type) const
+  {
+    apply(rhs, solution, this->options(type));
+  }
+
+  template< class VectorType >
+  void apply(const VectorType& rhs, VectorType& solution, const Stuff::Common::Configuration& opts) const
+  {
+    typename BaseType::UncachedSolverType(this->matrix_).apply(rhs, solution, opts);
+  }
+}; // class CachedLinearSolver
+
+
+#if HAVE_EIGEN
+
+
+/**
+ * \brief Caches the sparse LU and Cholesky factorizations and the ILUT and diagonal preconditioners of Eigen.
+ *
+ *        The types "lu.sparse", "llt.simplicial", "ldlt.simplicial", "bicgstab.ilut" and "bicgstab.diagonal" are
+ *        cached, all other types are forwarded to Stuff::LA::Solver.
+ */
+template< class S >
+class CachedLinearSolver< Stuff::LA::EigenRowMajorSparseMatrix< S > >
+  : public internal::CachedLinearSolverBase< Stuff::LA::EigenRowMajorSparseMatrix< S > >
+{
+  typedef internal::CachedLinearSolverBase< Stuff::LA::EigenRowMajorSparseMatrix< S > > BaseType;
+public:
+  using typename BaseType::MatrixType;
+  using typename BaseType::ScalarType;
+private:
+  typedef typename MatrixType::BackendType                             RowMajorBackendType;
+  typedef ::Eigen::SparseMatrix< ScalarType, ::Eigen::ColMajor >       ColMajorBackendType;
+  typedef ::Eigen::SparseLU< ColMajorBackendType, ::Eigen::COLAMDOrdering< int > > SparseLUType;
+  typedef ::Eigen::SimplicialLLT< ColMajorBackendType >                SimplicialLLTType;
+  typedef ::Eigen::SimplicialLDLT< ColMajorBackendType >               SimplicialLDLTType;
+  typedef ::Eigen::BiCGSTAB< RowMajorBackendType, ::Eigen::IncompleteLUT< ScalarType > >        BiCGSTABILUTType;
+  typedef ::Eigen::BiCGSTAB< RowMajorBackendType, ::Eigen::DiagonalPreconditioner< ScalarType > > BiCGSTABDiagType;
+
+public:
+  explicit CachedLinearSolver(const MatrixType& matrix)
+    : BaseType(matrix)
+  {}
+
+  static bool caches(const std::string& type)
+  {
+    return type == "lu.sparse" || type == "llt.simplicial" || type == "ldlt.simplicial" || type == "bicgstab.ilut"
+        || type == "bicgstab.diagonal";
+  }
+
+  /**
+   * \brief Drops all cached factorizations and preconditioners.
+   */
+  void reset()
+  {
+    std::lock_guard< std::mutex > lock(mutex_);
+    sparse_lu_.reset();
+    simplicial_llt_.reset();
+    simplicial_ldlt_.reset();
+    bicgstab_ilut_.reset();
+    bicgstab_diagonal_.reset();
+    col_major_.reset();
+  } // ... reset(...)
+
+  template< class VectorType >
+  void apply(const VectorType& rhs, VectorType& solution) const
+  {
+    apply(rhs, solution, this->options(this->types().at(0)));
+  }
+
+  template< class VectorType >
+  void apply(const VectorType& rhs, VectorType& solution, const std::string& type) const
+  {
+    apply(rhs, solution, this->options(type));
+  }
+
+  void apply(const Stuff::LA::EigenDenseVector< S >& rhs,
+             Stuff::LA::EigenDenseVector< S >& solution,
+             const Stuff::Common::Configuration& opts) const
+  {
+    const std::string type = opts.get< std::string >("type");
+    if (!caches(type)) {
+      typename BaseType::UncachedSolverType(this->matrix_).apply(rhs, solution, opts);
+      return;
+    }
+    ::Eigen::ComputationInfo info = ::Eigen::Success;
+    if (type == "lu.sparse") {
+      const auto& solver = direct_solver(sparse_lu_);
+      solution.backend() = solver.solve(rhs.backend());
+      info = solver.info();
+    } else if (type == "llt.simplicial") {
+      const auto& solver = direct_solver(simplicial_llt_);
+      solution.backend() = solver.solve(rhs.backend());
+      info = solver.info();
+    } else if (type == "ldlt.simplicial") {
+      const auto& solver = direct_solver(simplicial_ldlt_);
+      solution.backend() = solver.solve(rhs.backend());
+      info = solver.info();
+    } else if (type == "bicgstab.ilut") {
+      std::lock_guard< std::mutex > lock(iterative_apply_mutex_);
+      auto& solver = bicgstab_ilut(opts);
+      solver.setTolerance(opts.get("precision", ScalarType(1e-10)));
+      solver.setMaxIterations(opts.get("max_iter", 10000));
+      solution.backend() = solver.solve(rhs.backend());
+      info = solver.info();
+    } else {
+      std::lock_guard< std::mutex > lock(iterative_apply_mutex_);
+      auto& solver = bicgstab_diagonal();
+      solver.setTolerance(opts.get("precision", ScalarType(1e-10)));
+      solver.setMaxIterations(opts.get("max_iter", 10000));
+      solution.backend() = solver.solve(rhs.backend());
+      info = solver.info();
+    }
+    if (info != ::Eigen::Success)
+      DUNE_THROW(Stuff::Exceptions::linear_solver_failed,
+                 "The Eigen backend reported '" << int(info) << "' for solver type '" << type << "'!");
+    this->check_solution(rhs, solution, opts);
+  } // ... apply(...)
+
+private:
+  const ColMajorBackendType& col_major() const
+  {
+    if (!col_major_)
+      col_major_ = std::unique_ptr< ColMajorBackendType >(new ColMajorBackendType(this->matrix_.backend()));
+    return *col_major_;
+  }
+
+  template< class SolverType >
+  const SolverType& direct_solver(std::unique_ptr< SolverType >& solver) const
+  {
+    std::lock_guard< std::mutex > lock(mutex_);
+    if (!solver) {
+      solver = std::unique_ptr< SolverType >(new SolverType());
+      solver->compute(col_major());
+      if (solver->info() != ::Eigen::Success)
+        DUNE_THROW(Stuff::Exceptions::linear_solver_failed,
+                   "The factorization failed (Eigen reported '" << int(solver->info()) << "')!");
+    }
+    return *solver;
+  } // ... direct_solver(...)
+
+  BiCGSTABILUTType& bicgstab_ilut(const Stuff::Common::Configuration& opts) const
+  {
+    std::lock_guard< std::mutex > lock(mutex_);
+    const ScalarType drop_tol = opts.get("preconditioner.drop_tol", ScalarType(1e-4));
+    const int fill_factor = opts.get("preconditioner.fill_factor", 10);
+    if (!bicgstab_ilut_ || drop_tol != ilut_drop_tol_ || fill_factor != ilut_fill_factor_) {
+      bicgstab_ilut_ = std::unique_ptr< BiCGSTABILUTType >(new BiCGSTABILUTType());
+      bicgstab_ilut_->preconditioner().setDroptol(drop_tol);
+      bicgstab_ilut_->preconditioner().setFillfactor(fill_factor);
+      bicgstab_ilut_->compute(this->matrix_.backend());
+      ilut_drop_tol_ = drop_tol;
+      ilut_fill_factor_ = fill_factor;
+    }
+    return *bicgstab_ilut_;
+  } // ... bicgstab_ilut(...)
+
+  BiCGSTABDiagType& bicgstab_diagonal() const
+  {
+    std::lock_guard< std::mutex > lock(mutex_);
+    if (!bicgstab_diagonal_) {
+      bicgstab_diagonal_ = std::unique_ptr< BiCGSTABDiagType >(new BiCGSTABDiagType());
+      bicgstab_diagonal_->compute(this->matrix_.backend());
+    }
+    return *bicgstab_diagonal_;
+  } // ... bicgstab_diagonal(...)
+
+  mutable std::mutex mutex_;
+  // the iterative solvers are configured for and keep state during one solve
+  mutable std::mutex iterative_apply_mutex_;
+  mutable std::unique_ptr< ColMajorBackendType > col_major_;
+  mutable std::unique_ptr< SparseLUType > sparse_lu_;
+  mutable std::unique_ptr< SimplicialLLTType > simplicial_llt_;
+  mutable std::unique_ptr< SimplicialLDLTType > simplicial_ldlt_;
+  mutable std::unique_ptr< BiCGSTABILUTType > bicgstab_ilut_;
+  mutable ScalarType ilut_drop_tol_;
+  mutable int ilut_fill_factor_;
+  mutable std::unique_ptr< BiCGSTABDiagType > bicgstab_diagonal_;
+}; // class CachedLinearSolver< EigenRowMajorSparseMatrix< ... > >
+
+
+#endif // HAVE_EIGEN
+#if HAVE_DUNE_ISTL
+
+
+/**
+ * \brief Caches the AMG hierarchy and the SuperLU factorization of dune-istl.
+ *
+ *        The types "bicgstab.amg.ilu0" and "superlu" (if available) are cached, all other types are forwarded to
+ *        Stuff::LA::Solver.
+ * \note  Only sequential solves are cached.
+ */
+template< class S >
+class CachedLinearSolver< Stuff::LA::IstlRowMajorSparseMatrix< S > >
+  : public internal::CachedLinearSolverBase< Stuff::LA::IstlRowMajorSparseMatrix< S > >
+{
+  typedef internal::CachedLinearSolverBase< Stuff::LA::IstlRowMajorSparseMatrix< S > > BaseType;
+public:
+  using typename BaseType::MatrixType;
+  using typename BaseType::ScalarType;
+  typedef Stuff::LA::IstlDenseVector< S > VectorType;
+private:
+  typedef typename MatrixType::BackendType                                         IstlMatrixType;
+  typedef typename VectorType::BackendType                                         IstlVectorType;
+  typedef MatrixAdapter< IstlMatrixType, IstlVectorType, IstlVectorType >          OperatorType;
+  typedef SeqILU0< IstlMatrixType, IstlVectorType, IstlVectorType >                SmootherType;
+  typedef Amg::AMG< OperatorType, IstlVectorType, SmootherType >                   AmgType;
+  typedef Amg::CoarsenCriterion< Amg::SymmetricCriterion< IstlMatrixType, Amg::FirstDiagonal > > CriterionType;
+#if HAVE_SUPERLU
+  typedef SuperLU< IstlMatrixType > SuperLUType;
+#endif
+
+public:
+  explicit CachedLinearSolver(const MatrixType& matrix)
+    : BaseType(matrix)
+    , operator_(this->matrix_.backend())
+  {}
+
+  static bool caches(const std::string& type)
+  {
+#if HAVE_SUPERLU
+    if (type == "superlu")
+      return true;
+#endif
+    return type == "bicgstab.amg.ilu0";
+  }
+
+  /**
+   * \brief Drops the cached AMG hierarchy and factorization.
+   */
+  void reset()
+  {
+    std::lock_guard< std::mutex > lock(mutex_);
+    amg_.reset();
+#if HAVE_SUPERLU
+    superlu_.reset();
+#endif
+  } // ... reset(...)
+
+  template< class V >
+  void apply(const V& rhs, V& solution) const
+  {
+    apply(rhs, solution, this->options(this->types().at(0)));
+  }
+
+  template< class V >
+  void apply(const V& rhs, V& solution, const std::string& type) const
+  {
+    apply(rhs, solution, this->options(type));
+  }
+
+  void apply(const VectorType& rhs, VectorType& solution, const Stuff::Common::Configuration& opts) const
+  {
+    const std::string type = opts.get< std::string >("type");
+    if (!caches(type)) {
+      typename BaseType::UncachedSolverType(this->matrix_).apply(rhs, solution, opts);
+      return;
+    }
+    // the istl solvers modify the right hand side
+    IstlVectorType rhs_copy(rhs.backend());
+    InverseOperatorResult statistics;
+#if HAVE_SUPERLU
+    if (type == "superlu") {
+      superlu(opts).apply(solution.backend(), rhs_copy, statistics);
+    } else
+#endif
+    {
+      std::lock_guard< std::mutex > lock(amg_apply_mutex_);
+      auto& preconditioner = amg(opts);
+      BiCGSTABSolver< IstlVectorType > solver(operator_,
+                                              preconditioner,
+                                              opts.get("precision", ScalarType(1e-10)),
+                                              opts.get("max_iter", 10000),
+                                              opts.get("verbose", 0));
+      solver.apply(solution.backend(), rhs_copy, statistics);
+    }
+    if (!statistics.converged)
+      DUNE_THROW(Stuff::Exceptions::linear_solver_failed,
+                 "The dune-istl backend reported 'InverseOperatorResult.converged == false' for solver type '"
+                 << type << "'!");
+    this->check_solution(rhs, solution, opts);
+  } // ... apply(...)
+
+private:
+  /**
+   * \note The AMG hierarchy is set up according to the options of the first call, as in Stuff::LA::Solver.
+   */
+  AmgType& amg(const Stuff::Common::Configuration& opts) const
+  {
+    std::lock_guard< std::mutex > lock(mutex_);
+    if (!amg_) {
+      typename Amg::SmootherTraits< SmootherType >::Arguments smoother_parameters;
+      smoother_parameters.iterations = opts.get("smoother.iterations", 1);
+      smoother_parameters.relaxationFactor = opts.get("smoother.relaxation_factor", ScalarType(1));
+      Amg::Parameters amg_parameters(opts.get("preconditioner.max_level", 100),
+                                     opts.get("preconditioner.coarse_target", 1000),
+                                     opts.get("preconditioner.min_coarse_rate", 1.2),
+                                     opts.get("preconditioner.prolong_damp", 1.6));
+      amg_parameters.setDefaultValuesIsotropic(opts.get("preconditioner.isotropy_dim", 2));
+      amg_parameters.setDebugLevel(opts.get("preconditioner.verbose", 0));
+      CriterionType criterion(amg_parameters);
+      amg_ = std::unique_ptr< AmgType >(new AmgType(operator_, criterion, smoother_parameters));
+    }
+    return *amg_;
+  } // ... amg(...)
+
+#if HAVE_SUPERLU
+  SuperLUType& superlu(const Stuff::Common::Configuration& opts) const
+  {
+    std::lock_guard< std::mutex > lock(mutex_);
+    if (!superlu_)
+      superlu_ = std::unique_ptr< SuperLUType >(new SuperLUType(this->matrix_.backend(), opts.get("verbose", 0) > 0));
+    return *superlu_;
+  }
+#endif // HAVE_SUPERLU
+
+  mutable OperatorType operator_;
+  mutable std::mutex mutex_;
+  // the AMG preconditioner keeps state during one application
+  mutable std::mutex amg_apply_mutex_;
+  mutable std::unique_ptr< AmgType > amg_;
+#if HAVE_SUPERLU
+  mutable std::unique_ptr< SuperLUType > superlu_;
+#endif
+}; // class CachedLinearSolver< IstlRowMajorSparseMatrix< ... > >
+
+
+#endif // HAVE_DUNE_ISTL
+
+
+} // namespace Solvers
+} // namespace GDT
+} // namespace Dune
+
+#endif // DUNE_GDT_SOLVERS_CACHED_HH
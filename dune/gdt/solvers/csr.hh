@@ -0,0 +1,311 @@
+// This file is part of the dune-gdt project:
+//   http://users.dune-project.org/projects/dune-gdt
+// Copyright holders: Felix Schindler
+// License: BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+
+#ifndef DUNE_GDT_SOLVERS_CSR_HH
+#define DUNE_GDT_SOLVERS_CSR_HH
+
+#include <algorithm>
+#include <cassert>
+#include <vector>
+
+#if HAVE_TBB
+# include <tbb/blocked_range.h>
+# include <tbb/parallel_for.h>
+#endif
+
+#include <dune/stuff/la/container.hh>
+
+namespace Dune {
+namespace GDT {
+namespace Solvers {
+namespace internal {
+
+
+/**
+ * \brief Calls functor(first, last) for subranges of [0, size), in parallel if use_tbb is true and TBB is available.
+ */
+template< class FunctorType >
+void for_each_range(const size_t size, const bool use_tbb, const FunctorType& functor)
+{
+#if HAVE_TBB
+  if (use_tbb) {
+    tbb::parallel_for(tbb::blocked_range< size_t >(0, size),
+                      [&](const tbb::blocked_range< size_t >& range) { functor(range.begin(), range.end()); });
+    return;
+  }
+#else // HAVE_TBB
+  static_cast< void >(use_tbb);
+#endif // HAVE_TBB
+  functor(size_t(0), size);
+} // ... for_each_range(...)
+
+
+/**
+ * \brief A minimal compressed row storage matrix, which is all the multigrid methods need (products, diagonal and row
+ *        access for the smoothers), in a form which is independent of the container backend.
+ */
+template< class RangeFieldImp >
+class CsrMatrix
+{
+public:
+  typedef RangeFieldImp                 RangeFieldType;
+  typedef std::vector< RangeFieldType > VectorType;
+
+  CsrMatrix()
+    : cols_(0)
+    , row_offsets_(1, 0)
+  {}
+
+  CsrMatrix(const size_t cols,
+            std::vector< size_t >&& row_offsets,
+            std::vector< size_t >&& column_indices,
+            std::vector< RangeFieldType >&& values)
+    : cols_(cols)
+    , row_offsets_(std::move(row_offsets))
+    , column_indices_(std::move(column_indices))
+    , values_(std::move(values))
+  {
+    assert(row_offsets_.size() > 0);
+    assert(column_indices_.size() == values_.size());
+    assert(row_offsets_.back() == values_.size());
+  }
+
+  size_t rows() const
+  {
+    return row_offsets_.size() - 1;
+  }
+
+  size_t cols() const
+  {
+    return cols_;
+  }
+
+  size_t row_begin(const size_t ii) const
+  {
+    return row_offsets_[ii];
+  }
+
+  size_t row_end(const size_t ii) const
+  {
+    return row_offsets_[ii + 1];
+  }
+
+  size_t column_index(const size_t kk) const
+  {
+    return column_indices_[kk];
+  }
+
+  const RangeFieldType& value(const size_t kk) const
+  {
+    return values_[kk];
+  }
+
+  RangeFieldType& value(const size_t kk)
+  {
+    return values_[kk];
+  }
+
+  VectorType diagonal() const
+  {
+    VectorType ret(rows(), RangeFieldType(0));
+    for (size_t ii = 0; ii < rows(); ++ii)
+      for (size_t kk = row_begin(ii); kk < row_end(ii); ++kk)
+        if (column_indices_[kk] == ii)
+          ret[ii] += values_[kk];
+    return ret;
+  } // ... diagonal(...)
+
+  /**
+   * \brief Returns true for rows which only contain a 1 on the diagonal, as produced by Spaces::DirichletConstraints.
+   */
+  std::vector< bool > unit_rows() const
+  {
+    std::vector< bool > ret(rows(), false);
+    for (size_t ii = 0; ii < rows(); ++ii) {
+      bool is_unit_row = true;
+      for (size_t kk = row_begin(ii); kk < row_end(ii) && is_unit_row; ++kk)
+        is_unit_row = (column_indices_[kk] == ii) ? (values_[kk] == RangeFieldType(1))
+                                                  : (values_[kk] == RangeFieldType(0));
+      ret[ii] = is_unit_row;
+    }
+    return ret;
+  } // ... unit_rows(...)
+
+  CsrMatrix transposed() const
+  {
+    std::vector< size_t > row_offsets(cols_ + 1, 0);
+    for (const auto& jj : column_indices_)
+      ++row_offsets[jj + 1];
+    for (size_t jj = 0; jj < cols_; ++jj)
+      row_offsets[jj + 1] += row_offsets[jj];
+    std::vector< size_t > column_indices(values_.size());
+    std::vector< RangeFieldType > values(values_.size());
+    std::vector< size_t > position(row_offsets.begin(), row_offsets.end() - 1);
+    for (size_t ii = 0; ii < rows(); ++ii)
+      for (size_t kk = row_begin(ii); kk < row_end(ii); ++kk) {
+        const size_t target = position[column_indices_[kk]]++;
+        column_indices[target] = ii;
+        values[target] = values_[kk];
+      }
+    return CsrMatrix(rows(), std::move(row_offsets), std::move(column_indices), std::move(values));
+  } // ... transposed(...)
+
+  /**
+   * \brief Computes ret = alpha*ret + beta*(*this)*xx, in parallel if use_tbb is true and TBB is available.
+   */
+  void mv(const VectorType& xx, VectorType& ret, const bool use_tbb,
+          const RangeFieldType alpha = 0, const RangeFieldType beta = 1) const
+  {
+    assert(xx.size() >= cols_);
+    assert(ret.size() >= rows());
+    const auto mv_rows = [&](const size_t first, const size_t last) {
+      for (size_t ii = first; ii < last; ++ii) {
+        RangeFieldType sum(0);
+        for (size_t kk = row_begin(ii); kk < row_end(ii); ++kk)
+          sum += values_[kk] * xx[column_indices_[kk]];
+        ret[ii] = (alpha == RangeFieldType(0) ? RangeFieldType(0) : alpha * ret[ii]) + beta * sum;
+      }
+    };
+    for_each_range(rows(), use_tbb, mv_rows);
+  } // ... mv(...)
+
+  /**
+   * \brief Returns (*this)*other.
+   */
+  CsrMatrix multiply(const CsrMatrix& other) const
+  {
+    assert(other.rows() == cols_);
+    std::vector< size_t > row_offsets(rows() + 1, 0);
+    std::vector< size_t > column_indices;
+    std::vector< RangeFieldType > values;
+    // a dense accumulator for one row of the product and the positions of its nonzeros
+    std::vector< RangeFieldType > row_values(other.cols(), RangeFieldType(0));
+    std::vector< bool > row_pattern(other.cols(), false);
+    std::vector< size_t > row_columns;
+    for (size_t ii = 0; ii < rows(); ++ii) {
+      row_columns.clear();
+      for (size_t kk = row_begin(ii); kk < row_end(ii); ++kk) {
+        const size_t jj = column_indices_[kk];
+        for (size_t ll = other.row_begin(jj); ll < other.row_end(jj); ++ll) {
+          const size_t column = other.column_index(ll);
+          if (!row_pattern[column]) {
+            row_pattern[column] = true;
+            row_columns.push_back(column);
+          }
+          row_values[column] += values_[kk] * other.value(ll);
+        }
+      }
+      std::sort(row_columns.begin(), row_columns.end());
+      for (const auto& column : row_columns) {
+        column_indices.push_back(column);
+        values.push_back(row_values[column]);
+        row_values[column] = RangeFieldType(0);
+        row_pattern[column] = false;
+      }
+      row_offsets[ii + 1] = values.size();
+    }
+    return CsrMatrix(other.cols(), std::move(row_offsets), std::move(column_indices), std::move(values));
+  } // ... multiply(...)
+
+private:
+  size_t cols_;
+  std::vector< size_t > row_offsets_;
+  std::vector< size_t > column_indices_;
+  std::vector< RangeFieldType > values_;
+}; // class CsrMatrix
+
+
+template< class M, class S >
+CsrMatrix< S > to_csr(const Stuff::LA::MatrixInterface< M, S >& matrix)
+{
+  std::vector< size_t > row_offsets(matrix.rows() + 1, 0);
+  std::vector< size_t > column_indices;
+  std::vector< S > values;
+  for (size_t ii = 0; ii < matrix.rows(); ++ii) {
+    for (size_t jj = 0; jj < matrix.cols(); ++jj) {
+      const S value = matrix.get_entry(ii, jj);
+      if (value != S(0) || ii == jj) {
+        column_indices.push_back(jj);
+        values.push_back(value);
+      }
+    }
+    row_offsets[ii + 1] = values.size();
+  }
+  return CsrMatrix< S >(matrix.cols(), std::move(row_offsets), std::move(column_indices), std::move(values));
+} // ... to_csr(...)
+
+
+#if HAVE_EIGEN
+
+
+template< class S >
+CsrMatrix< S > to_csr(const Stuff::LA::EigenRowMajorSparseMatrix< S >& matrix)
+{
+  const auto& backend = matrix.backend();
+  std::vector< size_t > row_offsets(matrix.rows() + 1, 0);
+  std::vector< size_t > column_indices;
+  std::vector< S > values;
+  column_indices.reserve(backend.nonZeros());
+  values.reserve(backend.nonZeros());
+  for (size_t ii = 0; ii < matrix.rows(); ++ii) {
+    for (typename Stuff::LA::EigenRowMajorSparseMatrix< S >::BackendType::InnerIterator it(backend, ii); it; ++it) {
+      column_indices.push_back(it.col());
+      values.push_back(it.value());
+    }
+    row_offsets[ii + 1] = values.size();
+  }
+  return CsrMatrix< S >(matrix.cols(), std::move(row_offsets), std::move(column_indices), std::move(values));
+} // ... to_csr(...)
+
+
+#endif // HAVE_EIGEN
+#if HAVE_DUNE_ISTL
+
+
+template< class S >
+CsrMatrix< S > to_csr(const Stuff::LA::IstlRowMajorSparseMatrix< S >& matrix)
+{
+  const auto& backend = matrix.backend();
+  std::vector< size_t > row_offsets(matrix.rows() + 1, 0);
+  std::vector< size_t > column_indices;
+  std::vector< S > values;
+  column_indices.reserve(backend.nonzeroes());
+  values.reserve(backend.nonzeroes());
+  for (size_t ii = 0; ii < matrix.rows(); ++ii) {
+    const auto row_it_end = backend[ii].end();
+    for (auto row_it = backend[ii].begin(); row_it != row_it_end; ++row_it) {
+      column_indices.push_back(row_it.index());
+      values.push_back((*row_it)[0][0]);
+    }
+    row_offsets[ii + 1] = values.size();
+  }
+  return CsrMatrix< S >(matrix.cols(), std::move(row_offsets), std::move(column_indices), std::move(values));
+} // ... to_csr(...)
+
+
+#endif // HAVE_DUNE_ISTL
+
+
+template< class MatrixType, class S >
+MatrixType from_csr(const CsrMatrix< S >& matrix)
+{
+  Stuff::LA::SparsityPatternDefault pattern(matrix.rows());
+  for (size_t ii = 0; ii < matrix.rows(); ++ii)
+    for (size_t kk = matrix.row_begin(ii); kk < matrix.row_end(ii); ++kk)
+      pattern.inner(ii).push_back(matrix.column_index(kk));
+  MatrixType ret(matrix.rows(), matrix.cols(), pattern);
+  for (size_t ii = 0; ii < matrix.rows(); ++ii)
+    for (size_t kk = matrix.row_begin(ii); kk < matrix.row_end(ii); ++kk)
+      ret.set_entry(ii, matrix.column_index(kk), matrix.value(kk));
+  return ret;
+} // ... from_csr(...)
+
+
+} // namespace internal
+} // namespace Solvers
+} // namespace GDT
+} // namespace Dune
+
+#endif // DUNE_GDT_SOLVERS_CSR_HH
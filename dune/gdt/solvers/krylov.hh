@@ -0,0 +1,205 @@
+// This file is part of the dune-gdt project:
+//   http://users.dune-project.org/projects/dune-gdt
+// Copyright holders: Felix Schindler
+// License: BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+
+#ifndef DUNE_GDT_SOLVERS_KRYLOV_HH
+#define DUNE_GDT_SOLVERS_KRYLOV_HH
+
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <dune/stuff/common/exceptions.hh>
+
+#include "csr.hh"
+
+namespace Dune {
+namespace GDT {
+namespace Solvers {
+namespace internal {
+
+
+/**
+ * \brief Preconditioned iterative methods for a CsrMatrix, with the preconditioner given as a functor
+ *        precondition(rr, zz), which computes zz as an approximation of the solution of A zz = rr.
+ *
+ *        These are required since Stuff::LA::Solver does not accept external preconditioners (as Multigrid or
+ *        BlockJacobi). All methods use the given xx as initial guess, stop once the euclidean norm of the residual is
+ *        reduced by the factor precision and return the number of iterations.
+ */
+template< class RangeFieldImp >
+class Krylov
+{
+public:
+  typedef RangeFieldImp                 RangeFieldType;
+  typedef CsrMatrix< RangeFieldType >   MatrixType;
+  typedef std::vector< RangeFieldType > VectorType;
+
+  Krylov(const MatrixType& matrix,
+         const size_t max_iter,
+         const RangeFieldType precision,
+         const int verbose,
+         const bool use_tbb,
+         const std::string name)
+    : matrix_(matrix)
+    , max_iter_(max_iter)
+    , precision_(precision)
+    , verbose_(verbose)
+    , use_tbb_(use_tbb)
+    , name_(name)
+  {}
+
+  static RangeFieldType dot(const VectorType& xx, const VectorType& yy)
+  {
+    RangeFieldType ret(0);
+    for (size_t ii = 0; ii < xx.size(); ++ii)
+      ret += xx[ii] * yy[ii];
+    return ret;
+  }
+
+  static RangeFieldType norm(const VectorType& xx)
+  {
+    return std::sqrt(dot(xx, xx));
+  }
+
+  // rr = bb - A xx
+  void residual(const VectorType& bb, const VectorType& xx, VectorType& rr) const
+  {
+    rr = bb;
+    matrix_.mv(xx, rr, use_tbb_, RangeFieldType(1), RangeFieldType(-1));
+  }
+
+  /**
+   * \brief The stationary iteration xx += precondition(bb - A xx).
+   */
+  template< class PreconditionerType >
+  size_t iterate(const VectorType& bb, VectorType& xx, const PreconditionerType& precondition) const
+  {
+    const RangeFieldType rhs_norm = norm(bb);
+    VectorType rr(bb.size()), zz(bb.size());
+    for (size_t iteration = 0; iteration <= max_iter_; ++iteration) {
+      residual(bb, xx, rr);
+      if (converged(norm(rr), rhs_norm, iteration))
+        return iteration;
+      precondition(rr, zz);
+      for (size_t ii = 0; ii < xx.size(); ++ii)
+        xx[ii] += zz[ii];
+    }
+    failed();
+    return max_iter_;
+  } // ... iterate(...)
+
+  /**
+   * \note Requires a symmetric positive definite matrix and preconditioner.
+   */
+  template< class PreconditionerType >
+  size_t cg(const VectorType& bb, VectorType& xx, const PreconditionerType& precondition) const
+  {
+    const RangeFieldType rhs_norm = norm(bb);
+    VectorType rr(bb.size()), zz(bb.size()), pp(bb.size()), qq(bb.size());
+    residual(bb, xx, rr);
+    if (converged(norm(rr), rhs_norm, 0))
+      return 0;
+    precondition(rr, zz);
+    pp = zz;
+    RangeFieldType rz = dot(rr, zz);
+    for (size_t iteration = 1; iteration <= max_iter_; ++iteration) {
+      matrix_.mv(pp, qq, use_tbb_);
+      const RangeFieldType alpha = rz / dot(pp, qq);
+      for (size_t ii = 0; ii < xx.size(); ++ii) {
+        xx[ii] += alpha * pp[ii];
+        rr[ii] -= alpha * qq[ii];
+      }
+      if (converged(norm(rr), rhs_norm, iteration))
+        return iteration;
+      precondition(rr, zz);
+      const RangeFieldType rz_new = dot(rr, zz);
+      const RangeFieldType beta = rz_new / rz;
+      rz = rz_new;
+      for (size_t ii = 0; ii < pp.size(); ++ii)
+        pp[ii] = zz[ii] + beta * pp[ii];
+    }
+    failed();
+    return max_iter_;
+  } // ... cg(...)
+
+  /**
+   * \brief Right preconditioned BiCGStab.
+   */
+  template< class PreconditionerType >
+  size_t bicgstab(const VectorType& bb, VectorType& xx, const PreconditionerType& precondition) const
+  {
+    const RangeFieldType rhs_norm = norm(bb);
+    const size_t size = bb.size();
+    VectorType rr(size), rr_hat(size), pp(size, 0), vv(size, 0), yy(size), ss(size), zz(size), tt(size);
+    residual(bb, xx, rr);
+    if (converged(norm(rr), rhs_norm, 0))
+      return 0;
+    rr_hat = rr;
+    RangeFieldType rho(1), alpha(1), omega(1);
+    for (size_t iteration = 1; iteration <= max_iter_; ++iteration) {
+      const RangeFieldType rho_new = dot(rr_hat, rr);
+      if (rho_new == RangeFieldType(0))
+        DUNE_THROW(Stuff::Exceptions::linear_solver_failed, "BiCGStab broke down (rho = 0)!");
+      const RangeFieldType beta = (rho_new / rho) * (alpha / omega);
+      for (size_t ii = 0; ii < size; ++ii)
+        pp[ii] = rr[ii] + beta * (pp[ii] - omega * vv[ii]);
+      precondition(pp, yy);
+      matrix_.mv(yy, vv, use_tbb_);
+      alpha = rho_new / dot(rr_hat, vv);
+      for (size_t ii = 0; ii < size; ++ii)
+        ss[ii] = rr[ii] - alpha * vv[ii];
+      if (converged(norm(ss), rhs_norm, iteration)) {
+        for (size_t ii = 0; ii < size; ++ii)
+          xx[ii] += alpha * yy[ii];
+        return iteration;
+      }
+      precondition(ss, zz);
+      matrix_.mv(zz, tt, use_tbb_);
+      const RangeFieldType tt_norm_squared = dot(tt, tt);
+      omega = (tt_norm_squared > 0) ? dot(tt, ss) / tt_norm_squared : RangeFieldType(0);
+      for (size_t ii = 0; ii < size; ++ii) {
+        xx[ii] += alpha * yy[ii] + omega * zz[ii];
+        rr[ii] = ss[ii] - omega * tt[ii];
+      }
+      if (converged(norm(rr), rhs_norm, iteration))
+        return iteration;
+      if (omega == RangeFieldType(0))
+        DUNE_THROW(Stuff::Exceptions::linear_solver_failed, "BiCGStab broke down (omega = 0)!");
+      rho = rho_new;
+    }
+    failed();
+    return max_iter_;
+  } // ... bicgstab(...)
+
+private:
+  bool converged(const RangeFieldType residual_norm, const RangeFieldType rhs_norm, const size_t iteration) const
+  {
+    if (verbose_ > 0)
+      std::cout << name_ << ": iteration " << iteration << ", residual norm " << residual_norm << std::endl;
+    return residual_norm <= precision_ * (rhs_norm > 0 ? rhs_norm : RangeFieldType(1));
+  }
+
+  void failed() const
+  {
+    DUNE_THROW(Stuff::Exceptions::linear_solver_failed,
+               "The " << name_ << " method did not converge within " << max_iter_ << " iterations!");
+  }
+
+  const MatrixType& matrix_;
+  const size_t max_iter_;
+  const RangeFieldType precision_;
+  const int verbose_;
+  const bool use_tbb_;
+  const std::string name_;
+}; // class Krylov
+
+
+} // namespace internal
+} // namespace Solvers
+} // namespace GDT
+} // namespace Dune
+
+#endif // DUNE_GDT_SOLVERS_KRYLOV_HH
@@ -0,0 +1,382 @@
+// This file is part of the dune-gdt project:
+//   http://users.dune-project.org/projects/dune-gdt
+// Copyright holders: Felix Schindler
+// License: BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+
+#ifndef DUNE_GDT_SOLVERS_MULTIGRID_HH
+#define DUNE_GDT_SOLVERS_MULTIGRID_HH
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <dune/stuff/common/configuration.hh>
+#include <dune/stuff/common/exceptions.hh>
+#include <dune/stuff/la/container.hh>
+
+#include "block-jacobi.hh"
+#include "cached.hh"
+#include "csr.hh"
+#include "krylov.hh"
+
+namespace Dune {
+namespace GDT {
+namespace Solvers {
+
+
+/**
+ * \brief A geometric multigrid method for a hierarchy of nested discretizations.
+ *
+ *        Each level is given by its system matrix (assembled on that level, e.g. by the discretizer of the fine level
+ *        applied to a coarser level of the grid, which uses a SystemAssembler) and each pair of consecutive levels by
+ *        the matrix of the prolongation from the coarser to the finer level (e.g. assembled by
+ *        Operators::LagrangeProlongation::assemble_matrix() or Operators::L2Prolongation::assemble_matrix()). The
+ *        restriction is the transpose of the prolongation. One V-cycle uses damped Jacobi (in parallel, if requested),
+ *        damped block Jacobi (in parallel, if requested, for the blocks given on construction) or Gauss-Seidel
+ *        (forward before, backward after the coarse grid correction) smoothing and a CachedLinearSolver on the
+ *        coarsest level.
+ *
+ *        The multigrid is used as a preconditioner for BiCGStab or CG or as a stand alone iterative solver, see
+ *        types() and options(). Since the setup of the smoothers and the coarse solver is reused, the object should be
+ *        kept for all solves with the same hierarchy.
+ *
+ * \note  Rows which only contain a 1 on the diagonal (as produced by Spaces::DirichletConstraints) are treated as
+ *        constrained: the corresponding rows (on the finer level) and columns (on the coarser level) of the
+ *        prolongations are dropped, the smoothers resolve these rows exactly.
+ * \note  The levels are ordered from the coarsest (0) to the finest one, the system is solved on the finest level.
+ */
+template< class MatrixImp, class VectorImp >
+class Multigrid
+{
+public:
+  typedef MatrixImp                          MatrixType;
+  typedef VectorImp                          VectorType;
+  typedef typename MatrixType::ScalarType    ScalarType;
+private:
+  static_assert(Stuff::LA::is_matrix< MatrixType >::value,
+                "MatrixType has to be derived from Stuff::LA::MatrixInterface!");
+  static_assert(Stuff::LA::is_vector< VectorType >::value,
+                "VectorType has to be derived from Stuff::LA::VectorInterface!");
+  typedef internal::CsrMatrix< ScalarType > CsrMatrixType;
+  typedef std::vector< ScalarType >         LevelVectorType;
+
+  struct Parameters
+  {
+    explicit Parameters(const Stuff::Common::Configuration& opts)
+      : type(opts.get< std::string >("type", types()[0]))
+      , max_iter(opts.get("max_iter", size_t(1000)))
+      , precision(opts.get("precision", ScalarType(1e-10)))
+      , smoother(opts.get< std::string >("smoother", "gauss_seidel"))
+      , smoother_iterations(opts.get("smoother.iterations", size_t(2)))
+      , smoother_damping(opts.get("smoother.damping", ScalarType(0.7)))
+      , coarse_solver_options(CachedLinearSolver< MatrixType >::options(
+                                opts.get< std::string >("coarse_solver.type",
+                                                        CachedLinearSolver< MatrixType >::types()[0])))
+      , post_check_solves_system(opts.get("post_check_solves_system", ScalarType(1e-5)))
+      , verbose(opts.get("verbose", 0))
+    {
+      if (smoother != "jacobi" && smoother != "block_jacobi" && smoother != "gauss_seidel")
+        DUNE_THROW(Stuff::Exceptions::wrong_input_given,
+                   "Given smoother '" << smoother << "' is not one of 'jacobi', 'block_jacobi' or 'gauss_seidel'!");
+      // the result of the coarse solver is only a correction
+      coarse_solver_options["post_check_solves_system"] = "0";
+    }
+
+    std::string type;
+    size_t max_iter;
+    ScalarType precision;
+    std::string smoother;
+    size_t smoother_iterations;
+    ScalarType smoother_damping;
+    Stuff::Common::Configuration coarse_solver_options;
+    ScalarType post_check_solves_system;
+    int verbose;
+  }; // struct Parameters
+
+  struct Level
+  {
+    CsrMatrixType system_matrix;
+    LevelVectorType inverse_diagonal;
+    std::vector< bool > constrained;
+    internal::InverseBlocks< ScalarType > jacobi;
+    // rows which are not contained in any block are smoothed pointwise
+    internal::InverseBlocks< ScalarType > block_jacobi;
+    // to this level from the next coarser one, and back
+    CsrMatrixType prolongation;
+    CsrMatrixType restriction;
+  }; // struct Level
+
+public:
+  typedef std::vector< std::vector< size_t > > BlocksType;
+
+  static std::vector< std::string > types()
+  {
+    return {"bicgstab.multigrid", "cg.multigrid", "multigrid"};
+  }
+
+  /**
+   * \note The multigrid is a symmetric preconditioner (as required by "cg.multigrid") for symmetric system matrices.
+   */
+  static Stuff::Common::Configuration options(const std::string type = "")
+  {
+    const std::string tp = type.empty() ? types()[0] : type;
+    bool known_type = false;
+    for (const auto& candidate : types())
+      known_type = known_type || (candidate == tp);
+    if (!known_type)
+      DUNE_THROW(Stuff::Exceptions::wrong_input_given,
+                 "Given type '" << tp << "' is not one of the available types (see types())!");
+    Stuff::Common::Configuration opts;
+    opts["type"] = tp;
+    opts["max_iter"] = "1000";
+    opts["precision"] = "1e-10";
+    opts["smoother"] = "gauss_seidel";
+    opts["smoother.iterations"] = "2";
+    opts["smoother.damping"] = "0.7";
+    opts["coarse_solver.type"] = CachedLinearSolver< MatrixType >::types()[0];
+    opts["post_check_solves_system"] = "1e-5";
+    opts["verbose"] = "0";
+    return opts;
+  } // ... options(...)
+
+  /**
+   * \param system_matrices The system matrix on each level, from the coarsest to the finest one.
+   * \param prolongations   prolongations[ll] maps from level ll to level ll + 1.
+   * \param use_tbb         Use TBB for the matrix vector products and the Jacobi smoothers, if available.
+   */
+  Multigrid(const std::vector< MatrixType >& system_matrices,
+            const std::vector< MatrixType >& prolongations,
+            const bool use_tbb = false)
+    : Multigrid(system_matrices, prolongations, std::vector< BlocksType >(), use_tbb)
+  {}
+
+  /**
+   * \param blocks blocks[ll] contains the (disjoint) sets of DoFs on level ll, which are smoothed together by the
+   *               "block_jacobi" smoother (e.g. the DoFs of each entity for DG spaces, see entity_blocks()). Either
+   *               empty or one (possibly empty) set of blocks per level.
+   */
+  Multigrid(const std::vector< MatrixType >& system_matrices,
+            const std::vector< MatrixType >& prolongations,
+            const std::vector< BlocksType >& blocks,
+            const bool use_tbb = false)
+    : use_tbb_(use_tbb)
+    , levels_(system_matrices.size())
+    , last_iterations_(0)
+  {
+    if (system_matrices.empty())
+      DUNE_THROW(Stuff::Exceptions::wrong_input_given, "Given an empty hierarchy!");
+    if (prolongations.size() + 1 != system_matrices.size())
+      DUNE_THROW(Stuff::Exceptions::shapes_do_not_match,
+                 "Given " << system_matrices.size() << " levels but " << prolongations.size() << " prolongations!");
+    for (size_t ll = 0; ll < levels_.size(); ++ll) {
+      auto& level = levels_[ll];
+      if (system_matrices[ll].rows() != system_matrices[ll].cols())
+        DUNE_THROW(Stuff::Exceptions::shapes_do_not_match,
+                   "The system matrix on level " << ll << " is not square!");
+      level.system_matrix = internal::to_csr(system_matrices[ll]);
+      level.inverse_diagonal = level.system_matrix.diagonal();
+      for (auto& element : level.inverse_diagonal) {
+        if (element == ScalarType(0))
+          DUNE_THROW(Stuff::Exceptions::linear_solver_failed,
+                     "The system matrix on level " << ll << " has a zero on its diagonal!");
+        element = ScalarType(1) / element;
+      }
+      level.constrained = level.system_matrix.unit_rows();
+      level.jacobi = internal::InverseBlocks< ScalarType >(level.system_matrix, BlocksType(), use_tbb_);
+    }
+    if (!blocks.empty() && blocks.size() != levels_.size())
+      DUNE_THROW(Stuff::Exceptions::shapes_do_not_match,
+                 "Given " << system_matrices.size() << " levels but blocks for " << blocks.size() << " levels!");
+    for (size_t ll = 0; ll < levels_.size(); ++ll)
+      levels_[ll].block_jacobi = internal::InverseBlocks< ScalarType >(levels_[ll].system_matrix,
+                                                                       blocks.empty() ? BlocksType() : blocks[ll],
+                                                                       use_tbb_);
+    for (size_t ll = 1; ll < levels_.size(); ++ll) {
+      const auto& prolongation = prolongations[ll - 1];
+      if (prolongation.rows() != levels_[ll].system_matrix.rows()
+          || prolongation.cols() != levels_[ll - 1].system_matrix.rows())
+        DUNE_THROW(Stuff::Exceptions::shapes_do_not_match,
+                   "The prolongation from level " << ll - 1 << " to level " << ll << " does not match the system "
+                   << "matrices!");
+      auto& level = levels_[ll];
+      level.prolongation = internal::to_csr(prolongation);
+      // drop constrained rows and columns, see the class documentation
+      const auto& coarse_constrained = levels_[ll - 1].constrained;
+      for (size_t ii = 0; ii < level.prolongation.rows(); ++ii)
+        for (size_t kk = level.prolongation.row_begin(ii); kk < level.prolongation.row_end(ii); ++kk)
+          if (level.constrained[ii] || coarse_constrained[level.prolongation.column_index(kk)])
+            level.prolongation.value(kk) = ScalarType(0);
+      level.restriction = level.prolongation.transposed();
+    }
+    coarse_solver_ = std::make_shared< CachedLinearSolver< MatrixType > >(system_matrices[0]);
+  } // Multigrid(...)
+
+  size_t num_levels() const
+  {
+    return levels_.size();
+  }
+
+  /**
+   * \brief The number of iterations of the last call to apply().
+   */
+  size_t iterations() const
+  {
+    return last_iterations_;
+  }
+
+  void apply(const VectorType& rhs, VectorType& solution) const
+  {
+    apply(rhs, solution, options(types()[0]));
+  }
+
+  void apply(const VectorType& rhs, VectorType& solution, const std::string& type) const
+  {
+    apply(rhs, solution, options(type));
+  }
+
+  /**
+   * \brief Solves the system on the finest level, the given solution is used as initial guess.
+   * \note  The iteration stops once the euclidean norm of the residual is reduced by the factor given as "precision".
+   */
+  void apply(const VectorType& rhs, VectorType& solution, const Stuff::Common::Configuration& opts) const
+  {
+    const size_t size = levels_.back().system_matrix.rows();
+    if (rhs.size() != size || solution.size() != size)
+      DUNE_THROW(Stuff::Exceptions::shapes_do_not_match,
+                 "The sizes of rhs (" << rhs.size() << ") and solution (" << solution.size()
+                 << ") do not match the system (" << size << ")!");
+    const Parameters parameters(opts);
+    const internal::Krylov< ScalarType > krylov(levels_.back().system_matrix,
+                                                parameters.max_iter,
+                                                parameters.precision,
+                                                parameters.verbose,
+                                                use_tbb_,
+                                                "multigrid");
+    LevelVectorType bb(size), xx(size);
+    for (size_t ii = 0; ii < size; ++ii) {
+      bb[ii] = rhs.get_entry(ii);
+      xx[ii] = solution.get_entry(ii);
+    }
+    const auto precondition = [&](const LevelVectorType& rr, LevelVectorType& zz) {
+      v_cycle(levels_.size() - 1, rr, zz, parameters);
+    };
+    if (parameters.type == "multigrid")
+      last_iterations_ = krylov.iterate(bb, xx, precondition);
+    else if (parameters.type == "cg.multigrid")
+      last_iterations_ = krylov.cg(bb, xx, precondition);
+    else if (parameters.type == "bicgstab.multigrid")
+      last_iterations_ = krylov.bicgstab(bb, xx, precondition);
+    else
+      DUNE_THROW(Stuff::Exceptions::wrong_input_given,
+                 "Given type '" << parameters.type << "' is not one of the available types (see types())!");
+    for (size_t ii = 0; ii < size; ++ii)
+      solution.set_entry(ii, xx[ii]);
+    if (!solution.valid())
+      DUNE_THROW(Stuff::Exceptions::linear_solver_failed, "The computed solution contains inf or nan!");
+    const ScalarType threshold = parameters.post_check_solves_system;
+    if (threshold > 0) {
+      auto residual = rhs.copy();
+      system_matrix_mv(solution, residual);
+      residual -= rhs;
+      const ScalarType sup_norm = residual.sup_norm();
+      if (sup_norm > threshold)
+        DUNE_THROW(Stuff::Exceptions::linear_solver_failed,
+                   "The computed solution does not solve the system (sup norm of the residual is " << sup_norm
+                   << ", should be below " << threshold << ")!");
+    }
+  } // ... apply(...)
+
+private:
+  void system_matrix_mv(const VectorType& xx, VectorType& ret) const
+  {
+    const auto& matrix = levels_.back().system_matrix;
+    LevelVectorType xx_values(matrix.cols()), ret_values(matrix.rows());
+    for (size_t ii = 0; ii < xx_values.size(); ++ii)
+      xx_values[ii] = xx.get_entry(ii);
+    matrix.mv(xx_values, ret_values, use_tbb_);
+    for (size_t ii = 0; ii < ret_values.size(); ++ii)
+      ret.set_entry(ii, ret_values[ii]);
+  } // ... system_matrix_mv(...)
+
+  // rr = bb - A xx on the given level
+  void residual(const size_t ll, const LevelVectorType& bb, const LevelVectorType& xx, LevelVectorType& rr) const
+  {
+    rr = bb;
+    levels_[ll].system_matrix.mv(xx, rr, use_tbb_, ScalarType(1), ScalarType(-1));
+  }
+
+  void smooth(const size_t ll,
+              const LevelVectorType& bb,
+              LevelVectorType& xx,
+              const bool forward,
+              const Parameters& parameters) const
+  {
+    const auto& level = levels_[ll];
+    const auto& matrix = level.system_matrix;
+    const size_t iterations = parameters.smoother_iterations;
+    if (parameters.smoother == "jacobi" || parameters.smoother == "block_jacobi") {
+      const auto& inverse_blocks = (parameters.smoother == "jacobi") ? level.jacobi : level.block_jacobi;
+      LevelVectorType rr(bb.size()), zz(bb.size());
+      for (size_t it = 0; it < iterations; ++it) {
+        residual(ll, bb, xx, rr);
+        inverse_blocks.apply(rr, zz, parameters.smoother_damping, use_tbb_);
+        for (size_t ii = 0; ii < xx.size(); ++ii)
+          xx[ii] += zz[ii];
+      }
+    } else {
+      const size_t size = xx.size();
+      for (size_t it = 0; it < iterations; ++it) {
+        for (size_t nn = 0; nn < size; ++nn) {
+          const size_t ii = forward ? nn : size - 1 - nn;
+          ScalarType sum = bb[ii];
+          for (size_t kk = matrix.row_begin(ii); kk < matrix.row_end(ii); ++kk)
+            if (matrix.column_index(kk) != ii)
+              sum -= matrix.value(kk) * xx[matrix.column_index(kk)];
+          xx[ii] = sum * level.inverse_diagonal[ii];
+        }
+      }
+    }
+  } // ... smooth(...)
+
+  // one V-cycle for A_ll xx = bb, starting with xx = 0
+  void v_cycle(const size_t ll,
+               const LevelVectorType& bb,
+               LevelVectorType& xx,
+               const Parameters& parameters) const
+  {
+    std::fill(xx.begin(), xx.end(), ScalarType(0));
+    if (ll == 0) {
+      VectorType coarse_rhs(bb.size(), 0.0);
+      VectorType coarse_solution(bb.size(), 0.0);
+      for (size_t ii = 0; ii < bb.size(); ++ii)
+        coarse_rhs.set_entry(ii, bb[ii]);
+      coarse_solver_->apply(coarse_rhs, coarse_solution, parameters.coarse_solver_options);
+      for (size_t ii = 0; ii < xx.size(); ++ii)
+        xx[ii] = coarse_solution.get_entry(ii);
+      return;
+    }
+    const auto& level = levels_[ll];
+    smooth(ll, bb, xx, true, parameters);
+    LevelVectorType rr(bb.size());
+    residual(ll, bb, xx, rr);
+    LevelVectorType coarse_bb(level.restriction.rows());
+    LevelVectorType coarse_xx(level.restriction.rows());
+    level.restriction.mv(rr, coarse_bb, use_tbb_);
+    v_cycle(ll - 1, coarse_bb, coarse_xx, parameters);
+    level.prolongation.mv(coarse_xx, xx, use_tbb_, ScalarType(1), ScalarType(1));
+    smooth(ll, bb, xx, false, parameters);
+  } // ... v_cycle(...)
+
+  const bool use_tbb_;
+  std::vector< Level > levels_;
+  std::shared_ptr< const CachedLinearSolver< MatrixType > > coarse_solver_;
+  mutable size_t last_iterations_;
+}; // class Multigrid
+
+
+} // namespace Solvers
+} // namespace GDT
+} // namespace Dune
+
+#endif // DUNE_GDT_SOLVERS_MULTIGRID_HH
@@ -0,0 +1,256 @@
+// This file is part of the dune-gdt project:
+//   http://users.dune-project.org/projects/dune-gdt
+// Copyright holders: Felix Schindler
+// License: BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+
+#ifndef DUNE_GDT_SOLVERS_NEWTON_HH
+#define DUNE_GDT_SOLVERS_NEWTON_HH
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <dune/stuff/common/configuration.hh>
+#include <dune/stuff/common/exceptions.hh>
+#include <dune/stuff/common/string.hh>
+#include <dune/stuff/la/container/interfaces.hh>
+
+#include <dune/gdt/exceptions.hh>
+
+#include "cached.hh"
+
+namespace Dune {
+namespace GDT {
+namespace Solvers {
+
+
+/**
+ * \brief Newton's method for R(u) = 0, which reuses jacobians and their factorizations.
+ *
+ *        R and its jacobian DR are given by an assembler(iterate, residual, jacobian), which computes the residual at
+ *        the iterate and, if jacobian is not null, also the jacobian at the iterate (in the same grid walk, see e.g.
+ *        Operators::NonlinearElliptic). The linear systems are solved by a CachedLinearSolver, which is set up once per
+ *        assembled jacobian.
+ *
+ *        A jacobian is kept for at most max_jacobian_age iterations (1 gives the full Newton method) and reassembled
+ *        earlier if an iteration reduces the residual by less than jacobian_reassembly_ratio. The iteration stops once
+ *        the euclidean norm of the residual is reduced by the factor precision.
+ *
+ *        Available types are "newton" (the linear systems are solved as accurately as the linear solver allows) and
+ *        "newton.eisenstat_walker" (the linear systems are solved by an iterative linear solver to the relative
+ *        accuracy eta_k = gamma (|R(u_k)| / |R(u_{k - 1})|)^alpha, following Eisenstat and Walker, 1996).
+ * \note  Statistics of the last call to apply() are available by iterations(), num_jacobian_assemblies() and
+ *        num_residual_assemblies().
+ */
+template< class MatrixImp, class VectorImp >
+class Newton
+{
+  static_assert(Stuff::LA::is_matrix< MatrixImp >::value,
+                "MatrixImp has to be derived from Stuff::LA::MatrixInterface!");
+  static_assert(Stuff::LA::is_vector< VectorImp >::value,
+                "VectorImp has to be derived from Stuff::LA::VectorInterface!");
+public:
+  typedef MatrixImp                                   MatrixType;
+  typedef VectorImp                                   VectorType;
+  typedef typename VectorType::ScalarType             RangeFieldType;
+  typedef CachedLinearSolver< MatrixType >            LinearSolverType;
+  typedef std::function< void(const VectorType& /*iterate*/, VectorType& /*residual*/, MatrixType* /*jacobian*/) >
+      AssemblerType;
+
+  static std::vector< std::string > types()
+  {
+    return {"newton", "newton.eisenstat_walker"};
+  }
+
+  static Stuff::Common::Configuration options(const std::string type = "")
+  {
+    const std::string tp = !type.empty() ? type : types()[0];
+    Stuff::Common::Configuration opts;
+    opts["type"] = tp;
+    opts["max_iter"] = "50";
+    opts["precision"] = "1e-10";
+    opts["max_jacobian_age"] = "1";
+    opts["jacobian_reassembly_ratio"] = "0.5";
+    opts["verbose"] = "0";
+    if (tp == "newton") {
+      opts["linear_solver"] = LinearSolverType::types()[0];
+    } else if (tp == "newton.eisenstat_walker") {
+      opts["linear_solver"] = iterative_linear_solver_type();
+      opts["eisenstat_walker.gamma"] = "0.9";
+      opts["eisenstat_walker.alpha"] = "2";
+      opts["eisenstat_walker.eta_max"] = "0.9";
+      opts["eisenstat_walker.eta_0"] = "0.5";
+    } else
+      DUNE_THROW(Stuff::Exceptions::wrong_input_given,
+                 "Given type '" << tp << "' is not one of the available types()!");
+    return opts;
+  } // ... options(...)
+
+  /**
+   * \param jacobian A matrix with the sparsity pattern of the jacobian, the jacobians are assembled into a copy.
+   */
+  Newton(AssemblerType assembler, const MatrixType& jacobian)
+    : assembler_(assembler)
+    , jacobian_(jacobian)
+    , iterations_(0)
+    , num_jacobian_assemblies_(0)
+    , num_residual_assemblies_(0)
+  {}
+
+  size_t iterations() const
+  {
+    return iterations_;
+  }
+
+  size_t num_jacobian_assemblies() const
+  {
+    return num_jacobian_assemblies_;
+  }
+
+  size_t num_residual_assemblies() const
+  {
+    return num_residual_assemblies_;
+  }
+
+  void apply(VectorType& solution) const
+  {
+    apply(solution, options(types()[0]));
+  }
+
+  void apply(VectorType& solution, const std::string& type) const
+  {
+    apply(solution, options(type));
+  }
+
+  /**
+   * \param solution Used as the initial guess, contains the solution afterwards.
+   */
+  void apply(VectorType& solution, const Stuff::Common::Configuration& opts) const
+  {
+    const std::string type = opts.get< std::string >("type");
+    const auto available_types = types();
+    if (std::find(available_types.begin(), available_types.end(), type) == available_types.end())
+      DUNE_THROW(Stuff::Exceptions::wrong_input_given,
+                 "Given type '" << type << "' is not one of the available types()!");
+    const bool eisenstat_walker = (type == "newton.eisenstat_walker");
+    const size_t max_iter = opts.get("max_iter", size_t(50));
+    const RangeFieldType precision = opts.get("precision", RangeFieldType(1e-10));
+    const size_t max_jacobian_age = std::max(opts.get("max_jacobian_age", size_t(1)), size_t(1));
+    const RangeFieldType reassembly_ratio = opts.get("jacobian_reassembly_ratio", RangeFieldType(0.5));
+    const int verbose = opts.get("verbose", 0);
+    const RangeFieldType gamma = opts.get("eisenstat_walker.gamma", RangeFieldType(0.9));
+    const RangeFieldType alpha = opts.get("eisenstat_walker.alpha", RangeFieldType(2));
+    const RangeFieldType eta_max = opts.get("eisenstat_walker.eta_max", RangeFieldType(0.9));
+    auto linear_opts = LinearSolverType::options(
+          opts.get("linear_solver", eisenstat_walker ? iterative_linear_solver_type() : LinearSolverType::types()[0]));
+    if (eisenstat_walker) {
+      if (!linear_opts.has_key("precision"))
+        DUNE_THROW(Stuff::Exceptions::wrong_input_given,
+                   "The linear solver '" << linear_opts.get< std::string >("type") << "' is not iterative, as required"
+                   << " by the type '" << type << "'!");
+      // the linear systems are solved inexactly on purpose
+      linear_opts["post_check_solves_system"] = "0";
+    }
+    iterations_ = 0;
+    num_jacobian_assemblies_ = 0;
+    num_residual_assemblies_ = 0;
+    std::unique_ptr< LinearSolverType > linear_solver;
+    size_t jacobian_age = 0;
+    VectorType residual = solution.copy();
+    VectorType update = solution.copy();
+    RangeFieldType initial_residual_norm(0);
+    RangeFieldType previous_residual_norm(0);
+    RangeFieldType eta = opts.get("eisenstat_walker.eta_0", RangeFieldType(0.5));
+    for (;; ++iterations_) {
+      // we assemble the jacobian along with the residual (one walk), if it is known to be required
+      bool reassembled = !linear_solver || jacobian_age >= max_jacobian_age;
+      assemble(solution, residual, reassembled, linear_solver);
+      const RangeFieldType residual_norm = residual.l2_norm();
+      if (iterations_ == 0)
+        initial_residual_norm = residual_norm;
+      if (verbose > 0)
+        std::cout << type << ": iteration " << iterations_ << ", residual norm " << residual_norm
+                  << (reassembled ? " (new jacobian)" : "") << std::endl;
+      if (!std::isfinite(residual_norm))
+        DUNE_THROW(Exceptions::nonlinear_solver_failed,
+                   "The residual norm is " << residual_norm << " in iteration " << iterations_ << "!");
+      if (residual_norm <= precision * initial_residual_norm || residual_norm == RangeFieldType(0))
+        return;
+      if (iterations_ >= max_iter)
+        DUNE_THROW(Exceptions::nonlinear_solver_failed,
+                   "Did not converge in " << max_iter << " iterations (reduced the residual norm from "
+                   << initial_residual_norm << " to " << residual_norm << ", requested was " << precision << ")!");
+      if (!reassembled && residual_norm > reassembly_ratio * previous_residual_norm) {
+        // the frozen jacobian did not reduce the residual sufficiently, the residual is recomputed in the same walk
+        assemble(solution, residual, true, linear_solver);
+        reassembled = true;
+      }
+      if (reassembled)
+        jacobian_age = 0;
+      if (eisenstat_walker) {
+        if (iterations_ > 0) {
+          // choice 2 of Eisenstat and Walker, with their safeguard against too small forcing terms
+          const RangeFieldType safeguard = gamma * std::pow(eta, alpha);
+          eta = gamma * std::pow(residual_norm / previous_residual_norm, alpha);
+          if (safeguard > 0.1)
+            eta = std::max(eta, safeguard);
+          eta = std::min(eta, eta_max);
+        }
+        // do not solve more accurately than required for the nonlinear precision
+        eta = std::max(eta, RangeFieldType(0.5) * precision * initial_residual_norm / residual_norm);
+        linear_opts["precision"] = Stuff::Common::toString(eta);
+      }
+      update *= 0.0;
+      try {
+        linear_solver->apply(residual, update, linear_opts);
+      } catch (Stuff::Exceptions::linear_solver_failed& ee) {
+        DUNE_THROW(Exceptions::nonlinear_solver_failed,
+                   "The linear solver failed in iteration " << iterations_ << ":\n\n" << ee.what());
+      }
+      solution -= update;
+      ++jacobian_age;
+      previous_residual_norm = residual_norm;
+    }
+  } // ... apply(...)
+
+private:
+  static std::string iterative_linear_solver_type()
+  {
+    for (const auto& tp : LinearSolverType::types())
+      if (LinearSolverType::options(tp).has_key("precision"))
+        return tp;
+    return LinearSolverType::types()[0];
+  }
+
+  void assemble(const VectorType& iterate,
+                VectorType& residual,
+                const bool with_jacobian,
+                std::unique_ptr< LinearSolverType >& linear_solver) const
+  {
+    if (with_jacobian) {
+      linear_solver.reset();
+      assembler_(iterate, residual, &jacobian_);
+      linear_solver = std::unique_ptr< LinearSolverType >(new LinearSolverType(jacobian_));
+      ++num_jacobian_assemblies_;
+    } else
+      assembler_(iterate, residual, nullptr);
+    ++num_residual_assemblies_;
+  } // ... assemble(...)
+
+  const AssemblerType assembler_;
+  mutable MatrixType jacobian_;
+  mutable size_t iterations_;
+  mutable size_t num_jacobian_assemblies_;
+  mutable size_t num_residual_assemblies_;
+}; // class Newton
+
+
+} // namespace Solvers
+} // namespace GDT
+} // namespace Dune
+
+#endif // DUNE_GDT_SOLVERS_NEWTON_HH
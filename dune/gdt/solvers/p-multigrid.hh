@@ -0,0 +1,228 @@
+// This file is part of the dune-gdt project:
+//   http://users.dune-project.org/projects/dune-gdt
+// Copyright holders: Felix Schindler
+// License: BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+
+#ifndef DUNE_GDT_SOLVERS_P_MULTIGRID_HH
+#define DUNE_GDT_SOLVERS_P_MULTIGRID_HH
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include <dune/stuff/common/configuration.hh>
+#include <dune/stuff/common/exceptions.hh>
+
+#include <dune/gdt/operators/prolongations.hh>
+#include <dune/gdt/spaces/interface.hh>
+
+#include "multigrid.hh"
+
+namespace Dune {
+namespace GDT {
+namespace Solvers {
+
+
+/**
+ * \brief Returns the DoFs of each entity of the grid view of space, as required for the "block_jacobi" smoother of
+ *        Multigrid.
+ * \note  If some DoFs are shared by several entities (as for CG spaces), no blocks are returned, so that the level
+ *        is smoothed pointwise.
+ */
+template< class SpaceType >
+std::vector< std::vector< size_t > > entity_blocks(const SpaceType& space)
+{
+  static_assert(is_space< SpaceType >::value, "SpaceType has to be derived from SpaceInterface!");
+  std::vector< std::vector< size_t > > blocks;
+  std::vector< bool > visited(space.mapper().size(), false);
+  const auto entity_it_end = space.grid_view().template end< 0 >();
+  for (auto entity_it = space.grid_view().template begin< 0 >(); entity_it != entity_it_end; ++entity_it) {
+    const auto global_indices = space.mapper().globalIndices(*entity_it);
+    std::vector< size_t > block(global_indices.size());
+    for (size_t ii = 0; ii < global_indices.size(); ++ii) {
+      block[ii] = global_indices[ii];
+      if (visited[block[ii]])
+        return std::vector< std::vector< size_t > >();
+      visited[block[ii]] = true;
+    }
+    blocks.emplace_back(std::move(block));
+  }
+  return blocks;
+} // ... entity_blocks(...)
+
+
+/**
+ * \brief A polynomial multigrid method, where the levels are given by spaces of decreasing polynomial order on the
+ *        same grid (e.g. DG spaces of order p, p - 1, ..., 1 and a CG space of order 1).
+ *
+ *        Only the system matrix on the finest level has to be assembled, the coarse levels are given by the Galerkin
+ *        products P^T A P with the prolongations P, the default smoother is the element-block Jacobi method (which
+ *        is order robust for DG discretizations, contrary to pointwise smoothers). See make_p_multigrid() for the
+ *        assembly of the prolongations and blocks and Multigrid for the remaining options.
+ * \note  For spaces on the same grid with nested polynomial spaces the L2 prolongation (see
+ *        Operators::L2Prolongation::assemble_matrix()) is the natural embedding of the coarse space.
+ */
+template< class MatrixImp, class VectorImp >
+class PMultigrid
+  : public Multigrid< MatrixImp, VectorImp >
+{
+  typedef Multigrid< MatrixImp, VectorImp > BaseType;
+public:
+  using typename BaseType::MatrixType;
+  using typename BaseType::VectorType;
+  using typename BaseType::ScalarType;
+  using typename BaseType::BlocksType;
+
+  static std::vector< std::string > types()
+  {
+    return BaseType::types();
+  }
+
+  static Stuff::Common::Configuration options(const std::string type = "")
+  {
+    auto opts = BaseType::options(type);
+    opts["smoother"] = "block_jacobi";
+    return opts;
+  }
+
+  /**
+   * \param system_matrix The system matrix on the finest level.
+   * \param prolongations prolongations[ll] maps from level ll to level ll + 1 (level 0 being the coarsest one).
+   * \param blocks        See Multigrid.
+   */
+  PMultigrid(const MatrixType& system_matrix,
+             const std::vector< MatrixType >& prolongations,
+             const std::vector< BlocksType >& blocks = std::vector< BlocksType >(),
+             const bool use_tbb = false)
+    : BaseType(galerkin_hierarchy(system_matrix, prolongations), prolongations, blocks, use_tbb)
+  {}
+
+  using BaseType::apply;
+
+  void apply(const VectorType& rhs, VectorType& solution) const
+  {
+    apply(rhs, solution, options(types()[0]));
+  }
+
+  void apply(const VectorType& rhs, VectorType& solution, const std::string& type) const
+  {
+    apply(rhs, solution, options(type));
+  }
+
+  /**
+   * \brief Returns the system matrices of all levels (from the coarsest to the finest one), given by Galerkin
+   *        products.
+   * \note  Rows of the coarse matrices which vanish (since they only couple to constrained DoFs of the finer level)
+   *        are replaced by unit rows.
+   */
+  static std::vector< MatrixType > galerkin_hierarchy(const MatrixType& system_matrix,
+                                                     const std::vector< MatrixType >& prolongations)
+  {
+    typedef internal::CsrMatrix< ScalarType > CsrMatrixType;
+    // the coarse matrices are created from the finest to the coarsest one
+    std::vector< MatrixType > ret;
+    ret.reserve(prolongations.size() + 1);
+    CsrMatrixType fine_matrix = internal::to_csr(system_matrix);
+    for (size_t nn = prolongations.size(); nn > 0; --nn) {
+      const auto& prolongation_matrix = prolongations[nn - 1];
+      if (prolongation_matrix.rows() != fine_matrix.rows())
+        DUNE_THROW(Stuff::Exceptions::shapes_do_not_match,
+                   "The prolongation onto level " << nn << " has " << prolongation_matrix.rows() << " rows, the "
+                   << "system matrix on that level has " << fine_matrix.rows() << "!");
+      auto prolongation = internal::to_csr(prolongation_matrix);
+      // as in Multigrid, constrained DoFs of the finer level are not touched by the prolongation
+      const auto constrained = fine_matrix.unit_rows();
+      for (size_t ii = 0; ii < prolongation.rows(); ++ii)
+        if (constrained[ii])
+          for (size_t kk = prolongation.row_begin(ii); kk < prolongation.row_end(ii); ++kk)
+            prolongation.value(kk) = ScalarType(0);
+      auto coarse_matrix = prolongation.transposed().multiply(fine_matrix.multiply(prolongation));
+      fine_matrix = unit_rows_for_empty_rows(coarse_matrix);
+      ret.emplace_back(internal::from_csr< MatrixType >(fine_matrix));
+    }
+    std::reverse(ret.begin(), ret.end());
+    ret.emplace_back(system_matrix);
+    return ret;
+  } // ... galerkin_hierarchy(...)
+
+private:
+  static internal::CsrMatrix< ScalarType > unit_rows_for_empty_rows(const internal::CsrMatrix< ScalarType >& matrix)
+  {
+    std::vector< size_t > row_offsets(matrix.rows() + 1, 0);
+    std::vector< size_t > column_indices;
+    std::vector< ScalarType > values;
+    for (size_t ii = 0; ii < matrix.rows(); ++ii) {
+      bool is_empty = true;
+      for (size_t kk = matrix.row_begin(ii); kk < matrix.row_end(ii); ++kk)
+        is_empty = is_empty && (matrix.value(kk) == ScalarType(0));
+      if (is_empty) {
+        column_indices.push_back(ii);
+        values.push_back(ScalarType(1));
+      } else {
+        for (size_t kk = matrix.row_begin(ii); kk < matrix.row_end(ii); ++kk) {
+          column_indices.push_back(matrix.column_index(kk));
+          values.push_back(matrix.value(kk));
+        }
+      }
+      row_offsets[ii + 1] = values.size();
+    }
+    return internal::CsrMatrix< ScalarType >(matrix.cols(),
+                                             std::move(row_offsets), std::move(column_indices), std::move(values));
+  } // ... unit_rows_for_empty_rows(...)
+}; // class PMultigrid
+
+
+namespace internal {
+
+
+template< class MatrixType, class SpaceType >
+void add_p_multigrid_levels(std::vector< MatrixType >& /*prolongations*/,
+                            std::vector< std::vector< std::vector< size_t > > >& blocks,
+                            const SpaceType& finest_space)
+{
+  blocks.emplace_back(entity_blocks(finest_space));
+}
+
+template< class MatrixType, class CoarseSpaceType, class FineSpaceType, class... SpaceTypes >
+void add_p_multigrid_levels(std::vector< MatrixType >& prolongations,
+                            std::vector< std::vector< std::vector< size_t > > >& blocks,
+                            const CoarseSpaceType& coarse_space,
+                            const FineSpaceType& fine_space,
+                            const SpaceTypes&... finer_spaces)
+{
+  typedef typename FineSpaceType::GridViewType GridViewType;
+  blocks.emplace_back(entity_blocks(coarse_space));
+  prolongations.emplace_back(Operators::L2Prolongation< GridViewType >(fine_space.grid_view())
+                               .template assemble_matrix< MatrixType >(coarse_space, fine_space));
+  add_p_multigrid_levels(prolongations, blocks, fine_space, finer_spaces...);
+}
+
+
+} // namespace internal
+
+
+/**
+ * \brief Creates a PMultigrid for the given system matrix on the last of the given spaces.
+ *
+ *        The spaces are given from the coarsest to the finest one, e.g. a CG space of order 1 and DG spaces of order
+ *        1, 2 and 3, all on the same grid. The L2 prolongations between consecutive spaces and the entity blocks of
+ *        all DG spaces are assembled here.
+ */
+template< class VectorType, class MatrixType, class... SpaceTypes >
+PMultigrid< MatrixType, VectorType > make_p_multigrid(const MatrixType& system_matrix,
+                                                      const bool use_tbb,
+                                                      const SpaceTypes&... spaces)
+{
+  static_assert(sizeof...(SpaceTypes) > 1, "At least two spaces are required!");
+  std::vector< MatrixType > prolongations;
+  std::vector< std::vector< std::vector< size_t > > > blocks;
+  internal::add_p_multigrid_levels(prolongations, blocks, spaces...);
+  return PMultigrid< MatrixType, VectorType >(system_matrix, prolongations, blocks, use_tbb);
+} // ... make_p_multigrid(...)
+
+
+} // namespace Solvers
+} // namespace GDT
+} // namespace Dune
+
+#endif // DUNE_GDT_SOLVERS_P_MULTIGRID_HH
@@ -0,0 +1,324 @@
+// This file is part of the dune-gdt project:
+//   http://users.dune-project.org/projects/dune-gdt
+// Copyright holders: Felix Schindler
+// License: BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+
+#ifndef DUNE_GDT_SOLVERS_SCHWARZ_HH
+#define DUNE_GDT_SOLVERS_SCHWARZ_HH
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <dune/stuff/common/configuration.hh>
+#include <dune/stuff/common/exceptions.hh>
+#include <dune/stuff/la/container.hh>
+
+#include "cached.hh"
+#include "csr.hh"
+#include "krylov.hh"
+
+namespace Dune {
+namespace GDT {
+namespace Solvers {
+
+
+/**
+ * \brief Additive and restricted additive Schwarz preconditioners with CG and BiCGStab.
+ *
+ *        The subdomains are given by (disjoint) sets of DoFs, e.g. the DoFs of each local space of a Spaces::Block
+ *        (see BlockSystemAssembler::blocks()), and are extended by overlap layers of neighbors in the graph of the
+ *        matrix. The matrix of each extended subdomain is extracted and handed to a CachedLinearSolver once, so each
+ *        local matrix is factorized only once (on the first application of the preconditioner) and all local solves
+ *        are done in parallel, if requested. The additive variant sums the local solutions on all DoFs of the extended
+ *        subdomains, the restricted variant only takes the DoFs a subdomain owns (which is not symmetric but converges
+ *        faster and requires no summation). Rows which are not contained in any subdomain are treated pointwise.
+ * \note  The local solutions are kept between applications, so a preconditioner must not be used concurrently.
+ */
+template< class MatrixImp, class VectorImp >
+class Schwarz
+{
+public:
+  typedef MatrixImp                            MatrixType;
+  typedef VectorImp                            VectorType;
+  typedef typename MatrixType::ScalarType      ScalarType;
+  typedef std::vector< std::vector< size_t > > BlocksType;
+  typedef CachedLinearSolver< MatrixType >     LocalSolverType;
+private:
+  static_assert(Stuff::LA::is_matrix< MatrixType >::value,
+                "MatrixType has to be derived from Stuff::LA::MatrixInterface!");
+  static_assert(Stuff::LA::is_vector< VectorType >::value,
+                "VectorType has to be derived from Stuff::LA::VectorInterface!");
+  typedef std::vector< ScalarType > StdVectorType;
+
+  struct Subdomain
+  {
+    // the owned DoFs come first, followed by the overlap
+    std::vector< size_t > dofs;
+    size_t num_owned;
+    std::shared_ptr< const LocalSolverType > solver;
+  }; // struct Subdomain
+
+public:
+  static std::vector< std::string > types()
+  {
+    return {"bicgstab.restricted_additive_schwarz", "bicgstab.additive_schwarz", "cg.additive_schwarz"};
+  }
+
+  static Stuff::Common::Configuration options(const std::string type = "")
+  {
+    const auto available_types = types();
+    const std::string tp = type.empty() ? available_types[0] : type;
+    if (std::find(available_types.begin(), available_types.end(), tp) == available_types.end())
+      DUNE_THROW(Stuff::Exceptions::wrong_input_given,
+                 "Given type '" << tp << "' is not one of the available types (see types())!");
+    Stuff::Common::Configuration opts;
+    opts["type"] = tp;
+    opts["max_iter"] = "10000";
+    opts["precision"] = "1e-10";
+    opts["post_check_solves_system"] = "1e-5";
+    opts["verbose"] = "0";
+    return opts;
+  } // ... options(...)
+
+  /**
+   * \param blocks            The (disjoint) sets of DoFs owned by each subdomain.
+   * \param overlap           The number of layers (in the graph of the matrix) each subdomain is extended by.
+   * \param local_solver_type One of CachedLinearSolver::types(), the default is the first one.
+   */
+  Schwarz(const MatrixType& matrix,
+          const BlocksType& blocks,
+          const size_t overlap = 1,
+          const bool use_tbb = false,
+          const std::string local_solver_type = "")
+    : use_tbb_(use_tbb)
+    , matrix_(internal::to_csr(matrix))
+    , subdomains_(blocks.size())
+    , local_solver_options_(LocalSolverType::options(local_solver_type.empty() ? LocalSolverType::types()[0]
+                                                                               : local_solver_type))
+    , in_block_(matrix_.rows(), false)
+    , inverse_diagonal_(matrix_.rows(), ScalarType(0))
+    , last_iterations_(0)
+  {
+    if (matrix_.rows() != matrix_.cols())
+      DUNE_THROW(Stuff::Exceptions::shapes_do_not_match, "The given matrix is not square!");
+    for (const auto& block : blocks)
+      for (const auto& ii : block) {
+        if (ii >= matrix_.rows())
+          DUNE_THROW(Stuff::Exceptions::wrong_input_given,
+                     "Given a block with DoF " << ii << ", the matrix has only " << matrix_.rows() << " rows!");
+        // the restricted variant writes the owned DoFs concurrently
+        if (in_block_[ii])
+          DUNE_THROW(Stuff::Exceptions::wrong_input_given, "DoF " << ii << " is contained in several blocks!");
+        in_block_[ii] = true;
+      }
+    const auto diagonal = matrix_.diagonal();
+    for (size_t ii = 0; ii < matrix_.rows(); ++ii)
+      if (!in_block_[ii]) {
+        if (diagonal[ii] == ScalarType(0))
+          DUNE_THROW(Stuff::Exceptions::linear_solver_failed, "The matrix has a zero on its diagonal in row " << ii
+                     << "!");
+        inverse_diagonal_[ii] = ScalarType(1) / diagonal[ii];
+      }
+    // extend the subdomains and extract their matrices
+    const auto setup_subdomains = [&](const size_t first, const size_t last) {
+      static const size_t not_contained = std::numeric_limits< size_t >::max();
+      std::vector< size_t > local_index(matrix_.rows(), not_contained);
+      for (size_t ss = first; ss < last; ++ss) {
+        auto& subdomain = subdomains_[ss];
+        subdomain.dofs = blocks[ss];
+        subdomain.num_owned = subdomain.dofs.size();
+        for (size_t ii = 0; ii < subdomain.dofs.size(); ++ii)
+          local_index[subdomain.dofs[ii]] = ii;
+        size_t layer_begin = 0;
+        for (size_t layer = 0; layer < overlap; ++layer) {
+          const size_t layer_end = subdomain.dofs.size();
+          for (size_t ll = layer_begin; ll < layer_end; ++ll) {
+            const size_t row = subdomain.dofs[ll];
+            for (size_t kk = matrix_.row_begin(row); kk < matrix_.row_end(row); ++kk) {
+              const size_t col = matrix_.column_index(kk);
+              if (local_index[col] == not_contained) {
+                local_index[col] = subdomain.dofs.size();
+                subdomain.dofs.push_back(col);
+              }
+            }
+          }
+          layer_begin = layer_end;
+        }
+        const size_t size = subdomain.dofs.size();
+        std::vector< size_t > row_offsets(size + 1, 0);
+        std::vector< size_t > column_indices;
+        StdVectorType values;
+        for (size_t ii = 0; ii < size; ++ii) {
+          const size_t row = subdomain.dofs[ii];
+          for (size_t kk = matrix_.row_begin(row); kk < matrix_.row_end(row); ++kk) {
+            const size_t col = local_index[matrix_.column_index(kk)];
+            if (col != not_contained) {
+              column_indices.push_back(col);
+              values.push_back(matrix_.value(kk));
+            }
+          }
+          row_offsets[ii + 1] = column_indices.size();
+        }
+        subdomain.solver = std::make_shared< LocalSolverType >(internal::from_csr< MatrixType >(
+            internal::CsrMatrix< ScalarType >(size, std::move(row_offsets), std::move(column_indices),
+                                              std::move(values))));
+        for (const auto& ii : subdomain.dofs)
+          local_index[ii] = not_contained;
+      }
+    };
+    internal::for_each_range(subdomains_.size(), use_tbb_, setup_subdomains);
+    for (const auto& subdomain : subdomains_) {
+      local_rhs_.emplace_back(subdomain.dofs.size(), ScalarType(0));
+      local_solutions_.emplace_back(subdomain.dofs.size(), ScalarType(0));
+    }
+  } // Schwarz(...)
+
+  size_t num_subdomains() const
+  {
+    return subdomains_.size();
+  }
+
+  /**
+   * \brief The number of DoFs of the extended subdomain ss.
+   */
+  size_t subdomain_size(const size_t ss) const
+  {
+    assert(ss < subdomains_.size());
+    return subdomains_[ss].dofs.size();
+  }
+
+  /**
+   * \brief The number of iterations of the last call to apply().
+   */
+  size_t iterations() const
+  {
+    return last_iterations_;
+  }
+
+  /**
+   * \brief Applies the (restricted, if requested) additive Schwarz preconditioner to rhs.
+   */
+  void precondition(const VectorType& rhs, VectorType& ret, const bool restricted = true) const
+  {
+    StdVectorType rr(rhs.size()), zz(rhs.size());
+    for (size_t ii = 0; ii < rhs.size(); ++ii)
+      rr[ii] = rhs.get_entry(ii);
+    precondition(rr, zz, restricted);
+    for (size_t ii = 0; ii < zz.size(); ++ii)
+      ret.set_entry(ii, zz[ii]);
+  } // ... precondition(...)
+
+  void apply(const VectorType& rhs, VectorType& solution) const
+  {
+    apply(rhs, solution, options(types()[0]));
+  }
+
+  void apply(const VectorType& rhs, VectorType& solution, const std::string& type) const
+  {
+    apply(rhs, solution, options(type));
+  }
+
+  /**
+   * \brief Solves the system, the given solution is used as initial guess.
+   */
+  void apply(const VectorType& rhs, VectorType& solution, const Stuff::Common::Configuration& opts) const
+  {
+    const size_t size = matrix_.rows();
+    if (rhs.size() != size || solution.size() != size)
+      DUNE_THROW(Stuff::Exceptions::shapes_do_not_match,
+                 "The sizes of rhs (" << rhs.size() << ") and solution (" << solution.size()
+                 << ") do not match the system (" << size << ")!");
+    const std::string type = opts.get< std::string >("type", types()[0]);
+    const internal::Krylov< ScalarType > krylov(matrix_,
+                                                opts.get("max_iter", size_t(10000)),
+                                                opts.get("precision", ScalarType(1e-10)),
+                                                opts.get("verbose", 0),
+                                                use_tbb_,
+                                                "schwarz");
+    StdVectorType bb(size), xx(size);
+    for (size_t ii = 0; ii < size; ++ii) {
+      bb[ii] = rhs.get_entry(ii);
+      xx[ii] = solution.get_entry(ii);
+    }
+    const bool restricted = (type == "bicgstab.restricted_additive_schwarz");
+    const auto precondition_functor = [&](const StdVectorType& rr, StdVectorType& zz) {
+      precondition(rr, zz, restricted);
+    };
+    if (type == "cg.additive_schwarz")
+      last_iterations_ = krylov.cg(bb, xx, precondition_functor);
+    else if (type == "bicgstab.additive_schwarz" || type == "bicgstab.restricted_additive_schwarz")
+      last_iterations_ = krylov.bicgstab(bb, xx, precondition_functor);
+    else
+      DUNE_THROW(Stuff::Exceptions::wrong_input_given,
+                 "Given type '" << type << "' is not one of the available types (see types())!");
+    for (size_t ii = 0; ii < size; ++ii)
+      solution.set_entry(ii, xx[ii]);
+    if (!solution.valid())
+      DUNE_THROW(Stuff::Exceptions::linear_solver_failed, "The computed solution contains inf or nan!");
+    const ScalarType threshold = opts.get("post_check_solves_system", ScalarType(1e-5));
+    if (threshold > 0) {
+      StdVectorType rr(size);
+      krylov.residual(bb, xx, rr);
+      ScalarType sup_norm(0);
+      for (const auto& element : rr)
+        sup_norm = std::max(sup_norm, std::abs(element));
+      if (sup_norm > threshold)
+        DUNE_THROW(Stuff::Exceptions::linear_solver_failed,
+                   "The computed solution does not solve the system (sup norm of the residual is " << sup_norm
+                   << ", should be below " << threshold << ")!");
+    }
+  } // ... apply(...)
+
+private:
+  void precondition(const StdVectorType& rr, StdVectorType& zz, const bool restricted) const
+  {
+    assert(rr.size() == matrix_.rows());
+    assert(zz.size() == matrix_.rows());
+    std::fill(zz.begin(), zz.end(), ScalarType(0));
+    const auto solve_locally = [&](const size_t first, const size_t last) {
+      for (size_t ss = first; ss < last; ++ss) {
+        const auto& subdomain = subdomains_[ss];
+        auto& local_rhs = local_rhs_[ss];
+        auto& local_solution = local_solutions_[ss];
+        for (size_t ii = 0; ii < subdomain.dofs.size(); ++ii)
+          local_rhs.set_entry(ii, rr[subdomain.dofs[ii]]);
+        subdomain.solver->apply(local_rhs, local_solution, local_solver_options_);
+        // the owned DoFs are disjoint
+        if (restricted)
+          for (size_t ii = 0; ii < subdomain.num_owned; ++ii)
+            zz[subdomain.dofs[ii]] = local_solution.get_entry(ii);
+      }
+    };
+    internal::for_each_range(subdomains_.size(), use_tbb_, solve_locally);
+    if (!restricted)
+      for (size_t ss = 0; ss < subdomains_.size(); ++ss) {
+        const auto& dofs = subdomains_[ss].dofs;
+        for (size_t ii = 0; ii < dofs.size(); ++ii)
+          zz[dofs[ii]] += local_solutions_[ss].get_entry(ii);
+      }
+    for (size_t ii = 0; ii < rr.size(); ++ii)
+      if (!in_block_[ii])
+        zz[ii] += inverse_diagonal_[ii] * rr[ii];
+  } // ... precondition(...)
+
+  const bool use_tbb_;
+  const internal::CsrMatrix< ScalarType > matrix_;
+  std::vector< Subdomain > subdomains_;
+  const Stuff::Common::Configuration local_solver_options_;
+  std::vector< bool > in_block_;
+  StdVectorType inverse_diagonal_;
+  mutable std::vector< VectorType > local_rhs_;
+  mutable std::vector< VectorType > local_solutions_;
+  mutable size_t last_iterations_;
+}; // class Schwarz
+
+
+} // namespace Solvers
+} // namespace GDT
+} // namespace Dune
+
+#endif // DUNE_GDT_SOLVERS_SCHWARZ_HH
@@ -7,6 +7,7 @@
 #define DUNE_GDT_SPACES_CG_FEM_HH
 
 #include <memory>
+#include <mutex>
 
 #include <dune/common/deprecated.hh>
 
@@ -66,7 +67,7 @@ public:
         RangeFieldType, rangeDim, rangeDimCols > BaseFunctionSetType;
   static const Stuff::Grid::ChoosePartView part_view_type = Stuff::Grid::ChoosePartView::part;
   static const bool needs_grid_view = false;
-  typedef CommunicationChooser< GridViewType, false > CommunicationChooserType;
+  typedef CommunicationChooser< GridViewType >        CommunicationChooserType;
   typedef typename CommunicationChooserType::Type     CommunicatorType;
 }; // class SpaceWrappedFemContinuousLagrangeTraits
 
@@ -109,6 +110,7 @@ public:
     , backend_(new BackendType(*gridPart_))
     , mapper_(new MapperType(backend_->blockMapper()))
     , communicator_(CommunicationChooserType::create(*gridView_))
+    , communicator_prepared_(new std::once_flag())
   {}
 
   FemBased(const ThisType& other) = default;
@@ -153,9 +155,13 @@ public:
     return BaseFunctionSetType(*backend_, entity);
   }
 
+  /**
+   * \note The communicator (and whether it is prepared) is shared between copies of this space.
+   */
   CommunicatorType& communicator() const
   {
-    // no need to prepare the communicator, since we are not pdelab based
+    std::call_once(*communicator_prepared_,
+                   [&]() { CommunicationChooserType::prepare(*this, *communicator_); });
     return *communicator_;
   }
 
@@ -165,6 +171,7 @@ private:
   const std::shared_ptr< const BackendType > backend_;
   const std::shared_ptr< const MapperType > mapper_;
   mutable std::shared_ptr< CommunicatorType > communicator_;
+  const std::shared_ptr< std::once_flag > communicator_prepared_;
 }; // class FemBased< ..., 1 >
 
 
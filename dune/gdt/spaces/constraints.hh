@@ -92,6 +92,11 @@ public:
     return size_;
   }
 
+  const std::set< size_t >& dirichlet_DoFs() const
+  {
+    return dirichlet_DoFs_;
+  }
+
   inline void insert(const size_t DoF)
   {
     assert(DoF < size_);
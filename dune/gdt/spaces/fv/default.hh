@@ -6,7 +6,11 @@
 #ifndef DUNE_GDT_SPACES_FV_DEFAULT_HH
 #define DUNE_GDT_SPACES_FV_DEFAULT_HH
 
+#include <memory>
+#include <mutex>
+
 #include <dune/common/deprecated.hh>
+#include <dune/common/unused.hh>
 
 #include <dune/stuff/common/type_utils.hh>
 
@@ -84,15 +88,34 @@ public:
     : grid_view_(gv)
     , mapper_(grid_view_)
     , communicator_(CommunicationChooserType::create(grid_view_))
+    , communicator_prepared_(false)
   {}
 
+  /**
+   * \brief Copy ctor.
+   * \note  Manually implemented bc of the std::mutex + communicator_ unique_ptr
+   */
   Default(const ThisType& other)
     : grid_view_(other.grid_view_)
     , mapper_(other.mapper_)
     , communicator_(CommunicationChooserType::create(grid_view_))
-  {}
+    , communicator_prepared_(false)
+  {
+    // make sure our new communicator is prepared if other's was
+    if (other.communicator_prepared_)
+      const auto& DUNE_UNUSED(comm) = this->communicator();
+  }
 
-  Default(ThisType&& source) = default;
+  /**
+   * \brief Move ctor.
+   * \note  Manually implemented bc of the std::mutex.
+   */
+  Default(ThisType&& source)
+    : grid_view_(source.grid_view_)
+    , mapper_(source.mapper_)
+    , communicator_(std::move(source.communicator_))
+    , communicator_prepared_(source.communicator_prepared_)
+  {}
 
   ThisType& operator=(const ThisType& other) = delete;
 
@@ -120,14 +143,18 @@ public:
 
   CommunicatorType& communicator() const
   {
-    // no need to prepare the communicator, since we are not pdelab based
+    std::lock_guard< std::mutex > DUNE_UNUSED(gg)(communicator_mutex_);
+    if (!communicator_prepared_)
+      communicator_prepared_ = CommunicationChooserType::prepare(*this, *communicator_);
     return *communicator_;
-  }
+  } // ... communicator(...)
 
 private:
   const GridViewType grid_view_;
   const MapperType mapper_;
-  const std::unique_ptr< CommunicatorType > communicator_;
+  std::unique_ptr< CommunicatorType > communicator_;
+  mutable bool communicator_prepared_;
+  mutable std::mutex communicator_mutex_;
 }; // class Default< ..., 1, 1 >
 
 
@@ -8,20 +8,603 @@
 #ifndef DUNE_GDT_SPACES_PARALLEL_HH
 #define DUNE_GDT_SPACES_PARALLEL_HH
 
-#include <dune/common/parallel/communicator.hh>
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <map>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
-#include <dune/istl/owneroverlapcopy.hh>
+#if HAVE_MPI
+# include <mpi.h>
+#endif
 
-#if HAVE_DUNE_PDELAB
-# include <dune/pdelab/backend/istl/parallelhelper.hh>
+#include <dune/common/bigunsignedint.hh>
+#include <dune/common/parallel/communicator.hh>
+#include <dune/common/parallel/mpihelper.hh>
+#include <dune/common/unused.hh>
+#if HAVE_MPI
+# include <dune/common/parallel/mpitraits.hh>
 #endif
+#include <dune/grid/common/datahandleif.hh>
+#include <dune/grid/common/gridenums.hh>
+
+#include <dune/istl/owneroverlapcopy.hh>
 
+#include <dune/stuff/common/exceptions.hh>
+#include <dune/stuff/la/container/interfaces.hh>
 #include <dune/stuff/la/container/istl.hh>
 #include <dune/stuff/common/parallel/helper.hh>
 
 namespace Dune {
 namespace GDT {
 namespace Spaces {
+namespace internal {
+
+
+/**
+ * \brief Communicates valuesPerDof values per DoF of each codim 0 entity, see ParallelDofs.
+ */
+template< class SpaceType, class DataImp >
+class EntityDofDataHandle
+  : public Dune::CommDataHandleIF< EntityDofDataHandle< SpaceType, DataImp >, DataImp >
+{
+  typedef typename SpaceType::EntityType EntityType;
+public:
+  typedef DataImp                                                         DataType;
+  typedef std::function< void(const size_t /*dof*/, DataType* /*values*/) >       GatherType;
+  typedef std::function< void(const size_t /*dof*/, const DataType* /*values*/) > ScatterType;
+
+  EntityDofDataHandle(const SpaceType& space, const size_t valuesPerDof, GatherType gather, ScatterType scatter)
+    : space_(space)
+    , values_per_dof_(valuesPerDof)
+    , gather_(gather)
+    , scatter_(scatter)
+    , values_(values_per_dof_)
+  {}
+
+  bool contains(int /*dim*/, int codim) const
+  {
+    return codim == 0;
+  }
+
+  bool fixedsize(int /*dim*/, int /*codim*/) const
+  {
+    return false;
+  }
+
+  size_t size(const EntityType& entity) const
+  {
+    return values_per_dof_ * space_.mapper().numDofs(entity);
+  }
+
+  template< class E >
+  size_t size(const E& /*entity*/) const
+  {
+    return 0;
+  }
+
+  template< class BufferType >
+  void gather(BufferType& buffer, const EntityType& entity) const
+  {
+    const auto global_indices = space_.mapper().globalIndices(entity);
+    for (size_t ii = 0; ii < space_.mapper().numDofs(entity); ++ii) {
+      gather_(global_indices[ii], values_.data());
+      for (const auto& value : values_)
+        buffer.write(value);
+    }
+  } // ... gather(...)
+
+  template< class BufferType, class E >
+  void gather(BufferType& /*buffer*/, const E& /*entity*/) const {}
+
+  template< class BufferType >
+  void scatter(BufferType& buffer, const EntityType& entity, size_t /*n*/)
+  {
+    const auto global_indices = space_.mapper().globalIndices(entity);
+    for (size_t ii = 0; ii < space_.mapper().numDofs(entity); ++ii) {
+      for (auto& value : values_)
+        buffer.read(value);
+      scatter_(global_indices[ii], values_.data());
+    }
+  } // ... scatter(...)
+
+  template< class BufferType, class E >
+  void scatter(BufferType& /*buffer*/, const E& /*entity*/, size_t /*n*/) {}
+
+private:
+  const SpaceType& space_;
+  const size_t values_per_dof_;
+  const GatherType gather_;
+  const ScatterType scatter_;
+  mutable std::vector< DataType > values_;
+}; // class EntityDofDataHandle
+
+
+#if HAVE_MPI
+
+
+inline MPI_Comm mpi_communicator(const CollectiveCommunication< MPI_Comm >& comm)
+{
+  return comm;
+}
+
+/// grids without an MPI communicator are sequential
+template< class CommunicationType >
+MPI_Comm mpi_communicator(const CommunicationType& /*comm*/)
+{
+  return MPI_COMM_SELF;
+}
+
+
+#endif // HAVE_MPI
+
+} // namespace internal
+
+
+template< class ScalarImp >
+class HaloExchange;
+
+
+/**
+ * \brief The distribution of the DoFs of a space among the processes of a parallel run, computed from the partition
+ *        types of the grid view, for all space backends.
+ *
+ *        A DoF is owned by the process with the lowest rank among those which have the DoF on an interior entity. The
+ *        attribute of a DoF is owner, overlap (if it is also attached to an interior entity of this process, but owned
+ *        by another one) or copy (if it is only attached to overlap or ghost entities). The owned DoFs are numbered
+ *        consecutively across all processes, which gives the global indices. The constructor is collective.
+ *
+ *        prepare() sets up an OwnerOverlapCopyCommunication (as required by the parallel solvers of dune-istl) and
+ *        exchange() copies the values of the owned DoFs of a vector (e.g. the vector of a DiscreteFunction) to all
+ *        other processes, which hold a copy of these DoFs.
+ * \note  Owners and global indices are agreed on via the codim 0 entities, repeating the communication until
+ *        all processes sharing a DoF agree (even if some of them do not share an element). The processes sharing a
+ *        DoF have thus to be connected by overlap or ghost elements with this DoF, which is the case for grids with
+ *        overlap or ghost elements (e.g. YaspGrid with overlap). All further communication is point to point.
+ */
+template< class SpaceImp >
+class ParallelDofs
+{
+public:
+  typedef SpaceImp                                      SpaceType;
+  typedef typename SpaceType::GridViewType              GridViewType;
+  typedef typename SpaceType::EntityType                EntityType;
+  typedef OwnerOverlapCopyAttributeSet::AttributeSet    AttributeType;
+
+  /// the ranks of the neighboring processes, each with the list of DoFs to send to or receive from it
+  typedef std::vector< std::pair< int, std::vector< size_t > > > NeighborListsType;
+
+  static const size_t invalid_index = std::numeric_limits< size_t >::max();
+
+  explicit ParallelDofs(const SpaceType& spc)
+    : space_(spc)
+    , rank_(space_.grid_view().comm().rank())
+    , owner_ranks_(space_.mapper().size(), invalid_index)
+    , attributes_(space_.mapper().size(), OwnerOverlapCopyAttributeSet::copy)
+    , global_indices_(space_.mapper().size(), invalid_index)
+    , num_owned_(0)
+    , global_size_(0)
+  {
+    const auto& comm = space_.grid_view().comm();
+    // the candidates are the processes with the DoF on an interior entity
+    const auto entity_it_end = space_.grid_view().template end< 0 >();
+    for (auto entity_it = space_.grid_view().template begin< 0 >(); entity_it != entity_it_end; ++entity_it) {
+      const auto& entity = *entity_it;
+      if (entity.partitionType() == InteriorEntity) {
+        const auto global_indices = space_.mapper().globalIndices(entity);
+        for (size_t ii = 0; ii < space_.mapper().numDofs(entity); ++ii) {
+          owner_ranks_[global_indices[ii]] = rank_;
+          attributes_[global_indices[ii]] = OwnerOverlapCopyAttributeSet::overlap;
+        }
+      }
+    }
+    // the minimum is passed on between processes sharing an element with the DoF until it is known everywhere, since
+    // not all processes sharing a DoF share an element (e.g. at a vertex where more than two processes meet)
+    communicate_until_unchanged< size_t >([&](const size_t dof, size_t* values) { values[0] = owner_ranks_[dof]; },
+                                          [&](const size_t dof, const size_t* values) {
+                                            if (values[0] >= owner_ranks_[dof])
+                                              return false;
+                                            owner_ranks_[dof] = values[0];
+                                            return true;
+                                          });
+    for (size_t ii = 0; ii < owner_ranks_.size(); ++ii)
+      if (owner_ranks_[ii] == rank_) {
+        attributes_[ii] = OwnerOverlapCopyAttributeSet::owner;
+        ++num_owned_;
+      }
+    // number the owned DoFs consecutively
+    std::vector< size_t > num_owned_per_rank(comm.size(), 0);
+    comm.allgather(&num_owned_, 1, num_owned_per_rank.data());
+    size_t offset = 0;
+    for (size_t rr = 0; rr < num_owned_per_rank.size(); ++rr) {
+      if (rr == rank_)
+        offset = global_size_;
+      global_size_ += num_owned_per_rank[rr];
+    }
+    for (size_t ii = 0; ii < global_indices_.size(); ++ii)
+      if (owned(ii))
+        global_indices_[ii] = offset++;
+    // as above, the global indices are passed on by all processes which know them
+    communicate_until_unchanged< size_t >([&](const size_t dof, size_t* values) { values[0] = global_indices_[dof]; },
+                                          [&](const size_t dof, const size_t* values) {
+                                            if (values[0] == invalid_index || values[0] == global_indices_[dof])
+                                              return false;
+                                            if (global_indices_[dof] != invalid_index)
+                                              DUNE_THROW(Stuff::Exceptions::internal_error,
+                                                         "DoF " << dof << " on rank " << rank_ << " has the global "
+                                                         << "indices " << global_indices_[dof] << " and " << values[0]
+                                                         << "!");
+                                            global_indices_[dof] = values[0];
+                                            return true;
+                                          });
+    for (size_t ii = 0; ii < global_indices_.size(); ++ii)
+      if (global_indices_[ii] == invalid_index)
+        DUNE_THROW(Stuff::Exceptions::internal_error,
+                   "DoF " << ii << " on rank " << rank_ << " was not numbered by its owner (the processes sharing "
+                   << "this DoF have to be connected by elements with this DoF in their overlap or ghost partition)!");
+    build_neighbor_lists();
+  } // ParallelDofs(...)
+
+  /**
+   * \brief The number of DoFs of this process (including overlap and copy DoFs).
+   */
+  size_t size() const
+  {
+    return global_indices_.size();
+  }
+
+  size_t num_owned() const
+  {
+    return num_owned_;
+  }
+
+  /**
+   * \brief The number of DoFs of all processes (each DoF counted once).
+   */
+  size_t global_size() const
+  {
+    return global_size_;
+  }
+
+  bool owned(const size_t ii) const
+  {
+    assert(ii < attributes_.size());
+    return attributes_[ii] == OwnerOverlapCopyAttributeSet::owner;
+  }
+
+  AttributeType attribute(const size_t ii) const
+  {
+    assert(ii < attributes_.size());
+    return attributes_[ii];
+  }
+
+  size_t global_index(const size_t ii) const
+  {
+    assert(ii < global_indices_.size());
+    return global_indices_[ii];
+  }
+
+  /**
+   * \brief The owned DoFs, which other processes hold a copy of, grouped by process and sorted by global index.
+   */
+  const NeighborListsType& sends() const
+  {
+    return sends_;
+  }
+
+  /**
+   * \brief The non-owned DoFs, grouped by their owner and sorted by global index (matching sends() of the owner).
+   */
+  const NeighborListsType& receives() const
+  {
+    return receives_;
+  }
+
+#if HAVE_MPI
+  MPI_Comm mpi_communicator() const
+  {
+    return internal::mpi_communicator(space_.grid_view().comm());
+  }
+#endif
+
+#if HAVE_MPI
+  /**
+   * \brief Fills the index set and the remote indices of communicator.
+   */
+  template< class GlobalIdType, class LocalIdType >
+  void prepare(OwnerOverlapCopyCommunication< GlobalIdType, LocalIdType >& communicator) const
+  {
+    typedef typename OwnerOverlapCopyCommunication< GlobalIdType, LocalIdType >::ParallelIndexSet IndexSetType;
+    auto& index_set = communicator.indexSet();
+    index_set.beginResize();
+    for (size_t ii = 0; ii < size(); ++ii)
+      index_set.add(GlobalIdType(global_indices_[ii]),
+                    typename IndexSetType::LocalIndex(ii, attributes_[ii], true));
+    index_set.endResize();
+    communicator.remoteIndices().setIndexSets(index_set, index_set, communicator.communicator());
+    communicator.remoteIndices().template rebuild< false >();
+  } // ... prepare(...)
+#endif // HAVE_MPI
+
+  /**
+   * \brief Copies the values of the owned DoFs to all processes holding a copy of these DoFs.
+   */
+  template< class V, class S >
+  void exchange(Stuff::LA::VectorInterface< V, S >& vector) const
+  {
+    if (vector.size() != size())
+      DUNE_THROW(Stuff::Exceptions::shapes_do_not_match,
+                 "The size of the vector (" << vector.size() << ") does not match the number of DoFs (" << size()
+                 << ")!");
+    // the values are sent directly from the owners, see build_neighbor_lists()
+    HaloExchange< S > halo_exchange(*this);
+    halo_exchange.begin([&](const size_t dof) { return vector.get_entry(dof); });
+    halo_exchange.finish([&](const size_t dof, const S& value) { vector.set_entry(dof, value); });
+  } // ... exchange(...)
+
+  /**
+   * \brief The global scalar product, where each DoF is only counted by its owner.
+   */
+  template< class V, class S >
+  S dot(const Stuff::LA::VectorInterface< V, S >& xx, const Stuff::LA::VectorInterface< V, S >& yy) const
+  {
+    if (xx.size() != size() || yy.size() != size())
+      DUNE_THROW(Stuff::Exceptions::shapes_do_not_match,
+                 "The sizes of the vectors (" << xx.size() << ", " << yy.size() << ") do not match the number of "
+                 << "DoFs (" << size() << ")!");
+    S ret(0);
+    for (size_t ii = 0; ii < size(); ++ii)
+      if (owned(ii))
+        ret += xx.get_entry(ii) * yy.get_entry(ii);
+    return space_.grid_view().comm().sum(ret);
+  } // ... dot(...)
+
+private:
+  /**
+   * Each process requests the global indices of its non-owned DoFs from their owners, which yields matching send
+   * and receive lists (regardless of which entities the processes share).
+   */
+  void build_neighbor_lists()
+  {
+    if (space_.grid_view().comm().size() == 1)
+      return;
+#if HAVE_MPI
+    const MPI_Comm comm = mpi_communicator();
+    const int num_ranks = space_.grid_view().comm().size();
+    std::map< size_t, std::vector< size_t > > dofs_per_owner;
+    for (size_t ii = 0; ii < size(); ++ii)
+      if (!owned(ii)) {
+        if (owner_ranks_[ii] == invalid_index)
+          DUNE_THROW(Stuff::Exceptions::internal_error,
+                     "The owner of DoF " << ii << " on rank " << rank_ << " is unknown!");
+        dofs_per_owner[owner_ranks_[ii]].push_back(ii);
+      }
+    std::vector< int > num_requested(num_ranks, 0);
+    std::vector< std::vector< size_t > > requested_indices;
+    for (auto& element : dofs_per_owner) {
+      auto& dofs = element.second;
+      std::sort(dofs.begin(), dofs.end(), [&](const size_t ii, const size_t jj) {
+        return global_indices_[ii] < global_indices_[jj];
+      });
+      num_requested[element.first] = static_cast< int >(dofs.size());
+      std::vector< size_t > indices(dofs.size());
+      for (size_t ii = 0; ii < dofs.size(); ++ii)
+        indices[ii] = global_indices_[dofs[ii]];
+      requested_indices.emplace_back(std::move(indices));
+      receives_.emplace_back(static_cast< int >(element.first), dofs);
+    }
+    std::vector< int > num_to_send(num_ranks, 0);
+    MPI_Alltoall(num_requested.data(), 1, MPI_INT, num_to_send.data(), 1, MPI_INT, comm);
+    for (int rr = 0; rr < num_ranks; ++rr)
+      if (num_to_send[rr] > 0)
+        sends_.emplace_back(rr, std::vector< size_t >(num_to_send[rr]));
+    std::vector< MPI_Request > requests;
+    requests.reserve(sends_.size() + receives_.size());
+    const auto index_type = MPITraits< size_t >::getType();
+    for (auto& element : sends_) {
+      requests.emplace_back();
+      MPI_Irecv(element.second.data(), int(element.second.size()), index_type, element.first, 0, comm,
+                &requests.back());
+    }
+    for (size_t nn = 0; nn < receives_.size(); ++nn) {
+      requests.emplace_back();
+      MPI_Isend(requested_indices[nn].data(), int(requested_indices[nn].size()), index_type, receives_[nn].first, 0,
+                comm, &requests.back());
+    }
+    MPI_Waitall(int(requests.size()), requests.data(), MPI_STATUSES_IGNORE);
+    // translate the requested global indices
+    std::unordered_map< size_t, size_t > owned_dofs;
+    for (size_t ii = 0; ii < size(); ++ii)
+      if (owned(ii))
+        owned_dofs[global_indices_[ii]] = ii;
+    for (auto& element : sends_)
+      for (auto& index : element.second) {
+        const auto search_result = owned_dofs.find(index);
+        if (search_result == owned_dofs.end())
+          DUNE_THROW(Stuff::Exceptions::internal_error,
+                     "Rank " << element.first << " requested DoF " << index << " from rank " << rank_
+                     << ", which does not own it!");
+        index = search_result->second;
+      }
+#endif // HAVE_MPI
+  } // ... build_neighbor_lists(...)
+
+  /**
+   * Communicates one value per DoF until no process changes its values anymore, scatter returns whether it changed
+   * the value of the DoF. The values are passed on by one process per round, so at most one round per process is
+   * required.
+   */
+  template< class DataType, class GatherType, class ScatterType >
+  void communicate_until_unchanged(const GatherType& gather, const ScatterType& scatter) const
+  {
+    const auto& comm = space_.grid_view().comm();
+    for (int round = 0; round <= comm.size(); ++round) {
+      int changed = 0;
+      communicate< DataType >(1, gather, [&](const size_t dof, const DataType* values) {
+        if (scatter(dof, values))
+          changed = 1;
+      });
+      if (comm.max(changed) == 0)
+        return;
+    }
+    DUNE_THROW(Stuff::Exceptions::internal_error,
+               "The communication did not settle after " << comm.size() + 1 << " rounds!");
+  } // ... communicate_until_unchanged(...)
+
+  template< class DataType >
+  void communicate(const size_t values_per_dof,
+                   typename internal::EntityDofDataHandle< SpaceType, DataType >::GatherType gather,
+                   typename internal::EntityDofDataHandle< SpaceType, DataType >::ScatterType scatter) const
+  {
+    internal::EntityDofDataHandle< SpaceType, DataType > data_handle(space_, values_per_dof, gather, scatter);
+    space_.grid_view().communicate(data_handle, All_All_Interface, ForwardCommunication);
+  }
+
+  const SpaceType& space_;
+  const size_t rank_;
+  std::vector< size_t > owner_ranks_;
+  std::vector< AttributeType > attributes_;
+  std::vector< size_t > global_indices_;
+  size_t num_owned_;
+  size_t global_size_;
+  NeighborListsType sends_;
+  NeighborListsType receives_;
+}; // class ParallelDofs
+
+
+/**
+ * \brief Non-blocking exchange of the values of all non-owned DoFs, as given by ParallelDofs, to overlap
+ *        communication with computation:
+\code
+HaloExchange< double > halo_exchange(parallel_dofs);
+// compute the values of all owned DoFs, which other processes hold a copy of (see sent_dofs())
+halo_exchange.begin([&](const size_t dof) { return values[dof]; });
+// compute the values of all other DoFs
+halo_exchange.finish([&](const size_t dof, const double& value) { values[dof] = value; });
+\endcode
+ *        Since the buffers are only allocated once, repeated exchanges (e.g. in each operator application) are cheap.
+ *        In sequential runs (and for default constructed objects) begin() and finish() do nothing.
+ */
+template< class ScalarImp >
+class HaloExchange
+{
+public:
+  typedef ScalarImp                                               ScalarType;
+  typedef std::vector< std::pair< int, std::vector< size_t > > > NeighborListsType;
+
+  HaloExchange()
+#if HAVE_MPI
+    : comm_(MPI_COMM_SELF)
+    , in_flight_(false)
+#else
+    : in_flight_(false)
+#endif
+  {}
+
+  template< class SpaceType >
+  explicit HaloExchange(const ParallelDofs< SpaceType >& parallel_dofs)
+    : sends_(parallel_dofs.sends())
+    , receives_(parallel_dofs.receives())
+#if HAVE_MPI
+    , comm_(parallel_dofs.mpi_communicator())
+#endif
+    , send_buffers_(sends_.size())
+    , receive_buffers_(receives_.size())
+    , in_flight_(false)
+  {
+    for (size_t nn = 0; nn < sends_.size(); ++nn) {
+      send_buffers_[nn].resize(sends_[nn].second.size());
+      sent_dofs_.insert(sent_dofs_.end(), sends_[nn].second.begin(), sends_[nn].second.end());
+    }
+    for (size_t nn = 0; nn < receives_.size(); ++nn)
+      receive_buffers_[nn].resize(receives_[nn].second.size());
+    std::sort(sent_dofs_.begin(), sent_dofs_.end());
+    sent_dofs_.erase(std::unique(sent_dofs_.begin(), sent_dofs_.end()), sent_dofs_.end());
+  } // HaloExchange(...)
+
+  /**
+   * \brief Whether there is nothing to exchange.
+   */
+  bool empty() const
+  {
+    return sends_.empty() && receives_.empty();
+  }
+
+  /**
+   * \brief The (sorted) owned DoFs, which have to be computed before calling begin().
+   */
+  const std::vector< size_t >& sent_dofs() const
+  {
+    return sent_dofs_;
+  }
+
+  /**
+   * \brief Sends get(dof) for all sent DoFs and starts receiving the values of the non-owned DoFs.
+   */
+  template< class GetType >
+  void begin(const GetType& get)
+  {
+    if (in_flight_)
+      DUNE_THROW(Stuff::Exceptions::you_are_using_this_wrong, "Call finish() before starting a new exchange!");
+    if (empty())
+      return;
+#if HAVE_MPI
+    requests_.resize(sends_.size() + receives_.size());
+    const auto value_type = MPITraits< ScalarType >::getType();
+    for (size_t nn = 0; nn < receives_.size(); ++nn)
+      MPI_Irecv(receive_buffers_[nn].data(), int(receive_buffers_[nn].size()), value_type, receives_[nn].first,
+                tag, comm_, &requests_[nn]);
+    for (size_t nn = 0; nn < sends_.size(); ++nn) {
+      const auto& dofs = sends_[nn].second;
+      auto& buffer = send_buffers_[nn];
+      for (size_t ii = 0; ii < dofs.size(); ++ii)
+        buffer[ii] = get(dofs[ii]);
+      MPI_Isend(buffer.data(), int(buffer.size()), value_type, sends_[nn].first, tag, comm_,
+                &requests_[receives_.size() + nn]);
+    }
+    in_flight_ = true;
+#else // HAVE_MPI
+    DUNE_UNUSED_PARAMETER(get);
+#endif // HAVE_MPI
+  } // ... begin(...)
+
+  /**
+   * \brief Waits for all messages and calls set(dof, value) for all non-owned DoFs.
+   */
+  template< class SetType >
+  void finish(const SetType& set)
+  {
+    if (!in_flight_)
+      return;
+#if HAVE_MPI
+    MPI_Waitall(int(requests_.size()), requests_.data(), MPI_STATUSES_IGNORE);
+#endif
+    for (size_t nn = 0; nn < receives_.size(); ++nn) {
+      const auto& dofs = receives_[nn].second;
+      const auto& buffer = receive_buffers_[nn];
+      for (size_t ii = 0; ii < dofs.size(); ++ii)
+        set(dofs[ii], buffer[ii]);
+    }
+    in_flight_ = false;
+  } // ... finish(...)
+
+private:
+  static const int tag = 4711;
+
+  NeighborListsType sends_;
+  NeighborListsType receives_;
+#if HAVE_MPI
+  MPI_Comm comm_;
+  std::vector< MPI_Request > requests_;
+#endif
+  std::vector< std::vector< ScalarType > > send_buffers_;
+  std::vector< std::vector< ScalarType > > receive_buffers_;
+  std::vector< size_t > sent_dofs_;
+  bool in_flight_;
+}; // class HaloExchange
+
 
 template< class ViewImp,
           bool is_parallel = Dune::Stuff::UseParallelCommunication< typename ViewImp::Grid::CollectiveCommunication >::value >
@@ -55,21 +638,15 @@ struct CommunicationChooser< ViewImp, true >
     return new Type(gridView.comm());
   }
 
+  /**
+   * \brief Sets up the communicator for any space backend, see ParallelDofs.
+   */
   template< class Space >
-  static bool prepare(const Space&
-#if HAVE_DUNE_PDELAB
-                                   space,     Type& communicator)
-#else
-                                   /*space*/, Type& /*communicator*/)
-#endif
+  static bool prepare(const Space& space, Type& communicator)
   {
-#if HAVE_DUNE_PDELAB
-    Stuff::LA::IstlRowMajorSparseMatrix< typename Space::RangeFieldType > matrix;
-    PDELab::istl::ParallelHelper< typename Space::BackendType >(space.backend(), 0)
-        .createIndexSetAndProjectForAMG(matrix.backend(), communicator);
-#endif // HAVE_DUNE_PDELAB
+    ParallelDofs< Space >(space).prepare(communicator);
     return true;
-  } // ... prepare(...)
+  }
 }; // struct CommunicationChooser< ..., true >
 
 
@@ -13,6 +13,7 @@
 #include <dune/stuff/grid/provider.hh>
 #include <dune/stuff/la/container.hh>
 
+#include <dune/gdt/assembler/boundary-index.hh>
 #include <dune/gdt/assembler/system.hh>
 #include <dune/gdt/discretizations/default.hh>
 #include <dune/gdt/discretefunction/default.hh>
@@ -80,17 +81,19 @@ public:
     typedef typename SpaceType::GridViewType    GridViewType;
     typedef typename GridViewType::Intersection IntersectionType;
     auto boundary_info = Stuff::Grid::BoundaryInfoProvider< IntersectionType >::create(problem.boundary_info_cfg());
+    typedef BoundaryIntersectionIndex< GridViewType > BoundaryIndexType;
+    const BoundaryIndexType boundary_index(space.grid_view(), *boundary_info);
     logger.info() << "Assembling... " << std::endl;
     VectorType rhs_vector(space.mapper().size(), 0.0);
     auto elliptic_operator = Operators::make_elliptic_cg< MatrixType >(problem.diffusion_factor(),
                                                                        problem.diffusion_tensor(),
                                                                        space);
     auto l2_force_functional = Functionals::make_l2_volume(problem.force(), rhs_vector, space);
-    auto l2_neumann_functional
-        = Functionals::make_l2_face(problem.neumann(),
-                                    rhs_vector,
-                                    space,
-                                    new Stuff::Grid::ApplyOn::NeumannIntersections< GridViewType >(*boundary_info));
+    auto l2_neumann_functional = Functionals::make_l2_face(problem.neumann(),
+                                                           rhs_vector,
+                                                           space,
+                                                           boundary_index,
+                                                           BoundaryIndexType::BoundaryType::neumann);
     // prepare the dirichlet projection
     auto dirichlet_function = make_discrete_function< VectorType >(space, "dirichlet values");
     auto dirichlet_projection = Operators::make_localizable_dirichlet_projection(space.grid_view(),
@@ -104,7 +107,9 @@ public:
     assembler.add(*l2_force_functional);
     assembler.add(*l2_neumann_functional);
     assembler.add(dirichlet_projection);
-    assembler.add(dirichlet_constraints);
+    assembler.add(dirichlet_constraints,
+                  new IndexedBoundaryEntities< GridViewType >(boundary_index,
+                                                              BoundaryIndexType::BoundaryType::dirichlet));
     assembler.assemble();
     // assemble the dirichlet shift
     auto& system_matrix = elliptic_operator->matrix();
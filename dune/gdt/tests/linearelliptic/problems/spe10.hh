@@ -10,10 +10,10 @@
 
 #include <dune/stuff/functions/constant.hh>
 #include <dune/stuff/playground/functions/indicator.hh>
-#include <dune/stuff/functions/spe10.hh>
 #include <dune/stuff/grid/boundaryinfo.hh>
 #include <dune/stuff/grid/provider/cube.hh>
 
+#include <dune/gdt/functions/spe10.hh>
 #include <dune/gdt/tests/stationary-eocstudy.hh>
 
 #include "base.hh"
@@ -39,7 +39,7 @@ class Spe10Model1Problem< EntityImp, DomainFieldImp, 2, RangeFieldImp, 1 >
   typedef Stuff::Functions::Constant< EntityImp, DomainFieldImp, 2, RangeFieldImp, 1 >      ScalarConstantFunctionType;
   typedef Stuff::Functions::Constant< EntityImp, DomainFieldImp, 2, RangeFieldImp, 2, 2 >   MatrixConstantFunctionType;
   typedef Stuff::Functions::Indicator< EntityImp, DomainFieldImp, 2, RangeFieldImp, 1 >     IndicatorFunctionType;
-  typedef Stuff::Functions::Spe10::Model1< EntityImp, DomainFieldImp, 2, RangeFieldImp, 1 > Spe10FunctionType;
+  typedef Functions::Spe10::Model1< EntityImp, DomainFieldImp, 2, RangeFieldImp, 1 >        Spe10FunctionType;
 
 public:
   static Stuff::Common::Configuration default_grid_cfg()
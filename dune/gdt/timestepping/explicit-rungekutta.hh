@@ -0,0 +1,133 @@
+// This file is part of the dune-gdt project:
+//   http://users.dune-project.org/projects/dune-gdt
+// Copyright holders: Felix Schindler
+// License: BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+
+#ifndef DUNE_GDT_TIMESTEPPING_EXPLICIT_RUNGEKUTTA_HH
+#define DUNE_GDT_TIMESTEPPING_EXPLICIT_RUNGEKUTTA_HH
+
+#include <cmath>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include <boost/numeric/conversion/cast.hpp>
+
+#include <dune/stuff/common/exceptions.hh>
+
+#include <dune/gdt/solvers/csr.hh>
+
+namespace Dune {
+namespace GDT {
+namespace TimeStepping {
+
+
+/**
+ * \brief Strong stability preserving explicit Runge-Kutta methods for d_t u = L(u), in the Shu-Osher form
+\code
+u_0 = u^n,   u_{s + 1} = a_s u^n + (1 - a_s) (u_s + dt L(u_s)),   u^{n + 1} = u_S,
+\endcode
+ *        which is a convex combination of forward Euler steps. Available types are "ssp_rk3" (a = {0, 3/4, 1/3}),
+ *        "ssp_rk2" (a = {0, 1/2}) and "forward_euler" (a = {0}).
+ *
+ *        L is given by an operator with apply(const VectorType& source, VectorType& range) and a RangeFieldType (e.g.
+ *        Operators::FiniteVolume, with its CellDataType as VectorType), VectorType has to provide size() and
+ *        operator[]. The linear combinations are computed in parallel, if TBB is available and use_tbb is true.
+ * \note  The stage vectors are kept between steps, so a time stepper must not be used concurrently.
+ */
+template< class OperatorImp, class VectorImp >
+class ExplicitRungeKutta
+{
+public:
+  typedef OperatorImp                             OperatorType;
+  typedef VectorImp                               VectorType;
+  typedef typename OperatorType::RangeFieldType   RangeFieldType;
+  typedef std::function< void(const RangeFieldType /*time*/, const VectorType& /*solution*/) > ObserverType;
+
+  static std::vector< std::string > types()
+  {
+    return {"ssp_rk3", "ssp_rk2", "forward_euler"};
+  }
+
+  ExplicitRungeKutta(const OperatorType& op, const std::string type = types()[0], const bool use_tbb = false)
+    : operator_(op)
+    , use_tbb_(use_tbb)
+    , coefficients_(coefficients(type))
+  {}
+
+  size_t num_stages() const
+  {
+    return coefficients_.size();
+  }
+
+  /**
+   * \brief Advances solution by one time step of size dt.
+   */
+  void step(VectorType& solution, const RangeFieldType dt) const
+  {
+    const size_t size = solution.size();
+    initial_ = solution;
+    update_ = solution;
+    for (const auto& aa : coefficients_) {
+      operator_.apply(solution, update_);
+      Solvers::internal::for_each_range(size, use_tbb_, [&](const size_t first, const size_t last) {
+        for (size_t ii = first; ii < last; ++ii)
+          solution[ii] = aa * initial_[ii] + (1 - aa) * (solution[ii] + dt * update_[ii]);
+      });
+    }
+  } // ... step(...)
+
+  /**
+   * \brief Advances solution from start_time to end_time, using equal steps no larger than max_time_step, and returns
+   *        the number of steps. The observer is called with the initial values and after each step.
+   */
+  size_t solve(VectorType& solution,
+               const RangeFieldType start_time,
+               const RangeFieldType end_time,
+               const RangeFieldType max_time_step,
+               const ObserverType& observer = [](const RangeFieldType, const VectorType&) {}) const
+  {
+    if (!(max_time_step > 0) || end_time < start_time)
+      DUNE_THROW(Stuff::Exceptions::wrong_input_given,
+                 "max_time_step (" << max_time_step << ") has to be positive and end_time (" << end_time << ") must "
+                 << "not be smaller than start_time (" << start_time << ")!");
+    const size_t num_steps = boost::numeric_cast< size_t >(
+          std::ceil((end_time - start_time) / max_time_step - RangeFieldType(1e-10)));
+    observer(start_time, solution);
+    if (num_steps == 0)
+      return 0;
+    const RangeFieldType dt = (end_time - start_time) / num_steps;
+    for (size_t nn = 0; nn < num_steps; ++nn) {
+      step(solution, dt);
+      observer(start_time + (nn + 1) * dt, solution);
+    }
+    return num_steps;
+  } // ... solve(...)
+
+private:
+  static std::vector< RangeFieldType > coefficients(const std::string& type)
+  {
+    if (type == "ssp_rk3")
+      return {RangeFieldType(0), RangeFieldType(3) / RangeFieldType(4), RangeFieldType(1) / RangeFieldType(3)};
+    else if (type == "ssp_rk2")
+      return {RangeFieldType(0), RangeFieldType(1) / RangeFieldType(2)};
+    else if (type == "forward_euler")
+      return {RangeFieldType(0)};
+    else
+      DUNE_THROW(Stuff::Exceptions::wrong_input_given,
+                 "Given type '" << type << "' is not one of the available types()!");
+  } // ... coefficients(...)
+
+  const OperatorType& operator_;
+  const bool use_tbb_;
+  const std::vector< RangeFieldType > coefficients_;
+  mutable VectorType initial_;
+  mutable VectorType update_;
+}; // class ExplicitRungeKutta
+
+
+} // namespace TimeStepping
+} // namespace GDT
+} // namespace Dune
+
+#endif // DUNE_GDT_TIMESTEPPING_EXPLICIT_RUNGEKUTTA_HH
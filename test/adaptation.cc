@@ -0,0 +1,260 @@
+// This file is part of the dune-gdt project:
+//   http://users.dune-project.org/projects/dune-gdt
+// Copyright holders: Felix Schindler
+// License: BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+
+// This one has to come first (includes the config.h)!
+#include <dune/stuff/test/main.hxx>
+
+#include <cmath>
+#include <vector>
+
+#if HAVE_ALUGRID
+# include <dune/grid/alugrid.hh>
+#endif
+
+#include <dune/stuff/functions/constant.hh>
+#include <dune/stuff/functions/expression.hh>
+#include <dune/stuff/grid/provider/cube.hh>
+#include <dune/stuff/la/container/common.hh>
+
+#include <dune/gdt/assembler/local/codim0.hh>
+#include <dune/gdt/assembler/local/codim1.hh>
+#include <dune/gdt/assembler/system.hh>
+#include <dune/gdt/functionals/l2.hh>
+#include <dune/gdt/localevaluation/product.hh>
+#include <dune/gdt/localevaluation/swipdg.hh>
+#include <dune/gdt/localoperator/codim0.hh>
+#include <dune/gdt/localoperator/codim1.hh>
+#include <dune/gdt/playground/adaptation/driver.hh>
+#include <dune/gdt/spaces/fv/default.hh>
+
+using namespace Dune;
+using namespace GDT;
+
+
+TEST(DoerflerMarking, marks_largest_indicators)
+{
+  const std::vector< double > indicators = {1.0, 4.0, 2.0, 3.0};
+  EXPECT_EQ(std::vector< bool >({false, true, false, true}), Adaptation::doerfler_marking(indicators, 0.5));
+  EXPECT_EQ(std::vector< bool >({false, true, false, false}), Adaptation::doerfler_marking(indicators, 0.4));
+  EXPECT_EQ(std::vector< bool >(4, true), Adaptation::doerfler_marking(indicators, 1.0));
+  EXPECT_THROW(Adaptation::doerfler_marking(indicators, 0.0), Stuff::Exceptions::wrong_input_given);
+}
+
+
+#if HAVE_ALUGRID
+
+
+struct AdaptationDriverTest
+  : public ::testing::Test
+{
+  typedef ALUGrid< 2, 2, simplex, conforming >                             GridType;
+  typedef GridType::LeafGridView                                           GridViewType;
+  typedef GridViewType::Codim< 0 >::Entity                                 EntityType;
+  typedef Spaces::FV::Default< GridViewType, double, 1 >                   SpaceType;
+  typedef Stuff::LA::CommonDenseMatrix< double >                           MatrixType;
+  typedef Stuff::LA::CommonDenseVector< double >                           VectorType;
+  typedef Stuff::Functions::Constant< EntityType, double, 2, double, 1 >   ConstantType;
+  typedef Stuff::Functions::Expression< EntityType, double, 2, double, 1 > ExpressionType;
+  typedef LocalOperator::Codim0Integral< LocalEvaluation::Product< ConstantType > > MassOperatorType;
+  typedef LocalOperator::Codim1CouplingIntegral< LocalEvaluation::SWIPDG::Inner< ConstantType > > CouplingOperatorType;
+  typedef Adaptation::Driver< SpaceType, MatrixType, VectorType >          DriverType;
+
+  AdaptationDriverTest()
+    : grid_provider_(Stuff::Grid::Providers::Cube< GridType >::create())
+    , one_(1.0)
+    , force_("x", "x[0]*x[1]", 2)
+    , mass_operator_(one_)
+    , mass_assembler_(mass_operator_)
+    , coupling_operator_(one_)
+    , coupling_assembler_(coupling_operator_)
+  {}
+
+  DriverType::AssemblerType assembler() const
+  {
+    return [&](const SpaceType& space, MatrixType& matrix, VectorType& vector, const std::vector< bool >& entities) {
+      SystemAssembler< SpaceType > system_assembler(space);
+      system_assembler.add(mass_assembler_, matrix);
+      system_assembler.add(coupling_assembler_,
+                           matrix,
+                           new Stuff::Grid::ApplyOn::InnerIntersectionsPrimally< GridViewType >());
+      Functionals::L2Volume< ExpressionType, VectorType, SpaceType > functional(force_, vector, space);
+      system_assembler.add(functional);
+      system_assembler.assemble(entities);
+      last_entities_ = entities;
+    };
+  } // ... assembler(...)
+
+  /**
+   * Whether SystemAssembler::assemble(entities) visits an intersection from an entity which is not given while the
+   * entity context is bound to another entity, i.e. whether the context has to be rebound.
+   */
+  static bool requires_rebinding(const GridViewType& grid_view, const std::vector< bool >& entities)
+  {
+    const auto& index_set = grid_view.indexSet();
+    bool bound = false;
+    const auto entity_it_end = grid_view.template end< 0 >();
+    for (auto entity_it = grid_view.template begin< 0 >(); entity_it != entity_it_end; ++entity_it) {
+      const auto& entity = *entity_it;
+      const size_t index = index_set.index(entity);
+      if (entities[index]) {
+        bound = true;
+        continue;
+      }
+      const auto intersection_it_end = grid_view.iend(entity);
+      for (auto intersection_it = grid_view.ibegin(entity); intersection_it != intersection_it_end; ++intersection_it) {
+        if (intersection_it->neighbor()) {
+          const size_t neighbor_index = index_set.index(*intersection_it->outside());
+          if (entities[neighbor_index]) {
+            // the coupling is assembled primally, i.e. from the entity with the smaller index
+            if (bound && index < neighbor_index)
+              return true;
+            bound = true;
+          }
+        }
+      }
+    }
+    return false;
+  } // ... requires_rebinding(...)
+
+  /**
+   * The indicators are large near the origin.
+   */
+  static double estimate(const SpaceType& space, const VectorType& /*solution*/, std::vector< double >& indicators)
+  {
+    const auto& grid_view = space.grid_view();
+    indicators = std::vector< double >(grid_view.indexSet().size(0), 0.0);
+    double eta = 0.0;
+    const auto entity_it_end = grid_view.template end< 0 >();
+    for (auto entity_it = grid_view.template begin< 0 >(); entity_it != entity_it_end; ++entity_it) {
+      const auto& entity = *entity_it;
+      const double indicator = entity.geometry().volume() / entity.geometry().center().two_norm();
+      indicators[grid_view.indexSet().index(entity)] = indicator;
+      eta += indicator;
+    }
+    return std::sqrt(eta);
+  } // ... estimate(...)
+
+  DriverType create_driver()
+  {
+    auto& grid = grid_provider_->grid();
+    return DriverType(grid, [&]() { return SpaceType(grid.leafGridView()); }, assembler(), estimate);
+  }
+
+  std::unique_ptr< Stuff::Grid::Providers::Cube< GridType > > grid_provider_;
+  const ConstantType one_;
+  const ExpressionType force_;
+  const MassOperatorType mass_operator_;
+  const LocalAssembler::Codim0Matrix< MassOperatorType > mass_assembler_;
+  const CouplingOperatorType coupling_operator_;
+  const LocalAssembler::Codim1CouplingMatrix< CouplingOperatorType > coupling_assembler_;
+  mutable std::vector< bool > last_entities_;
+}; // struct AdaptationDriverTest
+
+
+TEST_F(AdaptationDriverTest, assembles_intersections_of_other_entities)
+{
+  const SpaceType space(grid_provider_->grid().leafGridView());
+  const auto& grid_view = space.grid_view();
+  const auto& index_set = grid_view.indexSet();
+  // leave out one entity (but not the first one of the walk), which is the primal side of one of its intersections
+  std::vector< bool > entities(index_set.size(0), true);
+  size_t left_out = entities.size();
+  auto entity_it = grid_view.template begin< 0 >();
+  const auto entity_it_end = grid_view.template end< 0 >();
+  for (++entity_it; entity_it != entity_it_end && left_out == entities.size(); ++entity_it) {
+    const size_t index = index_set.index(*entity_it);
+    const auto intersection_it_end = grid_view.iend(*entity_it);
+    for (auto intersection_it = grid_view.ibegin(*entity_it); intersection_it != intersection_it_end; ++intersection_it)
+      if (intersection_it->neighbor() && index < index_set.index(*intersection_it->outside()))
+        left_out = index;
+  }
+  ASSERT_LT(left_out, entities.size());
+  entities[left_out] = false;
+  ASSERT_TRUE(requires_rebinding(grid_view, entities));
+  MatrixType expected_matrix(space.mapper().size(), space.mapper().size(), space.compute_pattern());
+  VectorType expected_vector(space.mapper().size(), 0.0);
+  assembler()(space, expected_matrix, expected_vector, std::vector< bool >(entities.size(), true));
+  MatrixType matrix(space.mapper().size(), space.mapper().size(), space.compute_pattern());
+  VectorType vector(space.mapper().size(), 0.0);
+  assembler()(space, matrix, vector, entities);
+  // all rows but the one of the left out entity receive all their contributions
+  for (entity_it = grid_view.template begin< 0 >(); entity_it != entity_it_end; ++entity_it) {
+    if (index_set.index(*entity_it) == left_out)
+      continue;
+    const size_t ii = space.mapper().mapToGlobal(*entity_it, 0);
+    EXPECT_NEAR(expected_vector.get_entry(ii), vector.get_entry(ii), 1e-15) << "row " << ii;
+    for (size_t jj = 0; jj < space.mapper().size(); ++jj)
+      EXPECT_NEAR(expected_matrix.get_entry(ii, jj), matrix.get_entry(ii, jj), 1e-12) << ii << ", " << jj;
+  }
+}
+
+TEST_F(AdaptationDriverTest, reassembles_only_changed_entities)
+{
+  auto driver = create_driver();
+  driver.solve();
+  driver.estimate();
+  const size_t num_entities_before = driver.space().grid_view().indexSet().size(0);
+  driver.mark_and_refine(0.2);
+  const auto& space = driver.space();
+  const size_t num_entities = space.grid_view().indexSet().size(0);
+  EXPECT_GT(num_entities, num_entities_before);
+  EXPECT_LT(driver.num_reassembled_entities(), num_entities);
+  // some intersections have to be assembled from entities which are not reassembled themselves
+  ASSERT_EQ(num_entities, last_entities_.size());
+  EXPECT_TRUE(requires_rebinding(space.grid_view(), last_entities_));
+  // the updated system has to coincide with the system assembled on the whole adapted grid
+  MatrixType matrix(space.mapper().size(), space.mapper().size(), space.compute_pattern());
+  VectorType vector(space.mapper().size(), 0.0);
+  assembler()(space, matrix, vector, std::vector< bool >(num_entities, true));
+  const auto pattern = space.compute_pattern();
+  for (size_t ii = 0; ii < space.mapper().size(); ++ii) {
+    EXPECT_NEAR(vector.get_entry(ii), driver.rhs_vector().get_entry(ii), 1e-15) << "row " << ii;
+    for (const auto& jj : pattern.inner(ii))
+      EXPECT_NEAR(matrix.get_entry(ii, jj), driver.system_matrix().get_entry(ii, jj), 1e-12) << ii << ", " << jj;
+  }
+}
+
+TEST_F(AdaptationDriverTest, transfers_the_solution)
+{
+  const auto integral = [](const SpaceType& space, const VectorType& vector) {
+    double ret = 0.0;
+    const auto& grid_view = space.grid_view();
+    const auto entity_it_end = grid_view.template end< 0 >();
+    for (auto entity_it = grid_view.template begin< 0 >(); entity_it != entity_it_end; ++entity_it)
+      ret += entity_it->geometry().volume() * vector.get_entry(space.mapper().mapToGlobal(*entity_it, 0));
+    return ret;
+  };
+  auto driver = create_driver();
+  driver.solve();
+  driver.estimate();
+  const double expected = integral(driver.space(), driver.solution());
+  driver.mark_and_refine(0.5);
+  EXPECT_EQ(driver.space().mapper().size(), driver.solution().size());
+  // piecewise constants are transferred exactly, so the integral of the solution is kept
+  EXPECT_NEAR(expected, integral(driver.space(), driver.solution()), 1e-13);
+}
+
+TEST_F(AdaptationDriverTest, run_stops_after_max_steps)
+{
+  auto driver = create_driver();
+  auto opts = DriverType::options();
+  opts["max_steps"] = "2";
+  const size_t num_entities_before = driver.space().grid_view().indexSet().size(0);
+  driver.run(opts);
+  EXPECT_GT(driver.space().grid_view().indexSet().size(0), num_entities_before);
+  EXPECT_EQ(driver.space().grid_view().indexSet().size(0), driver.indicators().size());
+}
+
+
+#else // HAVE_ALUGRID
+
+
+TEST(DISABLED_AdaptationDriverTest, assembles_intersections_of_other_entities) {}
+TEST(DISABLED_AdaptationDriverTest, reassembles_only_changed_entities) {}
+TEST(DISABLED_AdaptationDriverTest, transfers_the_solution) {}
+TEST(DISABLED_AdaptationDriverTest, run_stops_after_max_steps) {}
+
+
+#endif // HAVE_ALUGRID
@@ -0,0 +1,131 @@
+// This file is part of the dune-gdt project:
+//   http://users.dune-project.org/projects/dune-gdt
+// Copyright holders: Felix Schindler
+// License: BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+
+// This one has to come first (includes the config.h)!
+#include <dune/stuff/test/main.hxx>
+
+#include <dune/grid/sgrid.hh>
+#include <dune/grid/yaspgrid.hh>
+
+#include <dune/stuff/common/ranges.hh>
+#include <dune/stuff/functions/expression.hh>
+#include <dune/stuff/grid/boundaryinfo.hh>
+#include <dune/stuff/grid/provider/cube.hh>
+#include <dune/stuff/la/container/common.hh>
+
+#include <dune/gdt/assembler/boundary-index.hh>
+#include <dune/gdt/functionals/l2.hh>
+#include <dune/gdt/spaces/fv/default.hh>
+
+using namespace Dune;
+using namespace GDT;
+
+
+template< class GridType >
+struct BoundaryIntersectionIndexTest
+  : public ::testing::Test
+{
+  typedef typename GridType::LeafGridView                        GridViewType;
+  typedef typename GridViewType::Intersection                    IntersectionType;
+  typedef typename GridViewType::template Codim< 0 >::Entity     EntityType;
+  typedef BoundaryIntersectionIndex< GridViewType >              IndexType;
+  typedef typename IndexType::BoundaryType                       BoundaryType;
+
+  void matches_grid_walk() const
+  {
+    auto grid_provider = Stuff::Grid::Providers::Cube< GridType >::create();
+    const auto grid_view = grid_provider->grid().leafGridView();
+    const auto boundary_info = Stuff::Grid::BoundaryInfos::AllDirichlet< IntersectionType >::create();
+    const IndexType index(grid_view, *boundary_info);
+    size_t num_boundary_intersections = 0;
+    for (const auto& entity : DSC::entityRange(grid_view)) {
+      EXPECT_EQ(entity.hasBoundaryIntersections(), index.contains(entity, BoundaryType::dirichlet));
+      EXPECT_FALSE(index.contains(entity, BoundaryType::neumann));
+      const auto intersection_it_end = grid_view.iend(entity);
+      for (auto intersection_it = grid_view.ibegin(entity); intersection_it != intersection_it_end; ++intersection_it)
+        if (intersection_it->boundary() && !intersection_it->neighbor())
+          ++num_boundary_intersections;
+    }
+    EXPECT_EQ(num_boundary_intersections, index.size());
+    EXPECT_EQ(index.size(), index.size(BoundaryType::dirichlet));
+    EXPECT_EQ(0, index.size(BoundaryType::neumann));
+    EXPECT_EQ(0, index.size(BoundaryType::other));
+    size_t num_visited = 0;
+    index.for_each(BoundaryType::dirichlet, [&](const EntityType& /*entity*/, const IntersectionType& intersection) {
+      EXPECT_TRUE(intersection.boundary());
+      ++num_visited;
+    });
+    EXPECT_EQ(index.size(), num_visited);
+    num_visited = 0;
+    index.for_each(BoundaryType::neumann, [&](const EntityType& /*entity*/, const IntersectionType& /*intersection*/) {
+      ++num_visited;
+    });
+    EXPECT_EQ(0, num_visited);
+  } // ... matches_grid_walk(...)
+}; // struct BoundaryIntersectionIndexTest
+
+
+typedef testing::Types< SGrid< 1, 1 >, SGrid< 2, 2 >, SGrid< 3, 3 >
+                      , YaspGrid< 1 >, YaspGrid< 2 >, YaspGrid< 3 >
+                      > GridTypes;
+
+TYPED_TEST_CASE(BoundaryIntersectionIndexTest, GridTypes);
+TYPED_TEST(BoundaryIntersectionIndexTest, matches_grid_walk) {
+  this->matches_grid_walk();
+}
+
+
+TEST(BoundaryIntersectionIndexAssembly, matches_filtered_assembly_on_mixed_boundaries)
+{
+  typedef YaspGrid< 2 >                                                    GridType;
+  typedef GridType::LeafGridView                                           GridViewType;
+  typedef GridViewType::Intersection                                       IntersectionType;
+  typedef GridViewType::Codim< 0 >::Entity                                 EntityType;
+  typedef Spaces::FV::Default< GridViewType, double, 1 >                   SpaceType;
+  typedef Stuff::LA::CommonDenseVector< double >                           VectorType;
+  typedef Stuff::Functions::Expression< EntityType, double, 2, double, 1 > FunctionType;
+  typedef Functionals::L2Face< FunctionType, VectorType, SpaceType >       FunctionalType;
+  typedef BoundaryIntersectionIndex< GridViewType >                        IndexType;
+  typedef IndexType::BoundaryType                                          BoundaryType;
+  auto grid_provider = Stuff::Grid::Providers::Cube< GridType >::create();
+  const SpaceType space(grid_provider->grid().leafGridView());
+  const auto& grid_view = space.grid_view();
+  // Neumann on the right, Dirichlet everywhere else
+  FieldVector< double, 2 > neumann_normal(0.0);
+  neumann_normal[0] = 1.0;
+  const Stuff::Grid::BoundaryInfos::NormalBased< IntersectionType > boundary_info(true, {}, {neumann_normal});
+  const IndexType index(grid_view, boundary_info);
+  size_t num_dirichlet = 0;
+  size_t num_neumann = 0;
+  for (const auto& entity : DSC::entityRange(grid_view)) {
+    const auto intersection_it_end = grid_view.iend(entity);
+    for (auto intersection_it = grid_view.ibegin(entity); intersection_it != intersection_it_end; ++intersection_it) {
+      if (boundary_info.dirichlet(*intersection_it))
+        ++num_dirichlet;
+      else if (boundary_info.neumann(*intersection_it))
+        ++num_neumann;
+    }
+  }
+  ASSERT_GT(num_dirichlet, 0);
+  ASSERT_GT(num_neumann, 0);
+  EXPECT_EQ(num_dirichlet, index.size(BoundaryType::dirichlet));
+  EXPECT_EQ(num_neumann, index.size(BoundaryType::neumann));
+  const FunctionType function("x", "1 + x[0]*x[1]", 2);
+  // the same functional, restricted to the Neumann (Dirichlet) intersections by the index and by a filter
+  VectorType expected_neumann(space.mapper().size(), 0.0);
+  VectorType expected_dirichlet(space.mapper().size(), 0.0);
+  FunctionalType(function, expected_neumann, space,
+                 new Stuff::Grid::ApplyOn::NeumannIntersections< GridViewType >(boundary_info)).assemble();
+  FunctionalType(function, expected_dirichlet, space,
+                 new Stuff::Grid::ApplyOn::DirichletIntersections< GridViewType >(boundary_info)).assemble();
+  EXPECT_GT(expected_neumann.sup_norm(), 0.0);
+  EXPECT_GT(expected_dirichlet.sup_norm(), 0.0);
+  VectorType neumann(space.mapper().size(), 0.0);
+  VectorType dirichlet(space.mapper().size(), 0.0);
+  FunctionalType(function, neumann, space, index, BoundaryType::neumann).assemble();
+  FunctionalType(function, dirichlet, space, index, BoundaryType::dirichlet).assemble();
+  EXPECT_LE((neumann - expected_neumann).sup_norm(), 1e-14);
+  EXPECT_LE((dirichlet - expected_dirichlet).sup_norm(), 1e-14);
+}
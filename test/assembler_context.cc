@@ -0,0 +1,215 @@
+// This file is part of the dune-gdt project:
+//   http://users.dune-project.org/projects/dune-gdt
+// Copyright holders: Felix Schindler
+// License: BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+
+// This one has to come first (includes the config.h)!
+#include <dune/stuff/test/main.hxx>
+
+#include <atomic>
+
+#include <dune/grid/yaspgrid.hh>
+
+#include <dune/stuff/common/parallel/threadstorage.hh>
+#include <dune/stuff/functions/expression.hh>
+#include <dune/stuff/grid/provider/cube.hh>
+#include <dune/stuff/la/container/common.hh>
+
+#include <dune/gdt/assembler/local/context.hh>
+#include <dune/gdt/assembler/system.hh>
+#include <dune/gdt/functionals/l2.hh>
+#include <dune/gdt/spaces/fv/default.hh>
+
+using namespace Dune;
+using namespace GDT;
+
+
+// counts how often it is localized
+template< class FunctionImp >
+class CountingFunction
+  : public Stuff::LocalizableFunctionInterface< typename FunctionImp::EntityType, typename FunctionImp::DomainFieldType,
+                                                FunctionImp::dimDomain, typename FunctionImp::RangeFieldType,
+                                                FunctionImp::dimRange, FunctionImp::dimRangeCols >
+{
+  typedef Stuff::LocalizableFunctionInterface< typename FunctionImp::EntityType, typename FunctionImp::DomainFieldType,
+                                               FunctionImp::dimDomain, typename FunctionImp::RangeFieldType,
+                                               FunctionImp::dimRange, FunctionImp::dimRangeCols > BaseType;
+public:
+  typedef typename BaseType::EntityType        EntityType;
+  typedef typename BaseType::LocalfunctionType LocalfunctionType;
+
+  explicit CountingFunction(const FunctionImp& function)
+    : function_(function)
+    , count_(0)
+  {}
+
+  virtual std::string type() const override
+  {
+    return function_.type();
+  }
+
+  virtual std::string name() const override
+  {
+    return function_.name();
+  }
+
+  virtual std::unique_ptr< LocalfunctionType > local_function(const EntityType& entity) const override
+  {
+    ++count_;
+    return function_.local_function(entity);
+  }
+
+  size_t count() const
+  {
+    return count_;
+  }
+
+private:
+  const FunctionImp& function_;
+  mutable std::atomic< size_t > count_;
+}; // class CountingFunction
+
+
+struct EntityContextTest
+  : public ::testing::Test
+{
+  typedef YaspGrid< 2 >                                      GridType;
+  typedef GridType::LeafGridView                             GridViewType;
+  typedef GridViewType::Codim< 0 >::Entity                   EntityType;
+  typedef GridViewType::Intersection                         IntersectionType;
+  typedef Spaces::FV::Default< GridViewType, double, 1 >     SpaceType;
+  typedef Stuff::LA::CommonDenseVector< double >             VectorType;
+  typedef Stuff::Functions::Expression< EntityType, double, 2, double, 1 > ExpressionType;
+  typedef Functionals::L2Volume< ExpressionType, VectorType, SpaceType > VolumeFunctionalType;
+  typedef Functionals::L2Face< ExpressionType, VectorType, SpaceType >   FaceFunctionalType;
+  typedef LocalAssembler::EntityContext< SpaceType >                     ContextType;
+  typedef LocalAssembler::EntityContexts< ContextType >                  ContextsType;
+
+  EntityContextTest()
+    : grid_provider_(Stuff::Grid::Providers::Cube< GridType >::create())
+    , space_(grid_provider_->grid().leafGridView())
+    , function_("x", "1 + x[0]*x[1]", 2)
+  {}
+
+  std::unique_ptr< Stuff::Grid::Providers::Cube< GridType > > grid_provider_;
+  const SpaceType space_;
+  const ExpressionType function_;
+}; // struct EntityContextTest
+
+
+TEST_F(EntityContextTest, keeps_binding_for_the_same_key)
+{
+  const DS::PerThreadValue< const SpaceType > space(space_);
+  ContextsType contexts(space, space);
+  const auto& grid_view = space_.grid_view();
+  auto first = grid_view.template begin< 0 >();
+  auto second = grid_view.template begin< 0 >();
+  ++second;
+  const size_t first_index = grid_view.indexSet().index(*first);
+  const size_t second_index = grid_view.indexSet().index(*second);
+  contexts.next_walk();
+  contexts.bind(*first, first_index);
+  EXPECT_EQ(first_index, contexts->test_indices()[0]);
+  // the key identifies the entity, the computed indices are thus kept
+  contexts.bind(*second, first_index);
+  EXPECT_EQ(first_index, contexts->test_indices()[0]);
+  contexts.bind(*second, second_index);
+  EXPECT_EQ(second_index, contexts->test_indices()[0]);
+  // bindings of previous walks are never reused
+  contexts.next_walk();
+  contexts.bind(*first, second_index);
+  EXPECT_EQ(first_index, contexts->test_indices()[0]);
+}
+
+TEST_F(EntityContextTest, shares_contexts)
+{
+  const DS::PerThreadValue< const SpaceType > space(space_);
+  ContextsType contexts(space, space);
+  ContextsType nested(space, space);
+  ContextsType nested_nested(space, space);
+  EXPECT_NE(&*contexts, &*nested);
+  nested_nested.share(nested);
+  nested.share(contexts);
+  EXPECT_EQ(&*contexts, &*nested);
+  EXPECT_EQ(&*contexts, &*nested_nested);
+  const size_t walk = contexts.walk();
+  nested_nested.next_walk();
+  EXPECT_EQ(walk + 1, contexts.walk());
+  EXPECT_EQ(walk + 1, nested.walk());
+}
+
+TEST_F(EntityContextTest, rebinds_on_intersections)
+{
+  VectorType expected(space_.mapper().size(), 0.0);
+  FaceFunctionalType(function_, expected, space_).assemble();
+  // visit the intersections only, the entity context is thus never bound in apply_local(entity)
+  VectorType vector(space_.mapper().size(), 0.0);
+  FaceFunctionalType functional(function_, vector, space_);
+  const auto& grid_view = space_.grid_view();
+  functional.prepare();
+  const auto entity_it_end = grid_view.template end< 0 >();
+  for (auto entity_it = grid_view.template begin< 0 >(); entity_it != entity_it_end; ++entity_it) {
+    const EntityType& entity = *entity_it;
+    const auto intersection_it_end = grid_view.iend(entity);
+    for (auto intersection_it = grid_view.ibegin(entity); intersection_it != intersection_it_end; ++intersection_it) {
+      const IntersectionType& intersection = *intersection_it;
+      if (intersection.neighbor()) {
+        const auto neighbor_ptr = intersection.outside();
+        functional.apply_local(intersection, entity, *neighbor_ptr);
+      } else
+        functional.apply_local(intersection, entity, entity);
+    }
+  }
+  functional.finalize();
+  EXPECT_LE((vector - expected).sup_norm(), 1e-14);
+}
+
+TEST_F(EntityContextTest, nested_assemblers_yield_the_same_results)
+{
+  VectorType expected_volume(space_.mapper().size(), 0.0);
+  VectorType expected_face(space_.mapper().size(), 0.0);
+  VolumeFunctionalType(function_, expected_volume, space_).assemble();
+  FaceFunctionalType(function_, expected_face, space_).assemble();
+  for (const bool use_tbb : {false, true}) {
+    VectorType volume(space_.mapper().size(), 0.0);
+    VectorType face(space_.mapper().size(), 0.0);
+    VolumeFunctionalType volume_functional(function_, volume, space_);
+    FaceFunctionalType face_functional(function_, face, space_);
+    SystemAssembler< SpaceType > assembler(space_);
+    assembler.add(volume_functional);
+    assembler.add(face_functional);
+    assembler.assemble(use_tbb);
+    EXPECT_LE((volume - expected_volume).sup_norm(), 1e-14) << "use_tbb: " << use_tbb;
+    EXPECT_LE((face - expected_face).sup_norm(), 1e-14) << "use_tbb: " << use_tbb;
+    // a second walk has to rebind all contexts
+    volume *= 0.0;
+    face *= 0.0;
+    assembler.assemble(use_tbb);
+    EXPECT_LE((volume - expected_volume).sup_norm(), 1e-14) << "use_tbb: " << use_tbb;
+    EXPECT_LE((face - expected_face).sup_norm(), 1e-14) << "use_tbb: " << use_tbb;
+  }
+}
+
+TEST_F(EntityContextTest, localizes_shared_functions_once_per_entity)
+{
+  typedef CountingFunction< ExpressionType >                                     CountingFunctionType;
+  typedef Functionals::L2Volume< CountingFunctionType, VectorType, SpaceType > CountingFunctionalType;
+  VectorType expected(space_.mapper().size(), 0.0);
+  VolumeFunctionalType(function_, expected, space_).assemble();
+  const size_t num_entities = space_.grid_view().indexSet().size(0);
+  for (const bool use_tbb : {false, true}) {
+    const CountingFunctionType function(function_);
+    VectorType first(space_.mapper().size(), 0.0);
+    VectorType second(space_.mapper().size(), 0.0);
+    CountingFunctionalType first_functional(function, first, space_);
+    CountingFunctionalType second_functional(function, second, space_);
+    SystemAssembler< SpaceType > assembler(space_);
+    assembler.add(first_functional);
+    assembler.add(second_functional);
+    assembler.assemble(use_tbb);
+    EXPECT_LE((first - expected).sup_norm(), 1e-14) << "use_tbb: " << use_tbb;
+    EXPECT_LE((second - expected).sup_norm(), 1e-14) << "use_tbb: " << use_tbb;
+    // both functionals take the local function from the shared entity context
+    EXPECT_EQ(num_entities, function.count()) << "use_tbb: " << use_tbb;
+  }
+}
@@ -0,0 +1,87 @@
+// This file is part of the dune-gdt project:
+//   http://users.dune-project.org/projects/dune-gdt
+// Copyright holders: Felix Schindler
+// License: BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+
+// This one has to come first (includes the config.h)!
+#include <dune/stuff/test/main.hxx>
+
+#include <cmath>
+
+#include <dune/grid/yaspgrid.hh>
+
+#include <dune/stuff/functions/expression.hh>
+#include <dune/stuff/grid/provider/cube.hh>
+#include <dune/stuff/la/container/common.hh>
+
+#include <dune/gdt/assembler/costs.hh>
+#include <dune/gdt/functionals/l2.hh>
+#include <dune/gdt/spaces/fv/default.hh>
+
+using namespace Dune;
+using namespace GDT;
+
+
+struct AssemblyCostsTest
+  : public ::testing::Test
+{
+  typedef YaspGrid< 2 >                                      GridType;
+  typedef GridType::LeafGridView                             GridViewType;
+  typedef GridViewType::Codim< 0 >::Entity                   EntityType;
+  typedef Spaces::FV::Default< GridViewType, double, 1 >     SpaceType;
+  typedef Stuff::LA::CommonDenseVector< double >             VectorType;
+  typedef Stuff::Functions::Expression< EntityType, double, 2, double, 1 > ExpressionType;
+  typedef AssemblyCosts< GridViewType >                      CostsType;
+
+  AssemblyCostsTest()
+    : grid_provider_(Stuff::Grid::Providers::Cube< GridType >::create())
+    , space_(grid_provider_->grid().leafGridView())
+  {}
+
+  std::unique_ptr< Stuff::Grid::Providers::Cube< GridType > > grid_provider_;
+  const SpaceType space_;
+}; // struct AssemblyCostsTest
+
+
+TEST_F(AssemblyCostsTest, records_costs_of_all_entities)
+{
+  const ExpressionType function("x", "x[0]*x[1]", 2);
+  VectorType expected(space_.mapper().size(), 0.0);
+  Functionals::L2Volume< ExpressionType, VectorType, SpaceType >(function, expected, space_).assemble();
+  CostsType costs(space_.grid_view());
+  VectorType vector(space_.mapper().size(), 0.0);
+  Functionals::L2Volume< ExpressionType, VectorType, SpaceType > functional(function, vector, space_);
+  functional.record_costs(&costs);
+  functional.assemble();
+  EXPECT_LE((vector - expected).sup_norm(), 1e-15);
+  EXPECT_EQ(space_.grid_view().indexSet().size(0), costs.values().size());
+  for (const auto& cost : costs.values())
+    EXPECT_GT(cost, 0.0);
+  EXPECT_GT(costs.total(), 0.0);
+  EXPECT_GE(costs.imbalance(), 1.0);
+  costs.clear();
+  EXPECT_EQ(0.0, costs.total());
+}
+
+TEST_F(AssemblyCostsTest, partitioner_balances_costs)
+{
+  CostsType costs(space_.grid_view());
+  const auto& grid_view = space_.grid_view();
+  // the first half of the entities is three times as expensive as the second half
+  const size_t num_entities = grid_view.indexSet().size(0);
+  const auto entity_it_end = grid_view.template end< 0 >();
+  for (auto entity_it = grid_view.template begin< 0 >(); entity_it != entity_it_end; ++entity_it)
+    costs.add(*entity_it, grid_view.indexSet().index(*entity_it) < num_entities / 2 ? 3.0 : 1.0);
+  const size_t num_partitions = 4;
+  const auto partitioner = costs.partitioner(num_partitions);
+  EXPECT_EQ(num_partitions, partitioner.partitions());
+  std::vector< double > partition_costs(num_partitions, 0.0);
+  for (auto entity_it = grid_view.template begin< 0 >(); entity_it != entity_it_end; ++entity_it) {
+    const size_t partition = partitioner.partition(*entity_it);
+    ASSERT_LT(partition, num_partitions);
+    partition_costs[partition] += costs(*entity_it);
+  }
+  const double mean = costs.total() / num_partitions;
+  for (const auto& partition_cost : partition_costs)
+    EXPECT_LE(std::abs(partition_cost - mean), 3.0) << "mean: " << mean;
+}
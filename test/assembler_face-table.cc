@@ -0,0 +1,169 @@
+// This file is part of the dune-gdt project:
+//   http://users.dune-project.org/projects/dune-gdt
+// Copyright holders: Felix Schindler
+// License: BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+
+// This one has to come first (includes the config.h)!
+#include <dune/stuff/test/main.hxx>
+
+#include <algorithm>
+#include <array>
+#include <bitset>
+#include <cmath>
+
+#include <dune/grid/sgrid.hh>
+#include <dune/grid/yaspgrid.hh>
+
+#include <dune/stuff/common/float_cmp.hh>
+#include <dune/stuff/common/ranges.hh>
+#include <dune/stuff/functions/constant.hh>
+#include <dune/stuff/grid/provider/cube.hh>
+#include <dune/stuff/la/container/common.hh>
+
+#include <dune/gdt/assembler/face-table.hh>
+#include <dune/gdt/assembler/local/codim1.hh>
+#include <dune/gdt/assembler/system.hh>
+#include <dune/gdt/localevaluation/swipdg.hh>
+#include <dune/gdt/localoperator/codim1.hh>
+#include <dune/gdt/spaces/fv/default.hh>
+
+using namespace Dune;
+using namespace GDT;
+
+
+template< class GridType >
+struct FaceTableTest
+  : public ::testing::Test
+{
+  typedef typename GridType::LeafGridView   GridViewType;
+  typedef FaceTable< GridViewType >         FaceTableType;
+  typedef typename FaceTableType::WorldType WorldType;
+
+  void matches_grid_walk(const bool use_tbb) const
+  {
+    auto grid_provider = Stuff::Grid::Providers::Cube< GridType >::create();
+    const auto grid_view = grid_provider->grid().leafGridView();
+    const FaceTableType face_table(grid_view, 2, use_tbb);
+    EXPECT_EQ(grid_view.indexSet().size(0), face_table.num_entities());
+    size_t num_inner_intersections = 0;
+    size_t num_boundary_intersections = 0;
+    for (const auto& entity : DSC::entityRange(grid_view)) {
+      const size_t entity_index = grid_view.indexSet().index(entity);
+      EXPECT_TRUE(DSC::FloatCmp::eq(entity.geometry().volume(), face_table.entity_volumes()[entity_index]));
+      size_t num_intersections = 0;
+      const auto intersection_it_end = grid_view.iend(entity);
+      for (auto intersection_it = grid_view.ibegin(entity); intersection_it != intersection_it_end; ++intersection_it) {
+        ++num_intersections;
+        if (intersection_it->neighbor())
+          ++num_inner_intersections;
+        else
+          ++num_boundary_intersections;
+      }
+      EXPECT_EQ(num_intersections, face_table.num_faces(entity_index));
+      // the outer normals of a closed surface integrate to zero
+      WorldType normal_integral(0);
+      for (size_t ii = 0; ii < face_table.num_faces(entity_index); ++ii) {
+        const size_t face = face_table.face(entity_index, ii);
+        auto normal = face_table.unit_outer_normal(face);
+        normal *= face_table.volumes()[face];
+        if (face_table.insides()[face] == entity_index)
+          normal_integral += normal;
+        else {
+          EXPECT_EQ(entity_index, face_table.outsides()[face]);
+          normal_integral -= normal;
+        }
+      }
+      EXPECT_TRUE(DSC::FloatCmp::eq(normal_integral, WorldType(0), 1e-12, 1e-12));
+    }
+    EXPECT_EQ(num_inner_intersections / 2 + num_boundary_intersections, face_table.num_faces());
+    for (size_t face = 0; face < face_table.num_faces(); ++face) {
+      EXPECT_TRUE(DSC::FloatCmp::eq(face_table.unit_outer_normal(face).two_norm(), 1.0));
+      EXPECT_EQ(face_table.boundary(face), face_table.outsides()[face] == FaceTableType::invalid());
+      if (!face_table.boundary(face))
+        EXPECT_LT(face_table.insides()[face], face_table.outsides()[face]);
+      double volume = 0;
+      for (size_t ii = 0; ii < face_table.num_quadrature_points(face); ++ii)
+        volume += face_table.quadrature_weight(face_table.quadrature_offset(face) + ii);
+      EXPECT_TRUE(DSC::FloatCmp::eq(face_table.volumes()[face], volume));
+    }
+  } // ... matches_grid_walk(...)
+}; // struct FaceTableTest
+
+
+typedef testing::Types< SGrid< 1, 1 >, SGrid< 2, 2 >, SGrid< 3, 3 >
+                      , YaspGrid< 1 >, YaspGrid< 2 >, YaspGrid< 3 >
+                      > GridTypes;
+
+TYPED_TEST_CASE(FaceTableTest, GridTypes);
+TYPED_TEST(FaceTableTest, matches_grid_walk) {
+  this->matches_grid_walk(false);
+}
+TYPED_TEST(FaceTableTest, matches_grid_walk_in_parallel) {
+  this->matches_grid_walk(true);
+}
+
+
+TEST(FaceTableCouplingAssembly, matches_primal_walk)
+{
+  typedef YaspGrid< 2 >                                                    GridType;
+  typedef GridType::LeafGridView                                           GridViewType;
+  typedef GridViewType::Codim< 0 >::Entity                                 EntityType;
+  typedef Spaces::FV::Default< GridViewType, double, 1 >                   SpaceType;
+  typedef Stuff::LA::CommonDenseMatrix< double >                           MatrixType;
+  typedef Stuff::Functions::Constant< EntityType, double, 2, double, 1 >   ConstantType;
+  typedef LocalOperator::Codim1CouplingIntegral< LocalEvaluation::SWIPDG::Inner< ConstantType > > CouplingOperatorType;
+  auto grid_provider = Stuff::Grid::Providers::Cube< GridType >::create();
+  const SpaceType space(grid_provider->grid().leafGridView());
+  const ConstantType one(1.0);
+  const CouplingOperatorType coupling_operator(one);
+  const LocalAssembler::Codim1CouplingMatrix< CouplingOperatorType > coupling_assembler(coupling_operator);
+  const size_t size = space.mapper().size();
+  MatrixType expected(size, size, space.compute_face_and_volume_pattern());
+  SystemAssembler< SpaceType > primal_assembler(space);
+  primal_assembler.add(coupling_assembler,
+                       expected,
+                       new Stuff::Grid::ApplyOn::InnerIntersectionsPrimally< GridViewType >());
+  primal_assembler.assemble();
+  double max_entry = 0.0;
+  for (size_t ii = 0; ii < size; ++ii)
+    for (size_t jj = 0; jj < size; ++jj)
+      max_entry = std::max(max_entry, std::abs(expected.get_entry(ii, jj)));
+  EXPECT_GT(max_entry, 0.0);
+  const FaceTable< GridViewType > face_table(space.grid_view());
+  for (const bool use_tbb : {false, true}) {
+    MatrixType matrix(size, size, space.compute_face_and_volume_pattern());
+    SystemAssembler< SpaceType > assembler(space);
+    assembler.add(coupling_assembler, matrix, face_table);
+    assembler.assemble(use_tbb);
+    for (size_t ii = 0; ii < size; ++ii)
+      for (size_t jj = 0; jj < size; ++jj)
+        EXPECT_NEAR(expected.get_entry(ii, jj), matrix.get_entry(ii, jj), 1e-13) << ii << ", " << jj
+                                                                                 << ", use_tbb: " << use_tbb;
+  }
+}
+
+TEST(FaceTableCouplingAssembly, rejects_periodic_grid_views)
+{
+  typedef YaspGrid< 2 >                                                    GridType;
+  typedef GridType::LeafGridView                                           GridViewType;
+  typedef GridViewType::Codim< 0 >::Entity                                 EntityType;
+  typedef Spaces::FV::Default< GridViewType, double, 1 >                   SpaceType;
+  typedef Stuff::LA::CommonDenseMatrix< double >                           MatrixType;
+  typedef Stuff::Functions::Constant< EntityType, double, 2, double, 1 >   ConstantType;
+  typedef LocalOperator::Codim1CouplingIntegral< LocalEvaluation::SWIPDG::Inner< ConstantType > > CouplingOperatorType;
+  // periodic in x-direction
+  GridType grid(FieldVector< double, 2 >(1.0), std::array< int, 2 >{{4, 4}}, std::bitset< 2 >(1ULL), 1);
+  const SpaceType space(grid.leafGridView());
+  const FaceTable< GridViewType > face_table(space.grid_view());
+  ASSERT_TRUE(face_table.periodic());
+  const ConstantType one(1.0);
+  const CouplingOperatorType coupling_operator(one);
+  const LocalAssembler::Codim1CouplingMatrix< CouplingOperatorType > coupling_assembler(coupling_operator);
+  const size_t size = space.mapper().size();
+  MatrixType matrix(size, size, space.compute_face_and_volume_pattern());
+  SystemAssembler< SpaceType > assembler(space);
+  EXPECT_THROW(assembler.add(coupling_assembler, matrix, face_table), Stuff::Exceptions::you_are_using_this_wrong);
+  // a non periodic table of the same grid is fine
+  GridType non_periodic_grid(FieldVector< double, 2 >(1.0), std::array< int, 2 >{{4, 4}}, std::bitset< 2 >(0ULL), 1);
+  EXPECT_FALSE(FaceTable< GridViewType >(non_periodic_grid.leafGridView()).periodic());
+}
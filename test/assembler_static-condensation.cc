@@ -0,0 +1,102 @@
+// This file is part of the dune-gdt project:
+//   http://users.dune-project.org/projects/dune-gdt
+// Copyright holders: Felix Schindler
+// License: BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+
+// This one has to come first (includes the config.h)!
+#include <dune/stuff/test/main.hxx>
+
+#if HAVE_DUNE_FEM && HAVE_EIGEN
+# include <dune/grid/sgrid.hh>
+
+# include <dune/stuff/functions/constant.hh>
+# include <dune/stuff/grid/provider/cube.hh>
+# include <dune/stuff/la/container.hh>
+# include <dune/stuff/la/solver.hh>
+
+# include <dune/gdt/assembler/static-condensation.hh>
+# include <dune/gdt/assembler/system.hh>
+# include <dune/gdt/localevaluation/elliptic.hh>
+# include <dune/gdt/localevaluation/product.hh>
+# include <dune/gdt/localfunctional/codim0.hh>
+# include <dune/gdt/localoperator/codim0.hh>
+# include <dune/gdt/spaces/cg.hh>
+#endif // HAVE_DUNE_FEM && HAVE_EIGEN
+
+using namespace Dune;
+using namespace GDT;
+
+
+#if HAVE_DUNE_FEM && HAVE_EIGEN
+
+// -laplace u + u = 1 with natural boundary conditions, discretized with quadratic CG elements
+TEST(StaticCondensation, recovers_the_solution_of_the_full_system)
+{
+  static const size_t d = 2;
+  typedef SGrid< d, d >                                   GridType;
+  typedef GridType::template Codim< 0 >::Entity           E;
+  typedef GridType::ctype                                 D;
+  typedef double                                          R;
+  typedef Stuff::LA::EigenRowMajorSparseMatrix< R >       MatrixType;
+  typedef Stuff::LA::EigenDenseVector< R >                VectorType;
+  typedef Stuff::Functions::Constant< E, D, d, R, 1 >     FunctionType;
+  typedef Spaces::CGProvider< GridType, Stuff::Grid::ChooseLayer::leaf, ChooseSpaceBackend::fem, 2, R, 1 >
+      SpaceProvider;
+  typedef SpaceProvider::Type                             SpaceType;
+  typedef LocalOperator::Codim0Integral< LocalEvaluation::Elliptic< FunctionType > > EllipticOperatorType;
+  typedef LocalOperator::Codim0Integral< LocalEvaluation::Product< FunctionType > >  MassOperatorType;
+  typedef LocalFunctional::Codim0Integral< LocalEvaluation::Product< FunctionType > > FunctionalType;
+  auto grid_provider = Stuff::Grid::Providers::Cube< GridType >::create();
+  const auto space = SpaceProvider::create(*grid_provider);
+  const FunctionType one(1);
+  const EllipticOperatorType elliptic_operator(one);
+  const MassOperatorType mass_operator(one);
+  const FunctionalType functional(one);
+  const LocalAssembler::Codim0Matrix< EllipticOperatorType > elliptic_assembler(elliptic_operator);
+  const LocalAssembler::Codim0Matrix< MassOperatorType > mass_assembler(mass_operator);
+  const LocalAssembler::Codim0Vector< FunctionalType > rhs_assembler(functional);
+  // the full system
+  MatrixType matrix(space.mapper().size(), space.mapper().size(), space.compute_volume_pattern());
+  VectorType rhs(space.mapper().size(), 0.0);
+  SystemAssembler< SpaceType > full_assembler(space);
+  full_assembler.add(elliptic_assembler, matrix);
+  full_assembler.add(mass_assembler, matrix);
+  full_assembler.add(rhs_assembler, rhs);
+  full_assembler.assemble();
+  VectorType expected(space.mapper().size(), 0.0);
+  Stuff::LA::Solver< MatrixType >(matrix).apply(rhs, expected);
+  // the condensed system
+  StaticCondensation< SpaceType, MatrixType, VectorType > condensation(space);
+  condensation.add(elliptic_assembler);
+  condensation.add(mass_assembler);
+  VectorType condensed_rhs(space.mapper().size(), 0.0);
+  SystemAssembler< SpaceType > condensed_assembler(space);
+  condensed_assembler.add(condensation);
+  condensed_assembler.add(rhs_assembler, condensed_rhs);
+  condensed_assembler.assemble(true);
+  EXPECT_LT(condensation.size(), space.mapper().size());
+  EXPECT_EQ(condensation.size(), condensation.matrix().rows());
+  const auto reduced_rhs = condensation.reduce(condensed_rhs);
+  VectorType reduced_solution(condensation.size(), 0.0);
+  Stuff::LA::Solver< MatrixType >(condensation.matrix()).apply(reduced_rhs, reduced_solution);
+  for (const bool use_tbb : {false, true}) {
+    VectorType solution(space.mapper().size(), 0.0);
+    condensation.recover(reduced_solution, condensed_rhs, solution, use_tbb);
+    EXPECT_LE((solution - expected).sup_norm(), 1e-10) << "use_tbb: " << use_tbb;
+  }
+  // a second assembly has to yield the same reduced system
+  VectorType expected_product(condensation.size(), 0.0);
+  condensation.matrix().mv(reduced_solution, expected_product);
+  condensed_rhs *= 0.0;
+  condensed_assembler.assemble(true);
+  VectorType product(condensation.size(), 0.0);
+  condensation.matrix().mv(reduced_solution, product);
+  EXPECT_LE((product - expected_product).sup_norm(), 1e-10);
+  EXPECT_LE((condensation.reduce(condensed_rhs) - reduced_rhs).sup_norm(), 1e-10);
+} // TEST(StaticCondensation, recovers_the_solution_of_the_full_system)
+
+#else // HAVE_DUNE_FEM && HAVE_EIGEN
+
+TEST(DISABLED_StaticCondensation, recovers_the_solution_of_the_full_system) {}
+
+#endif // HAVE_DUNE_FEM && HAVE_EIGEN
@@ -0,0 +1,142 @@
+// This file is part of the dune-gdt project:
+//   http://users.dune-project.org/projects/dune-gdt
+// Copyright holders: Felix Schindler
+// License: BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+
+// This one has to come first (includes the config.h)!
+#include <dune/stuff/test/main.hxx>
+
+#include <dune/grid/yaspgrid.hh>
+
+#include <dune/stuff/functions/expression.hh>
+#include <dune/stuff/grid/provider/cube.hh>
+#include <dune/stuff/la/container/common.hh>
+
+#include <dune/gdt/assembler/local/codim0.hh>
+#include <dune/gdt/assembler/local/codim1.hh>
+#include <dune/gdt/assembler/static.hh>
+#include <dune/gdt/assembler/system.hh>
+#include <dune/gdt/localevaluation/product.hh>
+#include <dune/gdt/localevaluation/swipdg.hh>
+#include <dune/gdt/localfunctional/codim0.hh>
+#include <dune/gdt/localfunctional/codim1.hh>
+#include <dune/gdt/localoperator/codim0.hh>
+#include <dune/gdt/localoperator/codim1.hh>
+#include <dune/gdt/spaces/fv/default.hh>
+
+using namespace Dune;
+using namespace GDT;
+
+
+struct StaticSystemAssemblerTest
+  : public ::testing::Test
+{
+  typedef YaspGrid< 2 >                                                    GridType;
+  typedef GridType::LeafGridView                                           GridViewType;
+  typedef GridViewType::Codim< 0 >::Entity                                 EntityType;
+  typedef Spaces::FV::Default< GridViewType, double, 1 >                   SpaceType;
+  typedef Stuff::LA::CommonDenseMatrix< double >                           MatrixType;
+  typedef Stuff::LA::CommonDenseVector< double >                           VectorType;
+  typedef Stuff::Functions::Expression< EntityType, double, 2, double, 1 > FunctionType;
+  typedef LocalOperator::Codim0Integral< LocalEvaluation::Product< FunctionType > >              VolumeOperatorType;
+  typedef LocalOperator::Codim1CouplingIntegral< LocalEvaluation::SWIPDG::Inner< FunctionType > > CouplingOperatorType;
+  typedef LocalOperator::Codim1BoundaryIntegral< LocalEvaluation::SWIPDG::BoundaryLHS< FunctionType > >
+      BoundaryOperatorType;
+  typedef LocalFunctional::Codim0Integral< LocalEvaluation::Product< FunctionType > >            VolumeFunctionalType;
+  typedef LocalFunctional::Codim1Integral< LocalEvaluation::Product< FunctionType > >            FaceFunctionalType;
+
+  StaticSystemAssemblerTest()
+    : grid_provider_(Stuff::Grid::Providers::Cube< GridType >::create())
+    , space_(grid_provider_->grid().leafGridView())
+    , function_("x", "1 + x[0]*x[1]", 2)
+    , volume_operator_(function_)
+    , coupling_operator_(function_)
+    , boundary_operator_(function_)
+    , volume_functional_(function_)
+    , face_functional_(function_)
+    , volume_matrix_assembler_(volume_operator_)
+    , coupling_matrix_assembler_(coupling_operator_)
+    , boundary_matrix_assembler_(boundary_operator_)
+    , volume_vector_assembler_(volume_functional_)
+    , face_vector_assembler_(face_functional_)
+  {}
+
+  MatrixType create_matrix() const
+  {
+    return MatrixType(space_.mapper().size(), space_.mapper().size(), space_.compute_face_and_volume_pattern());
+  }
+
+  static void expect_equal(const MatrixType& expected, const MatrixType& matrix)
+  {
+    for (size_t ii = 0; ii < expected.rows(); ++ii)
+      for (size_t jj = 0; jj < expected.cols(); ++jj)
+        EXPECT_NEAR(expected.get_entry(ii, jj), matrix.get_entry(ii, jj), 1e-13) << ii << ", " << jj;
+  }
+
+  std::unique_ptr< Stuff::Grid::Providers::Cube< GridType > > grid_provider_;
+  const SpaceType space_;
+  const FunctionType function_;
+  const VolumeOperatorType volume_operator_;
+  const CouplingOperatorType coupling_operator_;
+  const BoundaryOperatorType boundary_operator_;
+  const VolumeFunctionalType volume_functional_;
+  const FaceFunctionalType face_functional_;
+  const LocalAssembler::Codim0Matrix< VolumeOperatorType > volume_matrix_assembler_;
+  const LocalAssembler::Codim1CouplingMatrix< CouplingOperatorType > coupling_matrix_assembler_;
+  const LocalAssembler::Codim1BoundaryMatrix< BoundaryOperatorType > boundary_matrix_assembler_;
+  const LocalAssembler::Codim0Vector< VolumeFunctionalType > volume_vector_assembler_;
+  const LocalAssembler::Codim1Vector< FaceFunctionalType > face_vector_assembler_;
+}; // struct StaticSystemAssemblerTest
+
+
+TEST_F(StaticSystemAssemblerTest, matches_system_assembler)
+{
+  // the same local assemblers with the same filters, assembled by the dynamic SystemAssembler
+  auto expected_volume_matrix = create_matrix();
+  auto expected_face_matrix = create_matrix();
+  VectorType expected_volume_vector(space_.mapper().size(), 0.0);
+  VectorType expected_face_vector(space_.mapper().size(), 0.0);
+  SystemAssembler< SpaceType > system_assembler(space_);
+  system_assembler.add(volume_matrix_assembler_, expected_volume_matrix);
+  system_assembler.add(coupling_matrix_assembler_,
+                       expected_face_matrix,
+                       new Stuff::Grid::ApplyOn::InnerIntersections< GridViewType >());
+  system_assembler.add(boundary_matrix_assembler_,
+                       expected_face_matrix,
+                       new Stuff::Grid::ApplyOn::BoundaryIntersections< GridViewType >());
+  system_assembler.add(volume_vector_assembler_, expected_volume_vector);
+  system_assembler.add(face_vector_assembler_,
+                       expected_face_vector,
+                       new Stuff::Grid::ApplyOn::BoundaryIntersections< GridViewType >());
+  system_assembler.assemble();
+  EXPECT_GT(expected_volume_vector.sup_norm(), 0.0);
+  EXPECT_GT(expected_face_vector.sup_norm(), 0.0);
+  // and by the StaticSystemAssembler
+  auto volume_matrix = create_matrix();
+  auto face_matrix = create_matrix();
+  VectorType volume_vector(space_.mapper().size(), 0.0);
+  VectorType face_vector(space_.mapper().size(), 0.0);
+  auto static_assembler
+      = make_system_assembler(space_,
+                              make_local_assembly(volume_matrix_assembler_, volume_matrix),
+                              make_local_assembly(coupling_matrix_assembler_,
+                                                  face_matrix,
+                                                  Stuff::Grid::ApplyOn::InnerIntersections< GridViewType >()),
+                              make_local_assembly(boundary_matrix_assembler_,
+                                                  face_matrix,
+                                                  Stuff::Grid::ApplyOn::BoundaryIntersections< GridViewType >()),
+                              make_local_assembly(volume_vector_assembler_, volume_vector),
+                              make_local_assembly(face_vector_assembler_,
+                                                  face_vector,
+                                                  Stuff::Grid::ApplyOn::BoundaryIntersections< GridViewType >()));
+  static_assembler->assemble();
+  expect_equal(expected_volume_matrix, volume_matrix);
+  expect_equal(expected_face_matrix, face_matrix);
+  EXPECT_LE((volume_vector - expected_volume_vector).sup_norm(), 1e-13);
+  EXPECT_LE((face_vector - expected_face_vector).sup_norm(), 1e-13);
+  // a second assembly adds the same contributions again
+  static_assembler->assemble();
+  VectorType twice_expected_volume_vector = expected_volume_vector;
+  twice_expected_volume_vector *= 2.0;
+  EXPECT_LE((volume_vector - twice_expected_volume_vector).sup_norm(), 1e-13);
+}
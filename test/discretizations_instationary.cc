@@ -0,0 +1,130 @@
+// This file is part of the dune-gdt project:
+//   http://users.dune-project.org/projects/dune-gdt
+// Copyright holders: Felix Schindler
+// License: BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+
+// This one has to come first (includes the config.h)!
+#include <dune/stuff/test/main.hxx>
+
+#if HAVE_DUNE_FEM && HAVE_EIGEN
+# include <dune/grid/sgrid.hh>
+
+# include <dune/stuff/functions/constant.hh>
+# include <dune/stuff/grid/provider/cube.hh>
+# include <dune/stuff/la/container.hh>
+
+# include <dune/gdt/assembler/system.hh>
+# include <dune/gdt/discretizations/default.hh>
+# include <dune/gdt/localevaluation/elliptic.hh>
+# include <dune/gdt/localevaluation/product.hh>
+# include <dune/gdt/localfunctional/codim0.hh>
+# include <dune/gdt/localoperator/codim0.hh>
+# include <dune/gdt/spaces/cg.hh>
+#endif // HAVE_DUNE_FEM && HAVE_EIGEN
+
+using namespace Dune;
+using namespace GDT;
+
+
+#if HAVE_DUNE_FEM && HAVE_EIGEN
+
+/**
+ * d_t u - laplace u = f with natural boundary conditions and u(0) = 0: for f = 1 the solution is u(t) = t, for
+ * f(t) = t it is u(t) = t^2 / 2, both constant in space.
+ */
+struct InstationaryContainerBasedDefaultTest
+  : public ::testing::Test
+{
+  static const size_t d = 2;
+  typedef SGrid< d, d >                                   GridType;
+  typedef GridType::template Codim< 0 >::Entity           E;
+  typedef GridType::ctype                                 D;
+  typedef double                                          R;
+  typedef Stuff::LA::EigenRowMajorSparseMatrix< R >       MatrixType;
+  typedef Stuff::LA::EigenDenseVector< R >                VectorType;
+  typedef Stuff::Functions::Constant< E, D, d, R, 1 >     FunctionType;
+  typedef Spaces::CGProvider< GridType, Stuff::Grid::ChooseLayer::leaf, ChooseSpaceBackend::fem, 1, R, 1 >
+      SpaceProvider;
+  typedef SpaceProvider::Type                             SpaceType;
+  typedef Discretizations::InstationaryContainerBasedDefault< FunctionType, SpaceType, MatrixType, VectorType >
+      DiscretizationType;
+
+  InstationaryContainerBasedDefaultTest()
+    : grid_provider_(Stuff::Grid::Providers::Cube< GridType >::create())
+    , space_(SpaceProvider::create(*grid_provider_))
+    , one_(1)
+    , mass_matrix_(space_.mapper().size(), space_.mapper().size(), space_.compute_volume_pattern())
+    , stiffness_matrix_(space_.mapper().size(), space_.mapper().size(), space_.compute_volume_pattern())
+    , rhs_vector_(space_.mapper().size(), 0.0)
+  {
+    typedef LocalOperator::Codim0Integral< LocalEvaluation::Product< FunctionType > >   MassOperatorType;
+    typedef LocalOperator::Codim0Integral< LocalEvaluation::Elliptic< FunctionType > >  EllipticOperatorType;
+    typedef LocalFunctional::Codim0Integral< LocalEvaluation::Product< FunctionType > > FunctionalType;
+    const MassOperatorType mass_operator(one_);
+    const EllipticOperatorType elliptic_operator(one_);
+    const FunctionalType functional(one_);
+    const LocalAssembler::Codim0Matrix< MassOperatorType > mass_assembler(mass_operator);
+    const LocalAssembler::Codim0Matrix< EllipticOperatorType > elliptic_assembler(elliptic_operator);
+    const LocalAssembler::Codim0Vector< FunctionalType > rhs_assembler(functional);
+    SystemAssembler< SpaceType > system_assembler(space_);
+    system_assembler.add(mass_assembler, mass_matrix_);
+    system_assembler.add(elliptic_assembler, stiffness_matrix_);
+    system_assembler.add(rhs_assembler, rhs_vector_);
+    system_assembler.assemble();
+  }
+
+  std::unique_ptr< Stuff::Grid::Providers::Cube< GridType > > grid_provider_;
+  const SpaceType space_;
+  const FunctionType one_;
+  MatrixType mass_matrix_;
+  MatrixType stiffness_matrix_;
+  VectorType rhs_vector_;
+}; // struct InstationaryContainerBasedDefaultTest
+
+
+TEST_F(InstationaryContainerBasedDefaultTest, all_time_steppers_are_exact_for_a_constant_rhs)
+{
+  const DiscretizationType discretization(one_, space_, mass_matrix_, stiffness_matrix_, rhs_vector_);
+  for (const auto& type : discretization.time_stepper_types()) {
+    auto opts = discretization.time_stepper_options(type);
+    opts["end_time"] = "0.5";
+    opts["time_step"] = "0.1";
+    size_t num_calls = 0;
+    auto solution = discretization.create_vector();
+    solution *= 0.0;
+    discretization.solve(solution, opts, [&](const R time, const VectorType& current_solution) {
+      ++num_calls;
+      EXPECT_LE((current_solution - VectorType(current_solution.size(), time)).sup_norm(), 1e-10)
+          << "type: " << type << ", time: " << time;
+    });
+    EXPECT_EQ(size_t(6), num_calls) << "type: " << type;
+  }
+} // TEST_F(InstationaryContainerBasedDefaultTest, all_time_steppers_are_exact_for_a_constant_rhs)
+
+
+TEST_F(InstationaryContainerBasedDefaultTest, reassembles_time_dependent_rhs_once_per_step)
+{
+  size_t num_assemblies = 0;
+  const VectorType rhs_vector = rhs_vector_;
+  const DiscretizationType discretization(one_, space_, mass_matrix_, stiffness_matrix_,
+                                          [&](const R time, VectorType& rhs) {
+                                            ++num_assemblies;
+                                            rhs = rhs_vector;
+                                            rhs *= time;
+                                          });
+  auto opts = discretization.time_stepper_options("crank_nicolson");
+  opts["end_time"] = "1";
+  opts["time_step"] = "0.1";
+  auto solution = discretization.create_vector();
+  solution *= 0.0;
+  discretization.solve(solution, opts);
+  EXPECT_EQ(size_t(11), num_assemblies);
+  EXPECT_LE((solution - VectorType(solution.size(), 0.5)).sup_norm(), 1e-10);
+} // TEST_F(InstationaryContainerBasedDefaultTest, reassembles_time_dependent_rhs_once_per_step)
+
+#else // HAVE_DUNE_FEM && HAVE_EIGEN
+
+TEST(DISABLED_InstationaryContainerBasedDefaultTest, all_time_steppers_are_exact_for_a_constant_rhs) {}
+TEST(DISABLED_InstationaryContainerBasedDefaultTest, reassembles_time_dependent_rhs_once_per_step) {}
+
+#endif // HAVE_DUNE_FEM && HAVE_EIGEN
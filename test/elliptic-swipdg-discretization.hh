@@ -43,6 +43,7 @@
 #include <dune/gdt/operators/oswaldinterpolation.hh>
 #include <dune/gdt/operators/prolongations.hh>
 #include <dune/gdt/operators/projections.hh>
+#include <dune/gdt/playground/estimators/ESV2007.hh>
 #include <dune/gdt/playground/products/ESV2007.hh>
 #include <dune/gdt/playground/spaces/dg/fem.hh>
 #include <dune/gdt/products/elliptic.hh>
@@ -825,6 +826,9 @@ private:
     const Operators::DiffusiveFluxReconstruction< GridViewType, DiffusionType >
       diffusive_flux_reconstruction(grid_view, test_.diffusion(), over_integrate);
     diffusive_flux_reconstruction.apply(discrete_solution, diffusive_flux);
+    RTN0DiscreteFunctionType diffusive_flux_in_parallel(rtn0_space);
+    diffusive_flux_reconstruction.apply(discrete_solution, diffusive_flux_in_parallel, true);
+    EXPECT_EQ(0.0, (diffusive_flux.vector() - diffusive_flux_in_parallel.vector()).sup_norm());
 
     GDT::Products::ESV2007::DiffusiveFluxEstimate< GridViewType, DiffusionType, RTN0DiscreteFunctionType
                                                 , ConstDiscreteFunctionType, ConstDiscreteFunctionType >
@@ -919,6 +923,16 @@ private:
 
       eta += eta_nc_t_squared + std::pow(eta_r + eta_df, 2);
     } // walk the grid
+
+    // the fused estimator has to yield the same result, with and without threads
+    typedef Estimators::ESV2007< typename DiscretizationType::SpaceType, VectorType, DiffusionType,
+                                 typename TestCase::ForceType, GridViewType > EstimatorType;
+    EstimatorType estimator(discretization.space(), grid_view, test_.diffusion(), test_.force(), 1);
+    for (const bool use_tbb : {false, true}) {
+      const double fused_eta = estimator.estimate(*current_solution_vector_on_level_, use_tbb);
+      EXPECT_NEAR(std::sqrt(eta), fused_eta, 1e-10 * std::sqrt(eta));
+      EXPECT_EQ(grid_view.indexSet().size(0), estimator.indicators().size());
+    }
     return std::sqrt(eta);
   } // ... compute_estimator_ESV07(...)
 
@@ -27,12 +27,12 @@
 #include <dune/stuff/functions/constant.hh>
 #include <dune/stuff/functions/expression.hh>
 #include <dune/stuff/functions/checkerboard.hh>
-#include <dune/stuff/functions/spe10.hh>
 #include <dune/stuff/common/color.hh>
 #include <dune/stuff/common/print.hh>
 #include <dune/stuff/common/float_cmp.hh>
 #include <dune/stuff/common/memory.hh>
 
+#include <dune/gdt/functions/spe10.hh>
 #include <dune/gdt/spaces/tools.hh>
 
 std::ostream&
@@ -607,7 +607,7 @@ public:
   typedef Dune::Stuff::Functions::Expression
       < EntityType, DomainFieldType, dimDomain, RangeFieldType, dimRange >
     ExpressionFunctionType;
-  typedef Dune::Stuff::Functions::Spe10::Model1
+  typedef Dune::GDT::Functions::Spe10::Model1
       < EntityType, DomainFieldType, dimDomain, RangeFieldType, dimRange >
     Spe10Model1FunctionType;
   typedef Spe10Model1FunctionType DiffusionType;
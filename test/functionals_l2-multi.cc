@@ -0,0 +1,85 @@
+// This file is part of the dune-gdt project:
+//   http://users.dune-project.org/projects/dune-gdt
+// Copyright holders: Felix Schindler
+// License: BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+
+// This one has to come first (includes the config.h)!
+#include <dune/stuff/test/main.hxx>
+
+#include <dune/grid/sgrid.hh>
+#include <dune/grid/yaspgrid.hh>
+
+#include <dune/stuff/functions/expression.hh>
+#include <dune/stuff/grid/provider/cube.hh>
+#include <dune/stuff/la/container/common.hh>
+
+#include <dune/gdt/functionals/l2.hh>
+#include <dune/gdt/functionals/l2-multi.hh>
+#include <dune/gdt/spaces/fv/default.hh>
+
+using namespace Dune;
+using namespace GDT;
+
+
+template< class GridType >
+struct L2MultiTest
+  : public ::testing::Test
+{
+  typedef typename GridType::LeafGridView                    GridViewType;
+  typedef typename GridViewType::template Codim< 0 >::Entity EntityType;
+  typedef typename GridType::ctype                           DomainFieldType;
+  static const size_t                                        dimDomain = GridType::dimension;
+  typedef Spaces::FV::Default< GridViewType, double, 1 >     SpaceType;
+  typedef Stuff::LA::CommonDenseVector< double >             VectorType;
+  typedef Stuff::Functions::Expression< EntityType, DomainFieldType, dimDomain, double, 1 > ExpressionType;
+
+  template< class MultiFunctionalType, class SingleFunctionalType >
+  void produces_same_results_as_single_functionals(const bool use_tbb) const
+  {
+    auto grid_provider = Stuff::Grid::Providers::Cube< GridType >::create();
+    const SpaceType space(grid_provider->grid().leafGridView());
+    const std::vector< ExpressionType > functions = {ExpressionType("x", "1", 0),
+                                                     ExpressionType("x", "x[0]", 1),
+                                                     ExpressionType("x", "x[0]*x[0] + 2", 2)};
+    // no copies of one vector, these would share their data until the first (possibly concurrent) write
+    std::vector< VectorType > vectors;
+    for (size_t kk = 0; kk < functions.size(); ++kk)
+      vectors.emplace_back(space.mapper().size(), 0.0);
+    MultiFunctionalType multi_functional({functions[0], functions[1], functions[2]}, vectors, space);
+    multi_functional.assemble(use_tbb);
+    for (size_t kk = 0; kk < functions.size(); ++kk) {
+      VectorType expected(space.mapper().size(), 0.0);
+      SingleFunctionalType single_functional(functions[kk], expected, space);
+      single_functional.assemble();
+      EXPECT_LE((vectors[kk] - expected).sup_norm(), 1e-13) << "function " << kk;
+    }
+  } // ... produces_same_results_as_single_functionals(...)
+}; // struct L2MultiTest
+
+
+typedef testing::Types< SGrid< 1, 1 >, SGrid< 2, 2 >, SGrid< 3, 3 >
+                      , YaspGrid< 1 >, YaspGrid< 2 >, YaspGrid< 3 >
+                      > GridTypes;
+
+TYPED_TEST_CASE(L2MultiTest, GridTypes);
+TYPED_TEST(L2MultiTest, volume_produces_same_results_as_single_functionals) {
+  typedef typename TestFixture::SpaceType      S;
+  typedef typename TestFixture::VectorType     V;
+  typedef typename TestFixture::ExpressionType F;
+  this->template produces_same_results_as_single_functionals< Functionals::L2VolumeMulti< F, V, S >,
+                                                              Functionals::L2Volume< F, V, S > >(false);
+}
+TYPED_TEST(L2MultiTest, volume_produces_same_results_as_single_functionals_in_parallel) {
+  typedef typename TestFixture::SpaceType      S;
+  typedef typename TestFixture::VectorType     V;
+  typedef typename TestFixture::ExpressionType F;
+  this->template produces_same_results_as_single_functionals< Functionals::L2VolumeMulti< F, V, S >,
+                                                              Functionals::L2Volume< F, V, S > >(true);
+}
+TYPED_TEST(L2MultiTest, face_produces_same_results_as_single_functionals) {
+  typedef typename TestFixture::SpaceType      S;
+  typedef typename TestFixture::VectorType     V;
+  typedef typename TestFixture::ExpressionType F;
+  this->template produces_same_results_as_single_functionals< Functionals::L2FaceMulti< F, V, S >,
+                                                              Functionals::L2Face< F, V, S > >(false);
+}
@@ -0,0 +1,198 @@
+// This file is part of the dune-gdt project:
+//   http://users.dune-project.org/projects/dune-gdt
+// Copyright holders: Felix Schindler
+// License: BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+
+// This one has to come first (includes the config.h)!
+#include <dune/stuff/test/main.hxx>
+
+#include <dune/grid/sgrid.hh>
+#include <dune/grid/yaspgrid.hh>
+
+#include <dune/stuff/common/float_cmp.hh>
+#include <dune/stuff/common/ranges.hh>
+#include <dune/stuff/functions/expression.hh>
+#include <dune/stuff/grid/provider/cube.hh>
+
+#include <dune/gdt/functions/elementwise-constant.hh>
+
+using namespace Dune;
+using namespace GDT;
+
+
+template< class GridType >
+struct ElementwiseConstantTest
+  : public ::testing::Test
+{
+  typedef typename GridType::LeafGridView                    GridViewType;
+  typedef typename GridViewType::template Codim< 0 >::Entity EntityType;
+  typedef typename GridType::ctype                           DomainFieldType;
+  static const size_t                                        dimDomain = GridType::dimension;
+  typedef Functions::ElementwiseConstant< GridViewType, double, 1 > ElementwiseConstantType;
+  typedef Stuff::Functions::Expression< EntityType, DomainFieldType, dimDomain, double, 1 > ExpressionType;
+
+  static_assert(Functions::is_elementwise_constant< ElementwiseConstantType >::value, "");
+  static_assert(!Functions::is_elementwise_constant< ExpressionType >::value, "");
+
+  void samples_in_centers(const bool use_tbb) const
+  {
+    auto grid_provider = Stuff::Grid::Providers::Cube< GridType >::create();
+    const auto grid_view = grid_provider->grid().leafGridView();
+    const ExpressionType expression("x", "x[0]", 1);
+    const auto elementwise_constant = Functions::make_elementwise_constant(grid_view, expression, use_tbb);
+    EXPECT_EQ(grid_view.indexSet().size(0), elementwise_constant.values().size());
+    for (const auto& entity : DSC::entityRange(grid_view)) {
+      const auto center = entity.geometry().center();
+      EXPECT_TRUE(DSC::FloatCmp::eq(center[0], elementwise_constant.value(entity)[0]));
+      const auto local_function = elementwise_constant.local_function(entity);
+      EXPECT_EQ(0, local_function->order());
+      const auto& reference_element = ReferenceElements< DomainFieldType, dimDomain >::general(entity.type());
+      for (int ii = 0; ii < reference_element.size(dimDomain); ++ii) {
+        const auto value = local_function->evaluate(reference_element.position(ii, dimDomain));
+        EXPECT_TRUE(DSC::FloatCmp::eq(center[0], value[0]));
+      }
+    }
+  } // ... samples_in_centers(...)
+}; // struct ElementwiseConstantTest
+
+
+typedef testing::Types< SGrid< 1, 1 >, SGrid< 2, 2 >, SGrid< 3, 3 >
+                      , YaspGrid< 1 >, YaspGrid< 2 >, YaspGrid< 3 >
+                      > GridTypes;
+
+TYPED_TEST_CASE(ElementwiseConstantTest, GridTypes);
+TYPED_TEST(ElementwiseConstantTest, samples_in_centers) {
+  this->samples_in_centers(false);
+}
+TYPED_TEST(ElementwiseConstantTest, samples_in_centers_in_parallel) {
+  this->samples_in_centers(true);
+}
+
+
+#if HAVE_DUNE_FEM
+
+# include <dune/stuff/la/container/common.hh>
+
+# include <dune/gdt/assembler/local/codim0.hh>
+# include <dune/gdt/assembler/system.hh>
+# include <dune/gdt/localevaluation/elliptic.hh>
+# include <dune/gdt/localoperator/codim0.hh>
+# include <dune/gdt/spaces/cg.hh>
+
+
+struct ElementwiseConstantEllipticTest
+  : public ::testing::Test
+{
+  static const size_t                                      d = 2;
+  typedef SGrid< d, d >                                    GridType;
+  typedef GridType::LeafGridView                           GridViewType;
+  typedef GridViewType::Codim< 0 >::Entity                 E;
+  typedef GridType::ctype                                  D;
+  typedef double                                           R;
+  typedef Stuff::LA::CommonDenseMatrix< R >                MatrixType;
+  typedef Functions::ElementwiseConstant< GridViewType, R, 1 >    FactorType;
+  typedef Functions::ElementwiseConstant< GridViewType, R, d, d > TensorType;
+  typedef Stuff::LocalizableFunctionInterface< E, D, d, R, 1 >    FactorInterfaceType;
+  typedef Stuff::LocalizableFunctionInterface< E, D, d, R, d, d > TensorInterfaceType;
+  typedef Spaces::CGProvider< GridType, Stuff::Grid::ChooseLayer::leaf, ChooseSpaceBackend::fem, 1, R, 1 > CG;
+
+  static_assert(!Functions::is_elementwise_constant< FactorInterfaceType >::value, "");
+
+  ElementwiseConstantEllipticTest()
+    : grid_provider_(Stuff::Grid::Providers::Cube< GridType >::create())
+  {
+    grid_provider_->grid().globalRefine(2);
+  }
+
+  FactorType create_factor() const
+  {
+    const auto grid_view = grid_provider_->grid().leafGridView();
+    std::vector< FactorType::RangeType > values(grid_view.indexSet().size(0));
+    for (size_t ii = 0; ii < values.size(); ++ii)
+      values[ii] = 1.0 + (ii % 3);
+    return FactorType(grid_view, values);
+  }
+
+  TensorType create_tensor() const
+  {
+    const auto grid_view = grid_provider_->grid().leafGridView();
+    std::vector< TensorType::RangeType > values(grid_view.indexSet().size(0), TensorType::RangeType(0));
+    for (size_t ii = 0; ii < values.size(); ++ii) {
+      values[ii][0][0] = 1.0 + (ii % 2);
+      values[ii][0][1] = values[ii][1][0] = 0.25;
+      values[ii][1][1] = 2.0 + (ii % 5);
+    }
+    return TensorType(grid_view, values);
+  }
+
+  template< class LocalEvaluationType, class... Args >
+  MatrixType assemble(const CG::Type& space, const Args&... args) const
+  {
+    typedef LocalOperator::Codim0Integral< LocalEvaluationType > LocalOperatorType;
+    const LocalOperatorType local_operator(args...);
+    const LocalAssembler::Codim0Matrix< LocalOperatorType > local_assembler(local_operator);
+    MatrixType matrix(space.mapper().size(), space.mapper().size(), space.compute_volume_pattern());
+    SystemAssembler< CG::Type > assembler(space);
+    assembler.add(local_assembler, matrix);
+    assembler.assemble();
+    return matrix;
+  } // ... assemble(...)
+
+  static void expect_equal(const MatrixType& expected, const MatrixType& matrix)
+  {
+    EXPECT_GT(expected.get_entry(0, 0), 0.0);
+    for (size_t ii = 0; ii < expected.rows(); ++ii)
+      for (size_t jj = 0; jj < expected.cols(); ++jj)
+        EXPECT_NEAR(expected.get_entry(ii, jj), matrix.get_entry(ii, jj), 1e-13) << ii << ", " << jj;
+  }
+
+  std::unique_ptr< Stuff::Grid::Providers::Cube< GridType > > grid_provider_;
+}; // struct ElementwiseConstantEllipticTest
+
+
+// the same functions seen through their interface take the generic path
+TEST_F(ElementwiseConstantEllipticTest, fast_path_matches_generic_path_for_a_diffusion)
+{
+  const auto space = CG::create(*grid_provider_);
+  const auto factor = create_factor();
+  const auto tensor = create_tensor();
+  const FactorInterfaceType& factor_interface = factor;
+  const TensorInterfaceType& tensor_interface = tensor;
+  expect_equal(assemble< LocalEvaluation::Elliptic< FactorInterfaceType > >(space, factor_interface),
+               assemble< LocalEvaluation::Elliptic< FactorType > >(space, factor));
+  expect_equal(assemble< LocalEvaluation::Elliptic< TensorInterfaceType > >(space, tensor_interface),
+               assemble< LocalEvaluation::Elliptic< TensorType > >(space, tensor));
+}
+
+TEST_F(ElementwiseConstantEllipticTest, fast_path_matches_generic_path_for_a_factor_and_a_tensor)
+{
+  const auto space = CG::create(*grid_provider_);
+  const auto factor = create_factor();
+  const auto tensor = create_tensor();
+  const FactorInterfaceType& factor_interface = factor;
+  const TensorInterfaceType& tensor_interface = tensor;
+  const auto expected
+      = assemble< LocalEvaluation::Elliptic< FactorInterfaceType, TensorInterfaceType > >(space,
+                                                                                           factor_interface,
+                                                                                           tensor_interface);
+  expect_equal(expected, assemble< LocalEvaluation::Elliptic< FactorType, TensorType > >(space, factor, tensor));
+  // mixed, only one of both is looked up per entity
+  expect_equal(expected,
+               assemble< LocalEvaluation::Elliptic< FactorType, TensorInterfaceType > >(space,
+                                                                                        factor,
+                                                                                        tensor_interface));
+  expect_equal(expected,
+               assemble< LocalEvaluation::Elliptic< FactorInterfaceType, TensorType > >(space,
+                                                                                        factor_interface,
+                                                                                        tensor));
+}
+
+
+#else // HAVE_DUNE_FEM
+
+
+TEST(DISABLED_ElementwiseConstantEllipticTest, fast_path_matches_generic_path_for_a_diffusion) {}
+TEST(DISABLED_ElementwiseConstantEllipticTest, fast_path_matches_generic_path_for_a_factor_and_a_tensor) {}
+
+
+#endif // HAVE_DUNE_FEM
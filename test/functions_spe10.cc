@@ -0,0 +1,156 @@
+// This file is part of the dune-gdt project:
+//   http://users.dune-project.org/projects/dune-gdt
+// Copyright holders: Felix Schindler
+// License: BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+
+// This one has to come first (includes the config.h)!
+#include <dune/stuff/test/main.hxx>
+
+#include <cstdio>
+#include <fstream>
+
+#include <dune/grid/yaspgrid.hh>
+
+#include <dune/stuff/common/float_cmp.hh>
+#include <dune/stuff/common/ranges.hh>
+#include <dune/stuff/grid/provider/cube.hh>
+
+#include <dune/gdt/functions/spe10.hh>
+
+using namespace Dune;
+using namespace GDT;
+
+static const std::string ascii_filename = "functions_spe10_test_data.dat";
+
+
+static void write_ascii_file(const size_t size, const double offset = 1.0)
+{
+  std::ofstream file(ascii_filename);
+  file.precision(15);
+  for (size_t ii = 0; ii < size; ++ii)
+    file << offset + ii << ((ii % 6 == 5) ? "\n" : " ");
+}
+
+
+static void remove_files()
+{
+  std::remove(ascii_filename.c_str());
+  std::remove((ascii_filename + ".bin").c_str());
+}
+
+
+TEST(Spe10Data, is_converted_once_and_shared)
+{
+  write_ascii_file(2000);
+  {
+    const auto data = Functions::Spe10::internal::Data::get(ascii_filename, 2000);
+    EXPECT_EQ(2000u, data->size());
+    for (size_t ii = 0; ii < data->size(); ++ii)
+      EXPECT_EQ(1.0 + ii, (*data)[ii]);
+    EXPECT_EQ(data.get(), Functions::Spe10::internal::Data::get(ascii_filename, 2000).get());
+    EXPECT_TRUE(std::ifstream(ascii_filename + ".bin").good());
+  }
+  // the binary file has to be used, even if the ascii file is gone
+  std::remove(ascii_filename.c_str());
+  {
+    const auto data = Functions::Spe10::internal::Data::get(ascii_filename, 2000);
+    EXPECT_EQ(2000u, data->size());
+    EXPECT_EQ(1.0, (*data)[0]);
+    EXPECT_EQ(2000.0, (*data)[1999]);
+  }
+  remove_files();
+  EXPECT_THROW(Functions::Spe10::internal::Data::get(ascii_filename, 2000), Exceptions::spe10_data_file_missing);
+} // TEST(Spe10Data, is_converted_once_and_shared)
+
+
+TEST(Spe10Data, is_recreated_if_the_source_changes)
+{
+  write_ascii_file(2000);
+  EXPECT_EQ(1.0, (*Functions::Spe10::internal::Data::get(ascii_filename, 2000))[0]);
+  // the size of the ascii file changes, as its modification time might not (given in seconds)
+  write_ascii_file(2000, 1000.5);
+  {
+    const auto data = Functions::Spe10::internal::Data::get(ascii_filename, 2000);
+    EXPECT_EQ(1000.5, (*data)[0]);
+    EXPECT_EQ(2999.5, (*data)[1999]);
+  }
+  remove_files();
+} // TEST(Spe10Data, is_recreated_if_the_source_changes)
+
+
+TEST(Spe10Data, is_recreated_if_the_binary_file_is_corrupted)
+{
+  write_ascii_file(2000);
+  const auto binary_filename = ascii_filename + ".bin";
+  EXPECT_EQ(2000.0, (*Functions::Spe10::internal::Data::get(ascii_filename, 2000))[1999]);
+  {
+    std::fstream file(binary_filename, std::ios::binary | std::ios::in | std::ios::out);
+    ASSERT_TRUE(file.is_open());
+    const double wrong_value = -1.0;
+    file.seekp(-std::streamoff(sizeof(double)), std::ios::end);
+    file.write(reinterpret_cast< const char* >(&wrong_value), sizeof(double));
+  }
+  EXPECT_EQ(2000.0, (*Functions::Spe10::internal::Data::get(ascii_filename, 2000))[1999]);
+  // the corrupted binary file has been replaced, which can thus be used without the ascii file
+  std::remove(ascii_filename.c_str());
+  EXPECT_EQ(2000.0, (*Functions::Spe10::internal::Data::get(ascii_filename, 2000))[1999]);
+  remove_files();
+} // TEST(Spe10Data, is_recreated_if_the_binary_file_is_corrupted)
+
+
+TEST(Spe10Model1, is_piecewise_constant)
+{
+  typedef YaspGrid< 2 >                                                GridType;
+  typedef GridType::Codim< 0 >::Entity                                 EntityType;
+  typedef Functions::Spe10::Model1< EntityType, double, 2, double, 1 > FunctionType;
+  write_ascii_file(2000);
+  {
+    Stuff::Grid::Providers::Cube< GridType > grid_provider({0.0, 0.0}, {5.0, 1.0}, {100u, 20u});
+    const auto grid_view = grid_provider.grid().leafGridView();
+    const FunctionType function(ascii_filename,
+                                {0.0, 0.0},
+                                {5.0, 1.0},
+                                Stuff::Functions::Spe10::internal::model1_min_value,
+                                Stuff::Functions::Spe10::internal::model1_max_value);
+    for (const auto& entity : DSC::entityRange(grid_view)) {
+      const auto center = entity.geometry().center();
+      const size_t ii = size_t(center[0] / 0.05);
+      const size_t jj = size_t(center[1] / 0.05);
+      const auto local_function = function.local_function(entity);
+      EXPECT_EQ(0u, local_function->order());
+      EXPECT_TRUE(DSC::FloatCmp::eq(1.0 + ii + 100*jj, local_function->evaluate(entity.geometry().local(center))[0]));
+    }
+  }
+  remove_files();
+} // TEST(Spe10Model1, is_piecewise_constant)
+
+
+TEST(Spe10Model2, is_piecewise_constant_and_diagonal)
+{
+  typedef YaspGrid< 3 >                                                   GridType;
+  typedef GridType::Codim< 0 >::Entity                                    EntityType;
+  typedef Functions::Spe10::Model2< EntityType, double, 3, double, 3, 3 > FunctionType;
+  const size_t num_cells = Functions::Spe10::internal::model2_x_elements
+                           * Functions::Spe10::internal::model2_y_elements
+                           * Functions::Spe10::internal::model2_z_elements;
+  write_ascii_file(3*num_cells);
+  {
+    // each element of the grid contains several cells of the dataset, the value in its center is checked
+    Stuff::Grid::Providers::Cube< GridType > grid_provider({0.0, 0.0, 0.0}, {1200.0, 2200.0, 170.0}, {6u, 22u, 5u});
+    const auto grid_view = grid_provider.grid().leafGridView();
+    const FunctionType function(ascii_filename);
+    for (const auto& entity : DSC::entityRange(grid_view)) {
+      const auto center = entity.geometry().center();
+      const size_t index = size_t(center[0] / 20.0)
+                           + Functions::Spe10::internal::model2_x_elements*(size_t(center[1] / 10.0)
+                           + Functions::Spe10::internal::model2_y_elements*size_t(center[2] / 2.0));
+      const auto local_function = function.local_function(entity);
+      EXPECT_EQ(0u, local_function->order());
+      const auto value = local_function->evaluate(entity.geometry().local(center));
+      for (size_t ii = 0; ii < 3; ++ii)
+        for (size_t jj = 0; jj < 3; ++jj)
+          EXPECT_TRUE(DSC::FloatCmp::eq(ii == jj ? 1.0 + ii*num_cells + index : 0.0, value[ii][jj]));
+    }
+  }
+  remove_files();
+} // TEST(Spe10Model2, is_piecewise_constant_and_diagonal)
@@ -59,6 +59,11 @@ struct DarcyOperator
     const FunctionType function("x", "-1.0", 0);
     const Operators::Darcy< GridViewType, FunctionType > darcy_operator(range_space.grid_view(), function);
     darcy_operator.apply(source, range);
+    // the second application reuses the mass matrix (for CG spaces)
+    VectorType threaded_range_vector(range_space.mapper().size());
+    DiscreteFunction< RangeSpaceType, VectorType > threaded_range(range_space, threaded_range_vector);
+    darcy_operator.apply(source, threaded_range, true);
+    EXPECT_EQ(0.0, (threaded_range_vector - range_vector).sup_norm());
 
     const Stuff::Functions::Expression< EntityType, DomainFieldType, dimDomain, RangeFieldType, dimDomain >
       desired_output("x", std::vector< std::string >({"x[1]", "x[0]"}), 1,
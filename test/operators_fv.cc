@@ -0,0 +1,121 @@
+// This file is part of the dune-gdt project:
+//   http://users.dune-project.org/projects/dune-gdt
+// Copyright holders: Felix Schindler
+// License: BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+
+// This one has to come first (includes the config.h)!
+#include <dune/stuff/test/main.hxx>
+
+#include <algorithm>
+#include <cmath>
+
+#include <dune/grid/yaspgrid.hh>
+
+#include <dune/stuff/grid/provider/cube.hh>
+#include <dune/stuff/la/container/common.hh>
+
+#include <dune/gdt/operators/fv.hh>
+#include <dune/gdt/spaces/fv/default.hh>
+#include <dune/gdt/timestepping/explicit-rungekutta.hh>
+
+using namespace Dune;
+using namespace GDT;
+
+
+struct FiniteVolumeOperatorTest
+  : public ::testing::Test
+{
+  static const size_t d = 2;
+  typedef YaspGrid< d >                                   GridType;
+  typedef GridType::LeafGridView                          GridViewType;
+  typedef double                                          R;
+  typedef Spaces::FV::Default< GridViewType, R, 1 >       SpaceType;
+  typedef FieldVector< R, 1 >                             RangeType;
+  typedef FieldVector< R, d >                             DomainType;
+
+  FiniteVolumeOperatorTest()
+    : grid_provider_(Stuff::Grid::Providers::Cube< GridType >::create())
+    , space_(grid_provider_->grid().leafGridView())
+  {}
+
+  // a smooth bump, which vanishes on all entities at the boundary
+  template< class OperatorType >
+  typename OperatorType::CellDataType create_bump(const OperatorType& op) const
+  {
+    const auto& face_table = op.face_table();
+    auto ret = op.create_cell_data();
+    for (size_t ee = 0; ee < face_table.num_entities(); ++ee)
+      ret[ee] = 1.0 + std::sin(0.7 * ee);
+    for (size_t face = 0; face < face_table.num_faces(); ++face)
+      if (face_table.boundary(face))
+        ret[face_table.insides()[face]] = 0.0;
+    return ret;
+  } // ... create_bump(...)
+
+  std::unique_ptr< Stuff::Grid::Providers::Cube< GridType > > grid_provider_;
+  const SpaceType space_;
+}; // struct FiniteVolumeOperatorTest
+
+
+TEST_F(FiniteVolumeOperatorTest, is_conservative)
+{
+  // burgers' equation in direction (1, 1)
+  const auto flux = NumericalFluxes::make_lax_friedrichs< R, 1, d >(
+        [](const RangeType& u, const DomainType& n) { return RangeType(0.5 * u[0] * u[0] * (n[0] + n[1])); },
+        [](const RangeType& u, const DomainType& n) { return std::abs(u[0] * (n[0] + n[1])); });
+  typedef Operators::FiniteVolume< SpaceType, std::decay< decltype(flux) >::type > OperatorType;
+  const OperatorType op(space_, flux, false, [](const RangeType&, const DomainType&, const DomainType&) {
+    return RangeType(0);
+  });
+  const auto source = create_bump(op);
+  auto range = op.create_cell_data();
+  op.apply(source, range);
+  R total_change = 0;
+  for (size_t ee = 0; ee < op.face_table().num_entities(); ++ee)
+    total_change += op.face_table().entity_volumes()[ee] * range[ee];
+  EXPECT_LE(std::abs(total_change), 1e-12);
+  EXPECT_GT(op.faces_per_second(), 0.0);
+  // the parallel kernel computes the same fluxes
+  const OperatorType parallel_op(space_, flux, true, [](const RangeType&, const DomainType&, const DomainType&) {
+    return RangeType(0);
+  });
+  auto parallel_range = parallel_op.create_cell_data();
+  parallel_op.apply(source, parallel_range);
+  for (size_t ee = 0; ee < range.size(); ++ee)
+    EXPECT_DOUBLE_EQ(range[ee], parallel_range[ee]);
+} // TEST_F(FiniteVolumeOperatorTest, is_conservative)
+
+
+TEST_F(FiniteVolumeOperatorTest, preserves_constants)
+{
+  typedef NumericalFluxes::Upwind< R, 1, d >                      FluxType;
+  typedef Operators::FiniteVolume< SpaceType, FluxType >          OperatorType;
+  const OperatorType op(space_, FluxType(DomainType(1.0)));
+  Stuff::LA::CommonDenseVector< R > source(space_.mapper().size(), 2.0);
+  Stuff::LA::CommonDenseVector< R > range(space_.mapper().size(), 1.0);
+  op.apply(source, range);
+  EXPECT_LE(range.sup_norm(), 1e-12);
+} // TEST_F(FiniteVolumeOperatorTest, preserves_constants)
+
+
+TEST_F(FiniteVolumeOperatorTest, ssp_runge_kutta_fulfills_maximum_principle)
+{
+  typedef NumericalFluxes::Upwind< R, 1, d >                      FluxType;
+  typedef Operators::FiniteVolume< SpaceType, FluxType >          OperatorType;
+  typedef OperatorType::CellDataType                              CellDataType;
+  const OperatorType op(space_, FluxType(DomainType(1.0)), true);
+  for (const auto& type : TimeStepping::ExplicitRungeKutta< OperatorType, CellDataType >::types()) {
+    const TimeStepping::ExplicitRungeKutta< OperatorType, CellDataType > time_stepper(op, type, true);
+    auto solution = create_bump(op);
+    const R min = *std::min_element(solution.begin(), solution.end());
+    const R max = *std::max_element(solution.begin(), solution.end());
+    const size_t num_steps = time_stepper.solve(solution, 0.0, 0.5, op.max_time_step(solution, 0.9),
+                                                [&](const R /*time*/, const CellDataType& current) {
+      for (const auto& value : current) {
+        EXPECT_GE(value, min - 1e-12) << "type: " << type;
+        EXPECT_LE(value, max + 1e-12) << "type: " << type;
+      }
+    });
+    EXPECT_GT(num_steps, size_t(0));
+  }
+} // TEST_F(FiniteVolumeOperatorTest, ssp_runge_kutta_fulfills_maximum_principle)
@@ -6,6 +6,12 @@
 #ifndef DUNE_GDT_TEST_OPERATORS_OSWALDINTERPOLATION_HH
 #define DUNE_GDT_TEST_OPERATORS_OSWALDINTERPOLATION_HH
 
+#include <cmath>
+#include <map>
+#include <utility>
+
+#include <dune/geometry/referenceelements.hh>
+
 #include <dune/stuff/common/exceptions.hh>
 #include <dune/stuff/grid/provider/cube.hh>
 #include <dune/stuff/la/container/common.hh>
@@ -28,9 +34,6 @@ struct Oswald_Interpolation_Operator
   typedef Dune::Stuff::Grid::Providers::Cube< GridType > GridProviderType;
   static const size_t                                    dimDomain = SpaceType::dimDomain;
 
-  /**
-   * \note This is not a test for correct results yet!
-   */
   void produces_correct_results() const
   {
     // prepare the source function
@@ -48,9 +51,9 @@ struct Oswald_Interpolation_Operator
          ++entity_ptr) {
       const auto& entity = *entity_ptr;
       const auto center = entity.geometry().center();
-      double value = 0.0;
-      if (center[0] > 0.5)
-        value = 1.0;
+      double value = 1.0;
+      for (size_t dd = 0; dd < dimDomain; ++dd)
+        value += (dd + 1.0)*center[dd];
       auto local_source = source.local_discrete_function(entity);
       auto local_source_DoF_vector = local_source->vector();
       for (size_t local_DoF = 0; local_DoF < local_source_DoF_vector.size(); ++local_DoF)
@@ -61,7 +64,39 @@ struct Oswald_Interpolation_Operator
     DiscreteFunctionType range(space, range_vector);
     Operators::OswaldInterpolation< typename SpaceType::GridViewType > oswald_operator(space.grid_view());
     oswald_operator.apply(source, range);
-    // TODO: test result
+    // the averages of the source over all entities sharing a vertex, computed by hand
+    const auto& grid_view = space.grid_view();
+    std::map< size_t, std::pair< double, size_t > > sums;
+    for (auto entity_ptr = grid_view.template begin< 0 >(); entity_ptr != grid_view.template end< 0 >(); ++entity_ptr) {
+      const auto& entity = *entity_ptr;
+      const auto value = source.local_function(entity)->evaluate(entity.geometry().local(entity.geometry().center()));
+      for (int cc = 0; cc < entity.geometry().corners(); ++cc) {
+        auto& sum = sums[grid_view.indexSet().subIndex(entity, cc, dimDomain)];
+        sum.first += value[0];
+        ++sum.second;
+      }
+    }
+    // the range has to be the average in each vertex in the interior and zero on the boundary of [0, 1]^d
+    for (auto entity_ptr = grid_view.template begin< 0 >(); entity_ptr != grid_view.template end< 0 >(); ++entity_ptr) {
+      const auto& entity = *entity_ptr;
+      const auto& reference_element = ReferenceElements< double, dimDomain >::general(entity.type());
+      const auto local_range = range.local_function(entity);
+      for (int cc = 0; cc < entity.geometry().corners(); ++cc) {
+        const auto corner = entity.geometry().corner(cc);
+        bool on_boundary = false;
+        for (size_t dd = 0; dd < dimDomain; ++dd)
+          on_boundary = on_boundary || std::abs(corner[dd]) < 1e-10 || std::abs(corner[dd] - 1.0) < 1e-10;
+        const auto& sum = sums[grid_view.indexSet().subIndex(entity, cc, dimDomain)];
+        const double expected = on_boundary ? 0.0 : sum.first / sum.second;
+        EXPECT_NEAR(expected, local_range->evaluate(reference_element.position(cc, dimDomain))[0], 1e-12)
+            << "entity " << grid_view.indexSet().index(entity) << ", corner " << cc;
+      }
+    }
+    // the second application reuses the vertex to DoF adjacency
+    VectorType threaded_range_vector(space.mapper().size(), 2.0);
+    DiscreteFunctionType threaded_range(space, threaded_range_vector);
+    oswald_operator.apply(source, threaded_range, true);
+    EXPECT_EQ(0.0, (threaded_range_vector - range_vector).sup_norm());
   } // ... produces_correct_results()
 }; // struct Oswald_Interpolation_Operator
 
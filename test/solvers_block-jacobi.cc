@@ -0,0 +1,187 @@
+// This file is part of the dune-gdt project:
+//   http://users.dune-project.org/projects/dune-gdt
+// Copyright holders: Felix Schindler
+// License: BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+
+// This one has to come first (includes the config.h)!
+#include <dune/stuff/test/main.hxx>
+
+#include <dune/stuff/la/container.hh>
+#include <dune/stuff/la/solver.hh>
+
+#include <dune/gdt/solvers/block-jacobi.hh>
+
+#if HAVE_DUNE_FEM && HAVE_EIGEN
+# include <dune/grid/sgrid.hh>
+
+# include <dune/stuff/functions/constant.hh>
+# include <dune/stuff/grid/boundaryinfo.hh>
+# include <dune/stuff/grid/provider/cube.hh>
+
+# include <dune/gdt/playground/operators/elliptic-swipdg.hh>
+# include <dune/gdt/spaces/dg.hh>
+#endif // HAVE_DUNE_FEM && HAVE_EIGEN
+
+using namespace Dune;
+using namespace GDT;
+
+
+template< class ContainerPair >
+struct BlockJacobiTest
+  : public ::testing::Test
+{
+  typedef typename ContainerPair::first_type  MatrixType;
+  typedef typename ContainerPair::second_type VectorType;
+  typedef Solvers::BlockJacobi< MatrixType, VectorType > SolverType;
+  static const size_t size = 100;
+  static const size_t block_size = 4;
+
+  // the (symmetric positive definite) finite difference laplacian in 1d
+  static MatrixType create_matrix()
+  {
+    Stuff::LA::SparsityPatternDefault pattern(size);
+    for (size_t ii = 0; ii < size; ++ii) {
+      if (ii > 0)
+        pattern.inner(ii).push_back(ii - 1);
+      pattern.inner(ii).push_back(ii);
+      if (ii < size - 1)
+        pattern.inner(ii).push_back(ii + 1);
+    }
+    MatrixType matrix(size, size, pattern);
+    for (size_t ii = 0; ii < size; ++ii) {
+      if (ii > 0)
+        matrix.set_entry(ii, ii - 1, -1.0);
+      matrix.set_entry(ii, ii, 2.0);
+      if (ii < size - 1)
+        matrix.set_entry(ii, ii + 1, -1.0);
+    }
+    return matrix;
+  } // ... create_matrix(...)
+
+  // consecutive blocks, the last DoFs are left to the pointwise treatment
+  static typename SolverType::BlocksType create_blocks()
+  {
+    typename SolverType::BlocksType blocks;
+    for (size_t first = 0; first + block_size < size; first += block_size) {
+      blocks.emplace_back();
+      for (size_t ii = first; ii < first + block_size; ++ii)
+        blocks.back().push_back(ii);
+    }
+    return blocks;
+  }
+
+  static VectorType create_rhs()
+  {
+    VectorType rhs(size, 0.0);
+    for (size_t ii = 0; ii < size; ++ii)
+      rhs.set_entry(ii, (ii % 7) + 1.0);
+    return rhs;
+  }
+
+  static void precondition_inverts_a_single_block()
+  {
+    const auto matrix = create_matrix();
+    typename SolverType::BlocksType blocks(1);
+    for (size_t ii = 0; ii < size; ++ii)
+      blocks[0].push_back(ii);
+    const SolverType preconditioner(matrix, blocks);
+    EXPECT_EQ(size_t(1), preconditioner.num_blocks());
+    const auto rhs = create_rhs();
+    VectorType solution(size, 0.0);
+    preconditioner.precondition(rhs, solution);
+    VectorType product(size, 0.0);
+    matrix.mv(solution, product);
+    EXPECT_LE((product - rhs).sup_norm(), 1e-10);
+  } // ... precondition_inverts_a_single_block(...)
+
+  static void produces_same_results_as_stuff_solver(const bool use_tbb)
+  {
+    const auto matrix = create_matrix();
+    const auto rhs = create_rhs();
+    VectorType expected(size, 0.0);
+    Stuff::LA::Solver< MatrixType >(matrix).apply(rhs, expected);
+    const SolverType solver(matrix, create_blocks(), use_tbb);
+    for (const auto& type : SolverType::types()) {
+      auto opts = SolverType::options(type);
+      opts["precision"] = "1e-12";
+      VectorType solution(size, 0.0);
+      solver.apply(rhs, solution, opts);
+      EXPECT_LE((solution - expected).sup_norm(), 1e-8) << "type: " << type;
+    }
+  } // ... produces_same_results_as_stuff_solver(...)
+}; // struct BlockJacobiTest
+
+
+typedef testing::Types<
+                        std::pair< Stuff::LA::CommonDenseMatrix< double >, Stuff::LA::CommonDenseVector< double > >
+#if HAVE_EIGEN
+                      , std::pair< Stuff::LA::EigenRowMajorSparseMatrix< double >,
+                                   Stuff::LA::EigenDenseVector< double > >
+#endif
+#if HAVE_DUNE_ISTL
+                      , std::pair< Stuff::LA::IstlRowMajorSparseMatrix< double >,
+                                   Stuff::LA::IstlDenseVector< double > >
+#endif
+                      > ContainerTypes;
+
+TYPED_TEST_CASE(BlockJacobiTest, ContainerTypes);
+TYPED_TEST(BlockJacobiTest, precondition_inverts_a_single_block) {
+  this->precondition_inverts_a_single_block();
+}
+TYPED_TEST(BlockJacobiTest, produces_same_results_as_stuff_solver) {
+  this->produces_same_results_as_stuff_solver(false);
+}
+TYPED_TEST(BlockJacobiTest, produces_same_results_as_stuff_solver_in_parallel) {
+  this->produces_same_results_as_stuff_solver(true);
+}
+
+
+#if HAVE_DUNE_FEM && HAVE_EIGEN
+
+TEST(BlockJacobiAssembler, captures_entity_blocks_during_swipdg_assembly)
+{
+  static const size_t d = 2;
+  typedef SGrid< d, d >                                   GridType;
+  typedef GridType::template Codim< 0 >::Entity           E;
+  typedef GridType::ctype                                 D;
+  typedef double                                          R;
+  typedef Stuff::LA::EigenRowMajorSparseMatrix< R >       MatrixType;
+  typedef Stuff::LA::EigenDenseVector< R >                VectorType;
+  typedef Stuff::Functions::Constant< E, D, d, R, 1 >     ScalarFunctionType;
+  typedef Stuff::Functions::Constant< E, D, d, R, d, d >  TensorFunctionType;
+  typedef Spaces::DGProvider< GridType, Stuff::Grid::ChooseLayer::leaf, ChooseSpaceBackend::fem, 2, R, 1 >
+      SpaceProvider;
+  typedef SpaceProvider::Type                             SpaceType;
+  typedef typename SpaceType::GridViewType::Intersection  IntersectionType;
+  auto grid_provider = Stuff::Grid::Providers::Cube< GridType >::create();
+  const auto space = SpaceProvider::create(*grid_provider);
+  auto boundary_info = Stuff::Grid::BoundaryInfos::AllDirichlet< IntersectionType >::create();
+  const ScalarFunctionType one(1);
+  const TensorFunctionType identity(Stuff::Functions::internal::unit_matrix< R, d >());
+  auto op = Operators::make_elliptic_swipdg(one, identity, *boundary_info, MatrixType(), space);
+  Solvers::BlockJacobiAssembler< SpaceType > block_jacobi_assembler(space);
+  op->add(block_jacobi_assembler);
+  op->assemble();
+  const auto blocks = block_jacobi_assembler.blocks();
+  EXPECT_EQ(size_t(space.grid_view().indexSet().size(0)), blocks.size());
+  size_t num_dofs = 0;
+  for (const auto& block : blocks)
+    num_dofs += block.size();
+  EXPECT_EQ(space.mapper().size(), num_dofs);
+  const auto& matrix = op->matrix();
+  const auto solver = block_jacobi_assembler.preconditioner< VectorType >(matrix, true);
+  VectorType rhs(matrix.rows(), 1.0);
+  VectorType expected(matrix.rows(), 0.0);
+  Stuff::LA::Solver< MatrixType >(matrix).apply(rhs, expected);
+  VectorType solution(matrix.rows(), 0.0);
+  auto opts = solver.options("cg.block_jacobi");
+  opts["precision"] = "1e-12";
+  solver.apply(rhs, solution, opts);
+  EXPECT_LE((solution - expected).sup_norm(), 1e-6);
+} // TEST(BlockJacobiAssembler, captures_entity_blocks_during_swipdg_assembly)
+
+#else // HAVE_DUNE_FEM && HAVE_EIGEN
+
+TEST(DISABLED_BlockJacobiAssembler, captures_entity_blocks_during_swipdg_assembly) {}
+
+#endif // HAVE_DUNE_FEM && HAVE_EIGEN
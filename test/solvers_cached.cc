@@ -0,0 +1,130 @@
+// This file is part of the dune-gdt project:
+//   http://users.dune-project.org/projects/dune-gdt
+// Copyright holders: Felix Schindler
+// License: BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+
+// This one has to come first (includes the config.h)!
+#include <dune/stuff/test/main.hxx>
+
+#include <thread>
+#include <vector>
+
+#include <dune/stuff/la/container.hh>
+#include <dune/stuff/la/solver.hh>
+
+#include <dune/gdt/solvers/cached.hh>
+
+using namespace Dune;
+using namespace GDT;
+
+
+template< class ContainerPair >
+struct CachedLinearSolverTest
+  : public ::testing::Test
+{
+  typedef typename ContainerPair::first_type  MatrixType;
+  typedef typename ContainerPair::second_type VectorType;
+  static const size_t size = 100;
+
+  // the (symmetric positive definite) finite difference laplacian in 1d
+  static MatrixType create_matrix()
+  {
+    Stuff::LA::SparsityPatternDefault pattern(size);
+    for (size_t ii = 0; ii < size; ++ii) {
+      if (ii > 0)
+        pattern.inner(ii).push_back(ii - 1);
+      pattern.inner(ii).push_back(ii);
+      if (ii < size - 1)
+        pattern.inner(ii).push_back(ii + 1);
+    }
+    MatrixType matrix(size, size, pattern);
+    for (size_t ii = 0; ii < size; ++ii) {
+      if (ii > 0)
+        matrix.set_entry(ii, ii - 1, -1.0);
+      matrix.set_entry(ii, ii, 2.0);
+      if (ii < size - 1)
+        matrix.set_entry(ii, ii + 1, -1.0);
+    }
+    return matrix;
+  } // ... create_matrix(...)
+
+  static VectorType create_rhs(const double factor)
+  {
+    VectorType rhs(size, 0.0);
+    for (size_t ii = 0; ii < size; ++ii)
+      rhs.set_entry(ii, factor*(ii % 7) + 1.0);
+    return rhs;
+  }
+
+  static void produces_same_results_as_stuff_solver()
+  {
+    typedef Solvers::CachedLinearSolver< MatrixType > SolverType;
+    const auto matrix = create_matrix();
+    const SolverType cached_solver(matrix);
+    for (const auto& type : SolverType::types()) {
+      auto opts = SolverType::options(type);
+      opts["precision"] = "1e-12";
+      // solve repeatedly to make use of the cached setup
+      for (const double factor : {1.0, -2.0, 0.5}) {
+        const auto rhs = create_rhs(factor);
+        VectorType expected(size, 0.0);
+        Stuff::LA::Solver< MatrixType >(matrix).apply(rhs, expected, opts);
+        VectorType solution(size, 0.0);
+        cached_solver.apply(rhs, solution, opts);
+        EXPECT_LE((solution - expected).sup_norm(), 1e-8) << "type: " << type;
+      }
+    }
+  } // ... produces_same_results_as_stuff_solver(...)
+
+  static void supports_concurrent_applies()
+  {
+    typedef Solvers::CachedLinearSolver< MatrixType > SolverType;
+    const auto matrix = create_matrix();
+    const SolverType cached_solver(matrix);
+    const size_t num_threads = 4;
+    for (const auto& type : SolverType::types()) {
+      if (!SolverType::caches(type))
+        continue;
+      auto opts = SolverType::options(type);
+      opts["precision"] = "1e-12";
+      std::vector< VectorType > expected;
+      for (size_t tt = 0; tt < num_threads; ++tt) {
+        expected.emplace_back(size, 0.0);
+        Stuff::LA::Solver< MatrixType >(matrix).apply(create_rhs(tt + 1.0), expected[tt], opts);
+      }
+      // the solvers keep state during a solve, which must not be shared between the threads
+      std::vector< VectorType > solutions(num_threads, VectorType(size, 0.0));
+      std::vector< std::thread > threads;
+      for (size_t tt = 0; tt < num_threads; ++tt)
+        threads.emplace_back([&, tt]() {
+          for (size_t ii = 0; ii < 10; ++ii)
+            cached_solver.apply(create_rhs(tt + 1.0), solutions[tt], opts);
+        });
+      for (auto& thread : threads)
+        thread.join();
+      for (size_t tt = 0; tt < num_threads; ++tt)
+        EXPECT_LE((solutions[tt] - expected[tt]).sup_norm(), 1e-8) << "type: " << type << ", thread: " << tt;
+    }
+  } // ... supports_concurrent_applies(...)
+}; // struct CachedLinearSolverTest
+
+
+typedef testing::Types<
+                        std::pair< Stuff::LA::CommonDenseMatrix< double >, Stuff::LA::CommonDenseVector< double > >
+#if HAVE_EIGEN
+                      , std::pair< Stuff::LA::EigenRowMajorSparseMatrix< double >,
+                                   Stuff::LA::EigenDenseVector< double > >
+#endif
+#if HAVE_DUNE_ISTL
+                      , std::pair< Stuff::LA::IstlRowMajorSparseMatrix< double >,
+                                   Stuff::LA::IstlDenseVector< double > >
+#endif
+                      > ContainerTypes;
+
+TYPED_TEST_CASE(CachedLinearSolverTest, ContainerTypes);
+TYPED_TEST(CachedLinearSolverTest, produces_same_results_as_stuff_solver) {
+  this->produces_same_results_as_stuff_solver();
+}
+TYPED_TEST(CachedLinearSolverTest, supports_concurrent_applies) {
+  this->supports_concurrent_applies();
+}
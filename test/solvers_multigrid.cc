@@ -0,0 +1,296 @@
+// This file is part of the dune-gdt project:
+//   http://users.dune-project.org/projects/dune-gdt
+// Copyright holders: Felix Schindler
+// License: BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+
+// This one has to come first (includes the config.h)!
+#include <dune/stuff/test/main.hxx>
+
+#include <dune/stuff/la/container.hh>
+#include <dune/stuff/la/solver.hh>
+
+#include <dune/gdt/solvers/multigrid.hh>
+
+using namespace Dune;
+using namespace GDT;
+
+
+template< class ContainerPair >
+struct MultigridTest
+  : public ::testing::Test
+{
+  typedef typename ContainerPair::first_type  MatrixType;
+  typedef typename ContainerPair::second_type VectorType;
+  static const size_t num_levels = 5;
+
+  static size_t size(const size_t level)
+  {
+    return (size_t(4) << level) + 1;
+  }
+
+  // the finite difference laplacian in 1d with unit rows for the dirichlet boundary, as assembled by the
+  // discretizations
+  static MatrixType create_system_matrix(const size_t level)
+  {
+    const size_t sz = size(level);
+    Stuff::LA::SparsityPatternDefault pattern(sz);
+    for (size_t ii = 0; ii < sz; ++ii) {
+      if (ii > 0)
+        pattern.inner(ii).push_back(ii - 1);
+      pattern.inner(ii).push_back(ii);
+      if (ii < sz - 1)
+        pattern.inner(ii).push_back(ii + 1);
+    }
+    MatrixType matrix(sz, sz, pattern);
+    matrix.set_entry(0, 0, 1.0);
+    matrix.set_entry(sz - 1, sz - 1, 1.0);
+    for (size_t ii = 1; ii < sz - 1; ++ii) {
+      matrix.set_entry(ii, ii - 1, -1.0);
+      matrix.set_entry(ii, ii, 2.0);
+      matrix.set_entry(ii, ii + 1, -1.0);
+    }
+    return matrix;
+  } // ... create_system_matrix(...)
+
+  // linear interpolation from level - 1 to level, as assembled by LagrangeProlongation for P1 elements
+  static MatrixType create_prolongation(const size_t level)
+  {
+    const size_t rows = size(level);
+    const size_t cols = size(level - 1);
+    Stuff::LA::SparsityPatternDefault pattern(rows);
+    for (size_t ii = 0; ii < rows; ++ii) {
+      pattern.inner(ii).push_back(ii / 2);
+      if (ii % 2 == 1)
+        pattern.inner(ii).push_back(ii / 2 + 1);
+    }
+    MatrixType prolongation(rows, cols, pattern);
+    for (size_t ii = 0; ii < rows; ++ii) {
+      if (ii % 2 == 0)
+        prolongation.set_entry(ii, ii / 2, 1.0);
+      else {
+        prolongation.set_entry(ii, ii / 2, 0.5);
+        prolongation.set_entry(ii, ii / 2 + 1, 0.5);
+      }
+    }
+    return prolongation;
+  } // ... create_prolongation(...)
+
+  static void solves_like_stuff_solver(const std::string smoother, const bool use_tbb)
+  {
+    typedef Solvers::Multigrid< MatrixType, VectorType > SolverType;
+    std::vector< MatrixType > system_matrices;
+    std::vector< MatrixType > prolongations;
+    for (size_t ll = 0; ll < num_levels; ++ll) {
+      system_matrices.emplace_back(create_system_matrix(ll));
+      if (ll > 0)
+        prolongations.emplace_back(create_prolongation(ll));
+    }
+    const SolverType multigrid(system_matrices, prolongations, use_tbb);
+    EXPECT_EQ(num_levels, multigrid.num_levels());
+    const size_t sz = size(num_levels - 1);
+    // homogeneous boundary values, as for the rhs_vector() of a discretization with a dirichlet shift
+    VectorType rhs(sz, 0.0);
+    for (size_t ii = 1; ii < sz - 1; ++ii)
+      rhs.set_entry(ii, 1.0 + (ii % 3));
+    VectorType expected(sz, 0.0);
+    Stuff::LA::Solver< MatrixType >(system_matrices.back()).apply(rhs, expected);
+    for (const auto& type : SolverType::types()) {
+      auto opts = SolverType::options(type);
+      opts["smoother"] = smoother;
+      opts["precision"] = "1e-12";
+      VectorType solution(sz, 0.0);
+      multigrid.apply(rhs, solution, opts);
+      EXPECT_LE((solution - expected).sup_norm(), 1e-8) << "type: " << type << ", smoother: " << smoother;
+      // the convergence rate has to be independent of the number of levels
+      EXPECT_LE(multigrid.iterations(), size_t(50)) << "type: " << type << ", smoother: " << smoother;
+    }
+  } // ... solves_like_stuff_solver(...)
+}; // struct MultigridTest
+
+
+typedef testing::Types<
+                        std::pair< Stuff::LA::CommonDenseMatrix< double >, Stuff::LA::CommonDenseVector< double > >
+#if HAVE_EIGEN
+                      , std::pair< Stuff::LA::EigenRowMajorSparseMatrix< double >,
+                                   Stuff::LA::EigenDenseVector< double > >
+#endif
+#if HAVE_DUNE_ISTL
+                      , std::pair< Stuff::LA::IstlRowMajorSparseMatrix< double >,
+                                   Stuff::LA::IstlDenseVector< double > >
+#endif
+                      > ContainerTypes;
+
+TYPED_TEST_CASE(MultigridTest, ContainerTypes);
+TYPED_TEST(MultigridTest, solves_like_stuff_solver_with_gauss_seidel) {
+  this->solves_like_stuff_solver("gauss_seidel", false);
+}
+TYPED_TEST(MultigridTest, solves_like_stuff_solver_with_jacobi) {
+  this->solves_like_stuff_solver("jacobi", false);
+}
+TYPED_TEST(MultigridTest, solves_like_stuff_solver_with_jacobi_in_parallel) {
+  this->solves_like_stuff_solver("jacobi", true);
+}
+
+
+#if HAVE_DUNE_FEM && HAVE_EIGEN
+
+# include <dune/grid/sgrid.hh>
+
+# include <dune/stuff/functions/constant.hh>
+# include <dune/stuff/grid/boundaryinfo.hh>
+# include <dune/stuff/grid/provider/cube.hh>
+
+# include <dune/gdt/assembler/local/codim0.hh>
+# include <dune/gdt/assembler/system.hh>
+# include <dune/gdt/discretefunction/default.hh>
+# include <dune/gdt/localevaluation/elliptic.hh>
+# include <dune/gdt/localoperator/codim0.hh>
+# include <dune/gdt/operators/prolongations.hh>
+# include <dune/gdt/spaces/cg.hh>
+# include <dune/gdt/spaces/constraints.hh>
+# include <dune/gdt/spaces/dg.hh>
+
+
+struct AssembledProlongationTest
+  : public ::testing::Test
+{
+  static const size_t d = 2;
+  static const int num_levels = 3;
+  typedef SGrid< d, d >                                  GridType;
+  typedef GridType::template Codim< 0 >::Entity          E;
+  typedef GridType::ctype                                D;
+  typedef double                                         R;
+  typedef Stuff::LA::EigenRowMajorSparseMatrix< R >      MatrixType;
+  typedef Stuff::LA::EigenDenseVector< R >               VectorType;
+  typedef Stuff::Functions::Constant< E, D, d, R, 1 >    ScalarFunctionType;
+  typedef Spaces::CGProvider< GridType, Stuff::Grid::ChooseLayer::level, ChooseSpaceBackend::fem, 1, R, 1 > CG;
+  typedef Spaces::DGProvider< GridType, Stuff::Grid::ChooseLayer::level, ChooseSpaceBackend::fem, 1, R, 1 > DG;
+
+  AssembledProlongationTest()
+    : grid_provider_(Stuff::Grid::Providers::Cube< GridType >::create())
+  {
+    grid_provider_->grid().globalRefine(num_levels - 1);
+  }
+
+  static VectorType create_vector(const size_t size)
+  {
+    VectorType vector(size, 0.0);
+    for (size_t ii = 0; ii < size; ++ii)
+      vector.set_entry(ii, 1.0 + (ii % 7));
+    return vector;
+  }
+
+  // the matrix has to reproduce the prolongation operator applied to the discrete function of the coarse DoFs
+  template< class ProlongationType, class CoarseSpaceType, class FineSpaceType >
+  static void matches_operator(const CoarseSpaceType& coarse_space, const FineSpaceType& fine_space)
+  {
+    const ProlongationType prolongation(fine_space.grid_view());
+    const auto coarse_vector = create_vector(coarse_space.mapper().size());
+    const ConstDiscreteFunction< CoarseSpaceType, VectorType > coarse_function(coarse_space, coarse_vector);
+    VectorType expected(fine_space.mapper().size(), 0.0);
+    DiscreteFunction< FineSpaceType, VectorType > fine_function(fine_space, expected);
+    prolongation.apply(coarse_function, fine_function);
+    const auto matrix = prolongation.template assemble_matrix< MatrixType >(coarse_space, fine_space);
+    ASSERT_EQ(fine_space.mapper().size(), matrix.rows());
+    ASSERT_EQ(coarse_space.mapper().size(), matrix.cols());
+    VectorType result(fine_space.mapper().size(), 0.0);
+    matrix.mv(coarse_vector, result);
+    EXPECT_LE((result - expected).sup_norm(), 1e-12);
+  } // ... matches_operator(...)
+
+  // the laplacian with unit rows for the dirichlet DoFs, assembled on the level of space, the dirichlet DoFs of rhs
+  // are cleared
+  static MatrixType assemble_laplacian(const CG::Type& space, VectorType& rhs)
+  {
+    typedef CG::Type::GridViewType::Intersection IntersectionType;
+    typedef LocalOperator::Codim0Integral< LocalEvaluation::Elliptic< ScalarFunctionType > > LocalOperatorType;
+    const ScalarFunctionType one(1);
+    const LocalOperatorType local_operator(one);
+    const LocalAssembler::Codim0Matrix< LocalOperatorType > local_assembler(local_operator);
+    auto boundary_info = Stuff::Grid::BoundaryInfos::AllDirichlet< IntersectionType >::create();
+    Spaces::DirichletConstraints< IntersectionType > constraints(*boundary_info, space.mapper().size(), true);
+    MatrixType matrix(space.mapper().size(), space.mapper().size(), space.compute_volume_pattern());
+    SystemAssembler< CG::Type > assembler(space);
+    assembler.add(local_assembler, matrix);
+    assembler.add(constraints);
+    assembler.assemble();
+    constraints.apply(matrix, rhs);
+    return matrix;
+  } // ... assemble_laplacian(...)
+
+  std::unique_ptr< Stuff::Grid::Providers::Cube< GridType > > grid_provider_;
+}; // struct AssembledProlongationTest
+
+
+TEST_F(AssembledProlongationTest, lagrange_prolongation_matches_operator)
+{
+  for (int ll = 1; ll < num_levels; ++ll) {
+    const auto coarse_space = CG::create(*grid_provider_, ll - 1);
+    const auto fine_space = CG::create(*grid_provider_, ll);
+    matches_operator< Operators::LagrangeProlongation< CG::Type::GridViewType > >(coarse_space, fine_space);
+  }
+}
+
+TEST_F(AssembledProlongationTest, l2_prolongation_matches_operator)
+{
+  for (int ll = 1; ll < num_levels; ++ll) {
+    const auto coarse_space = DG::create(*grid_provider_, ll - 1);
+    const auto fine_space = DG::create(*grid_provider_, ll);
+    matches_operator< Operators::L2Prolongation< DG::Type::GridViewType > >(coarse_space, fine_space);
+  }
+}
+
+TEST_F(AssembledProlongationTest, l2_prolongation_requires_local_fine_dofs)
+{
+  const auto coarse_space = DG::create(*grid_provider_, 0);
+  const auto fine_space = CG::create(*grid_provider_, 1);
+  const Operators::L2Prolongation< CG::Type::GridViewType > prolongation(fine_space.grid_view());
+  EXPECT_THROW(prolongation.assemble_matrix< MatrixType >(coarse_space, fine_space),
+               Stuff::Exceptions::you_are_using_this_wrong);
+}
+
+TEST_F(AssembledProlongationTest, multigrid_solves_assembled_hierarchy)
+{
+  typedef Solvers::Multigrid< MatrixType, VectorType > SolverType;
+  std::vector< MatrixType > system_matrices;
+  std::vector< MatrixType > prolongations;
+  // only the rhs of the finest level is kept
+  VectorType rhs;
+  for (int ll = 0; ll < num_levels; ++ll) {
+    const auto space = CG::create(*grid_provider_, ll);
+    rhs = create_vector(space.mapper().size());
+    system_matrices.emplace_back(assemble_laplacian(space, rhs));
+    if (ll > 0) {
+      const auto coarse_space = CG::create(*grid_provider_, ll - 1);
+      prolongations.emplace_back(Operators::LagrangeProlongation< CG::Type::GridViewType >(space.grid_view())
+                                   .assemble_matrix< MatrixType >(coarse_space, space));
+    }
+  }
+  const auto& system_matrix = system_matrices.back();
+  VectorType expected(system_matrix.rows(), 0.0);
+  Stuff::LA::Solver< MatrixType >(system_matrix).apply(rhs, expected);
+  for (const bool use_tbb : {false, true}) {
+    const SolverType multigrid(system_matrices, prolongations, use_tbb);
+    EXPECT_EQ(size_t(num_levels), multigrid.num_levels());
+    for (const auto& type : SolverType::types()) {
+      auto opts = SolverType::options(type);
+      opts["smoother"] = use_tbb ? "jacobi" : "gauss_seidel";
+      opts["precision"] = "1e-12";
+      VectorType solution(system_matrix.rows(), 0.0);
+      multigrid.apply(rhs, solution, opts);
+      EXPECT_LE((solution - expected).sup_norm(), 1e-8) << "type: " << type << ", use_tbb: " << use_tbb;
+    }
+  }
+}
+
+
+#else // HAVE_DUNE_FEM && HAVE_EIGEN
+
+
+TEST(DISABLED_AssembledProlongationTest, lagrange_prolongation_matches_operator) {}
+TEST(DISABLED_AssembledProlongationTest, l2_prolongation_matches_operator) {}
+TEST(DISABLED_AssembledProlongationTest, l2_prolongation_requires_local_fine_dofs) {}
+TEST(DISABLED_AssembledProlongationTest, multigrid_solves_assembled_hierarchy) {}
+
+
+#endif // HAVE_DUNE_FEM && HAVE_EIGEN
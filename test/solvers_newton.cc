@@ -0,0 +1,122 @@
+// This file is part of the dune-gdt project:
+//   http://users.dune-project.org/projects/dune-gdt
+// Copyright holders: Felix Schindler
+// License: BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+
+// This one has to come first (includes the config.h)!
+#include <dune/stuff/test/main.hxx>
+
+#if HAVE_DUNE_FEM && HAVE_EIGEN
+# include <dune/grid/sgrid.hh>
+
+# include <dune/stuff/functions/constant.hh>
+# include <dune/stuff/grid/boundaryinfo.hh>
+# include <dune/stuff/grid/provider/cube.hh>
+# include <dune/stuff/la/container.hh>
+
+# include <dune/gdt/localevaluation/nonlinear-elliptic.hh>
+# include <dune/gdt/operators/nonlinear-elliptic.hh>
+# include <dune/gdt/solvers/newton.hh>
+# include <dune/gdt/spaces/cg.hh>
+#endif // HAVE_DUNE_FEM && HAVE_EIGEN
+
+using namespace Dune;
+using namespace GDT;
+
+
+#if HAVE_DUNE_FEM && HAVE_EIGEN
+
+/**
+ * The regularized p-Laplace problem -div((0.01 + |grad u|^2)^(1/2) grad u) = 1 with homogeneous Dirichlet values.
+ */
+struct NewtonTest
+  : public ::testing::Test
+{
+  static const size_t d = 2;
+  typedef SGrid< d, d >                                   GridType;
+  typedef GridType::template Codim< 0 >::Entity           E;
+  typedef GridType::ctype                                 D;
+  typedef double                                          R;
+  typedef Stuff::LA::EigenRowMajorSparseMatrix< R >       MatrixType;
+  typedef Stuff::LA::EigenDenseVector< R >                VectorType;
+  typedef Stuff::Functions::Constant< E, D, d, R, 1 >     FunctionType;
+  typedef Spaces::CGProvider< GridType, Stuff::Grid::ChooseLayer::leaf, ChooseSpaceBackend::fem, 1, R, 1 >
+      SpaceProvider;
+  typedef SpaceProvider::Type                             SpaceType;
+  typedef SpaceType::GridViewType::Intersection           IntersectionType;
+  typedef LocalEvaluation::PLaplaceCoefficient< R, d >    CoefficientType;
+  typedef Operators::NonlinearElliptic< CoefficientType, FunctionType, SpaceType, MatrixType, VectorType >
+      OperatorType;
+  typedef Solvers::Newton< MatrixType, VectorType >       NewtonType;
+
+  NewtonTest()
+    : grid_provider_(Stuff::Grid::Providers::Cube< GridType >::create())
+    , space_(SpaceProvider::create(*grid_provider_))
+    , boundary_info_(Stuff::Grid::BoundaryInfos::AllDirichlet< IntersectionType >::create())
+    , coefficient_(3, 0.1)
+    , one_(1)
+    , operator_(coefficient_, one_, *boundary_info_, space_)
+    , newton_([&](const VectorType& iterate, VectorType& residual, MatrixType* jacobian) {
+                operator_.assemble(iterate, residual, jacobian);
+              },
+              operator_.create_jacobian())
+  {}
+
+  VectorType solve(const Stuff::Common::Configuration& opts) const
+  {
+    auto solution = operator_.create_vector();
+    newton_.apply(solution, opts);
+    auto residual = operator_.create_vector();
+    operator_.assemble(solution, residual, nullptr);
+    const auto type = opts.get< std::string >("type");
+    EXPECT_LE(residual.l2_norm(), 1e-8) << "type: " << type;
+    // one walk per iteration, plus one for each jacobian which is discarded early
+    EXPECT_GE(newton_.num_residual_assemblies(), newton_.iterations() + 1) << "type: " << type;
+    return solution;
+  } // ... solve(...)
+
+  std::unique_ptr< Stuff::Grid::Providers::Cube< GridType > > grid_provider_;
+  const SpaceType space_;
+  std::unique_ptr< Stuff::Grid::BoundaryInfoInterface< IntersectionType > > boundary_info_;
+  const CoefficientType coefficient_;
+  const FunctionType one_;
+  const OperatorType operator_;
+  const NewtonType newton_;
+}; // struct NewtonTest
+
+
+TEST_F(NewtonTest, full_newton_converges)
+{
+  const auto solution = solve(NewtonType::options("newton"));
+  EXPECT_GT(solution.sup_norm(), 0.0);
+  EXPECT_LE(newton_.iterations(), size_t(15));
+  EXPECT_EQ(newton_.iterations() + 1, newton_.num_jacobian_assemblies());
+} // TEST_F(NewtonTest, full_newton_converges)
+
+
+TEST_F(NewtonTest, reuses_jacobians)
+{
+  const auto expected = solve(NewtonType::options("newton"));
+  const size_t full_newton_jacobian_assemblies = newton_.num_jacobian_assemblies();
+  auto opts = NewtonType::options("newton");
+  opts["max_jacobian_age"] = "3";
+  const auto solution = solve(opts);
+  EXPECT_LE((solution - expected).sup_norm(), 1e-8);
+  EXPECT_LT(newton_.num_jacobian_assemblies(), full_newton_jacobian_assemblies);
+} // TEST_F(NewtonTest, reuses_jacobians)
+
+
+TEST_F(NewtonTest, eisenstat_walker_converges)
+{
+  const auto expected = solve(NewtonType::options("newton"));
+  const auto solution = solve(NewtonType::options("newton.eisenstat_walker"));
+  EXPECT_LE((solution - expected).sup_norm(), 1e-8);
+} // TEST_F(NewtonTest, eisenstat_walker_converges)
+
+#else // HAVE_DUNE_FEM && HAVE_EIGEN
+
+TEST(DISABLED_NewtonTest, full_newton_converges) {}
+TEST(DISABLED_NewtonTest, reuses_jacobians) {}
+TEST(DISABLED_NewtonTest, eisenstat_walker_converges) {}
+
+#endif // HAVE_DUNE_FEM && HAVE_EIGEN
@@ -0,0 +1,137 @@
+// This file is part of the dune-gdt project:
+//   http://users.dune-project.org/projects/dune-gdt
+// Copyright holders: Felix Schindler
+// License: BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+
+// This one has to come first (includes the config.h)!
+#include <dune/stuff/test/main.hxx>
+
+#if HAVE_DUNE_FEM && HAVE_EIGEN
+
+#include <dune/grid/sgrid.hh>
+
+#include <dune/stuff/functions/constant.hh>
+#include <dune/stuff/grid/boundaryinfo.hh>
+#include <dune/stuff/grid/provider/cube.hh>
+#include <dune/stuff/la/container.hh>
+#include <dune/stuff/la/solver.hh>
+
+#include <dune/gdt/playground/operators/elliptic-swipdg.hh>
+#include <dune/gdt/solvers/p-multigrid.hh>
+#include <dune/gdt/spaces/cg.hh>
+#include <dune/gdt/spaces/dg.hh>
+
+using namespace Dune;
+using namespace GDT;
+
+
+struct PMultigridTest
+  : public ::testing::Test
+{
+  static const size_t d = 2;
+  typedef SGrid< d, d >                                  GridType;
+  typedef GridType::template Codim< 0 >::Entity          E;
+  typedef GridType::ctype                                D;
+  typedef double                                         R;
+  typedef Stuff::LA::EigenRowMajorSparseMatrix< R >      MatrixType;
+  typedef Stuff::LA::EigenDenseVector< R >               VectorType;
+  typedef Stuff::Functions::Constant< E, D, d, R, 1 >    ScalarFunctionType;
+  typedef Stuff::Functions::Constant< E, D, d, R, d, d > TensorFunctionType;
+
+  template< int p >
+  struct DG
+  {
+    typedef Spaces::DGProvider< GridType, Stuff::Grid::ChooseLayer::leaf, ChooseSpaceBackend::fem, p, R, 1 > Type;
+  };
+
+  typedef Spaces::CGProvider< GridType, Stuff::Grid::ChooseLayer::leaf, ChooseSpaceBackend::fem, 1, R, 1 > CG;
+
+  PMultigridTest()
+    : grid_provider_(Stuff::Grid::Providers::Cube< GridType >::create())
+    , cg_1_(CG::create(*grid_provider_))
+    , dg_1_(DG< 1 >::Type::create(*grid_provider_))
+    , dg_2_(DG< 2 >::Type::create(*grid_provider_))
+    , dg_3_(DG< 3 >::Type::create(*grid_provider_))
+  {}
+
+  template< class SpaceType >
+  static MatrixType assemble_swipdg(const SpaceType& space)
+  {
+    typedef typename SpaceType::GridViewType GridViewType;
+    auto boundary_info = Stuff::Grid::BoundaryInfos::AllDirichlet< typename GridViewType::Intersection >::create();
+    const ScalarFunctionType one(1);
+    const TensorFunctionType identity(Stuff::Functions::internal::unit_matrix< R, d >());
+    auto op = Operators::make_elliptic_swipdg(one, identity, *boundary_info, MatrixType(), space);
+    op->assemble();
+    return op->matrix().copy();
+  } // ... assemble_swipdg(...)
+
+  static VectorType create_rhs(const size_t size)
+  {
+    VectorType rhs(size, 0.0);
+    for (size_t ii = 0; ii < size; ++ii)
+      rhs.set_entry(ii, 1.0 + (ii % 5));
+    return rhs;
+  }
+
+  std::shared_ptr< Stuff::Grid::Providers::Cube< GridType > > grid_provider_;
+  const CG::Type cg_1_;
+  const DG< 1 >::Type::Type dg_1_;
+  const DG< 2 >::Type::Type dg_2_;
+  const DG< 3 >::Type::Type dg_3_;
+}; // struct PMultigridTest
+
+
+TEST_F(PMultigridTest, entity_blocks_cover_dg_spaces_only)
+{
+  const auto dg_blocks = Solvers::entity_blocks(dg_3_);
+  size_t num_dofs = 0;
+  for (const auto& block : dg_blocks)
+    num_dofs += block.size();
+  EXPECT_EQ(dg_3_.mapper().size(), num_dofs);
+  EXPECT_TRUE(Solvers::entity_blocks(cg_1_).empty());
+}
+
+TEST_F(PMultigridTest, galerkin_hierarchy_is_symmetric)
+{
+  const auto system_matrix = assemble_swipdg(dg_2_);
+  const auto prolongation = Operators::L2Prolongation< typename DG< 2 >::Type::Type::GridViewType >(dg_2_.grid_view())
+                              .assemble_matrix< MatrixType >(dg_1_, dg_2_);
+  const auto matrices = Solvers::PMultigrid< MatrixType, VectorType >::galerkin_hierarchy(system_matrix,
+                                                                                         {prolongation});
+  ASSERT_EQ(size_t(2), matrices.size());
+  const auto& coarse_matrix = matrices[0];
+  ASSERT_EQ(dg_1_.mapper().size(), coarse_matrix.rows());
+  for (size_t ii = 0; ii < coarse_matrix.rows(); ++ii)
+    for (size_t jj = 0; jj < coarse_matrix.cols(); ++jj)
+      EXPECT_NEAR(coarse_matrix.get_entry(ii, jj), coarse_matrix.get_entry(jj, ii), 1e-10);
+}
+
+TEST_F(PMultigridTest, solves_swipdg_system)
+{
+  typedef Solvers::PMultigrid< MatrixType, VectorType > SolverType;
+  const auto system_matrix = assemble_swipdg(dg_3_);
+  const auto rhs = create_rhs(system_matrix.rows());
+  VectorType expected(system_matrix.rows(), 0.0);
+  Stuff::LA::Solver< MatrixType >(system_matrix).apply(rhs, expected);
+  for (const bool use_tbb : {false, true}) {
+    const auto multigrid = Solvers::make_p_multigrid< VectorType >(system_matrix, use_tbb, cg_1_, dg_1_, dg_2_, dg_3_);
+    EXPECT_EQ(size_t(4), multigrid.num_levels());
+    for (const auto& type : {"cg.multigrid", "bicgstab.multigrid"}) {
+      auto opts = SolverType::options(type);
+      opts["precision"] = "1e-12";
+      VectorType solution(system_matrix.rows(), 0.0);
+      multigrid.apply(rhs, solution, opts);
+      EXPECT_LE((solution - expected).sup_norm(), 1e-6) << "type: " << type;
+      EXPECT_LE(multigrid.iterations(), size_t(100)) << "type: " << type;
+    }
+  }
+} // TEST_F(PMultigridTest, solves_swipdg_system)
+
+#else // HAVE_DUNE_FEM && HAVE_EIGEN
+
+TEST(DISABLED_PMultigridTest, entity_blocks_cover_dg_spaces_only) {}
+TEST(DISABLED_PMultigridTest, galerkin_hierarchy_is_symmetric) {}
+TEST(DISABLED_PMultigridTest, solves_swipdg_system) {}
+
+#endif // HAVE_DUNE_FEM && HAVE_EIGEN
@@ -0,0 +1,139 @@
+// This file is part of the dune-gdt project:
+//   http://users.dune-project.org/projects/dune-gdt
+// Copyright holders: Felix Schindler
+// License: BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+
+// This one has to come first (includes the config.h)!
+#include <dune/stuff/test/main.hxx>
+
+#include <dune/stuff/la/container.hh>
+#include <dune/stuff/la/solver.hh>
+
+#include <dune/gdt/solvers/schwarz.hh>
+
+using namespace Dune;
+using namespace GDT;
+
+
+template< class ContainerPair >
+struct SchwarzTest
+  : public ::testing::Test
+{
+  typedef typename ContainerPair::first_type  MatrixType;
+  typedef typename ContainerPair::second_type VectorType;
+  typedef Solvers::Schwarz< MatrixType, VectorType > SolverType;
+  static const size_t size = 100;
+  static const size_t num_subdomains = 8;
+
+  // the (symmetric positive definite) finite difference laplacian in 1d
+  static MatrixType create_matrix()
+  {
+    Stuff::LA::SparsityPatternDefault pattern(size);
+    for (size_t ii = 0; ii < size; ++ii) {
+      if (ii > 0)
+        pattern.inner(ii).push_back(ii - 1);
+      pattern.inner(ii).push_back(ii);
+      if (ii < size - 1)
+        pattern.inner(ii).push_back(ii + 1);
+    }
+    MatrixType matrix(size, size, pattern);
+    for (size_t ii = 0; ii < size; ++ii) {
+      if (ii > 0)
+        matrix.set_entry(ii, ii - 1, -1.0);
+      matrix.set_entry(ii, ii, 2.0);
+      if (ii < size - 1)
+        matrix.set_entry(ii, ii + 1, -1.0);
+    }
+    return matrix;
+  } // ... create_matrix(...)
+
+  // contiguous subdomains (as given by a block space), the last DoFs are left to the pointwise treatment
+  static typename SolverType::BlocksType create_blocks()
+  {
+    typename SolverType::BlocksType blocks(num_subdomains);
+    for (size_t ss = 0; ss < num_subdomains; ++ss)
+      for (size_t ii = ss * (size / num_subdomains); ii < (ss + 1) * (size / num_subdomains); ++ii)
+        blocks[ss].push_back(ii);
+    return blocks;
+  }
+
+  static VectorType create_rhs()
+  {
+    VectorType rhs(size, 0.0);
+    for (size_t ii = 0; ii < size; ++ii)
+      rhs.set_entry(ii, (ii % 7) + 1.0);
+    return rhs;
+  }
+
+  static void extends_subdomains_by_overlap()
+  {
+    const auto matrix = create_matrix();
+    const size_t block_size = size / num_subdomains;
+    for (size_t overlap : {0, 1, 2}) {
+      const SolverType solver(matrix, create_blocks(), overlap);
+      EXPECT_EQ(size_t(num_subdomains), solver.num_subdomains());
+      EXPECT_EQ(block_size + overlap, solver.subdomain_size(0));
+      EXPECT_EQ(block_size + 2 * overlap, solver.subdomain_size(1));
+    }
+  } // ... extends_subdomains_by_overlap(...)
+
+  static void produces_same_results_as_stuff_solver(const bool use_tbb)
+  {
+    const auto matrix = create_matrix();
+    const auto rhs = create_rhs();
+    VectorType expected(size, 0.0);
+    Stuff::LA::Solver< MatrixType >(matrix).apply(rhs, expected);
+    for (size_t overlap : {0, 2}) {
+      const SolverType solver(matrix, create_blocks(), overlap, use_tbb);
+      for (const auto& type : SolverType::types()) {
+        auto opts = SolverType::options(type);
+        opts["precision"] = "1e-12";
+        VectorType solution(size, 0.0);
+        solver.apply(rhs, solution, opts);
+        EXPECT_LE((solution - expected).sup_norm(), 1e-8) << "type: " << type << ", overlap: " << overlap;
+      }
+    }
+  } // ... produces_same_results_as_stuff_solver(...)
+
+  static void overlap_reduces_iterations()
+  {
+    const auto matrix = create_matrix();
+    const auto rhs = create_rhs();
+    const SolverType block_jacobi(matrix, create_blocks(), 0);
+    const SolverType schwarz(matrix, create_blocks(), 4);
+    for (const auto& type : SolverType::types()) {
+      VectorType solution(size, 0.0);
+      block_jacobi.apply(rhs, solution, type);
+      solution *= 0.0;
+      schwarz.apply(rhs, solution, type);
+      EXPECT_LT(schwarz.iterations(), block_jacobi.iterations()) << "type: " << type;
+    }
+  } // ... overlap_reduces_iterations(...)
+}; // struct SchwarzTest
+
+
+typedef testing::Types<
+                        std::pair< Stuff::LA::CommonDenseMatrix< double >, Stuff::LA::CommonDenseVector< double > >
+#if HAVE_EIGEN
+                      , std::pair< Stuff::LA::EigenRowMajorSparseMatrix< double >,
+                                   Stuff::LA::EigenDenseVector< double > >
+#endif
+#if HAVE_DUNE_ISTL
+                      , std::pair< Stuff::LA::IstlRowMajorSparseMatrix< double >,
+                                   Stuff::LA::IstlDenseVector< double > >
+#endif
+                      > ContainerTypes;
+
+TYPED_TEST_CASE(SchwarzTest, ContainerTypes);
+TYPED_TEST(SchwarzTest, extends_subdomains_by_overlap) {
+  this->extends_subdomains_by_overlap();
+}
+TYPED_TEST(SchwarzTest, produces_same_results_as_stuff_solver) {
+  this->produces_same_results_as_stuff_solver(false);
+}
+TYPED_TEST(SchwarzTest, produces_same_results_as_stuff_solver_in_parallel) {
+  this->produces_same_results_as_stuff_solver(true);
+}
+TYPED_TEST(SchwarzTest, overlap_reduces_iterations) {
+  this->overlap_reduces_iterations();
+}
@@ -0,0 +1,115 @@
+// This file is part of the dune-gdt project:
+//   http://users.dune-project.org/projects/dune-gdt
+// Copyright holders: Felix Schindler
+// License: BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+
+// This one has to come first (includes the config.h)!
+#include <dune/stuff/test/main.hxx>
+
+#if HAVE_DUNE_GRID_MULTISCALE && HAVE_DUNE_FEM
+
+# include <memory>
+# include <vector>
+
+# include <dune/grid/sgrid.hh>
+
+# include <dune/grid/multiscale/provider/cube.hh>
+
+# include <dune/stuff/common/configuration.hh>
+# include <dune/stuff/common/ranges.hh>
+
+# include <dune/gdt/playground/spaces/block.hh>
+# include <dune/gdt/spaces/dg.hh>
+
+using namespace Dune;
+using namespace GDT;
+
+
+struct BlockMapperTest
+  : public ::testing::Test
+{
+  typedef SGrid< 2, 2 >                                       GridType;
+  typedef grid::Multiscale::Providers::Cube< GridType >       MsGridProviderType;
+  typedef Spaces::DGProvider< GridType, Stuff::Grid::ChooseLayer::local, ChooseSpaceBackend::fem, 1, double, 1 >
+      LocalSpaceProviderType;
+  typedef LocalSpaceProviderType::Type                        LocalSpaceType;
+  typedef Spaces::Block< LocalSpaceType >                     SpaceType;
+  typedef SpaceType::EntityType                               EntityType;
+
+  BlockMapperTest()
+    : ms_grid_provider_(MsGridProviderType::create(config()))
+  {
+    const auto& ms_grid = ms_grid_provider_->ms_grid();
+    for (size_t ss = 0; ss < ms_grid->size(); ++ss)
+      local_spaces_.emplace_back(new LocalSpaceType(LocalSpaceProviderType::create(*ms_grid_provider_, ss)));
+  }
+
+  static Stuff::Common::Configuration config()
+  {
+    auto cfg = MsGridProviderType::default_config();
+    cfg["lower_left"] = "[0 0]";
+    cfg["upper_right"] = "[1 1]";
+    cfg["num_elements"] = "[8 8]";
+    cfg["num_partitions"] = "[2 2]";
+    return cfg;
+  }
+
+  // the lookup of the subdomain in the map of the multiscale grid, as done by the mapper before
+  size_t block_of(const EntityType& entity) const
+  {
+    const auto& ms_grid = *ms_grid_provider_->ms_grid();
+    const auto result = ms_grid.entityToSubdomainMap()->find(ms_grid.globalGridView().indexSet().index(entity));
+    EXPECT_TRUE(result != ms_grid.entityToSubdomainMap()->end());
+    return result->second;
+  }
+
+  size_t global_start_index(const size_t block) const
+  {
+    size_t ret = 0;
+    for (size_t bb = 0; bb < block; ++bb)
+      ret += local_spaces_[bb]->mapper().size();
+    return ret;
+  }
+
+  std::unique_ptr< MsGridProviderType > ms_grid_provider_;
+  std::vector< std::shared_ptr< const LocalSpaceType > > local_spaces_;
+}; // struct BlockMapperTest
+
+
+TEST_F(BlockMapperTest, matches_lookup_in_the_entity_to_subdomain_map)
+{
+  const auto& ms_grid = ms_grid_provider_->ms_grid();
+  ASSERT_EQ(4, ms_grid->size());
+  const SpaceType space(ms_grid, local_spaces_);
+  const auto& mapper = space.mapper();
+  EXPECT_EQ(global_start_index(ms_grid->size()), mapper.size());
+  std::vector< size_t > hits(mapper.size(), 0);
+  Dune::DynamicVector< size_t > global_indices(mapper.maxNumDofs(), 0);
+  for (const auto& entity : DSC::entityRange(space.grid_view())) {
+    const size_t block = block_of(entity);
+    const auto& local_mapper = local_spaces_[block]->mapper();
+    EXPECT_EQ(block, mapper.blockOf(entity));
+    ASSERT_EQ(local_mapper.numDofs(entity), mapper.numDofs(entity));
+    mapper.globalIndices(entity, global_indices);
+    for (size_t ii = 0; ii < local_mapper.numDofs(entity); ++ii) {
+      const size_t expected = global_start_index(block) + local_mapper.mapToGlobal(entity, ii);
+      EXPECT_EQ(expected, mapper.mapToGlobal(entity, ii));
+      EXPECT_EQ(expected, global_indices[ii]);
+      EXPECT_EQ(expected, mapper.mapToGlobal(block, local_mapper.mapToGlobal(entity, ii)));
+      ASSERT_LT(expected, mapper.size());
+      ++hits[expected];
+    }
+  }
+  // the DoFs of a DG space belong to exactly one entity
+  for (size_t ii = 0; ii < hits.size(); ++ii)
+    EXPECT_EQ(1, hits[ii]) << ii;
+}
+
+
+#else // HAVE_DUNE_GRID_MULTISCALE && HAVE_DUNE_FEM
+
+
+TEST(DISABLED_BlockMapperTest, matches_lookup_in_the_entity_to_subdomain_map) {}
+
+
+#endif // HAVE_DUNE_GRID_MULTISCALE && HAVE_DUNE_FEM
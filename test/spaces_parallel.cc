@@ -0,0 +1,147 @@
+// This file is part of the dune-gdt project:
+//   http://users.dune-project.org/projects/dune-gdt
+// Copyright holders: Felix Schindler
+// License: BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+
+// This one has to come first (includes the config.h)!
+#include <dune/stuff/test/main.hxx>
+
+#include <dune/grid/yaspgrid.hh>
+
+#include <dune/stuff/grid/provider/cube.hh>
+#include <dune/stuff/la/container/common.hh>
+
+#include <dune/gdt/spaces/cg/pdelab.hh>
+#include <dune/gdt/spaces/fv/default.hh>
+#include <dune/gdt/spaces/parallel.hh>
+
+using namespace Dune;
+using namespace GDT;
+
+
+struct ParallelDofsTest
+  : public ::testing::Test
+{
+  typedef YaspGrid< 2 >                                   GridType;
+  typedef GridType::LeafGridView                          GridViewType;
+  typedef Spaces::FV::Default< GridViewType, double, 1 >  SpaceType;
+  typedef Spaces::ParallelDofs< SpaceType >               ParallelDofsType;
+  typedef Stuff::LA::CommonDenseVector< double >          VectorType;
+
+  ParallelDofsTest()
+    : grid_provider_(Stuff::Grid::Providers::Cube< GridType >::create())
+    , space_(grid_provider_->grid().leafGridView())
+  {}
+
+  VectorType create_vector() const
+  {
+    VectorType ret(space_.mapper().size(), 0.0);
+    for (size_t ii = 0; ii < ret.size(); ++ii)
+      ret.set_entry(ii, (ii % 5) + 1.0);
+    return ret;
+  }
+
+  std::unique_ptr< Stuff::Grid::Providers::Cube< GridType > > grid_provider_;
+  const SpaceType space_;
+}; // struct ParallelDofsTest
+
+
+TEST_F(ParallelDofsTest, owns_all_dofs_in_a_sequential_run)
+{
+  if (space_.grid_view().comm().size() > 1)
+    return;
+  const ParallelDofsType parallel_dofs(space_);
+  EXPECT_EQ(space_.mapper().size(), parallel_dofs.size());
+  EXPECT_EQ(parallel_dofs.size(), parallel_dofs.num_owned());
+  EXPECT_EQ(parallel_dofs.size(), parallel_dofs.global_size());
+  for (size_t ii = 0; ii < parallel_dofs.size(); ++ii) {
+    EXPECT_TRUE(parallel_dofs.owned(ii));
+    EXPECT_EQ(ii, parallel_dofs.global_index(ii));
+  }
+}
+
+TEST_F(ParallelDofsTest, exchange_keeps_owned_values)
+{
+  const ParallelDofsType parallel_dofs(space_);
+  const auto expected = create_vector();
+  auto vector = expected;
+  parallel_dofs.exchange(vector);
+  for (size_t ii = 0; ii < vector.size(); ++ii)
+    if (parallel_dofs.owned(ii))
+      EXPECT_EQ(expected.get_entry(ii), vector.get_entry(ii));
+}
+
+TEST_F(ParallelDofsTest, dot_counts_each_dof_once)
+{
+  const ParallelDofsType parallel_dofs(space_);
+  const auto vector = create_vector();
+  double expected = 0.0;
+  for (size_t ii = 0; ii < vector.size(); ++ii)
+    if (parallel_dofs.owned(ii))
+      expected += vector.get_entry(ii) * vector.get_entry(ii);
+  expected = space_.grid_view().comm().sum(expected);
+  EXPECT_DOUBLE_EQ(expected, parallel_dofs.dot(vector, vector));
+  if (space_.grid_view().comm().size() == 1)
+    EXPECT_DOUBLE_EQ(vector.dot(vector), parallel_dofs.dot(vector, vector));
+}
+
+TEST_F(ParallelDofsTest, halo_exchange_is_empty_in_a_sequential_run)
+{
+  if (space_.grid_view().comm().size() > 1)
+    return;
+  Spaces::HaloExchange< double > halo_exchange((ParallelDofsType(space_)));
+  EXPECT_TRUE(halo_exchange.empty());
+  EXPECT_TRUE(halo_exchange.sent_dofs().empty());
+  const auto expected = create_vector();
+  auto vector = expected;
+  halo_exchange.begin([&](const size_t dof) { return vector.get_entry(dof); });
+  halo_exchange.finish([&](const size_t dof, const double& value) { vector.set_entry(dof, 2.0 * value); });
+  EXPECT_EQ(0.0, (vector - expected).sup_norm());
+}
+
+
+#if HAVE_DUNE_PDELAB
+
+/**
+ * The vertex DoFs at the corners of the subdomains are shared by more than two processes, not all of which share an
+ * element. Run with at least 3 processes to cover these (see test/CMakeLists.txt).
+ */
+TEST(ParallelDofsCG, agree_on_owners_and_global_indices)
+{
+  typedef YaspGrid< 2 >                                         GridType;
+  typedef GridType::LeafGridView                                GridViewType;
+  typedef Spaces::CG::PdelabBased< GridViewType, 1, double, 1 > SpaceType;
+  const size_t num_elements = 8;
+  Stuff::Grid::Providers::Cube< GridType > grid_provider(0.0, 1.0, num_elements);
+  const SpaceType space(grid_provider.grid().leafGridView());
+  const Spaces::ParallelDofs< SpaceType > parallel_dofs(space);
+  const auto& comm = space.grid_view().comm();
+  // each vertex is owned by exactly one process
+  EXPECT_EQ((num_elements + 1) * (num_elements + 1), parallel_dofs.global_size());
+  EXPECT_EQ(parallel_dofs.global_size(), comm.sum(parallel_dofs.num_owned()));
+  // the owners send their global indices to all other processes
+  Stuff::LA::CommonDenseVector< double > vector(parallel_dofs.size(), -1.0);
+  for (size_t ii = 0; ii < parallel_dofs.size(); ++ii)
+    if (parallel_dofs.owned(ii))
+      vector.set_entry(ii, double(parallel_dofs.global_index(ii)));
+  parallel_dofs.exchange(vector);
+  for (size_t ii = 0; ii < parallel_dofs.size(); ++ii) {
+    EXPECT_LT(parallel_dofs.global_index(ii), parallel_dofs.global_size());
+    EXPECT_EQ(double(parallel_dofs.global_index(ii)), vector.get_entry(ii)) << "DoF " << ii;
+  }
+  // all non-owned DoFs are received, each from a single process
+  size_t num_sent = 0;
+  for (const auto& element : parallel_dofs.sends())
+    num_sent += element.second.size();
+  size_t num_received = 0;
+  for (const auto& element : parallel_dofs.receives())
+    num_received += element.second.size();
+  EXPECT_EQ(parallel_dofs.size() - parallel_dofs.num_owned(), num_received);
+  EXPECT_EQ(comm.sum(num_sent), comm.sum(num_received));
+}
+
+#else // HAVE_DUNE_PDELAB
+
+TEST(DISABLED_ParallelDofsCG, agree_on_owners_and_global_indices) {}
+
+#endif // HAVE_DUNE_PDELAB